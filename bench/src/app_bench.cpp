@@ -0,0 +1,84 @@
+#include "core/app.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+
+namespace
+{
+// Runs a fixed number of frames without a window and times them from the first update to the last
+class HeadlessApp: public zaphod::App
+{
+  public:
+	explicit HeadlessApp(uint32_t frameCount, uint32_t eventsPerFrame):
+		m_frameCount(frameCount), m_eventsPerFrame(eventsPerFrame)
+	{
+		setHeadless(true);
+	}
+
+	double getElapsedSeconds() const { return std::chrono::duration<double>(m_lastFrame - m_firstFrame).count(); }
+
+  protected:
+	bool onInitialize() override
+	{
+		zaphod::FramePacer::Config pacing;
+		pacing.mode				= zaphod::FramePacer::Mode::UNLIMITED;
+		pacing.throttleWhenIdle = false;
+		getFramePacer().setConfig(pacing);
+		getEventBus().subscribe<zaphod::events::KeyEvent>(m_onKey);
+		return true;
+	}
+
+	void onUpdate(float) override
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if (m_frame == 0)
+			m_firstFrame = now;
+		m_lastFrame = now;
+
+		// Input for the next frame's dispatch
+		for (uint32_t i = 0; i < m_eventsPerFrame; ++i)
+		{
+			zaphod::events::KeyEvent key {};
+			key.key = static_cast<int>(i);
+			getEventBus().publish(key);
+		}
+		if (++m_frame == m_frameCount)
+			requestExit();
+	}
+
+	void onRender(float) override {}
+	void onShutdown() override {}
+
+  private:
+	uint32_t m_frameCount;
+	uint32_t m_eventsPerFrame;
+	uint32_t m_frame   = 0;
+	int64_t	 m_handled = 0;
+	std::function<void(const zaphod::events::KeyEvent&)> m_onKey = [this](const zaphod::events::KeyEvent& event)
+	{ m_handled += event.key; };
+
+	std::chrono::steady_clock::time_point m_firstFrame;
+	std::chrono::steady_clock::time_point m_lastFrame;
+};
+
+// The engine's cost of a frame outside of rendering: events, main thread jobs, updates and pacing
+void BM_HeadlessFrameLoop(benchmark::State& state)
+{
+	constexpr uint32_t framesPerRun	  = 1000;
+	const uint32_t	   eventsPerFrame = static_cast<uint32_t>(state.range(0));
+	for (auto _ : state)
+	{
+		HeadlessApp app(framesPerRun + 1, eventsPerFrame);
+		if (!app.initialize(0, nullptr))
+		{
+			state.SkipWithError("Failed to initialize the app");
+			return;
+		}
+		app.run();
+		state.SetIterationTime(app.getElapsedSeconds());
+	}
+	state.SetItemsProcessed(state.iterations() * framesPerRun);
+}
+BENCHMARK(BM_HeadlessFrameLoop)->Arg(0)->Arg(64)->UseManualTime()->Unit(benchmark::kMillisecond);
+}	 // namespace
@@ -0,0 +1,56 @@
+#include "util/arena.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+namespace
+{
+using zaphod::LinearArena;
+
+// Mixes 1-aligned string copies with wider arrays near the end of a small block, the pattern
+// LogEvent::create produces. Every allocation is filled, so an overrun trips the arena's assert in
+// Debug builds and the sanitizers in instrumented ones.
+bool checkMixedAlignment()
+{
+	for (size_t alignment = 8; alignment <= 256; alignment *= 2)
+	{
+		for (size_t filler = 1; filler < 64; ++filler)
+		{
+			LinearArena arena(64);
+			std::memset(arena.allocate(1, 1), 0, 1);
+			std::memset(arena.allocate(filler, 1), 0, filler);
+			void* wide = arena.allocate(8, alignment);
+			if (reinterpret_cast<uintptr_t>(wide) % alignment != 0)
+				return false;
+			std::memset(wide, 0, 8);
+		}
+	}
+	return true;
+}
+
+void BM_ArenaMixedAlignment(benchmark::State& state)
+{
+	if (!checkMixedAlignment())
+	{
+		state.SkipWithError("Arena returned a misaligned allocation");
+		return;
+	}
+
+	constexpr char text[] = "Renderer initialized";
+	const uint64_t values[] = { 1, 2, 3, 4 };
+
+	LinearArena arena;
+	for (auto _ : state)
+	{
+		for (int i = 0; i < 64; ++i)
+		{
+			benchmark::DoNotOptimize(arena.copyString(std::string_view(text, 1 + i % (sizeof(text) - 1))));
+			benchmark::DoNotOptimize(arena.copyArray(std::span<const uint64_t>(values)));
+		}
+		arena.reset();
+	}
+	state.SetItemsProcessed(state.iterations() * 128);
+}
+BENCHMARK(BM_ArenaMixedAlignment);
+}	 // namespace
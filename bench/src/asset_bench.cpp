@@ -0,0 +1,54 @@
+#include "asset/asset_package.h"
+#include "util/lz4.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+using namespace zaphod;
+
+// A chunk of the size packages compress in, of words like indices and quantized attributes: three
+// in four small, the rest random
+std::vector<char> makeChunk()
+{
+	std::mt19937	  random(1);
+	std::vector<char> data(asset::asset_package::lz4ChunkSize);
+	for (size_t i = 0; i + sizeof(uint32_t) <= data.size(); i += sizeof(uint32_t))
+	{
+		const uint32_t word = random() % 64 < 48 ? random() % 256 : random();
+		std::memcpy(data.data() + i, &word, sizeof(word));
+	}
+	return data;
+}
+
+void BM_Lz4Compress(benchmark::State& state)
+{
+	const std::vector<char> data = makeChunk();
+	std::vector<char>		block(lz4CompressBound(data.size()));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(lz4Compress(data.data(), data.size(), block.data(), block.size()));
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Lz4Compress);
+
+void BM_Lz4Decompress(benchmark::State& state)
+{
+	const std::vector<char> data = makeChunk();
+	std::vector<char>		block(lz4CompressBound(data.size()));
+	std::vector<char>		output(data.size());
+	const size_t			blockSize = lz4Compress(data.data(), data.size(), block.data(), block.size());
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lz4Decompress(block.data(), blockSize, output.data(), output.size()));
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * data.size());
+	state.counters["ratio"] = static_cast<double>(blockSize) / data.size();
+}
+BENCHMARK(BM_Lz4Decompress);
+}	 // namespace
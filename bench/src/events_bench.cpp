@@ -0,0 +1,77 @@
+#include "core/event_bus.h"
+#include "gui/window_events.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using namespace zaphod::events;
+
+// A mix of event types, as handlers that take EventBase see them
+void BM_EventAs(benchmark::State& state)
+{
+	const KeyEvent		   key {};
+	const MouseMoveEvent   move {};
+	const WindowFocusEvent focus {};
+	const EventBase*	   events[] = { &key, &move, &focus, &move };
+
+	size_t i		 = 0;
+	double positions = 0.0;
+	for (auto _ : state)
+	{
+		const EventBase& event = *events[i++ % std::size(events)];
+		if (event.isType<MouseMoveEvent>())
+			positions += event.as<MouseMoveEvent>().x;
+		benchmark::DoNotOptimize(positions);
+	}
+}
+BENCHMARK(BM_EventAs);
+
+void BM_EventTryAs(benchmark::State& state)
+{
+	const KeyEvent		 key {};
+	const MouseMoveEvent move {};
+	const EventBase*	 events[] = { &key, &move };
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(events[i++ % std::size(events)]->tryAs<KeyEvent>());
+}
+BENCHMARK(BM_EventTryAs);
+
+// What a frame pays for its input: publish a batch of events and dispatch it to a few subscribers
+void BM_EventBusDispatch(benchmark::State& state)
+{
+	EventBus bus;
+	int64_t	 handled = 0;
+	auto	 onKey	 = [&handled](const KeyEvent& event) { handled += event.key; };
+	auto	 onMove	 = [&handled](const MouseMoveEvent& event) { handled += static_cast<int64_t>(event.x); };
+	bus.subscribe<KeyEvent>(onKey);
+	bus.subscribe<MouseMoveEvent>(onMove);
+	bus.subscribe<MouseMoveEvent>(onMove);
+
+	const int64_t batchSize = state.range(0);
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < batchSize; ++i)
+		{
+			if (i % 4 == 0)
+			{
+				KeyEvent key {};
+				key.key = static_cast<int>(i);
+				bus.publish(key);
+			}
+			else
+			{
+				MouseMoveEvent move {};
+				move.x = static_cast<double>(i);
+				bus.publish(move);
+			}
+		}
+		bus.dispatch();
+	}
+	benchmark::DoNotOptimize(handled);
+	state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_EventBusDispatch)->Arg(16)->Arg(256)->Arg(4096);
+}	 // namespace
@@ -0,0 +1,108 @@
+#include "core/logger.h"
+#include "util/flags.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using Level		 = zaphod::logging::Logger::LogLevel;
+using LevelFlags = zaphod::Flags<Level>;
+
+constexpr Level levels[] = { Level::INFO, Level::DEBUG, Level::WARN, Level::ERROR, Level::FATAL };
+
+void BM_FlagsSetAndCheck(benchmark::State& state)
+{
+	LevelFlags flags;
+	size_t	   i = 0;
+	for (auto _ : state)
+	{
+		const Level level = levels[i++ % std::size(levels)];
+		flags.setFlag(level, !flags.checkFlag(level));
+		benchmark::DoNotOptimize(flags);
+	}
+}
+BENCHMARK(BM_FlagsSetAndCheck);
+
+void BM_FlagsCombine(benchmark::State& state)
+{
+	const LevelFlags verbose({ Level::INFO, Level::DEBUG });
+	const LevelFlags errors({ Level::ERROR, Level::FATAL });
+	for (auto _ : state)
+	{
+		LevelFlags flags;
+		flags |= verbose;
+		flags |= Level::WARN;
+		flags.unsetFlags(errors);
+		benchmark::DoNotOptimize(flags.checkFlags(verbose & flags));
+	}
+}
+BENCHMARK(BM_FlagsCombine);
+
+void BM_FlagsFromVector(benchmark::State& state)
+{
+	const std::vector<Level> list(std::begin(levels), std::end(levels));
+	for (auto _ : state)
+	{
+		LevelFlags flags(list);
+		benchmark::DoNotOptimize(flags);
+	}
+}
+BENCHMARK(BM_FlagsFromVector);
+
+void BM_FlagsFromInitializerList(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		LevelFlags flags { Level::INFO, Level::DEBUG, Level::WARN, Level::ERROR, Level::FATAL };
+		benchmark::DoNotOptimize(flags);
+	}
+}
+BENCHMARK(BM_FlagsFromInitializerList);
+
+// Component masks as entity queries test them, over a few hundred types
+enum class Component : uint32_t
+{
+};
+using ComponentFlags = zaphod::Flags<Component, 512>;
+
+ComponentFlags makeMask(uint32_t seed, uint32_t count)
+{
+	ComponentFlags mask;
+	for (uint32_t i = 0; i < count; ++i)
+		mask.setFlag(static_cast<Component>((seed + i * 37) % ComponentFlags::bitCount));
+	return mask;
+}
+
+void BM_WideFlagsMatch(benchmark::State& state)
+{
+	const ComponentFlags required = makeMask(3, 4);
+	const ComponentFlags excluded = makeMask(101, 2);
+	ComponentFlags		 archetypes[64];
+	for (uint32_t i = 0; i < std::size(archetypes); ++i)
+		archetypes[i] = makeMask(i, 24);
+	archetypes[7] |= required;
+
+	for (auto _ : state)
+	{
+		size_t matches = 0;
+		for (const ComponentFlags& archetype : archetypes)
+			matches += archetype.checkAllFlags(required) && !archetype.checkFlags(excluded);
+		benchmark::DoNotOptimize(matches);
+	}
+	state.SetItemsProcessed(state.iterations() * std::size(archetypes));
+}
+BENCHMARK(BM_WideFlagsMatch);
+
+void BM_WideFlagsIterate(benchmark::State& state)
+{
+	const ComponentFlags mask = makeMask(5, 48);
+	for (auto _ : state)
+	{
+		uint32_t sum = 0;
+		mask.forEachFlag([&sum](Component component) { sum += static_cast<uint32_t>(component); });
+		benchmark::DoNotOptimize(sum);
+		benchmark::DoNotOptimize(mask.countFlags());
+	}
+}
+BENCHMARK(BM_WideFlagsIterate);
+}	 // namespace
@@ -0,0 +1,57 @@
+#include "gui/input_system.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using zaphod::InputState;
+using zaphod::InputSystem;
+using zaphod::RawInputEvent;
+
+// What a frame pays for its input: capture a batch of raw events, mostly mouse motion as from a
+// high-rate mouse, and fold them into the frame's snapshot
+void BM_InputSystemUpdate(benchmark::State& state)
+{
+	InputSystem	  input;
+	const int64_t batchSize = state.range(0);
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < batchSize; ++i)
+		{
+			RawInputEvent event;
+			if (i % 8 == 0)
+			{
+				event.type	 = RawInputEvent::Type::KEY;
+				event.code	 = GLFW_KEY_F11 + static_cast<int>(i % 2);
+				event.action = i % 16 == 0 ? GLFW_PRESS : GLFW_RELEASE;
+			}
+			else
+			{
+				event.type = RawInputEvent::Type::CURSOR;
+				event.x	   = static_cast<double>(i);
+				event.y	   = static_cast<double>(i);
+			}
+			input.record(event);
+		}
+		benchmark::DoNotOptimize(&input.update());
+	}
+	state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_InputSystemUpdate)->Arg(16)->Arg(256)->Arg(1024);
+
+// What a job pays to read the frame's input
+void BM_InputStateRead(benchmark::State& state)
+{
+	InputSystem input;
+	input.update();
+	int key = 0;
+	for (auto _ : state)
+	{
+		const InputState& snapshot = input.getState();
+		benchmark::DoNotOptimize(snapshot.isKeyDown(key));
+		benchmark::DoNotOptimize(snapshot.getCursorDeltaX());
+		key = (key + 1) % InputState::keyCount;
+	}
+}
+BENCHMARK(BM_InputStateRead);
+}	 // namespace
@@ -0,0 +1,160 @@
+#include "math/kernels.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+using namespace zaphod::math;
+
+constexpr size_t objectCount = 100000;
+
+// Every path the build has, the first argument of each benchmark
+void addLevels(benchmark::internal::Benchmark* benchmark)
+{
+	for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE, SimdLevel::AVX2, SimdLevel::NEON })
+		benchmark->Arg(static_cast<int64_t>(level));
+}
+
+// Run on the level of the benchmark's argument, false if this CPU or build has no such path
+bool useLevel(benchmark::State& state)
+{
+	const SimdLevel level = static_cast<SimdLevel>(state.range(0));
+	if (setSimdLevel(level) != level)
+	{
+		state.SkipWithError("Not supported here");
+		return false;
+	}
+	state.SetLabel(toString(level));
+	return true;
+}
+
+std::vector<float> makeValues(std::mt19937& random, float min, float max)
+{
+	std::uniform_real_distribution<float> distribution(min, max);
+	std::vector<float>					  values(objectCount);
+	for (float& value : values)
+		value = distribution(random);
+	return values;
+}
+
+// A frustum looking down -z from the origin, 90 degrees wide and tall, from 0.1 to 100
+Frustum makeFrustum()
+{
+	const float side = std::sqrt(0.5f);
+	return { { { side, 0.0f, -side, 0.0f },
+			   { -side, 0.0f, -side, 0.0f },
+			   { 0.0f, side, -side, 0.0f },
+			   { 0.0f, -side, -side, 0.0f },
+			   { 0.0f, 0.0f, -1.0f, -0.1f },
+			   { 0.0f, 0.0f, 1.0f, 100.0f } } };
+}
+
+void BM_ComposeTransforms(benchmark::State& state)
+{
+	if (!useLevel(state))
+		return;
+
+	std::mt19937		   random(1);
+	std::vector<float>	   values[10];
+	std::vector<glm::mat4> matrices(objectCount);
+	for (std::vector<float>& component : values)
+		component = makeValues(random, -1.0f, 1.0f);
+	const TransformArrays local { values[0].data(), values[1].data(), values[2].data(), values[3].data(), values[4].data(),
+								  values[5].data(), values[6].data(), values[7].data(), values[8].data(), values[9].data() };
+	for (auto _ : state)
+	{
+		composeTransforms(local, objectCount, matrices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_ComposeTransforms)->Apply(addLevels);
+
+void BM_PropagateTransforms(benchmark::State& state)
+{
+	if (!useLevel(state))
+		return;
+
+	// A wide, shallow hierarchy, every parent before its children
+	std::mt19937		   random(1);
+	std::vector<uint32_t>  parents(objectCount);
+	std::vector<glm::mat4> local(objectCount, glm::mat4(1.0f));
+	std::vector<glm::mat4> world(objectCount);
+	for (size_t i = 0; i < objectCount; ++i)
+		parents[i] = i % 16 == 0 ? noParent : static_cast<uint32_t>(random() % i);
+	for (auto _ : state)
+	{
+		propagateTransforms(local.data(), parents.data(), objectCount, world.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_PropagateTransforms)->Apply(addLevels);
+
+void BM_TransformSpheres(benchmark::State& state)
+{
+	if (!useLevel(state))
+		return;
+
+	std::vector<glm::mat4> world(objectCount, glm::mat4(1.0f));
+	std::vector<glm::vec4> local(objectCount, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	std::vector<float>	   components[4];
+	for (std::vector<float>& component : components)
+		component.resize(objectCount);
+	const SphereArrays spheres { components[0].data(), components[1].data(), components[2].data(), components[3].data() };
+	for (auto _ : state)
+	{
+		transformSpheres(world.data(), local.data(), objectCount, spheres);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_TransformSpheres)->Apply(addLevels);
+
+// Objects scattered around the camera, about a sixth of them visible
+void BM_CullSpheres(benchmark::State& state)
+{
+	if (!useLevel(state))
+		return;
+
+	std::mt19937		  random(1);
+	std::vector<float>	  x		 = makeValues(random, -100.0f, 100.0f);
+	std::vector<float>	  y		 = makeValues(random, -100.0f, 100.0f);
+	std::vector<float>	  z		 = makeValues(random, -100.0f, 100.0f);
+	std::vector<float>	  radius = makeValues(random, 0.5f, 2.0f);
+	std::vector<uint32_t> visible(objectCount);
+	const SphereArrays	  spheres { x.data(), y.data(), z.data(), radius.data() };
+	const Frustum		  frustum = makeFrustum();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(cullSpheres(frustum, spheres, objectCount, visible.data()));
+	state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_CullSpheres)->Apply(addLevels);
+
+void BM_CullBoxes(benchmark::State& state)
+{
+	if (!useLevel(state))
+		return;
+
+	std::mt19937		  random(1);
+	std::vector<float>	  centers[3];
+	std::vector<float>	  extents[3];
+	std::vector<uint32_t> visible(objectCount);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		centers[axis] = makeValues(random, -100.0f, 100.0f);
+		extents[axis] = makeValues(random, 0.5f, 2.0f);
+	}
+	const BoxArrays boxes { centers[0].data(), centers[1].data(), centers[2].data(),
+							extents[0].data(), extents[1].data(), extents[2].data() };
+	const Frustum	frustum = makeFrustum();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(cullBoxes(frustum, boxes, objectCount, visible.data()));
+	state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_CullBoxes)->Apply(addLevels);
+}	 // namespace
@@ -0,0 +1,93 @@
+#include "core/logger.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+namespace
+{
+using zaphod::logging::LogFileWriter;
+using zaphod::logging::Logger;
+using zaphod::logging::SimpleLogger;
+using zaphod::logging::SimpleLoggerFactory;
+
+const std::string					formatString = "[%{SOURCE}%][%{LEVEL}%][%{TIME}%]{%{*THREAD}%}: %{MESSAGE}%";
+const Logger::Format::ParameterMap parameters	= { { "SOURCE", "Bench" } };
+
+void BM_FormatConstruction(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		Logger::Format format(formatString, parameters);
+		benchmark::DoNotOptimize(format);
+	}
+}
+BENCHMARK(BM_FormatConstruction);
+
+void BM_FormatRender(benchmark::State& state)
+{
+	const Logger::Format   format(formatString, parameters);
+	const std::string_view dynamicParameters[] = { "main" };
+	std::string			   output;
+	for (auto _ : state)
+	{
+		output.clear();
+		format.render(output, "Loaded 128 meshes in 12 ms", Logger::LogLevel::INFO, "2025-01-01 12:00:00.000",
+					  dynamicParameters);
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * output.size()));
+}
+BENCHMARK(BM_FormatRender);
+
+void BM_ValidateFormatParameters(benchmark::State& state)
+{
+	for (auto _ : state)
+		benchmark::DoNotOptimize(zaphod::logging::validateFormatParameters(formatString, parameters));
+}
+BENCHMARK(BM_ValidateFormatParameters);
+
+enum class Sink
+{
+	FILE,
+	BINARY,
+	ASYNC_FILE
+};
+
+// The console is left out, its throughput is the terminal's
+void BM_SimpleLoggerInfo(benchmark::State& state, Sink sink)
+{
+	if (!Logger::isLevelCompiled(Logger::LogLevel::INFO))
+	{
+		state.SkipWithError("INFO is compiled out of this build");
+		return;
+	}
+
+	std::unique_ptr<SimpleLogger> logger = SimpleLoggerFactory("Bench").create();
+	logger->removeDestination(Logger::LogDestination::CONSOLE);
+
+	LogFileWriter::Config fileConfig;
+	fileConfig.path		  = std::filesystem::temp_directory_path() / "zaphod-bench.log";
+	zaphod::Result result = sink == Sink::BINARY ? logger->setBinaryLogFile(fileConfig) : logger->setLogFile(fileConfig);
+	if (result.isFailure())
+	{
+		state.SkipWithError(result.message);
+		return;
+	}
+	if (sink == Sink::ASYNC_FILE)
+		logger->enableAsync({ 1 << 14, Logger::OverflowPolicy::BLOCK });
+
+	int64_t count = 0;
+	for (auto _ : state)
+		logger->info("Loaded {} meshes in {} ms", ++count, 12);
+	state.SetItemsProcessed(state.iterations());
+
+	logger->flush();
+	logger.reset();
+	std::error_code error;
+	std::filesystem::remove(fileConfig.path, error);
+}
+BENCHMARK_CAPTURE(BM_SimpleLoggerInfo, file, Sink::FILE);
+BENCHMARK_CAPTURE(BM_SimpleLoggerInfo, binary, Sink::BINARY);
+BENCHMARK_CAPTURE(BM_SimpleLoggerInfo, async_file, Sink::ASYNC_FILE);
+}	 // namespace
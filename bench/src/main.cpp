@@ -0,0 +1,15 @@
+#include <benchmark/benchmark.h>
+
+// Run with --benchmark_out=<file> --benchmark_out_format=json for results to compare across versions
+int main(int argc, char** argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	benchmark::AddCustomContext("zaphod_revision", ZAPHOD_BENCH_REVISION);
+	benchmark::AddCustomContext("zaphod_build_type", ZAPHOD_BENCH_BUILD_TYPE);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
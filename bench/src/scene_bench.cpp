@@ -0,0 +1,117 @@
+#include "scene/world.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using namespace zaphod::scene;
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float x, y, z;
+};
+
+struct Health
+{
+	float value;
+};
+
+// Entities of three archetypes, so queries match more than one
+void populate(World& world, int64_t count)
+{
+	for (int64_t i = 0; i < count; ++i)
+	{
+		const float value = static_cast<float>(i);
+		if (i % 4 == 0)
+			world.create(Position { value, 0.0f, 0.0f });
+		else if (i % 4 == 1)
+			world.create(Position { value, 0.0f, 0.0f }, Velocity { 1.0f, 0.0f, 0.0f }, Health { 100.0f });
+		else
+			world.create(Position { value, 0.0f, 0.0f }, Velocity { 1.0f, 0.0f, 0.0f });
+	}
+}
+
+void BM_QueryForEach(benchmark::State& state)
+{
+	World world;
+	populate(world, state.range(0));
+	Query movers = world.query<Position, const Velocity>();
+	for (auto _ : state)
+	{
+		movers.forEach<Position, const Velocity>(
+			[](Position& position, const Velocity& velocity)
+			{
+				position.x += velocity.x * 0.016f;
+				position.y += velocity.y * 0.016f;
+				position.z += velocity.z * 0.016f;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(movers.getEntityCount()));
+}
+BENCHMARK(BM_QueryForEach)->Arg(1000)->Arg(100000);
+
+void BM_QueryParallelForEach(benchmark::State& state)
+{
+	zaphod::JobSystem jobs;
+	World			  world;
+	populate(world, state.range(0));
+	Query movers = world.query<Position, const Velocity>();
+	for (auto _ : state)
+	{
+		movers.parallelForEach<Position, const Velocity>(jobs,
+														 [](Position& position, const Velocity& velocity)
+														 {
+															 position.x += velocity.x * 0.016f;
+															 position.y += velocity.y * 0.016f;
+															 position.z += velocity.z * 0.016f;
+														 });
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(movers.getEntityCount()));
+}
+BENCHMARK(BM_QueryParallelForEach)->Arg(100000)->Arg(1000000)->UseRealTime();
+
+// Moving entities between archetypes, as adding and removing a tag component does
+void BM_AddRemoveComponent(benchmark::State& state)
+{
+	World world;
+	populate(world, 1024);
+	std::vector<Entity> entities;
+	world.query<Position>().forEach<Position>([&entities](Entity entity, Position&) { entities.push_back(entity); });
+
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		const Entity entity = entities[i++ % entities.size()];
+		world.add(entity, Health { 1.0f });
+		world.remove<Health>(entity);
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_AddRemoveComponent);
+
+void BM_CommandBufferApply(benchmark::State& state)
+{
+	World		  world;
+	CommandBuffer commands;
+	const int64_t batchSize = state.range(0);
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < batchSize; ++i)
+			commands.create(Position { 0.0f, 0.0f, 0.0f }, Velocity { 1.0f, 0.0f, 0.0f });
+		world.apply(commands);
+
+		state.PauseTiming();
+		world.query<Position>().forEach<Position>([&commands](Entity entity, Position&) { commands.destroy(entity); });
+		world.apply(commands);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_CommandBufferApply)->Arg(1024);
+}	 // namespace
@@ -0,0 +1,145 @@
+#include "asset/asset_loader.h"
+#include "core/glfw_common.h"
+#include "core/job_system.h"
+#include "gui/window.h"
+#include "render/renderer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+using namespace zaphod;
+namespace format = asset::asset_package;
+
+constexpr uint32_t textureExtent = 2048;
+
+// A package of one LZ4 texture with its whole mip chain, of texels that compress about as well as a real one's
+Result writeTexturePackage(const std::filesystem::path& path, format::TextureInfo& info)
+{
+	info = { VK_FORMAT_R8G8B8A8_UNORM, textureExtent, textureExtent, 12, 4 };
+	std::vector<format::CookedAsset> assets(1);
+	format::CookedAsset&			 texture = assets.front();
+	texture.name							 = "texture";
+	texture.entry.type						 = format::AssetType::TEXTURE;
+	format::setInfo(texture.entry, info);
+	texture.data.resize(format::getMipOffset(info, info.mipCount));
+	std::mt19937 random(1);
+	for (size_t i = 0; i + sizeof(uint32_t) <= texture.data.size(); i += sizeof(uint32_t))
+	{
+		const uint32_t texel = random() % 64 < 48 ? 0xff000000u | (i / 4096 % 256) : random();
+		std::memcpy(texture.data.data() + i, &texel, sizeof(texel));
+	}
+
+	std::string file;
+	Result		result = format::buildPackage(assets, true, file);
+	if (result.isFailure())
+		return result;
+	if (assets.front().entry.compression != format::Compression::LZ4)
+		return Result(Result::Code::FAILURE, "The texture did not compress");
+	std::ofstream stream(path, std::ios::binary);
+	stream.write(file.data(), static_cast<std::streamsize>(file.size()));
+	return stream ? Result(Result::Code::SUCCESS) : Result(Result::Code::IO_ERROR, "Failed to write " + path.string());
+}
+
+// Loads a large LZ4 texture on a worker while the main thread flushes the upload queue as every frame does. The
+// decompression runs outside the queue's lock, so the longest flush stays far below the time the load takes.
+void BM_FlushDuringTextureLoad(benchmark::State& state)
+{
+	if (!glfwInit())
+	{
+		state.SkipWithError("GLFW could not be initialized");
+		return;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "zaphod-upload-bench.zpk";
+	{
+		JobSystem		 jobs;
+		Window			 window(64, 64, "zaphod-bench", false);
+		render::Renderer renderer;
+		renderer.setJobSystem(&jobs);
+
+		format::TextureInfo info;
+		asset::AssetPackage package;
+		Result				result = window.getGLFWwindow() ? renderer.initialize(window)
+															: Result(Result::Code::UNSUPPORTED, "No window");
+		if (result.isSuccess())
+			result = writeTexturePackage(path, info);
+		if (result.isSuccess())
+			result = package.open(path);
+
+		render::Image image;
+		if (result.isSuccess())
+		{
+			VkImageCreateInfo imageInfo {};
+			imageInfo.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType		= VK_IMAGE_TYPE_2D;
+			imageInfo.format		= static_cast<VkFormat>(info.format);
+			imageInfo.extent		= { info.width, info.height, 1 };
+			imageInfo.mipLevels		= info.mipCount;
+			imageInfo.arrayLayers	= 1;
+			imageInfo.samples		= VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling		= VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage			= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			imageInfo.sharingMode	= VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			result = renderer.getMemoryAllocator().createImage(imageInfo, render::MemoryUsage::GPU_ONLY, image);
+		}
+		if (result.isFailure())
+		{
+			state.SkipWithError(result.message.c_str());
+		}
+		else
+		{
+			render::UploadQueue& uploads = renderer.getUploadQueue();
+			asset::AssetLoader	 loader(jobs, uploads);
+			const auto*			 entry	  = package.find("texture");
+			double				 maxFlush = 0.0;
+			uint64_t			 flushes  = 0;
+			for (auto _ : state)
+			{
+				asset::AssetLoader::Load load;
+				JobCounter				 counter;
+				loader.loadTexture(package, *entry, image.image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, load, counter);
+				while (!counter.isDone())
+				{
+					const auto start = std::chrono::steady_clock::now();
+					uploads.flush();
+					const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+					maxFlush = std::max(maxFlush, duration.count());
+					++flushes;
+				}
+
+				// Submit the texture and free its staging memory for the next iteration
+				state.PauseTiming();
+				if (load.result.isFailure())
+					state.SkipWithError(load.result.message.c_str());
+				uploads.flush();
+				renderer.getDevice().waitIdle();
+				uploads.flush();
+				state.ResumeTiming();
+				if (load.result.isFailure())
+					break;
+			}
+			state.SetBytesProcessed(state.iterations() * entry->size);
+			state.counters["max_flush_ms"]	   = maxFlush * 1000.0;
+			state.counters["flushes_per_load"] = static_cast<double>(flushes) / std::max<int64_t>(state.iterations(), 1);
+			renderer.getMemoryAllocator().destroyImage(image);
+		}
+		package.close();
+		renderer.shutdown();
+	}
+	std::filesystem::remove(path);
+	glfwTerminate();
+}
+BENCHMARK(BM_FlushDuringTextureLoad)->Unit(benchmark::kMillisecond)->UseRealTime();
+}	 // namespace
@@ -1,9 +1,18 @@
 #include "core/app.h"
 
+#include <deque>
+#include <string>
+
 class EditorApp : public zaphod::App {
+public:
+    // The most recent log messages, oldest first, for the console panel
+    const std::deque<std::string>& getConsoleLines() const { return m_consoleLines; }
+
 protected:
     bool onInitialize() override {
         // Editor-specific initialization
+        // Everything logged to the app's log event sink ends up in the console
+        getEventBus().subscribe<zaphod::events::LogEvent, &EditorApp::onLogEvent>(*this);
         return true;
     }
 
@@ -11,11 +20,21 @@ protected:
         // Editor update logic
     }
 
-    void onRender() override {
+    void onRender(float alpha) override {
         // Editor rendering
     }
 
     void onShutdown() override {
         // Editor cleanup
     }
+
+private:
+    static constexpr size_t maxConsoleLines = 1000;
+
+    std::deque<std::string> m_consoleLines;
+
+    void onLogEvent(const zaphod::events::LogEvent& event) {
+        if (m_consoleLines.size() == maxConsoleLines) m_consoleLines.pop_front();
+        m_consoleLines.emplace_back(event.getMessage());
+    }
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "asset/asset_package.h"
+#include "render/upload_queue.h"
+#include "util/result.h"
+
+namespace zaphod
+{
+class JobCounter;
+class JobSystem;
+}	 // namespace zaphod
+
+namespace zaphod::asset
+{
+/**
+ * @brief Loads assets from packages into GPU resources on job threads.
+ *
+ * @details
+ * Every load is one job, which pages the asset's blob in from the package's mapping and
+ * decompresses it straight into the staging ring of the @ref render::UploadQueue, so the data is
+ * never copied through a buffer of its own. Starting a load prefetches the blob, so the OS reads it
+ * in while the job waits to run. The decompression holds no lock of the upload queue, so however
+ * large the asset, the frame's @ref render::UploadQueue::flush never waits for it: the copy joins
+ * the batch being filled once the data is in the ring.
+ *
+ * The caller creates the resources from the entry, e.g. from its @ref asset_package::TextureInfo,
+ * and keeps the package, the entry and the @ref Load alive until the counter is done. The load then
+ * holds the result, and the ticket to pass to @ref render::Renderer::useUpload in the first frame
+ * using the resource.
+ *
+ * @code
+ * AssetLoader::Load load;
+ * JobCounter counter;
+ * loader.loadTexture(package, *entry, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, load, counter);
+ * // In a later frame, once counter.isDone()
+ * if (load.result.isSuccess())
+ *     renderer.useUpload(load.ticket);
+ * @endcode
+ *
+ * A load finding the staging ring full fails with Result::Code::OUT_OF_MEMORY, and can be started
+ * again once a later frame has flushed the uploads before it.
+ */
+class AssetLoader
+{
+  public:
+	struct Load
+	{
+		Result						result;
+		render::UploadQueue::Ticket ticket = 0;
+	};
+
+	/**
+	 * @param jobs The job system the loads run on
+	 * @param uploads The upload queue, initialized, both must outlive the loader's loads
+	 */
+	AssetLoader(JobSystem& jobs, render::UploadQueue& uploads): m_jobs(jobs), m_uploads(uploads) {}
+
+	/**
+	 * @brief Load an asset's data into a buffer, e.g. the vertices and indices of a mesh
+	 *
+	 * @param package The package, open until the load has finished
+	 * @param entry The asset, of any type
+	 * @param buffer The buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and room for entry.size bytes
+	 * @param offset Where the data goes in the buffer
+	 * @param load Receives the result of @ref render::UploadQueue::uploadBuffer and the ticket, or the
+	 * Result::Code::INVALID_ARGUMENT of a corrupted asset
+	 * @param counter Counts the job of the load
+	 */
+	void loadBuffer(const AssetPackage& package, const AssetPackage::Entry& entry, VkBuffer buffer, VkDeviceSize offset,
+					Load& load, JobCounter& counter);
+	/**
+	 * @brief Load a texture into every mip level of an image
+	 *
+	 * @param package The package, open until the load has finished
+	 * @param entry The texture
+	 * @param image The image, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT from the entry's
+	 * @ref asset_package::TextureInfo, with its format, extent and mip count
+	 * @param finalLayout The layout the image is in once the copy has finished
+	 * @param load As for @ref loadBuffer, the result is also Result::Code::INVALID_ARGUMENT if the
+	 * entry is not a texture
+	 * @param counter Counts the job of the load
+	 */
+	void loadTexture(const AssetPackage& package, const AssetPackage::Entry& entry, VkImage image, VkImageLayout finalLayout,
+					 Load& load, JobCounter& counter);
+
+  private:
+	JobSystem&			 m_jobs;
+	render::UploadQueue& m_uploads;
+};
+}	 // namespace zaphod::asset
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "util/result.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zaphod::asset
+{
+/**
+ * @brief The layout of asset package files, written by the `zaphod-asset-cooker` with @ref buildPackage
+ *
+ * @details
+ * A package starts with a @ref Header, followed by one @ref Entry per asset, sorted by name, and
+ * the names. The data of every asset, its blob, starts on a @ref blobAlignment boundary, so blobs
+ * are prefetched and paged in and out whole. Offsets count from the start of the file.
+ *
+ * Blobs hold the data as the GPU consumes it, so loading one is a copy or a decompression:
+ * - MESH: the vertices from offset 0 as @ref MeshInfo::layout describes, then uint32_t indices
+ *   at @ref MeshInfo::indexOffset
+ * - TEXTURE: every mip level from the largest, rows tightly packed, each level at
+ *   @ref getMipOffset, ready for vkCmdCopyBufferToImage
+ * - RAW: anything else, as the cooker found it
+ *
+ * LZ4 blobs are split into chunks of @ref lz4ChunkSize bytes, the last one shorter, each an
+ * independent LZ4 block after its uint32_t size. Chunks that did not compress are stored as they
+ * are, with @ref rawChunkBit set in their size. Chunks keep what a block refers back to in the
+ * cache while it decompresses, and let the destination be write-combined staging memory.
+ */
+namespace asset_package
+{
+inline constexpr char	  magic[4]		= { 'Z', 'A', 'P', 'K' };
+inline constexpr uint32_t version		= 1;
+inline constexpr uint64_t blobAlignment = 4096;
+inline constexpr uint64_t mipAlignment	= 16;	 // Suits copies of formats with power of two texel sizes
+inline constexpr uint32_t maxMipCount	= 32;
+inline constexpr uint32_t lz4ChunkSize	= 64 << 10;
+inline constexpr uint32_t rawChunkBit	= 0x80000000u;
+
+enum class AssetType : uint32_t
+{
+	RAW,
+	MESH,
+	TEXTURE
+};
+
+enum class Compression : uint32_t
+{
+	NONE,
+	LZ4	   // LZ4 blocks of lz4ChunkSize bytes, see util/lz4.h
+};
+
+enum class MeshLayout : uint32_t
+{
+	INTERLEAVED,	// Position, normal and uv of each vertex together, 32 bytes
+	SPLIT			// All positions, 12 bytes each, then all normals and uvs, 20 bytes each
+};
+
+struct MeshInfo
+{
+	MeshLayout layout;
+	uint32_t   vertexCount;
+	uint32_t   indexCount;
+	uint32_t   attributeOffset;	   // Of the normals and uvs with SPLIT, 0 with INTERLEAVED
+	uint32_t   indexOffset;
+};
+
+struct TextureInfo
+{
+	uint32_t format;	// A VkFormat
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t texelSize;	   // In bytes
+};
+
+struct Header
+{
+	char	 magic[4];
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+};
+
+struct Entry
+{
+	uint32_t	nameOffset;
+	uint32_t	nameLength;
+	AssetType	type;
+	Compression compression;
+	uint64_t	offset;		   // Of the blob, a multiple of blobAlignment
+	uint64_t	storedSize;	   // Of the blob in the file
+	uint64_t	size;		   // Of the data once decompressed
+	uint64_t	hash;		   // hashBytes of the blob as stored, see AssetPackage::verify
+	uint32_t	info[6];	   // A MeshInfo or TextureInfo, by type
+};
+static_assert(sizeof(Header) == 16 && sizeof(Entry) == 72);
+static_assert(sizeof(MeshInfo) <= sizeof(Entry::info) && sizeof(TextureInfo) <= sizeof(Entry::info));
+
+template<typename T>
+T getInfo(const Entry& entry)
+{
+	T info;
+	std::memcpy(&info, entry.info, sizeof(info));
+	return info;
+}
+
+template<typename T>
+void setInfo(Entry& entry, const T& info)
+{
+	std::memcpy(entry.info, &info, sizeof(info));
+}
+
+constexpr uint32_t getMipExtent(uint32_t extent, uint32_t level)
+{
+	return extent >> level > 0 ? extent >> level : 1;
+}
+
+/**
+ * @brief Get where a mip level starts in a texture's data
+ *
+ * @param info The texture
+ * @param level The level, info.mipCount gives the size of the whole chain
+ * @return The offset in bytes, a multiple of @ref mipAlignment
+ */
+constexpr uint64_t getMipOffset(const TextureInfo& info, uint32_t level)
+{
+	uint64_t offset = 0;
+	for (uint32_t i = 0; i < level; ++i)
+	{
+		offset += uint64_t(getMipExtent(info.width, i)) * getMipExtent(info.height, i) * info.texelSize;
+		offset = (offset + mipAlignment - 1) & ~(mipAlignment - 1);
+	}
+	return offset;
+}
+
+/**
+ * @brief An asset on its way into a package, as the cooker produced it
+ */
+struct CookedAsset
+{
+	std::string name;
+	Entry		entry {};	 // Its type and info, @ref buildPackage fills in the rest
+	std::string data;		 // As the GPU consumes it, before compression
+};
+
+/**
+ * @brief Compress data into an LZ4 blob, chunked as described above
+ *
+ * @param data The data to compress
+ * @return The blob, empty if it would not be at least a page smaller than the data
+ */
+std::string compressBlob(std::string_view data);
+/**
+ * @brief Lay out a package file
+ *
+ * @details
+ * Sorts the assets by name and fills in the rest of their entries. With `compress` every blob that
+ * @ref compressBlob gets a page smaller is stored compressed, the data of the others is moved into
+ * the file as it is.
+ *
+ * @param assets The assets, sorted and with their entries completed on return
+ * @param compress Whether to try LZ4 for every blob
+ * @param file Receives the contents of the package file
+ * @return Result::Code::SUCCESS if the file was laid out\n
+ * Result::Code::INVALID_ARGUMENT if more than one asset has the same name
+ */
+Result buildPackage(std::vector<CookedAsset>& assets, bool compress, std::string& file);
+}	 // namespace asset_package
+
+/**
+ * @brief A memory mapped package of cooked assets.
+ *
+ * @details
+ * Opening maps the file and checks its entry table, nothing else is read: the blobs are paged in
+ * by whoever reads them, typically @ref AssetLoader jobs, which decompress them straight into the
+ * staging ring. @ref prefetch starts reading a blob in ahead of that, and pages of blobs nothing
+ * reads stay on disk. Looking an asset up is a binary search over the names in the mapping.
+ *
+ * @code
+ * AssetPackage package;
+ * if (package.open("assets.zap").isSuccess())
+ *     if (const asset_package::Entry* entry = package.find("meshes/ship"))
+ *         loader.loadBuffer(package, *entry, vertexBuffer, 0, load, counter);
+ * @endcode
+ *
+ * The const methods can be called from any thread. The file must not change while it is open:
+ * reading a blob of a file truncated underneath the mapping faults.
+ */
+class AssetPackage
+{
+  public:
+	using Entry = asset_package::Entry;
+
+	AssetPackage();
+	~AssetPackage();
+
+	// Non-copyable, non-movable
+	AssetPackage(const AssetPackage&)			 = delete;
+	AssetPackage& operator=(const AssetPackage&) = delete;
+	AssetPackage(AssetPackage&&)				 = delete;
+	AssetPackage& operator=(AssetPackage&&)		 = delete;
+
+	/**
+	 * @brief Map a package file, closing the current one
+	 *
+	 * @param path The package file
+	 * @return Result::Code::SUCCESS if the package was opened\n
+	 * Result::Code::IO_ERROR if the file could not be mapped\n
+	 * Result::Code::INVALID_ARGUMENT if it is not a valid asset package
+	 */
+	Result open(const std::filesystem::path& path);
+	/**
+	 * @brief Unmap the file, no read may be running
+	 */
+	void close();
+
+	/**
+	 * @brief Find an asset
+	 *
+	 * @param name The name the cooker gave it
+	 * @return The entry, valid until @ref close, nullptr if the package has no such asset
+	 */
+	const Entry*		   find(std::string_view name) const;
+	std::span<const Entry> getEntries() const { return m_entries; }
+	std::string_view	   getName(const Entry& entry) const;
+	/**
+	 * @brief Get the blob of an asset as it is stored, compressed or not
+	 */
+	std::span<const std::byte> getBlob(const Entry& entry) const;
+
+	/**
+	 * @brief Ask the OS to start reading a blob in, returns immediately
+	 */
+	void prefetch(const Entry& entry) const;
+	/**
+	 * @brief Copy or decompress an asset's data
+	 *
+	 * @details
+	 * Pages the blob in on the calling thread, so it is meant for jobs. The blob is not hashed, a
+	 * corrupted LZ4 block fails to decompress but a corrupted uncompressed one is copied as is.
+	 *
+	 * @param entry The asset
+	 * @param destination Receives entry.size bytes
+	 * @return Result::Code::SUCCESS if the data was written\n
+	 * Result::Code::INVALID_ARGUMENT if the blob does not decompress to entry.size bytes
+	 */
+	Result read(const Entry& entry, void* destination) const;
+	/**
+	 * @brief Check a blob against the hash the cooker stored, for tools and debugging
+	 *
+	 * @param entry The asset
+	 * @return Result::Code::SUCCESS if the blob is intact\n
+	 * Result::Code::INVALID_ARGUMENT if it is not
+	 */
+	Result verify(const Entry& entry) const;
+
+	bool   isOpen() const { return m_data != nullptr; }
+	size_t getSize() const { return m_size; }
+
+  private:
+	struct Mapping;
+
+	std::unique_ptr<Mapping> m_mapping;
+	const std::byte*		 m_data = nullptr;
+	size_t					 m_size = 0;
+	std::span<const Entry>	 m_entries;
+};
+}	 // namespace zaphod::asset
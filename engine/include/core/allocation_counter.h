@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace zaphod
+{
+/**
+ * @brief Get the number of heap allocations the program has made so far
+ *
+ * @details
+ * With the `ZAPHOD_ALLOCATION_COUNTER` CMake option, builds other than Release replace the global
+ * `operator new` of the whole program with one that counts every call, from every thread and
+ * library, with one relaxed atomic increment before calling `malloc`. The @ref App samples the
+ * count once per frame to report how many allocations a frame made, see
+ * @ref App::getFrameAllocationCount. Steady frames are meant to make none, with per-frame data in
+ * @ref App::getFrameArena and long-lived objects in pools.
+ *
+ * @return The number of allocations, always 0 if they are not counted
+ */
+uint64_t getHeapAllocationCount();
+
+/**
+ * @brief Check if this build counts heap allocations, see @ref getHeapAllocationCount
+ *
+ * @return true if allocations are counted, false otherwise
+ */
+bool isHeapAllocationCounted();
+}	 // namespace zaphod
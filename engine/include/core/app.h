@@ -1,7 +1,19 @@
 #pragma once
 
+#include "core/event_bus.h"
+#include "core/frame_pacer.h"
+#include "core/profiler.h"
+#include "core/job_system.h"
+#include "core/log_event_sink.h"
+#include "gui/input_system.h"
 #include "gui/window.h"
+#include "gui/window_events.h"
+#include "render/renderer.h"
+#include "scene/world.h"
+#include "util/arena.h"
+#include "util/memory_resource.h"
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -23,15 +35,123 @@ class App
 	virtual int	 run();
 	virtual void shutdown();
 
+	// Run without windows, GLFW or a renderer, set before initialize. Frames still dispatch events, run main
+	// thread jobs and onUpdate, but never onRender, e.g. for benchmarks and servers. End run() with requestExit.
+	void setHeadless(bool headless) { m_headless = headless; }
+	bool isHeadless() const { return m_headless; }
+	// End run() once the current frame is done
+	void requestExit() { m_running = false; }
+
+	// The bus window, input, logging and application events are published to, dispatched once per frame after polling
+	events::EventBus&		getEventBus() { return m_eventBus; }
+	const events::EventBus& getEventBus() const { return m_eventBus; }
+	// Publishes the records of loggers given it with setEventSink to the bus as LogEvent, right before each dispatch.
+	// The engine's own logger uses it, so errors reported by run() reach the bus too.
+	events::LogEventSink& getLogEventSink() { return m_logEventSink; }
+
+	// Keyboard and mouse input of every window, one snapshot per frame taken right after polling. getState() may be
+	// called from any job, the bus still delivers the individual events for UI and text input.
+	InputSystem&	   getInputSystem() { return m_inputSystem; }
+	const InputSystem& getInputSystem() const { return m_inputSystem; }
+
+	// The thread pool for engine and application jobs, valid between initialize and shutdown
+	JobSystem&		 getJobSystem() { return *m_jobSystem; }
+	const JobSystem& getJobSystem() const { return *m_jobSystem; }
+
+	// The entities of the application. Structural changes made while a query runs, e.g. from parallelForEach jobs,
+	// go into getCommandBuffer(), which is the calling worker's own; every buffer is applied after onUpdate.
+	scene::World&		  getWorld() { return m_world; }
+	const scene::World&	  getWorld() const { return m_world; }
+	scene::CommandBuffer& getCommandBuffer() { return m_commandBuffers[m_jobSystem->getCurrentWorkerIndex()]; }
+
+	// Open a window from onInitialize or later, publishing to the event bus and rendered to from the next frame. The
+	// first window is the main one, run() opens a 1280x720 one if onInitialize opened none. nullptr if it failed.
+	// Resizing recreates the window's swapchain without stalling, and frames keep rendering during the resize.
+	Window* openWindow(int width, int height, const char* title, bool resizable = true);
+	// Close a window at the end of the frame, closing the main window ends run(). The windows other than the main one
+	// also close when their close button is pressed.
+	void										closeWindow(Window& window);
+	const std::vector<std::unique_ptr<Window>>& getWindows() const { return m_windows; }
+	// The first window opened, nullptr before there is one
+	Window* getMainWindow() const { return m_windows.empty() ? nullptr : m_windows.front().get(); }
+
+	// Renders to every window, configure it from onInitialize. In onRender, record into getRenderer().getCurrentFrame()
+	// on the main thread, for the main window unless it is minimized, and fan draws out to the job workers with
+	// getRenderer().record. getRenderer().selectWindow switches to another window.
+	render::Renderer&		getRenderer() { return m_renderer; }
+	const render::Renderer& getRenderer() const { return m_renderer; }
+
+	// Controls the frame rate of run(), configure it from onInitialize
+	FramePacer&		  getFramePacer() { return m_framePacer; }
+	const FramePacer& getFramePacer() const { return m_framePacer; }
+
+	// Run onUpdate in fixed steps of `step` seconds, at most `maxStepsPerFrame` per frame. Time that
+	// cannot be caught up within that budget is dropped instead of piling up (the spiral of death).
+	void setFixedTimestep(double step, uint32_t maxStepsPerFrame = 8);
+	// Run onUpdate once per frame with the measured frame time (the default)
+	void setVariableTimestep();
+	bool   isFixedTimestep() const { return m_fixedTimestep > 0.0; }
+	double getFixedTimestep() const { return m_fixedTimestep; }
+
+	// Reset at the start of every frame, for data that lives for one frame. Allocating from it never touches the heap
+	// once it has grown to a frame's needs; the resource lets std::pmr containers use it.
+	LinearArena&			   getFrameArena() { return m_frameArena; }
+	std::pmr::memory_resource& getFrameResource() { return m_frameResource; }
+	// The heap allocations the previous frame made on any thread, 0 unless isHeapAllocationCounted(). F12 logs it.
+	uint64_t getFrameAllocationCount() const { return m_frameAllocationCount; }
+
+	// Where F11 writes the profiler capture it stops, see profiling::Profiler. F12 logs the frame time statistics.
+	void						 setProfileCapturePath(std::filesystem::path path) { m_profileCapturePath = std::move(path); }
+	const std::filesystem::path& getProfileCapturePath() const { return m_profileCapturePath; }
+
   protected:
 	virtual bool onInitialize()			   = 0;
 	virtual void onUpdate(float deltaTime) = 0;
-	virtual void onRender()				   = 0;
+	// `alpha` is how far the current time is between the last two fixed updates (0..1), used to
+	// interpolate rendered state. It is always 1 with a variable timestep. Only called when there is
+	// a frame to render to, i.e. not while the window is minimized.
+	virtual void onRender(float alpha)	   = 0;
 	virtual void onShutdown()			   = 0;
 
   private:
 	bool m_running	   = false;
 	bool m_initialized = false;
+	bool m_headless	   = false;
 	std::vector<std::unique_ptr<Window>> m_windows;
+	std::vector<Window*>				 m_closingWindows;	  // Closed at the end of the frame
+	bool								 m_isPollingEvents = false;	   // Inside the event pump, see onWindowRefresh
+	FramePacer::Clock::time_point		 m_pumpStart;				   // When the pump was entered or last rendered from
+	float								 m_alpha		   = 1.0f;	   // Passed to onRender, from the last update
+	events::EventBus	 m_eventBus;
+	events::LogEventSink m_logEventSink;
+	InputSystem			 m_inputSystem;
+	FramePacer			 m_framePacer;
+	std::unique_ptr<JobSystem> m_jobSystem;
+	render::Renderer		   m_renderer;
+
+	scene::World					  m_world;
+	std::vector<scene::CommandBuffer> m_commandBuffers;	   // One per job worker
+
+	double	 m_fixedTimestep	= 0.0;	  // Seconds per update, 0 for a variable timestep
+	uint32_t m_maxStepsPerFrame = 8;
+	double	 m_accumulator		= 0.0;
+
+	LinearArena	  m_frameArena;
+	ArenaResource m_frameResource { m_frameArena };
+	uint64_t	  m_allocationCount		 = 0;	 // The heap allocation count when the current frame began
+	uint64_t	  m_frameAllocationCount = 0;
+
+	std::filesystem::path m_profileCapturePath = "profile.json";
+	bool				  m_isCaptureToggled   = false;	   // F11 was pressed this frame
+	bool				  m_areStatsRequested  = false;	   // F12 was pressed this frame
+	events::EventBus::SubscriptionId m_profilerKeySubscription = events::EventBus::invalidSubscription;
+
+	void  closePendingWindows();
+	void  renderFrame();
+	void  onWindowRefresh();
+	bool  isIdle() const;
+	float advanceSimulation(double frameTime);
+	void  applyCommandBuffers();
+	void  onProfilerKey(const events::KeyEvent& event);
 };
 }	 // namespace zaphod
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "core/logger.h"
+#include "util/mpmc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace zaphod::logging
+{
+/**
+ * @brief Writes a logger's records on a dedicated sink thread.
+ *
+ * @details
+ * Producers copy each record into a fixed-size entry of a bounded lock-free
+ * [queue](@ref zaphod::MpmcQueue): level, format index, timestamp, message bytes and
+ * length-prefixed dynamic parameters. The sink thread pops entries, rebuilds a
+ * @ref Logger::Record that views the entry, and passes it to the logger's @ref Logger::write.
+ * Formatting and console/file I/O therefore never happen on the logging thread.
+ *
+ * While the queue is empty the sink thread sleeps, waking every @ref idleInterval to let the
+ * logger's destinations write out buffered output.
+ *
+ * Messages and parameters that do not fit in an entry are truncated, and parameters beyond
+ * @ref maxDynamicParameters are dropped; both are counted in the statistics.
+ *
+ * @note Backends are created through @ref Logger::enableAsync.
+ *
+ * @see Logger::AsyncConfig
+ * @see Logger::OverflowPolicy
+ */
+class AsyncLogBackend
+{
+  public:
+	/**
+	 * @brief The maximum number of dynamic parameters carried by a queued record
+	 */
+	static constexpr size_t maxDynamicParameters = Logger::maxDynamicParameters;
+	/**
+	 * @brief The number of bytes available for the message and its parameters in a queued record
+	 */
+	static constexpr size_t payloadCapacity = Logger::maxMessageLength + Logger::maxDynamicParametersLength;
+	/**
+	 * @brief How often the idle sink thread wakes up to flush destinations
+	 */
+	static constexpr std::chrono::milliseconds idleInterval = std::chrono::milliseconds(100);
+
+	/**
+	 * @brief Counters describing the backend's activity since it was created
+	 */
+	struct Statistics
+	{
+		uint64_t enqueued	   = 0;	   //!< Records accepted into the queue
+		uint64_t written	   = 0;	   //!< Records written by the sink thread
+		uint64_t droppedNewest = 0;	   //!< Records discarded because the queue was full (DROP_NEWEST)
+		uint64_t droppedOldest = 0;	   //!< Queued records discarded to make room (DROP_OLDEST)
+		uint64_t truncated	   = 0;	   //!< Records whose message or parameters were cut short
+	};
+
+	/**
+	 * @brief Construct a new AsyncLogBackend and start its sink thread
+	 *
+	 * @param logger The logger whose @ref Logger::write the sink thread calls
+	 * @param config The queue capacity and overflow policy
+	 */
+	AsyncLogBackend(Logger& logger, const Logger::AsyncConfig& config);
+	/**
+	 * @brief Write every queued record and stop the sink thread
+	 */
+	~AsyncLogBackend();
+
+	// Non-copyable, non-movable
+	AsyncLogBackend(const AsyncLogBackend&)			   = delete;
+	AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+	AsyncLogBackend(AsyncLogBackend&&)				   = delete;
+	AsyncLogBackend& operator=(AsyncLogBackend&&)	   = delete;
+
+	/**
+	 * @brief Queue a record for the sink thread
+	 *
+	 * @param record The record to copy into the queue
+	 * @return true if the record was queued, false if it was dropped
+	 */
+	bool enqueue(const Logger::Record& record);
+	/**
+	 * @brief Wait until every record queued before the call has been written or dropped
+	 */
+	void flush();
+
+	/**
+	 * @brief Get a snapshot of the backend's counters
+	 *
+	 * @return The current statistics
+	 */
+	Statistics getStatistics() const;
+	/**
+	 * @brief Get the total number of dropped records
+	 *
+	 * @return The number of records dropped by either drop policy
+	 */
+	uint64_t getDroppedCount() const
+	{
+		return m_droppedNewest.load(std::memory_order_relaxed) + m_droppedOldest.load(std::memory_order_relaxed);
+	}
+
+  private:
+	struct Entry
+	{
+		int64_t			 time		 = 0;
+		uint32_t		 formatIndex = 0;
+		Logger::LogLevel level		 = Logger::LogLevel::EMPTY;
+		uint16_t		 messageLength;
+		uint16_t		 parameterCount;
+		uint16_t		 parameterLengths[maxDynamicParameters];
+		char			 payload[payloadCapacity];
+	};
+
+	void run();
+	void write(const Entry& entry);
+	void wake();
+
+	Logger&					m_logger;
+	Logger::OverflowPolicy	m_overflowPolicy;
+	MpmcQueue<Entry>		m_queue;
+	std::atomic<uint64_t>	m_enqueued { 0 };
+	std::atomic<uint64_t>	m_consumed { 0 };
+	std::atomic<uint64_t>	m_written { 0 };
+	std::atomic<uint64_t>	m_droppedNewest { 0 };
+	std::atomic<uint64_t>	m_droppedOldest { 0 };
+	std::atomic<uint64_t>	m_truncated { 0 };
+	std::atomic<bool>		m_running { true };
+	std::atomic<bool>		m_sleeping { false };
+	std::mutex				m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+	std::thread				m_thread;
+};
+}	 // namespace zaphod::logging
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "core/logger.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zaphod::logging
+{
+/**
+ * @brief Constants describing the binary log file layout.
+ *
+ * @details
+ * A binary log file starts with a header:
+ * - `magic` (8 bytes), `version` (u32)
+ * - the numerator and denominator of the timestamp tick period in seconds (2 x i64)
+ * .
+ * followed by a sequence of chunks, each starting with a one byte @ref ChunkType:
+ * - FORMAT: index (u32), format string (u32 length + bytes), static token count (u32), then
+ *   for every static token its name and value (u32 length + bytes each). A FORMAT chunk replaces
+ *   any earlier definition of the same index.
+ * - RECORD: level (u8), format index (u32), raw timestamp ticks (i64), message (u16 length + bytes),
+ *   dynamic parameter count (u8), then every parameter (u16 length + bytes).
+ * .
+ * Every new file starts with the header and a FORMAT chunk for each format, so rotated files
+ * decode on their own. All integers are stored in the host's byte order (little-endian on every
+ * supported platform).
+ */
+namespace binary_log
+{
+inline constexpr char	  magic[8] = { 'Z', 'A', 'P', 'H', 'L', 'O', 'G', '\0' };
+inline constexpr uint32_t version  = 1;
+
+enum class ChunkType : uint8_t
+{
+	FORMAT = 1,
+	RECORD = 2
+};
+}	 // namespace binary_log
+
+/**
+ * @brief Writes compact binary records for the BINARY log destination.
+ *
+ * @details
+ * Instead of rendering text, every record is written as its format index, level, raw timestamp
+ * and length-prefixed message and dynamic parameters. Format strings are written once, so the
+ * logging thread (or the async sink thread) never formats text for this destination.
+ * The output goes through a @ref LogFileWriter and is batched and rotated like text logs.
+ *
+ * Use the `zaphod-log-decoder` tool, or @ref BinaryLogReader, to turn the files back into text.
+ *
+ * @note Binary log files are always truncated when opened, never appended to.
+ */
+class BinaryLogWriter
+{
+  public:
+	/**
+	 * @brief Open the binary log file
+	 *
+	 * @param config The log file configuration, `append` is ignored
+	 * @param formats The logger's current formats, written into the file header
+	 * @return The Result of opening the file
+	 */
+	Result open(const LogFileWriter::Config& config, const std::vector<Logger::Format>& formats);
+	/**
+	 * @brief Flush and close the binary log file
+	 */
+	void close() { m_file.close(); }
+
+	/**
+	 * @brief Write the definitions of the logger's formats
+	 *
+	 * @details
+	 * Called whenever the logger's formats change, so that later records decode with the new
+	 * definitions. Files created by rotation afterwards start with these definitions.
+	 *
+	 * @param formats The logger's current formats
+	 */
+	void setFormats(const std::vector<Logger::Format>& formats);
+	/**
+	 * @brief Write a record
+	 *
+	 * @param record The record to write
+	 */
+	void write(const Logger::Record& record);
+
+	void flush() { m_file.flush(); }
+	void flushIfDue() { m_file.flushIfDue(); }
+
+  private:
+	std::string encodeHeader(const std::vector<Logger::Format>& formats) const;
+
+	LogFileWriter m_file;
+};
+
+/**
+ * @brief Reads binary log files written by @ref BinaryLogWriter.
+ */
+class BinaryLogReader
+{
+  public:
+	/**
+	 * @brief A record read from a binary log file
+	 *
+	 * @details
+	 * The message and parameters view the reader's buffer and stay valid until the reader is
+	 * reopened or destroyed.
+	 */
+	struct Entry
+	{
+		Logger::LogLevel					  level		  = Logger::LogLevel::EMPTY;
+		uint32_t							  formatIndex = 0;
+		std::chrono::system_clock::time_point time;
+		std::string_view					  message;
+		std::vector<std::string_view>		  dynamicParameters;
+	};
+
+	/**
+	 * @brief Load a binary log file and validate its header
+	 *
+	 * @param path The path of the file
+	 * @return Result::Code::SUCCESS if the file was loaded\n
+	 * Result::Code::IO_ERROR if it could not be read\n
+	 * Result::Code::INVALID_ARGUMENT if it is not a binary log file or has an unsupported version
+	 */
+	Result open(const std::filesystem::path& path);
+
+	/**
+	 * @brief Read the next record, applying any format definitions before it
+	 *
+	 * @param entry Receives the record
+	 * @return true if a record was read, false at the end of the file or if the file is truncated
+	 */
+	bool next(Entry& entry);
+
+	/**
+	 * @brief Get the format a record refers to
+	 *
+	 * @param index The format index of the record
+	 * @return The most recent definition of the format read so far, or nullptr if there is none
+	 */
+	const Logger::Format* getFormat(uint32_t index) const;
+	/**
+	 * @brief Get the static tokens of a format
+	 *
+	 * @param index The format index
+	 * @return The static tokens of the most recent definition of the format, or an empty map
+	 */
+	const Logger::Format::ParameterMap& getStaticTokens(uint32_t index) const;
+
+  private:
+	bool readFormat();
+
+	template<typename T>
+	bool read(T& value);
+	bool readString(std::string_view& value, size_t length);
+
+	std::string								   m_data;
+	size_t									   m_offset = 0;
+	int64_t									   m_periodNumerator;
+	int64_t									   m_periodDenominator;
+	std::vector<std::optional<Logger::Format>> m_formats;
+};
+}	 // namespace zaphod::logging
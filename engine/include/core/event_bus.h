@@ -0,0 +1,282 @@
+#pragma once
+
+#include "core/events.h"
+#include "util/arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zaphod::events
+{
+/**
+ * @brief Queues events by type and delivers them to subscribers in batches.
+ *
+ * @details
+ * Every event type is indexed directly by its @ref EventTypeId, with a list of subscribers and a
+ * contiguous array of queued events. The arrays are allocated from a per-frame @ref LinearArena,
+ * so publishing an event is a copy into arena memory and never a heap allocation once the arena
+ * has warmed up.
+ *
+ * The queue is double-buffered: @ref dispatch swaps buffers before delivering, so events
+ * published by handlers (or from anywhere else while a dispatch is running) are queued for the
+ * next dispatch instead of extending the current one. Each buffer's arena is reset once its
+ * events have been delivered. Urgent events can bypass the queue with @ref dispatchImmediate.
+ *
+ * Subscribers are plain function pointer delegates (a context pointer plus a generated thunk),
+ * so delivery involves no virtual calls. With @ref DeliveryOrder::BY_TYPE, @ref dispatch hands
+ * each subscriber all queued events of a type in one run before moving on to the next
+ * subscriber, keeping the handler hot in cache.
+ *
+ * @code
+ * struct Camera
+ * {
+ *     void onResize(const WindowResizeEvent& event);
+ * };
+ *
+ * bus.subscribe<WindowResizeEvent, &Camera::onResize>(camera);
+ * bus.publish(WindowResizeEvent { {}, 1280, 720 });
+ * bus.dispatch();
+ * @endcode
+ *
+ * @note The bus is not synchronized, it should only be used from the main thread.
+ */
+class EventBus
+{
+  public:
+	/**
+	 * @brief Identifies a subscription, used to unsubscribe
+	 */
+	using SubscriptionId = uint64_t;
+	/**
+	 * @brief A subscription id that never refers to a subscription
+	 */
+	static constexpr SubscriptionId invalidSubscription = 0;
+
+	/**
+	 * @brief The order @ref dispatch delivers queued events in
+	 *
+	 * @details
+	 * - BY_TYPE: Events are grouped by type, in the order the types were first published, and
+	 *   keep their publish order within a type. Each subscriber receives its whole batch at once.
+	 * - PUBLISH_ORDER: Events are delivered one by one in the exact order they were published,
+	 *   for handlers that depend on the interleaving of different event types.
+	 */
+	enum class DeliveryOrder
+	{
+		BY_TYPE,
+		PUBLISH_ORDER
+	};
+
+	/**
+	 * @brief Construct a new EventBus
+	 *
+	 * @param arenaBlockSize The initial size of each buffer's event arena in bytes
+	 */
+	explicit EventBus(size_t arenaBlockSize = LinearArena::defaultBlockSize):
+		m_queues { FrameQueue(arenaBlockSize), FrameQueue(arenaBlockSize) }
+	{
+	}
+
+	// Non-copyable, non-movable
+	EventBus(const EventBus&)			 = delete;
+	EventBus& operator=(const EventBus&) = delete;
+	EventBus(EventBus&&)				 = delete;
+	EventBus& operator=(EventBus&&)		 = delete;
+
+	/**
+	 * @brief Subscribe a free function
+	 *
+	 * @tparam T The event type
+	 * @tparam Function The function to call, taking a `const T&`
+	 * @return The id of the subscription
+	 */
+	template<typename T, auto Function>
+	SubscriptionId subscribe()
+	{
+		return addSubscriber(getEventTypeId<T>(), nullptr, [](void*, const EventBase& event)
+							 { Function(static_cast<const T&>(event)); });
+	}
+	/**
+	 * @brief Subscribe a member function
+	 *
+	 * @tparam T The event type
+	 * @tparam Method The member function to call, taking a `const T&`
+	 * @param instance The object to call the member function on, it must outlive the subscription
+	 * @return The id of the subscription
+	 */
+	template<typename T, auto Method, typename C>
+	SubscriptionId subscribe(C& instance)
+	{
+		return addSubscriber(getEventTypeId<T>(), &instance, [](void* context, const EventBase& event)
+							 { (static_cast<C*>(context)->*Method)(static_cast<const T&>(event)); });
+	}
+	/**
+	 * @brief Subscribe a callable object, such as a lambda
+	 *
+	 * @tparam T The event type
+	 * @param callable The callable to invoke with a `const T&`, it is not copied and must outlive
+	 * the subscription
+	 * @return The id of the subscription
+	 */
+	template<typename T, typename F>
+		requires std::is_invocable_v<F&, const T&>
+	SubscriptionId subscribe(F& callable)
+	{
+		return addSubscriber(getEventTypeId<T>(), &callable, [](void* context, const EventBase& event)
+							 { (*static_cast<F*>(context))(static_cast<const T&>(event)); });
+	}
+	/**
+	 * @brief Remove a subscription
+	 *
+	 * @details
+	 * May be called from within an event handler, the subscriber receives no further events.
+	 *
+	 * @param id The id returned when subscribing, unknown ids are ignored
+	 */
+	void unsubscribe(SubscriptionId id);
+
+	/**
+	 * @brief Queue a copy of an event for the next @ref dispatch
+	 *
+	 * @param event The event to queue
+	 */
+	template<typename T>
+	void publish(const T& event)
+	{
+		new (allocateEvent<T>()) T(event);
+	}
+	/**
+	 * @brief Construct an event in place in the queue for the next @ref dispatch
+	 *
+	 * @tparam T The event type
+	 * @param args The constructor arguments of the event
+	 */
+	template<typename T, typename... Args>
+	void emplace(Args&&... args)
+	{
+		new (allocateEvent<T>()) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Deliver an event to its subscribers right away, bypassing the queue
+	 *
+	 * @details
+	 * Meant for the rare event that cannot wait for the next @ref dispatch. The event is not
+	 * copied, so it may live on the stack.
+	 *
+	 * @param event The event to deliver
+	 */
+	template<typename T>
+	void dispatchImmediate(const T& event)
+	{
+		static_assert(std::is_base_of_v<Event<T>, T>, "Events must derive from Event<T>");
+		deliverImmediate(getEventTypeId<T>(), event);
+	}
+
+	/**
+	 * @brief Deliver every event queued since the last dispatch, then release their arena
+	 *
+	 * @details
+	 * Events are delivered in the current @ref DeliveryOrder. Events published during the
+	 * dispatch are queued for the next one. Calls made from within a handler are ignored.
+	 */
+	void dispatch();
+
+	/**
+	 * @brief Set the order @ref dispatch delivers events in
+	 *
+	 * @param order The delivery order, BY_TYPE by default
+	 */
+	void setDeliveryOrder(DeliveryOrder order) { m_deliveryOrder = order; }
+	/**
+	 * @brief Get the order @ref dispatch delivers events in
+	 *
+	 * @return The delivery order
+	 */
+	DeliveryOrder getDeliveryOrder() const { return m_deliveryOrder; }
+
+	/**
+	 * @brief Get the arena events are queued in
+	 *
+	 * @details
+	 * Strings and arrays referenced by queued events should be copied into this arena, so they
+	 * live exactly as long as the events themselves.
+	 *
+	 * @return The arena of the buffer currently being published to, reset after its events are dispatched
+	 */
+	LinearArena& getArena() { return m_queues[m_writeQueue].arena; }
+	/**
+	 * @brief Get the number of events waiting for the next @ref dispatch
+	 *
+	 * @return The number of queued events
+	 */
+	size_t getQueuedCount() const { return m_queues[m_writeQueue].order.size(); }
+
+  private:
+	using Invoke = void (*)(void* context, const EventBase& event);
+
+	struct Delegate
+	{
+		void*		   context;
+		Invoke		   invoke;	  // nullptr once unsubscribed during a dispatch
+		SubscriptionId id;
+	};
+
+	struct SubscriberList
+	{
+		std::vector<Delegate> delegates;
+		bool				  hasRemoved = false;	 // Delegates were tombstoned during a dispatch
+	};
+
+	struct EventArray
+	{
+		std::byte* events	= nullptr;
+		uint32_t   count	= 0;
+		uint32_t   capacity = 0;
+		uint32_t   stride	= 0;
+	};
+
+	struct QueuedEvent
+	{
+		EventTypeId type;
+		uint32_t	index;
+	};
+
+	// One side of the double buffer
+	struct FrameQueue
+	{
+		explicit FrameQueue(size_t arenaBlockSize): arena(arenaBlockSize) {}
+
+		LinearArena				 arena;
+		std::vector<EventArray>	 arrays;		  // Indexed by event type id
+		std::vector<EventTypeId> pendingTypes;	  // Types with queued events, in first-publish order
+		std::vector<QueuedEvent> order;			  // Every queued event, in publish order
+	};
+
+	template<typename T>
+	void* allocateEvent()
+	{
+		static_assert(std::is_base_of_v<Event<T>, T>, "Events must derive from Event<T>");
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+					  "Events are stored in arena memory and must be trivially copyable and destructible");
+		return allocateEvent(getEventTypeId<T>(), sizeof(T), alignof(T));
+	}
+
+	SubscriptionId addSubscriber(EventTypeId type, void* context, Invoke invoke);
+	void*		   allocateEvent(EventTypeId type, size_t size, size_t alignment);
+	void		   deliverBatch(EventTypeId type, const EventArray& array);
+	void		   deliverImmediate(EventTypeId type, const EventBase& event);
+	void		   resetQueue(FrameQueue& queue);
+
+	std::vector<SubscriberList> m_subscribers;	  // Indexed by event type id
+	FrameQueue					m_queues[2];
+	uint32_t					m_writeQueue	   = 0;
+	uint32_t					m_nextSubscription = 1;
+	DeliveryOrder				m_deliveryOrder	   = DeliveryOrder::BY_TYPE;
+	bool						m_isDispatching	   = false;
+};
+}	 // namespace zaphod::events
@@ -1,25 +1,60 @@
 #pragma once
 
 #include "core/logger.h"
+#include "util/arena.h"
 
-#include <set>
-#include <string>
-#include <typeindex>
-#include <unordered_map>
-#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <typeinfo>
 
 namespace zaphod::events
 {
+/**
+ * @brief A dense integer identifying an event type
+ */
+using EventTypeId = uint32_t;
+
+namespace detail
+{
+inline std::atomic<EventTypeId> nextEventTypeId { 0 };
+}	 // namespace detail
+
+/**
+ * @brief Get the id of an event type
+ *
+ * @details
+ * Ids are handed out on first use and count up from zero, so they can index arrays directly
+ * instead of being hashed. The id of a type is stable for the lifetime of the process, but not
+ * across runs.
+ *
+ * @tparam T The event type
+ * @return The id of `T`
+ */
+template<typename T>
+EventTypeId getEventTypeId()
+{
+	static const EventTypeId id = detail::nextEventTypeId.fetch_add(1, std::memory_order_relaxed);
+	return id;
+}
+
+/**
+ * @brief The base class of all events.
+ *
+ * @details
+ * Events carry their @ref EventTypeId instead of relying on RTTI, so checking and casting an
+ * event is an integer comparison. Derive events from @ref Event rather than from this class.
+ */
 class EventBase
 {
   public:
-	virtual ~EventBase()					= default;
-	virtual std::type_index getType() const = 0;
+	EventTypeId getType() const { return m_type; }
 
 	template<typename T>
 	bool isType() const
 	{
-		return getType() == typeid(T);
+		return m_type == getEventTypeId<T>();
 	}
 
 	template<typename T>
@@ -29,31 +64,107 @@ class EventBase
 			throw std::bad_cast();
 		return static_cast<const T&>(*this);
 	}
+
+	/**
+	 * @brief Get the event as `T` if it is one
+	 *
+	 * @tparam T The event type
+	 * @return A pointer to the event, or nullptr if it is not a `T`
+	 */
+	template<typename T>
+	const T* tryAs() const
+	{
+		return isType<T>() ? static_cast<const T*>(this) : nullptr;
+	}
+
+  protected:
+	explicit EventBase(EventTypeId type): m_type(type) {}
+	~EventBase() = default;
+
+  private:
+	EventTypeId m_type;
 };
 
-class LogEvent: public EventBase
+/**
+ * @brief The base class of concrete events.
+ *
+ * @details
+ * Events are queued by copying them into arena memory, so they must be trivially copyable and
+ * trivially destructible; strings and arrays are stored as views of arena copies,
+ * see @ref EventBus::getArena.
+ *
+ * @code
+ * struct WindowResizeEvent: Event<WindowResizeEvent>
+ * {
+ *     int width, height;
+ * };
+ *
+ * bus.publish(WindowResizeEvent { {}, 1280, 720 });
+ * @endcode
+ *
+ * @tparam Derived The event type itself
+ */
+template<typename Derived>
+class Event: public EventBase
+{
+  public:
+	Event(): EventBase(getEventTypeId<Derived>()) {}
+
+	static EventTypeId getStaticType() { return getEventTypeId<Derived>(); }
+};
+
+/**
+ * @brief A log record published as an event.
+ *
+ * @details
+ * The message and parameters are views, use @ref create to copy them into an arena.
+ */
+class LogEvent: public Event<LogEvent>
 {
   public:
 	using Logger = zaphod::logging::Logger;
-	LogEvent(const std::string&				 message,
-			 const std::vector<std::string>& dynamicParameters,
-			 Logger::LogLevel				 level,
-			 size_t							 formatIndex = 0):
+	LogEvent(std::string_view				   message,
+			 std::span<const std::string_view> dynamicParameters,
+			 Logger::LogLevel				   level,
+			 size_t							   formatIndex = 0):
 		m_message(message), m_dynamicParameters(dynamicParameters), m_formatIndex(formatIndex), m_level(level)
 	{
 	}
 
-	std::type_index getType() const override { return typeid(LogEvent); }
+	/**
+	 * @brief Create a LogEvent whose message and parameters are copied into an arena
+	 *
+	 * @param arena The arena to copy into, usually the one of the bus the event is published to
+	 * @param message The log message
+	 * @param dynamicParameters The values of the dynamic tokens
+	 * @param level The log level
+	 * @param formatIndex The format index
+	 * @return The event
+	 */
+	static LogEvent create(LinearArena&						 arena,
+						   std::string_view					 message,
+						   std::span<const std::string_view> dynamicParameters,
+						   Logger::LogLevel					 level,
+						   size_t							 formatIndex = 0)
+	{
+		std::string_view* parameters = arena.allocateArray<std::string_view>(dynamicParameters.size());
+		for (size_t i = 0; i < dynamicParameters.size(); ++i)
+			parameters[i] = arena.copyString(dynamicParameters[i]);
+		return LogEvent(arena.copyString(message),
+						std::span<const std::string_view>(parameters, dynamicParameters.size()),
+						level,
+						formatIndex);
+	}
 
-	const std::string&				getMessage() const { return m_message; }
-	const std::vector<std::string>& getDynamicParameters() const { return m_dynamicParameters; }
-	size_t							getFormatIndex() const { return m_formatIndex; }
-	Logger::LogLevel				getLogLevel() const { return m_level; }
+	std::string_view				  getMessage() const { return m_message; }
+	std::span<const std::string_view> getDynamicParameters() const { return m_dynamicParameters; }
+	size_t							  getFormatIndex() const { return m_formatIndex; }
+	Logger::LogLevel				  getLogLevel() const { return m_level; }
 
   private:
-	std::string				 m_message;
-	std::vector<std::string> m_dynamicParameters;
-	size_t					 m_formatIndex;
-	Logger::LogLevel		 m_level;
+	std::string_view				  m_message;
+	std::span<const std::string_view> m_dynamicParameters;
+	size_t							  m_formatIndex;
+	Logger::LogLevel				  m_level;
 };
-}	 // namespace zaphod::events
\ No newline at end of file
+}	 // namespace zaphod::events
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+
+namespace zaphod
+{
+/**
+ * @brief Limits how often the main loop runs.
+ *
+ * @details
+ * At the end of every frame @ref waitForNextFrame sleeps until shortly before the next frame's
+ * deadline and spins for the remainder, which hits the deadline far more precisely than sleeping
+ * alone. The spin window adapts to how late the OS wakes the thread up, so it stays short on
+ * platforms with precise timers.
+ *
+ * Deadlines advance by exactly one frame period, so small oversleeps do not accumulate into a
+ * lower frame rate; a frame that runs more than a whole period late restarts the schedule instead
+ * of bursting to catch up.
+ *
+ * The pacer also decides how long an idle application (all windows unfocused or minimized)
+ * waits for events, see @ref Config::idleFps.
+ */
+class FramePacer
+{
+  public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Frame pacing modes
+	 *
+	 * @details
+	 * - UNLIMITED: Frames run back to back.
+	 * - TARGET_FPS: Frames are limited to @ref Config::targetFps.
+	 * - VSYNC: Frames follow the display refresh rate. Until presentation itself blocks on the
+	 *   display, frames are limited to the refresh rate given to @ref setRefreshRate.
+	 */
+	enum class Mode
+	{
+		UNLIMITED,
+		TARGET_FPS,
+		VSYNC
+	};
+
+	/**
+	 * @brief Configuration of the frame pacer
+	 */
+	struct Config
+	{
+		/**
+		 * @brief The pacing mode
+		 */
+		Mode mode = Mode::VSYNC;
+		/**
+		 * @brief The frame rate limit in TARGET_FPS mode
+		 */
+		double targetFps = 60.0;
+		/**
+		 * @brief Wait for events instead of polling when the application is idle
+		 */
+		bool throttleWhenIdle = true;
+		/**
+		 * @brief How many frames per second an idle application runs at most when no events arrive
+		 */
+		double idleFps = 10.0;
+		/**
+		 * @brief The shortest time spent spinning before a deadline
+		 */
+		std::chrono::microseconds minimumSpin = std::chrono::microseconds(200);
+	};
+
+	FramePacer();
+	explicit FramePacer(const Config& config);
+
+	void		  setConfig(const Config& config);
+	const Config& getConfig() const { return m_config; }
+
+	/**
+	 * @brief Set the display refresh rate used in VSYNC mode
+	 *
+	 * @param refreshRate The refresh rate in Hz, values <= 0 fall back to 60 Hz
+	 */
+	void setRefreshRate(double refreshRate);
+
+	/**
+	 * @brief Get the frame period of the current mode
+	 *
+	 * @return The time between frame deadlines, zero in UNLIMITED mode
+	 */
+	Clock::duration getFramePeriod() const;
+	/**
+	 * @brief Get how long an idle frame waits for events
+	 *
+	 * @return The timeout in seconds
+	 */
+	double getIdleTimeout() const { return 1.0 / (m_config.idleFps > 0.0 ? m_config.idleFps : 1.0); }
+
+	/**
+	 * @brief Wait until the deadline of the next frame
+	 *
+	 * @details
+	 * Returns immediately in UNLIMITED mode.
+	 */
+	void waitForNextFrame();
+	/**
+	 * @brief Restart the schedule from now
+	 *
+	 * @details
+	 * Used after frames that were paced by something else, such as waiting for events while idle.
+	 */
+	void reset();
+
+  private:
+	Config			  m_config;
+	double			  m_refreshRate = 60.0;
+	Clock::time_point m_deadline;
+	Clock::duration	  m_spinWindow;
+	bool			  m_hasDeadline = false;
+};
+}	 // namespace zaphod
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "util/mpmc_queue.h"
+#include "util/work_stealing_deque.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zaphod
+{
+class JobCounter;
+
+/**
+ * @brief A unit of work run by the @ref JobSystem.
+ *
+ * @details
+ * The callable is stored inline, so scheduling a job never allocates from a worker thread.
+ */
+struct alignas(64) Job
+{
+	/**
+	 * @brief The number of bytes available for the job's callable and its captures
+	 */
+	static constexpr size_t storageSize = 96;
+
+	using Function = void (*)(Job& job);
+
+	Function		  run			  = nullptr;	// Invokes and destroys the callable
+	JobCounter*		  counter		  = nullptr;
+	Job*			  next			  = nullptr;	// Next continuation waiting on the same counter
+	bool			  isHeapAllocated = false;
+	std::atomic<bool> inUse { false };
+	alignas(std::max_align_t) std::byte storage[storageSize];
+};
+
+/**
+ * @brief Counts unfinished jobs, used to wait for them or to chain dependent jobs.
+ *
+ * @details
+ * Every job scheduled with a counter increments it and decrements it once it has run.
+ * Jobs scheduled with @ref JobSystem::scheduleAfter wait until a counter reaches zero.
+ *
+ * @note A counter must outlive the jobs that reference it; @ref JobSystem::wait returns only
+ * once no job touches the counter any more.
+ */
+class JobCounter
+{
+  public:
+	JobCounter() = default;
+
+	// Non-copyable, non-movable
+	JobCounter(const JobCounter&)			 = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	/**
+	 * @brief Check if every job counted by this counter has finished
+	 *
+	 * @return true if the counter is zero and no longer in use
+	 */
+	bool isDone() const
+	{
+		return m_value.load(std::memory_order_acquire) == 0 && !m_lock.test(std::memory_order_acquire);
+	}
+	uint32_t getValue() const { return m_value.load(std::memory_order_relaxed); }
+
+  private:
+	friend class JobSystem;
+
+	void lock()
+	{
+		while (m_lock.test_and_set(std::memory_order_acquire))
+			std::this_thread::yield();
+	}
+	void unlock() { m_lock.clear(std::memory_order_release); }
+
+	std::atomic<uint32_t> m_value { 0 };
+	std::atomic_flag	  m_lock;
+	Job*				  m_continuations = nullptr;
+};
+
+/**
+ * @brief A work-stealing thread pool.
+ *
+ * @details
+ * One worker thread runs per core besides the thread that created the job system, which counts
+ * as worker 0 and runs jobs while it @ref wait "waits". Every worker owns a
+ * [work-stealing deque](@ref WorkStealingDeque): jobs scheduled from a worker go to its own
+ * deque, and idle workers steal from the others. Jobs scheduled from threads outside the pool go
+ * through a shared queue. Workers that find no work sleep until new jobs are scheduled.
+ *
+ * Jobs are stored in a ring of slots owned by the scheduling worker, so there is no allocation
+ * per job. Work can be fanned out with @ref parallelFor, and ordered with @ref JobCounter
+ * dependencies.
+ *
+ * Calls that must happen on the main thread (such as GLFW calls) can be queued from any thread
+ * with @ref runOnMainThread and are run by @ref runMainThreadJobs, which the @ref App calls once
+ * per frame.
+ *
+ * @code
+ * JobCounter counter;
+ * jobs.schedule([&] { buildMeshes(); }, &counter);
+ * jobs.schedule([&] { loadTextures(); }, &counter);
+ * jobs.scheduleAfter(counter, [&] { uploadScene(); });
+ * jobs.parallelFor(objects.size(), 64, [&](size_t begin, size_t end) { cull(begin, end); });
+ * @endcode
+ */
+class JobSystem
+{
+  public:
+	/**
+	 * @brief The number of job slots per worker, i.e. how many jobs a worker can have in flight
+	 */
+	static constexpr size_t jobsPerWorker = 4096;
+	/**
+	 * @brief The capacity of the queues shared by all threads (external jobs and main thread jobs)
+	 */
+	static constexpr size_t sharedQueueCapacity = 4096;
+	/**
+	 * @brief The worker index reported for threads that do not belong to the job system
+	 */
+	static constexpr uint32_t invalidWorkerIndex = UINT32_MAX;
+
+	/**
+	 * @brief Construct a new JobSystem and start its worker threads
+	 *
+	 * @param workerThreads The number of threads to start, 0 for one per core less the calling thread
+	 */
+	explicit JobSystem(uint32_t workerThreads = 0);
+	/**
+	 * @brief Finish every scheduled job and stop the worker threads
+	 */
+	~JobSystem();
+
+	// Non-copyable, non-movable
+	JobSystem(const JobSystem&)			   = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	JobSystem(JobSystem&&)				   = delete;
+	JobSystem& operator=(JobSystem&&)	   = delete;
+
+	/**
+	 * @brief Schedule a job
+	 *
+	 * @param function The callable to run, its captures must fit in @ref Job::storageSize bytes
+	 * @param counter A counter to increment now and decrement when the job has run, or nullptr
+	 */
+	template<typename F>
+	void schedule(F&& function, JobCounter* counter = nullptr)
+	{
+		Job* job = createJob(std::forward<F>(function), counter);
+		submit(job);
+	}
+	/**
+	 * @brief Schedule a job to run once a counter reaches zero
+	 *
+	 * @param dependency The counter to wait for
+	 * @param function The callable to run, its captures must fit in @ref Job::storageSize bytes
+	 * @param counter A counter to increment now and decrement when the job has run, or nullptr
+	 */
+	template<typename F>
+	void scheduleAfter(JobCounter& dependency, F&& function, JobCounter* counter = nullptr)
+	{
+		Job* job = createJob(std::forward<F>(function), counter);
+		if (!addContinuation(dependency, job))
+			submit(job);
+	}
+
+	/**
+	 * @brief Run a function over a range, split into chunks across all workers
+	 *
+	 * @details
+	 * Returns once every chunk has run. The calling thread runs chunks too.
+	 *
+	 * @param count The size of the range
+	 * @param grainSize The number of elements per chunk, 0 to pick one from the worker count
+	 * @param function The callable, invoked as `function(begin, end)` for every chunk
+	 */
+	template<typename F>
+	void parallelFor(size_t count, size_t grainSize, F&& function)
+	{
+		if (count == 0)
+			return;
+		if (grainSize == 0)
+			grainSize = std::max<size_t>(1, count / (static_cast<size_t>(getWorkerCount()) * 4));
+
+		JobCounter counter;
+		for (size_t begin = grainSize; begin < count; begin += grainSize)
+		{
+			size_t end = std::min(begin + grainSize, count);
+			schedule([&function, begin, end] { function(begin, end); }, &counter);
+		}
+		function(size_t(0), std::min(grainSize, count));	// Run the first chunk here
+		wait(counter);
+	}
+
+	/**
+	 * @brief Run jobs until a counter reaches zero
+	 *
+	 * @param counter The counter to wait for
+	 */
+	void wait(const JobCounter& counter);
+
+	/**
+	 * @brief Queue a function to run on the main thread, may be called from any thread
+	 *
+	 * @param function The callable to run, its captures must fit in @ref Job::storageSize bytes
+	 * @param counter A counter to increment now and decrement when the function has run, or nullptr
+	 */
+	template<typename F>
+	void runOnMainThread(F&& function, JobCounter* counter = nullptr)
+	{
+		pushMainThreadJob(createJob(std::forward<F>(function), counter));
+	}
+	/**
+	 * @brief Run every function queued with @ref runOnMainThread, must be called on the main thread
+	 */
+	void runMainThreadJobs();
+
+	/**
+	 * @brief Get the number of threads running jobs, including the main thread
+	 *
+	 * @return The number of workers
+	 */
+	uint32_t getWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+	/**
+	 * @brief Get the index of the worker the calling thread is
+	 *
+	 * @details
+	 * Useful to index per-worker data, such as command pools, from inside a job.
+	 *
+	 * @return The index, 0 on the main thread and below @ref getWorkerCount on the workers, or
+	 * @ref invalidWorkerIndex on threads outside the job system
+	 */
+	uint32_t getCurrentWorkerIndex() const;
+	/**
+	 * @brief Check if the calling thread is the thread that created the job system
+	 *
+	 * @return true on the main thread, false otherwise
+	 */
+	bool isMainThread() const { return std::this_thread::get_id() == m_mainThreadId; }
+
+  private:
+	struct Worker
+	{
+		Worker(): deque(jobsPerWorker), jobs(std::make_unique<Job[]>(jobsPerWorker)) {}
+
+		WorkStealingDeque<Job*> deque;
+		std::unique_ptr<Job[]>	jobs;
+		size_t					nextJob = 0;
+		std::thread				thread;
+	};
+
+	template<typename F>
+	Job* createJob(F&& function, JobCounter* counter)
+	{
+		using Function = std::decay_t<F>;
+		static_assert(sizeof(Function) <= Job::storageSize && alignof(Function) <= alignof(std::max_align_t),
+					  "Job captures are too large, capture by reference or through a pointer");
+
+		Job* job = allocateJob();
+		new (job->storage) Function(std::forward<F>(function));
+		job->run = [](Job& self)
+		{
+			Function* callable = std::launder(reinterpret_cast<Function*>(self.storage));
+			(*callable)();
+			callable->~Function();
+		};
+		job->counter = counter;
+		job->next	 = nullptr;
+		if (counter)
+			counter->m_value.fetch_add(1, std::memory_order_relaxed);
+		return job;
+	}
+
+	Job*	allocateJob();
+	void	submit(Job* job);
+	void	pushMainThreadJob(Job* job);
+	bool	addContinuation(JobCounter& dependency, Job* job);
+	void	execute(Job* job);
+	Job*	findJob();
+	bool	runOneJob();
+	void	workerLoop(uint32_t index);
+	void	wakeWorkers();
+	Worker* getCurrentWorker();
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	MpmcQueue<Job*>						 m_externalQueue;
+	MpmcQueue<Job*>						 m_mainThreadQueue;
+	std::thread::id						 m_mainThreadId;
+	std::atomic<uint32_t>				 m_wakeSignal { 0 };
+	std::atomic<uint32_t>				 m_sleepingWorkers { 0 };
+	std::atomic<size_t>					 m_pendingJobs { 0 };	// Submitted jobs that have not run yet
+	std::atomic<bool>					 m_running { true };
+};
+}	 // namespace zaphod
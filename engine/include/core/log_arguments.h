@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace zaphod::logging
+{
+/**
+ * @brief A string literal usable as a template argument.
+ *
+ * @tparam N The size of the literal including its terminating null character
+ */
+template<size_t N>
+struct FixedString
+{
+	char value[N] {};
+
+	constexpr FixedString(const char (&string)[N]) { std::copy_n(string, N, value); }
+
+	constexpr std::string_view view() const { return std::string_view(value, N - 1); }
+};
+
+/**
+ * @brief Check if a string is a valid format token name
+ *
+ * @param token The token name without the surrounding '%{ }%'
+ * @return true if the token is non-empty and contains only uppercase letters, numbers and underscores
+ */
+constexpr bool isValidTokenName(std::string_view token)
+{
+	if (token.empty())
+		return false;
+	for (char c : token)
+		if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'))
+			return false;
+	return true;
+}
+
+/**
+ * @brief A value bound by name to a dynamic token of a log format.
+ *
+ * @details
+ * Created with @ref param. The name is checked at compile time; the slot it binds to is
+ * resolved against the format being logged with.
+ *
+ * @tparam Name The dynamic token name, without the surrounding '%{* }%'
+ * @tparam T The type of the value
+ */
+template<FixedString Name, typename T>
+struct NamedParameter
+{
+	static_assert(isValidTokenName(Name.view()),
+				  "Dynamic token names may only contain uppercase letters, numbers and underscores");
+	static_assert(Name.view() != "MESSAGE", "The MESSAGE token cannot be bound as a dynamic parameter");
+
+	static constexpr std::string_view name = Name.view();
+	const T&						  value;
+};
+
+/**
+ * @brief Types that can be rendered into a log message without allocating
+ */
+template<typename T>
+concept LogArgument = std::convertible_to<const T&, std::string_view> || std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+					  std::is_pointer_v<T>;
+
+/**
+ * @brief Bind a value to a dynamic token by name
+ *
+ * @details
+ * For example, with the format string `"[%{*USER}%]: %{MESSAGE}%"`:
+ * @code
+ * logger.log<Logger::LogLevel::INFO>("Opened {} files", count, param<"USER">(userName));
+ * @endcode
+ *
+ * @tparam Name The dynamic token name
+ * @param value The value of the token, it must outlive the log call
+ * @return The named parameter
+ */
+template<FixedString Name, LogArgument T>
+constexpr NamedParameter<Name, T> param(const T& value)
+{
+	return NamedParameter<Name, T> { value };
+}
+
+template<typename T>
+struct IsNamedParameter: std::false_type
+{
+};
+
+template<FixedString Name, typename T>
+struct IsNamedParameter<NamedParameter<Name, T>>: std::true_type
+{
+};
+
+/**
+ * @brief A fixed-capacity character buffer used to render log messages on the stack.
+ *
+ * @details
+ * Appending past the capacity truncates the text instead of allocating.
+ *
+ * @tparam Capacity The maximum number of characters the buffer holds
+ */
+template<size_t Capacity>
+class LogBuffer
+{
+  public:
+	void append(std::string_view text)
+	{
+		size_t length = std::min(text.size(), Capacity - m_size);
+		std::copy_n(text.data(), length, m_data + m_size);
+		m_size += length;
+		m_isTruncated |= length < text.size();
+	}
+	void append(char c)
+	{
+		if (m_size < Capacity)
+			m_data[m_size++] = c;
+		else
+			m_isTruncated = true;
+	}
+
+	template<LogArgument T>
+	void appendArgument(const T& value)
+	{
+		if constexpr (std::convertible_to<const T&, std::string_view>)
+			append(std::string_view(value));
+		else if constexpr (std::is_same_v<T, bool>)
+			append(value ? std::string_view("true") : std::string_view("false"));
+		else if constexpr (std::is_same_v<T, char>)
+			append(value);
+		else if constexpr (std::is_enum_v<T>)
+			appendArgument(static_cast<std::underlying_type_t<T>>(value));
+		else if constexpr (std::is_pointer_v<T>)
+		{
+			append("0x");
+			appendChars(reinterpret_cast<uintptr_t>(value), 16);
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+			appendChars(value);
+		else
+			appendChars(value, 10);
+	}
+
+	std::string_view view() const { return std::string_view(m_data, m_size); }
+	size_t			 size() const { return m_size; }
+	bool			 isTruncated() const { return m_isTruncated; }
+
+  private:
+	template<typename... ToCharsArgs>
+	void appendChars(ToCharsArgs... args)
+	{
+		auto [end, error] = std::to_chars(m_data + m_size, m_data + Capacity, args...);
+		if (error == std::errc())
+			m_size = static_cast<size_t>(end - m_data);
+		else
+			m_isTruncated = true;
+	}
+
+	char   m_data[Capacity];
+	size_t m_size		 = 0;
+	bool   m_isTruncated = false;
+};
+
+namespace detail
+{
+// Intentionally not constexpr, calling it during constant evaluation reports the error
+inline void logStringError(const char*) {}
+
+constexpr size_t countPlaceholders(std::string_view text)
+{
+	size_t count = 0;
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		if (text[i] == '{')
+		{
+			if (i + 1 < text.size() && text[i + 1] == '{')
+				++i;	// Escaped '{'
+			else if (i + 1 < text.size() && text[i + 1] == '}')
+			{
+				++count;
+				++i;
+			}
+			else
+				logStringError("Unmatched '{' in log message, use '{{' for a literal brace");
+		}
+		else if (text[i] == '}')
+		{
+			if (i + 1 < text.size() && text[i + 1] == '}')
+				++i;	// Escaped '}'
+			else
+				logStringError("Unmatched '}' in log message, use '}}' for a literal brace");
+		}
+	}
+	return count;
+}
+
+// Empty names belong to positional arguments and are ignored
+template<typename... Names>
+constexpr bool hasUniqueNames(Names... names)
+{
+	std::string_view list[] = { std::string_view(), names... };
+	for (size_t i = 1; i < sizeof...(Names) + 1; ++i)
+		for (size_t j = i + 1; j < sizeof...(Names) + 1; ++j)
+			if (!list[i].empty() && list[i] == list[j])
+				return false;
+	return true;
+}
+
+// Copies literal text up to the next '{}' placeholder (or the end) and consumes the placeholder
+template<size_t Capacity>
+void appendUntilPlaceholder(LogBuffer<Capacity>& buffer, std::string_view& text)
+{
+	size_t i = 0;
+	for (; i < text.size(); ++i)
+	{
+		if (text[i] == '{' && i + 1 < text.size() && text[i + 1] == '}')
+		{
+			text.remove_prefix(i + 2);
+			return;
+		}
+		buffer.append(text[i]);
+		if ((text[i] == '{' || text[i] == '}') && i + 1 < text.size() && text[i + 1] == text[i])
+			++i;	// Skip the second character of an escaped brace
+	}
+	text.remove_prefix(i);
+}
+
+template<typename T>
+constexpr std::string_view parameterName()
+{
+	if constexpr (IsNamedParameter<T>::value)
+		return T::name;
+	else
+		return std::string_view();
+}
+}	 // namespace detail
+
+/**
+ * @brief A log message checked against its arguments at compile time.
+ *
+ * @details
+ * The message may contain `{}` placeholders which are replaced, in order, by the positional
+ * (unnamed) arguments. Literal braces are written as `{{` and `}}`.
+ * Construction is `consteval`, so a mismatch between the number of placeholders and the number of
+ * positional arguments, an unmatched brace, an unsupported argument type or a dynamic token bound
+ * twice is a compile error.
+ *
+ * @tparam Args The types of the log call's arguments
+ */
+template<typename... Args>
+class BasicLogString
+{
+  public:
+	template<typename String>
+		requires std::convertible_to<const String&, std::string_view>
+	consteval BasicLogString(const String& text): m_text(text)
+	{
+		static_assert(((IsNamedParameter<Args>::value || LogArgument<Args>)&&...), "Unsupported log argument type");
+		static_assert(detail::hasUniqueNames(detail::parameterName<Args>()...), "A dynamic token is bound more than once");
+
+		if (detail::countPlaceholders(m_text) != positionalCount)
+			detail::logStringError("The number of '{}' placeholders does not match the number of arguments");
+	}
+
+	constexpr std::string_view get() const { return m_text; }
+
+	static constexpr size_t positionalCount = (size_t(0) + ... + size_t(!IsNamedParameter<Args>::value));
+	static constexpr size_t namedCount		= sizeof...(Args) - positionalCount;
+
+  private:
+	std::string_view m_text;
+};
+
+/**
+ * @brief The message type of the @ref Logger::log "log<Level>" API.
+ *
+ * @details
+ * Argument types are not deduced from the message, only from the arguments that follow it.
+ */
+template<typename... Args>
+using LogString = BasicLogString<std::type_identity_t<std::remove_cvref_t<Args>>...>;
+}	 // namespace zaphod::logging
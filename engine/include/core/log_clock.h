@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace zaphod::logging
+{
+/**
+ * @brief The number of sub-second digits rendered for the TIME token, from coarsest to finest
+ */
+enum class TimePrecision : uint8_t
+{
+	SECONDS,		 //!< "YYYY-MM-DD HH:MM:SS"
+	CENTISECONDS,	 //!< "YYYY-MM-DD HH:MM:SS.cc"
+	MILLISECONDS,	 //!< "YYYY-MM-DD HH:MM:SS.mmm"
+	MICROSECONDS	 //!< "YYYY-MM-DD HH:MM:SS.uuuuuu"
+};
+
+/**
+ * @brief The source of the timestamps of log records.
+ *
+ * @details
+ * Loggers read the time of every record through a clock, so that the cheapest clock for the
+ * platform can be used and tests can inject a deterministic time, see @ref Logger::setClock.
+ *
+ * @note Implementations must be safe to call from several threads at once.
+ */
+class LogClock
+{
+  public:
+	virtual ~LogClock() = default;
+
+	/**
+	 * @brief Read the current time
+	 *
+	 * @return The current wall-clock time
+	 */
+	virtual std::chrono::system_clock::time_point now() const = 0;
+	/**
+	 * @brief Get the smallest step between two different times the clock reads
+	 *
+	 * @return The resolution of the clock, one `system_clock` tick unless overridden
+	 */
+	virtual std::chrono::nanoseconds getResolution() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::duration(1));
+	}
+	/**
+	 * @brief Get the finest precision whose digits the clock can resolve
+	 *
+	 * @return The finest precision with a last digit no smaller than the @ref getResolution "resolution"
+	 */
+	TimePrecision getFinestPrecision() const;
+
+	/**
+	 * @brief Get the clock loggers use unless another one is set
+	 *
+	 * @return A shared @ref CoarseLogClock
+	 */
+	static std::shared_ptr<const LogClock> getDefault();
+};
+
+/**
+ * @brief A cheap wall clock derived from a coarse monotonic clock.
+ *
+ * @details
+ * Reads `CLOCK_MONOTONIC_COARSE` on Linux (a vDSO read without a syscall, with a resolution of
+ * one scheduler tick) or `std::chrono::steady_clock` elsewhere, and converts it to wall-clock time
+ * with an offset measured against `std::chrono::system_clock`. The offset is re-measured every
+ * @ref calibrationInterval so that adjustments of the system time are picked up.
+ *
+ * The resolution is queried with `clock_getres`. At the usual 1 to 10 ms tick it resolves
+ * milliseconds or only centiseconds, and loggers render no more digits than that.
+ *
+ * Timestamps never go backwards between calibrations.
+ */
+class CoarseLogClock: public LogClock
+{
+  public:
+	/**
+	 * @brief How often the offset to the system clock is re-measured
+	 */
+	static constexpr std::chrono::seconds calibrationInterval = std::chrono::seconds(60);
+
+	CoarseLogClock();
+
+	std::chrono::system_clock::time_point now() const override;
+	std::chrono::nanoseconds			  getResolution() const override { return m_resolution; }
+
+  private:
+	static int64_t readMonotonic();
+	static int64_t readResolution();
+	void		   calibrate(int64_t monotonic) const;
+
+	const std::chrono::nanoseconds m_resolution { readResolution() };
+
+	mutable std::atomic<int64_t> m_offset { 0 };
+	mutable std::atomic<int64_t> m_nextCalibration { 0 };
+};
+
+/**
+ * @brief A clock that only moves when told to, for tests and tools.
+ */
+class ManualLogClock: public LogClock
+{
+  public:
+	explicit ManualLogClock(std::chrono::system_clock::time_point time = {}): m_time(time.time_since_epoch().count()) {}
+
+	std::chrono::system_clock::time_point now() const override
+	{
+		return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(m_time.load()));
+	}
+
+	void setTime(std::chrono::system_clock::time_point time) { m_time.store(time.time_since_epoch().count()); }
+	void advance(std::chrono::system_clock::duration duration) { m_time.fetch_add(duration.count()); }
+
+  private:
+	std::atomic<std::chrono::system_clock::rep> m_time;
+};
+
+/**
+ * @brief Renders timestamps as local time, converting to calendar time only once per second.
+ *
+ * @details
+ * The "YYYY-MM-DD HH:MM:SS" prefix is cached for the last second seen, so records within the same
+ * second only patch in their sub-second digits instead of calling `localtime` and `strftime`
+ * (which take locks inside libc).
+ *
+ * @note A cache is not synchronized, use one per thread.
+ */
+class TimestampCache
+{
+  public:
+	/**
+	 * @brief Render a time point
+	 *
+	 * @param time The time to render
+	 * @param precision The number of sub-second digits to render
+	 * @return The rendered time, valid until the next call
+	 */
+	std::string_view format(std::chrono::system_clock::time_point time, TimePrecision precision);
+
+  private:
+	int64_t m_cachedSecond = INT64_MIN;
+	size_t	m_prefixLength = 0;
+	char	m_buffer[40];
+};
+}	 // namespace zaphod::logging
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/logger.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace zaphod::events
+{
+class EventBus;
+
+/**
+ * @brief Collects log records from any thread and publishes them to an event bus as @ref LogEvent.
+ *
+ * @details
+ * The bus is only used from the main thread, so loggers with the EVENTS destination, see
+ * @ref logging::Logger::setEventSink, push their records here instead, and the main thread moves
+ * them to the bus with @ref publish once per frame before the bus dispatches. Records are copied
+ * into buffers that are reused from frame to frame, so steady-state logging does not allocate.
+ *
+ * @code
+ * logger->setEventSink(&app.getLogEventSink());
+ * app.getEventBus().subscribe<LogEvent, &Console::onLogEvent>(console);
+ * @endcode
+ */
+class LogEventSink
+{
+  public:
+	/**
+	 * @brief Queue a copy of a record until the next @ref publish, from any thread
+	 *
+	 * @param record The record, the event carries its message, dynamic parameters, format index and level
+	 */
+	void push(const logging::Logger::Record& record);
+	/**
+	 * @brief Publish every record pushed since the last call, from the thread that owns the bus
+	 *
+	 * @param bus The bus, whose arena the messages and parameters are copied into
+	 * @return The number of events published
+	 */
+	size_t publish(EventBus& bus);
+
+  private:
+	struct Entry
+	{
+		size_t					  textOffset;	 // Where the message starts in Buffer::text, followed by the parameters
+		uint32_t				  messageLength;
+		uint32_t				  parameterCount;
+		uint32_t				  parameterLengths[logging::Logger::maxDynamicParameters];
+		size_t					  formatIndex;
+		logging::Logger::LogLevel level;
+	};
+	struct Buffer
+	{
+		std::string		   text;	// The messages and parameters of every entry, back to back
+		std::vector<Entry> entries;
+	};
+
+	std::mutex m_mutex;
+	Buffer	   m_pending;		 // Pushed to under the mutex
+	Buffer	   m_publishing;	 // Swapped with m_pending by publish, so pushes never wait for the bus
+};
+}	 // namespace zaphod::events
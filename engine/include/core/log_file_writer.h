@@ -0,0 +1,173 @@
+#pragma once
+
+#include "util/result.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace zaphod::logging
+{
+/**
+ * @brief A high-throughput writer behind the FILE log destination.
+ *
+ * @details
+ * Formatted records are appended to a large page-aligned buffer instead of being written one
+ * line at a time. The buffer is written out when it is full, when the flush interval has passed,
+ * when an urgent (FATAL) record arrives, or when @ref flush is called. Writes triggered by a full
+ * buffer are always whole, page-aligned buffers.
+ *
+ * The log file can be rotated by size and/or age; rotated files are renamed to `<path>.1`,
+ * `<path>.2`, ... with the oldest beyond @ref Config::maxRotatedFiles being removed.
+ *
+ * In memory-mapped mode records are copied straight into a mapping of the file that grows in
+ * @ref Config::mappingGrowth steps, and the file is truncated to its real size when closed.
+ *
+ * @note The writer is internally synchronized, so it may be written to from several threads.
+ */
+class LogFileWriter
+{
+  public:
+	/**
+	 * @brief Configuration of a log file
+	 */
+	struct Config
+	{
+		/**
+		 * @brief The path of the active log file
+		 */
+		std::filesystem::path path = "zaphod.log";
+		/**
+		 * @brief The size of the write buffer in bytes (rounded up to a multiple of @ref pageSize)
+		 */
+		size_t bufferSize = 1 << 20;
+		/**
+		 * @brief The longest time records may wait in the buffer before being written
+		 */
+		std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000);
+		/**
+		 * @brief Rotate the file once it would exceed this many bytes (0 disables size rotation)
+		 */
+		uint64_t maxFileSize = 0;
+		/**
+		 * @brief Rotate the file once it has been open this long (0 disables time rotation)
+		 */
+		std::chrono::seconds rotationInterval = std::chrono::seconds(0);
+		/**
+		 * @brief The number of rotated files to keep
+		 */
+		uint32_t maxRotatedFiles = 5;
+		/**
+		 * @brief Append through a memory mapping of the file instead of buffered writes
+		 */
+		bool memoryMapped = false;
+		/**
+		 * @brief How much the mapping grows by when it is full, in bytes (memory-mapped mode only)
+		 */
+		size_t mappingGrowth = 64 << 20;
+		/**
+		 * @brief Append to an existing file instead of truncating it
+		 */
+		bool append = true;
+		/**
+		 * @brief Bytes written at the start of every new (empty) file, including rotated ones
+		 */
+		std::string fileHeader;
+	};
+
+	/**
+	 * @brief The alignment and granularity of the write buffer
+	 */
+	static constexpr size_t pageSize = 4096;
+
+	LogFileWriter();
+	/**
+	 * @brief Flush and close the file
+	 */
+	~LogFileWriter();
+
+	// Non-copyable, non-movable
+	LogFileWriter(const LogFileWriter&)			   = delete;
+	LogFileWriter& operator=(const LogFileWriter&) = delete;
+	LogFileWriter(LogFileWriter&&)				   = delete;
+	LogFileWriter& operator=(LogFileWriter&&)	   = delete;
+
+	/**
+	 * @brief Open the log file, closing any file that is already open
+	 *
+	 * @param config The log file configuration
+	 * @return Result::Code::SUCCESS if the file was opened\n
+	 * Result::Code::IO_ERROR if the file could not be opened or mapped
+	 */
+	Result open(const Config& config);
+	/**
+	 * @brief Flush and close the log file
+	 */
+	void close();
+	/**
+	 * @brief Check if a log file is open
+	 *
+	 * @return true if a file is open, false otherwise
+	 */
+	bool isOpen() const;
+
+	/**
+	 * @brief Append formatted text to the log file
+	 *
+	 * @param text The text to append, including its line terminator
+	 * @param isUrgent Write the buffer out immediately (used for FATAL records)
+	 */
+	void write(std::string_view text, bool isUrgent = false);
+	/**
+	 * @brief Write out any buffered text
+	 */
+	void flush();
+	/**
+	 * @brief Write out buffered text if the flush interval has passed
+	 */
+	void flushIfDue();
+
+	/**
+	 * @brief Replace the header written at the start of files created from now on
+	 *
+	 * @param header The new file header
+	 */
+	void setFileHeader(std::string header);
+
+	/**
+	 * @brief Get the number of bytes written to the active file, including buffered bytes
+	 *
+	 * @return The size of the active log file
+	 */
+	uint64_t getFileSize() const;
+
+  private:
+	struct Mapping;
+
+	Result openFile();
+	void   closeFile();
+	void   flushBuffer();
+	void   rotate();
+	bool   shouldRotate(size_t incoming) const;
+	void   append(std::string_view text);
+	void   appendMapped(std::string_view text);
+	bool   growMapping(size_t required);
+
+	Config								  m_config;
+	mutable std::mutex					  m_mutex;
+	std::FILE*							  m_file	   = nullptr;
+	char*								  m_buffer	   = nullptr;
+	size_t								  m_bufferSize = 0;
+	size_t								  m_used	   = 0;
+	uint64_t							  m_fileSize   = 0;
+	std::unique_ptr<Mapping>			  m_mapping;
+	std::chrono::steady_clock::time_point m_lastFlush;
+	std::chrono::steady_clock::time_point m_openedAt;
+};
+}	 // namespace zaphod::logging
@@ -1,16 +1,32 @@
 #pragma once
 
+#include "core/log_arguments.h"
+#include "core/log_clock.h"
+#include "core/log_file_writer.h"
 #include "util/flags.h"
 #include "util/result.h"
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <set>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+namespace zaphod::events
+{
+class LogEventSink;
+}	 // namespace zaphod::events
+
 namespace zaphod::logging
 {
+class AsyncLogBackend;
+class BinaryLogWriter;
 
 /**
  * @brief A base logger class providing core logger functionality.
@@ -24,8 +40,11 @@ namespace zaphod::logging
  * The class also provides methods to manage formats, destinations, and log levels.
  * Loggers are created using a factory pattern, with the `LoggerFactory` class
  *
+ * Logging can optionally be made asynchronous with @ref enableAsync, in which case @ref log only
+ * copies the message into a lock-free queue and a dedicated sink thread renders and writes it.
+ *
  * @note The Logger class is a base class and must be extended for specific logging implementations.
- * @note The @ref log method must be implemented by derived classes.
+ * @note The @ref write method must be implemented by derived classes.
  *
  * @see Logger::Format
  * @see Logger::LogDestination
@@ -44,6 +63,45 @@ class Logger
 	//	bool		isDynamic = false;	  // If true, the value will be provided at log time
 	// };
 
+	/**
+	 * @brief Log destination options
+	 *
+	 * @details
+	 * - CONSOLE: Log messages will be output to the console (standard output).
+	 * - FILE: Log messages will be written to a file, see @ref setLogFile.
+	 * - BINARY: Unformatted records will be written to a binary log file, see @ref setBinaryLogFile.
+	 * - EVENTS: Unformatted records will be published to an event bus as LogEvent, see @ref setEventSink.
+	 */
+	enum class LogDestination
+	{
+		CONSOLE,
+		FILE,
+		BINARY,
+		EVENTS
+	};
+
+	/**
+	 * @brief Log level options
+	 *
+	 * @details
+	 * - EMPTY: Required for use of Flags utility
+	 * - INFO: Informational messages that highlight the progress of the application at coarse-grained level
+	 * - DEBUG: Detailed information typically of interest only when diagnosing problems
+	 * - WARN: Potentially harmful situations which still allow the application to continue running
+	 * - ERROR: Error events that might still allow the application to continue running
+	 * - FATAL: Very severe error events that will presumably lead the application to abort
+	 *
+	 */
+	enum class LogLevel : uint32_t
+	{
+		EMPTY,
+		INFO,
+		DEBUG,
+		WARN,
+		ERROR,
+		FATAL
+	};
+
 	/**
 	 * @brief
 	 * A log message format consisting of a format string and a set of parameters.
@@ -51,6 +109,10 @@ class Logger
 	 * @details
 	 * The format string and parameters are validated upon construction and when updated.
 	 *
+	 * Validation also compiles the format string into a flat list of @ref Segment "segments"
+	 * (literal spans and token slots), so rendering a message is a single walk over that list
+	 * with no parsing, map lookups or temporary strings.
+	 *
 	 */
 	class Format
 	{
@@ -70,6 +132,32 @@ class Logger
 		 */
 		typedef std::unordered_map<std::string, std::string> ParameterMap;
 
+		/**
+		 * @brief A single compiled piece of a format string
+		 *
+		 * @details
+		 * - LITERAL: `offset` and `length` describe a span of the unescaped literal text.
+		 * - STATIC: `offset` is the slot of a static token value.
+		 * - DYNAMIC: `offset` is the position of the value in the dynamic parameters passed at log time.
+		 * - MESSAGE, LEVEL, TIME: Special tokens filled in at log time, `offset` and `length` are unused.
+		 */
+		struct Segment
+		{
+			enum class Type : uint8_t
+			{
+				LITERAL,
+				STATIC,
+				DYNAMIC,
+				MESSAGE,
+				LEVEL,
+				TIME
+			};
+
+			Type	 type;
+			uint32_t offset = 0;
+			uint32_t length = 0;
+		};
+
 		/**
 		 * @brief Construct a new Format object and validates it.
 		 *
@@ -93,46 +181,70 @@ class Logger
 		/**
 		 * @brief Get the current dynamic tokens
 		 *
+		 * @details
+		 * The tokens are returned in the order they appear in the format string,
+		 * which is also the order their values are expected in at log time.
+		 *
 		 * @return The list of dynamic tokens in the format string
 		 */
-		const std::vector<std::string> getDynamicTokens() const
-		{
-			return std::vector<std::string>(m_dynamicTokens.begin(), m_dynamicTokens.end());
-		}
+		const std::vector<std::string>& getDynamicTokens() const { return m_dynamicTokens; }
 		/**
 		 * @brief Get the current special tokens
 		 *
 		 * @return The list of special tokens in the format string
 		 */
-		const std::vector<std::string> getSpecialTokens() const
+		const std::vector<std::string>& getSpecialTokens() const { return m_specialTokens; }
+		/**
+		 * @brief Get the compiled segments of the format string
+		 *
+		 * @return The segments in the order they are rendered
+		 */
+		std::span<const Segment> getSegments() const { return m_segments; }
+		/**
+		 * @brief Find the position of a dynamic token
+		 *
+		 * @param token The dynamic token to look for
+		 * @return The position of the token's value in the dynamic parameters, or `npos` if the
+		 * format has no such dynamic token
+		 */
+		size_t findDynamicToken(std::string_view token) const
 		{
-			return std::vector<std::string>(m_specialTokens.begin(), m_specialTokens.end());
+			for (size_t i = 0; i < m_dynamicTokens.size(); ++i)
+				if (m_dynamicTokens[i] == token)
+					return i;
+			return npos;
 		}
 
+		/**
+		 * @brief The value returned by @ref findDynamicToken when a token is not found
+		 */
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
 		/**
 		 * @brief Set the format string and validates it
 		 *
+		 * @details
+		 * Values of static tokens that are still present in the new format string are kept.
+		 *
 		 * @param formatString The new format string to set
 		 */
-		void setFormatString(const std::string& formatString) { validateFormatString(formatString); }
+		void setFormatString(const std::string& formatString) { validate(formatString, m_staticTokens); }
 		/**
 		 * @brief Set the Parameters object
 		 *
 		 * @param parameters The new parameters map to set
 		 */
-		void setParameters(const ParameterMap& parameters) { validateStaticTokens(parameters); }
+		void setParameters(const ParameterMap& parameters)
+		{
+			m_isValid = m_isFormatValid && validateStaticTokens(parameters).isSuccess();
+		}
 		/**
 		 * @brief Set the Static Token object
 		 *
 		 * @param token The token to set
 		 * @param value The value to set for the token
 		 */
-		void setStaticToken(const std::string& token, const std::string& value)
-		{
-			auto it = m_staticTokens.find(token);
-			if (it != m_staticTokens.end())
-				it->second = value;
-		}
+		void setStaticToken(const std::string& token, const std::string& value);
 		/**
 		 * @brief Check if the format is valid
 		 *
@@ -140,6 +252,28 @@ class Logger
 		 */
 		bool isValid() const { return m_isValid; }
 
+		/**
+		 * @brief Render a log message into the output buffer
+		 *
+		 * @details
+		 * Walks the compiled segments and appends each one to `output`. The buffer is not cleared first,
+		 * so callers can reuse a single buffer across messages and avoid reallocating.
+		 * Missing dynamic parameters are rendered as empty strings.
+		 *
+		 * @note Nothing is rendered if the format is invalid.
+		 *
+		 * @param output The buffer to append the rendered message to
+		 * @param message The log message content
+		 * @param level The log level of the message
+		 * @param time The rendered timestamp of the message
+		 * @param dynamicParameters The values of the dynamic tokens, in the order of @ref getDynamicTokens
+		 */
+		void render(std::string&					   output,
+					std::string_view				   message,
+					LogLevel						   level,
+					std::string_view				   time,
+					std::span<const std::string_view> dynamicParameters) const;
+
 	  private:
 		/**
 		 * @brief The log message format string
@@ -160,7 +294,7 @@ class Logger
 		 * It also may not be overriden.
 		 * @details
 		 * - LEVEL: The log level of the log entry.
-		 * - TIME: The timestamp of the log entry.
+		 * - TIME: The timestamp of the log entry as local time, see @ref Logger::setTimePrecision.
 		 * .
 		 *
 		 * Special tokens can be overridden by prefixing them with '!' (i.e. '%{!LEVEL}\%').
@@ -185,27 +319,55 @@ class Logger
 		 */
 		ParameterMap m_staticTokens;
 		/**
-		 * @brief The set of dynamic tokens in the format string
+		 * @brief The static tokens in the format string, in order of appearance
+		 *
+		 * @details
+		 * The index of a token in this list is the slot its value occupies in @ref m_staticValues.
+		 *
+		 * It is automatically updated when the format string is validated.
+		 */
+		std::vector<std::string> m_staticTokenNames;
+		/**
+		 * @brief The values of the static tokens, indexed by slot
+		 *
+		 * @details
+		 * Resolved from @ref m_staticTokens when the parameters are validated so that rendering
+		 * never has to look them up by name.
+		 */
+		std::vector<std::string> m_staticValues;
+		/**
+		 * @brief The dynamic tokens in the format string, in order of appearance
 		 *
 		 * @details
-		 * This set stores the tokens that are dynamic and will have their values provided at log time.
-		 * The keys in this set should not include the surrounding '%{ }\%', or any preceding
+		 * This list stores the tokens that are dynamic and will have their values provided at log time.
+		 * The entries in this list should not include the surrounding '%{ }\%', or any preceding
 		 * '!' or '*' characters.
 		 *
 		 * It is automatically updated when the format string is validated.
 		 */
-		std::set<std::string> m_dynamicTokens;
+		std::vector<std::string> m_dynamicTokens;
 		/**
-		 * @brief The set of special tokens in the format string
+		 * @brief The special tokens in the format string, in order of appearance
 		 *
 		 * @details
-		 * This set stores the special tokens that are included in the format string.
-		 * The keys in this set should not include the surrounding '%{ }\%', or any preceding
+		 * This list stores the special tokens that are included in the format string.
+		 * The entries in this list should not include the surrounding '%{ }\%', or any preceding
 		 * '!' or '*' characters.
 		 *
 		 * It is automatically updated when the format string is validated.
 		 */
-		std::set<std::string> m_specialTokens;
+		std::vector<std::string> m_specialTokens;
+		/**
+		 * @brief The unescaped literal text of the format string
+		 *
+		 * @details
+		 * LITERAL segments refer to spans of this string.
+		 */
+		std::string m_literals;
+		/**
+		 * @brief The compiled segments of the format string
+		 */
+		std::vector<Segment> m_segments;
 		/**
 		 * @brief Indicates whether the format is valid
 		 *
@@ -214,6 +376,14 @@ class Logger
 		 * and false otherwise. It is updated during validation.
 		 */
 		bool m_isValid = false;
+		/**
+		 * @brief Indicates whether the format string alone is valid
+		 *
+		 * @details
+		 * Set during validation of the format string, so that new parameters cannot make a format
+		 * with a bad format string valid.
+		 */
+		bool m_isFormatValid = false;
 
 		/**
 		 * @brief Validates the format string
@@ -224,6 +394,9 @@ class Logger
 		 * and that special tokens are used correctly.
 		 * It also checks for duplicate tokens and ensures that dynamic tokens are marked appropriately.
 		 *
+		 * On success the format string is compiled into @ref m_segments.
+		 * On failure the current format string is left untouched.
+		 *
 		 * @param formatString The format string to validate
 		 * @return The Result of the validation\n
 		 * If the format string is valid, returns Result::Code::SUCCESS\n
@@ -238,7 +411,10 @@ class Logger
 		 * This method checks the static tokens for correctness.
 		 * It ensures that all tokens are well-formed, that there are no duplicate tokens,
 		 * and that special tokens are not included unless overridden in the format string.
-		 * It also checks that the MESSAGE token is not included in the static tokens.
+		 * It also checks that the MESSAGE token is not included in the static tokens,
+		 * and that every static token in the format string has a value.
+		 *
+		 * On success the values are resolved into @ref m_staticValues.
 		 *
 		 * @param staticTokens The static tokens to validate
 		 * @return The Result of the validation\n
@@ -278,38 +454,51 @@ class Logger
 	};
 
 	/**
-	 * @brief Log destination options
+	 * @brief A single log message as it is handed to @ref write
 	 *
 	 * @details
-	 * - CONSOLE: Log messages will be output to the console (standard output).
-	 * - FILE: Log messages will be written to a file.
+	 * The record only views its message and parameters; they are valid for the duration of the
+	 * @ref write call.
 	 */
-	enum class LogDestination
+	struct Record
 	{
-		CONSOLE,
-		FILE
+		std::string_view					  message;
+		std::span<const std::string_view>	  dynamicParameters;
+		size_t								  formatIndex = 0;
+		LogLevel							  level		  = LogLevel::INFO;
+		std::chrono::system_clock::time_point time;
 	};
 
 	/**
-	 * @brief Log level options
+	 * @brief What an asynchronous logger does when its queue is full
 	 *
 	 * @details
-	 * - EMPTY: Required for use of Flags utility
-	 * - INFO: Informational messages that highlight the progress of the application at coarse-grained level
-	 * - DEBUG: Detailed information typically of interest only when diagnosing problems
-	 * - WARN: Potentially harmful situations which still allow the application to continue running
-	 * - ERROR: Error events that might still allow the application to continue running
-	 * - FATAL: Very severe error events that will presumably lead the application to abort
+	 * - BLOCK: The calling thread waits until the sink thread frees a slot.
+	 * - DROP_NEWEST: The new record is discarded.
+	 * - DROP_OLDEST: The oldest queued record is discarded to make room for the new one.
+	 */
+	enum class OverflowPolicy
+	{
+		BLOCK,
+		DROP_NEWEST,
+		DROP_OLDEST
+	};
+
+	/**
+	 * @brief Configuration of asynchronous logging
 	 *
+	 * @see enableAsync
 	 */
-	enum class LogLevel : uint32_t
+	struct AsyncConfig
 	{
-		EMPTY,
-		INFO,
-		DEBUG,
-		WARN,
-		ERROR,
-		FATAL
+		/**
+		 * @brief The number of records the queue can hold (rounded up to a power of two)
+		 */
+		size_t capacity = 1024;
+		/**
+		 * @brief What to do when the queue is full
+		 */
+		OverflowPolicy overflowPolicy = OverflowPolicy::BLOCK;
 	};
 
 	/**
@@ -317,21 +506,52 @@ class Logger
 	 *
 	 * Initializes the logger with no formats, no destinations, and no log levels enabled.
 	 */
-	Logger() = default;
+	Logger();
 	/**
 	 * @brief Destroy the Logger object
 	 *
+	 * @note Derived classes must call @ref disableAsync in their destructor, since the sink thread
+	 * calls into @ref write.
 	 */
-	virtual ~Logger() = default;
+	virtual ~Logger();
+
+	// Non-copyable, the async backend refers back to its logger
+	Logger(const Logger&)			 = delete;
+	Logger& operator=(const Logger&) = delete;
 
 	/**
 	 * @brief Utilizes the Flags utility to manage enabled log levels.
 	 */
 	typedef Flags<LogLevel> LogLevelFlags;
 
+	/**
+	 * @brief The maximum number of dynamic parameters passed along with a message
+	 */
+	static constexpr size_t maxDynamicParameters = 8;
+	/**
+	 * @brief The maximum length of a message rendered by the templated @ref log API
+	 */
+	static constexpr size_t maxMessageLength = 512;
+	/**
+	 * @brief The maximum combined length of the dynamic parameters rendered by the templated @ref log API
+	 */
+	static constexpr size_t maxDynamicParametersLength = 256;
+
+	/**
+	 * @brief Get the display name of a log level
+	 *
+	 * @param level The log level
+	 * @return The name of the log level as it is rendered by the LEVEL token
+	 */
+	static std::string_view getLogLevelName(LogLevel level);
+
 	/**
 	 * @brief Add a new log message format
 	 *
+	 * @details
+	 * Formats may be changed while other threads log, including the sink thread of an asynchronous
+	 * logger; this and the other format setters wait for the messages being rendered.
+	 *
 	 * @param format The format to add
 	 */
 	void addFormat(const Format& format);
@@ -363,15 +583,9 @@ class Logger
 	/**
 	 * @brief Replace current log level flags with the provided flags
 	 *
-	 * @param flags The new log level flags to set
+	 * @param flags The new log level flags to set, e.g. `{ LogLevel::WARN, LogLevel::ERROR }`
 	 */
 	void setLogLevelFlags(LogLevelFlags flags) { m_logLevelFlags = flags; };
-	/**
-	 * @brief Replace current log level flags with the provided levels
-	 *
-	 * @param levels The new log levels to set
-	 */
-	void setLogLevelFlags(std::vector<LogLevel> levels) { m_logLevelFlags = LogLevelFlags(levels); };
 	/**
 	 * @brief Enable or disable a specific log level
 	 *
@@ -395,21 +609,361 @@ class Logger
 	 */
 	void updateLogLevelFlags(LogLevelFlags flags) { m_logLevelFlags.updateFlags(flags); };
 
+	/**
+	 * @brief Check if messages of a log level are compiled into this build
+	 *
+	 * @details
+	 * INFO and DEBUG are compiled out when `ZAPHOD_LOG_STRIP_VERBOSE` is defined, which the
+	 * `ZAPHOD_STRIP_VERBOSE_LOGS` CMake option does for Release builds.
+	 *
+	 * @param level The log level to check
+	 * @return true if messages of the level can be logged, false if they are stripped
+	 */
+	static constexpr bool isLevelCompiled(LogLevel level)
+	{
+#ifdef ZAPHOD_LOG_STRIP_VERBOSE
+		return level != LogLevel::INFO && level != LogLevel::DEBUG;
+#else
+		return level != LogLevel::EMPTY;
+#endif
+	}
+	/**
+	 * @brief Check if messages of a log level would be logged
+	 *
+	 * @details
+	 * This is the cheap check to make before building a message or its arguments,
+	 * the ZAPHOD_LOG_* macros use it so that nothing is evaluated for disabled levels.
+	 *
+	 * @param level The log level to check
+	 * @return true if the level is compiled in and enabled, false otherwise
+	 */
+	bool isEnabled(LogLevel level) const { return isLevelCompiled(level) && m_logLevelFlags.checkFlag(level); }
+
+	/**
+	 * @brief Switch the logger to asynchronous mode
+	 *
+	 * @details
+	 * Starts a sink thread that renders and writes queued records. Replaces any previously
+	 * enabled backend, draining it first.
+	 *
+	 * @note Destinations should be configured before enabling async mode, they are read by the sink
+	 * thread without synchronization. Formats are guarded and may be changed at any time.
+	 *
+	 * @param config The queue capacity and overflow policy to use
+	 */
+	void enableAsync(const AsyncConfig& config);
+	/**
+	 * @brief Switch the logger back to synchronous mode
+	 *
+	 * @details
+	 * Writes every queued record and stops the sink thread. Does nothing if the logger is not asynchronous.
+	 */
+	void disableAsync();
+	/**
+	 * @brief Check if the logger is asynchronous
+	 *
+	 * @return true if records are written by a sink thread, false otherwise
+	 */
+	bool isAsync() const { return m_asyncBackend != nullptr; }
+	/**
+	 * @brief Get the asynchronous backend
+	 *
+	 * @return The backend, or nullptr if the logger is synchronous
+	 */
+	const AsyncLogBackend* getAsyncBackend() const { return m_asyncBackend.get(); }
+	/**
+	 * @brief Wait until every record logged so far has been written
+	 *
+	 * @details
+	 * Waits for the sink thread of asynchronous loggers, then writes out any buffered file output.
+	 */
+	void flush();
+
+	/**
+	 * @brief Open the log file behind the FILE destination and enable the destination
+	 *
+	 * @param config The log file configuration
+	 * @return The Result of opening the file
+	 */
+	Result setLogFile(const LogFileWriter::Config& config);
+	/**
+	 * @brief Flush and close the log file and disable the FILE destination
+	 */
+	void closeLogFile();
+	/**
+	 * @brief Open the binary log file behind the BINARY destination and enable the destination
+	 *
+	 * @details
+	 * Records are written without being formatted and can be turned back into text offline with
+	 * the `zaphod-log-decoder` tool, see @ref BinaryLogWriter.
+	 *
+	 * @param config The log file configuration, `append` is ignored
+	 * @return The Result of opening the file
+	 */
+	Result setBinaryLogFile(const LogFileWriter::Config& config);
+	/**
+	 * @brief Flush and close the binary log file and disable the BINARY destination
+	 */
+	void closeBinaryLogFile();
+	/**
+	 * @brief Set the sink behind the EVENTS destination and enable or disable the destination
+	 *
+	 * @details
+	 * Records go to the sink unformatted, and reach the bus as events::LogEvent the next time the
+	 * sink publishes, see @ref events::LogEventSink. The App's sink publishes once per frame.
+	 *
+	 * @note Should not be called while other threads are logging.
+	 *
+	 * @param sink The sink, which must outlive the logger's use of it, or nullptr to disable the destination
+	 */
+	void setEventSink(events::LogEventSink* sink);
+
+	/**
+	 * @brief Set the clock the timestamps of records are read from
+	 *
+	 * @note Should not be called while other threads are logging.
+	 *
+	 * @param clock The clock to use, or nullptr to restore the @ref LogClock::getDefault "default clock"
+	 */
+	void setClock(std::shared_ptr<const LogClock> clock)
+	{
+		m_clock			 = clock ? std::move(clock) : LogClock::getDefault();
+		m_clockPrecision = m_clock->getFinestPrecision();
+	}
+	/**
+	 * @brief Get the clock the timestamps of records are read from
+	 *
+	 * @return The logger's clock
+	 */
+	const LogClock& getClock() const { return *m_clock; }
+	/**
+	 * @brief Set the number of sub-second digits rendered for the TIME token
+	 *
+	 * @details
+	 * Digits finer than the clock resolves are not rendered, see @ref LogClock::getFinestPrecision.
+	 * The default coarse clock usually resolves milliseconds or centiseconds.
+	 *
+	 * @param precision The precision to render timestamps with
+	 */
+	void setTimePrecision(TimePrecision precision) { m_timePrecision = precision; }
+	/**
+	 * @brief Get the number of sub-second digits rendered for the TIME token
+	 *
+	 * @return The precision timestamps are rendered with
+	 */
+	TimePrecision getTimePrecision() const { return m_timePrecision; }
+
+	/**
+	 * @brief Log a message with compile-time checked arguments
+	 *
+	 * @details
+	 * Positional arguments replace the `{}` placeholders of the message in order, and
+	 * [named parameters](@ref param) are bound to the dynamic tokens of the format at `FormatIndex`.
+	 * The number of placeholders and arguments, the argument types and the parameter names are
+	 * all checked at compile time, see @ref BasicLogString.
+	 *
+	 * The message and parameters are rendered into fixed-size buffers on the stack, so nothing is
+	 * allocated, and nothing is rendered at all if the level is disabled. Levels that are not
+	 * [compiled in](@ref isLevelCompiled) reduce the call to nothing.
+	 * Text beyond @ref maxMessageLength and @ref maxDynamicParametersLength is truncated.
+	 *
+	 * @code
+	 * logger.log<Logger::LogLevel::INFO>("Loaded {} meshes in {} ms", meshCount, elapsed);
+	 * @endcode
+	 *
+	 * @tparam Level The log level of the message
+	 * @tparam FormatIndex The index of the format to use for the message
+	 * @param message The message, with a `{}` placeholder for every positional argument
+	 * @param args The positional arguments and named parameters
+	 */
+	template<LogLevel Level, size_t FormatIndex = 0, typename... Args>
+	void log(LogString<Args...> message, const Args&... args)
+	{
+		if constexpr (!isLevelCompiled(Level))
+			return;
+		if (!m_logLevelFlags.checkFlag(Level))
+			return;
+		logFormatted<FormatIndex>(Level, message, args...);
+	}
+	/**
+	 * @brief Log a report the user asked for, with compile-time checked arguments
+	 *
+	 * @details
+	 * Reports are INFO records that are neither [compiled out](@ref isLevelCompiled) nor filtered by
+	 * the level flags, for output requested on demand, such as the App's F11 and F12 profiler reports.
+	 * Otherwise they behave like @ref log.
+	 *
+	 * @code
+	 * logger.report("Wrote the profile to {}", path);
+	 * @endcode
+	 *
+	 * @tparam FormatIndex The index of the format to use for the report
+	 * @param message The message, with a `{}` placeholder for every positional argument
+	 * @param args The positional arguments and named parameters
+	 */
+	template<size_t FormatIndex = 0, typename... Args>
+	void report(LogString<Args...> message, const Args&... args)
+	{
+		logFormatted<FormatIndex>(LogLevel::INFO, message, args...);
+	}
+
   protected:
+	friend class AsyncLogBackend;
+
 	/**
 	 * @brief Log a message with the specified dynamic parameters, format index, and log level
 	 *
-	 * @note This method must be implemented by derived classes to handle the actual logging logic.
+	 * @details
+	 * Drops the message if its level is disabled, otherwise passes it to @ref submit.
 	 *
 	 * @param message The log message content
 	 * @param dynamicParameters The dynamic parameters to include in the log message
-	 * @param formatIndex The index of the format to use for the log message (default: 0)
-	 * @param level The log level of the message (default: INFO)
+	 * @param formatIndex The index of the format to use for the log message
+	 * @param level The log level of the message
+	 */
+	void log(std::string_view				   message,
+			 std::span<const std::string_view> dynamicParameters,
+			 size_t							   formatIndex,
+			 LogLevel						   level);
+	/**
+	 * @brief Log a message regardless of the enabled levels
+	 *
+	 * @details
+	 * The message is either passed to @ref write directly or, in asynchronous mode, queued for the
+	 * sink thread. FATAL messages are always written before this method returns.
+	 *
+	 * @param message The log message content
+	 * @param dynamicParameters The dynamic parameters to include in the log message
+	 * @param formatIndex The index of the format to use for the log message
+	 * @param level The log level of the message
+	 */
+	void submit(std::string_view				  message,
+				std::span<const std::string_view> dynamicParameters,
+				size_t							  formatIndex,
+				LogLevel						  level);
+
+	/**
+	 * @brief Render the message and arguments of the templated API and @ref submit the record
+	 *
+	 * @details
+	 * Callers have already decided that the message is logged.
+	 */
+	template<size_t FormatIndex, typename... Args>
+	void logFormatted(LogLevel level, LogString<Args...> message, const Args&... args)
+	{
+		LogBuffer<maxMessageLength>			  text;
+		LogBuffer<maxDynamicParametersLength> parameterText;
+		std::string_view					  parameters[maxDynamicParameters];
+		size_t								  parameterCount = 0;
+		// Named parameters look up their slots in the format, which can be replaced concurrently
+		std::shared_lock<std::shared_mutex> formatLock(m_formatMutex, std::defer_lock);
+		if constexpr (LogString<Args...>::namedCount > 0)
+		{
+			formatLock.lock();
+			if (FormatIndex < m_formats.size())
+				parameterCount = std::min(m_formats[FormatIndex].getDynamicTokens().size(), maxDynamicParameters);
+		}
+
+		std::string_view remaining = message.get();
+		(appendArgument<FormatIndex>(text, remaining, parameterText, parameters, parameterCount, args), ...);
+		detail::appendUntilPlaceholder(text, remaining);
+		if (formatLock.owns_lock())
+			formatLock.unlock();
+
+		submit(text.view(), std::span<const std::string_view>(parameters, parameterCount), FormatIndex, level);
+	}
+
+	/**
+	 * @brief Write a record to the enabled destinations
+	 *
+	 * @note This method must be implemented by derived classes to handle the actual logging logic.
+	 * In asynchronous mode it is called from the sink thread.
+	 *
+	 * @param record The record to write
+	 */
+	virtual void write(const Record& record) = 0;
+
+	/**
+	 * @brief Render a record with the format at its format index
+	 *
+	 * @details
+	 * Appends the rendered message to `output`.
+	 * Derived classes use this from their @ref write implementation.
+	 *
+	 * @param output The buffer to append the rendered message to
+	 * @param record The record to render
+	 * @return true if the message was rendered, false if the format index is out of range or the format is invalid
+	 */
+	bool renderMessage(std::string& output, const Record& record) const;
+	/**
+	 * @brief Append a rendered line to the log file if the FILE destination is enabled
+	 *
+	 * @param line The rendered line, including its line terminator
+	 * @param level The log level of the line, FATAL lines are written out immediately
+	 */
+	void writeToFile(std::string_view line, LogLevel level);
+	/**
+	 * @brief Write a record to the binary log file if the BINARY destination is enabled
+	 *
+	 * @param record The record to write
+	 */
+	void writeToBinaryLog(const Record& record);
+	/**
+	 * @brief Push a record to the event sink if the EVENTS destination is enabled
+	 *
+	 * @param record The record to push
+	 */
+	void writeToEvents(const Record& record);
+	/**
+	 * @brief Check if any destination needs the record rendered as text
+	 *
+	 * @return true if the CONSOLE or FILE destination is enabled
+	 */
+	bool hasTextDestination() const
+	{
+		return m_destinations.contains(LogDestination::CONSOLE) || m_destinations.contains(LogDestination::FILE);
+	}
+	/**
+	 * @brief Write out buffered destination output whose flush interval has passed
+	 *
+	 * @details
+	 * Called periodically by the sink thread of asynchronous loggers while it is idle.
+	 */
+	void flushDestinations();
+
+	/**
+	 * @brief Render one argument of the templated @ref log API
+	 *
+	 * @details
+	 * Positional arguments are appended to the message after the literal text preceding their
+	 * placeholder. Named parameters are rendered into the slot of their dynamic token, and ignored
+	 * if the format has no such token.
 	 */
-	virtual void log(const std::string&				 message,
-					 const std::vector<std::string>& dynamicParameters,
-					 size_t							 formatIndex,
-					 LogLevel						 level) = 0;
+	template<size_t FormatIndex, typename T>
+	void appendArgument(LogBuffer<maxMessageLength>&		   text,
+						std::string_view&					   remaining,
+						LogBuffer<maxDynamicParametersLength>& parameterText,
+						std::string_view (&parameters)[maxDynamicParameters],
+						size_t								   parameterCount,
+						const T&							   argument) const
+	{
+		if constexpr (IsNamedParameter<T>::value)
+		{
+			if (parameterCount == 0)
+				return;
+			size_t slot = m_formats[FormatIndex].findDynamicToken(T::name);
+			if (slot >= parameterCount)
+				return;
+			size_t start = parameterText.size();
+			parameterText.appendArgument(argument.value);
+			parameters[slot] = parameterText.view().substr(start);
+		}
+		else
+		{
+			detail::appendUntilPlaceholder(text, remaining);
+			text.appendArgument(argument);
+		}
+	}
 
 	/**
 	 * @brief The set of log destinations currently enabled
@@ -419,10 +973,42 @@ class Logger
 	 * @brief The list of log message formats currently defined
 	 */
 	std::vector<Format> m_formats;
+	/**
+	 * @brief Held exclusively while the formats change, shared while a message is rendered with them
+	 */
+	mutable std::shared_mutex m_formatMutex;
 	/**
 	 * @brief The flags representing the currently enabled log levels
 	 */
 	LogLevelFlags m_logLevelFlags;
+	/**
+	 * @brief The backend writing records on a sink thread, if the logger is asynchronous
+	 */
+	std::unique_ptr<AsyncLogBackend> m_asyncBackend;
+	/**
+	 * @brief The writer behind the FILE destination, if a log file is open
+	 */
+	std::unique_ptr<LogFileWriter> m_fileWriter;
+	/**
+	 * @brief The writer behind the BINARY destination, if a binary log file is open
+	 */
+	std::unique_ptr<BinaryLogWriter> m_binaryWriter;
+	/**
+	 * @brief The sink behind the EVENTS destination, if one is set
+	 */
+	events::LogEventSink* m_eventSink = nullptr;
+	/**
+	 * @brief The clock the timestamps of records are read from
+	 */
+	std::shared_ptr<const LogClock> m_clock = LogClock::getDefault();
+	/**
+	 * @brief The finest precision the clock resolves, timestamps are rendered no finer
+	 */
+	TimePrecision m_clockPrecision = m_clock->getFinestPrecision();
+	/**
+	 * @brief The number of sub-second digits rendered for the TIME token
+	 */
+	TimePrecision m_timePrecision = TimePrecision::MILLISECONDS;
 };
 
 /**
@@ -437,8 +1023,8 @@ class Logger
 class SimpleLogger: public Logger
 {
   public:
-	SimpleLogger()			 = default;
-	~SimpleLogger() override = default;
+	SimpleLogger() = default;
+	~SimpleLogger() override { disableAsync(); }
 
 	/**
 	 * @brief Log an informational message.
@@ -449,7 +1035,22 @@ class SimpleLogger: public Logger
 	 *
 	 * @param message The informational message to log.
 	 */
-	void info(std::string message);
+	void info(std::string_view message)
+	{
+		if constexpr (isLevelCompiled(LogLevel::INFO))
+			log(message, {}, 0, LogLevel::INFO);
+	}
+	/**
+	 * @brief Log an informational message with compile-time checked arguments.
+	 *
+	 * @see Logger::log
+	 */
+	template<typename... Args>
+		requires(sizeof...(Args) > 0)
+	void info(LogString<Args...> message, const Args&... args)
+	{
+		log<LogLevel::INFO>(message, args...);
+	}
 	/**
 	 * @brief Log a debug message.
 	 *
@@ -457,9 +1058,24 @@ class SimpleLogger: public Logger
 	 * This method logs a message with the DEBUG log level.
 	 * It uses the default log format and outputs to the configured destinations.
 	 *
-	 * @param message
+	 * @param message The debug message to log.
 	 */
-	void debug(std::string message);
+	void debug(std::string_view message)
+	{
+		if constexpr (isLevelCompiled(LogLevel::DEBUG))
+			log(message, {}, 0, LogLevel::DEBUG);
+	}
+	/**
+	 * @brief Log a debug message with compile-time checked arguments.
+	 *
+	 * @see Logger::log
+	 */
+	template<typename... Args>
+		requires(sizeof...(Args) > 0)
+	void debug(LogString<Args...> message, const Args&... args)
+	{
+		log<LogLevel::DEBUG>(message, args...);
+	}
 
 	/**
 	 * @brief The default log message format string for SimpleLogger.
@@ -482,22 +1098,16 @@ class SimpleLogger: public Logger
 
   protected:
   /**
-   * @brief Log a message with the specified dynamic parameters, format index, and log level
+   * @brief Write a record to the configured destinations
    * 
    * @details
-   * This method overrides the base Logger's @ref log method to handle logging for
+   * This method overrides the base Logger's @ref write method to handle logging for
    * INFO and DEBUG log levels.
-   * It uses the default log format and outputs to the configured destinations.
+   * It uses the record's log format and outputs to the configured destinations.
    * 
-   * @param message The log message content
-   * @param dynamicParameters The dynamic parameters to include in the log message
-   * @param formatIndex The index of the format to use for the log message
-   * @param level The log level of the message
+   * @param record The record to write
    */
-	void log(const std::string&				 message,
-			 const std::vector<std::string>& dynamicParameters,
-			 size_t							 formatIndex,
-			 LogLevel						 level) override;
+	void write(const Record& record) override;
 };
 
 /**
@@ -513,8 +1123,8 @@ class SimpleLogger: public Logger
 class ErrorLogger: public Logger
 {
   public:
-	ErrorLogger()  = default;
-	~ErrorLogger() = default;
+	ErrorLogger() = default;
+	~ErrorLogger() override { disableAsync(); }
 
 	/**
 	 * @brief Log a warning message.
@@ -527,7 +1137,22 @@ class ErrorLogger: public Logger
 	 *
 	 * @param message The warning message to log.
 	 */
-	void warn(std::string message);
+	void warn(std::string_view message)
+	{
+		if constexpr (isLevelCompiled(LogLevel::WARN))
+			log(message, {}, 0, LogLevel::WARN);
+	}
+	/**
+	 * @brief Log a warning message with compile-time checked arguments.
+	 *
+	 * @see Logger::log
+	 */
+	template<typename... Args>
+		requires(sizeof...(Args) > 0)
+	void warn(LogString<Args...> message, const Args&... args)
+	{
+		log<LogLevel::WARN>(message, args...);
+	}
 	/**
 	 * @brief Log an error message.
 	 *
@@ -539,7 +1164,22 @@ class ErrorLogger: public Logger
 	 *
 	 * @param message The error message to log.
 	 */
-	void error(std::string message);
+	void error(std::string_view message)
+	{
+		if constexpr (isLevelCompiled(LogLevel::ERROR))
+			log(message, {}, 0, LogLevel::ERROR);
+	}
+	/**
+	 * @brief Log a error message with compile-time checked arguments.
+	 *
+	 * @see Logger::log
+	 */
+	template<typename... Args>
+		requires(sizeof...(Args) > 0)
+	void error(LogString<Args...> message, const Args&... args)
+	{
+		log<LogLevel::ERROR>(message, args...);
+	}
 	/**
 	 * @brief Log a fatal error message.
 	 *
@@ -551,7 +1191,22 @@ class ErrorLogger: public Logger
 	 *
 	 * @param message The fatal error message to log.
 	 */
-	void fatal(std::string message);
+	void fatal(std::string_view message)
+	{
+		if constexpr (isLevelCompiled(LogLevel::FATAL))
+			log(message, {}, 0, LogLevel::FATAL);
+	}
+	/**
+	 * @brief Log a fatal error message with compile-time checked arguments.
+	 *
+	 * @see Logger::log
+	 */
+	template<typename... Args>
+		requires(sizeof...(Args) > 0)
+	void fatal(LogString<Args...> message, const Args&... args)
+	{
+		log<LogLevel::FATAL>(message, args...);
+	}
 
 	/**
 	 * @brief The default log message format string for ErrorLogger.
@@ -573,28 +1228,22 @@ class ErrorLogger: public Logger
 	inline const static std::string defaultFormatString = "[%{LEVEL}%][%{TIME}%]{%{SOURCE}%->%{FUNCTION}%}: %{MESSAGE}%";
 
 	/**
-	 * @brief Log a message with the specified dynamic parameters, format index, and log level
+	 * @brief Write a record to the configured destinations
 	 * 
 	 * @details
-	 * This method overrides the base Logger's @ref log method to handle logging for
+	 * This method overrides the base Logger's @ref write method to handle logging for
 	 * WARN, ERROR, and FATAL log levels.
-	 * It uses the default log format and outputs to the configured destinations.
+	 * It uses the record's log format and outputs to the configured destinations.
 	 * Additionally, it applies color coding to the log messages based on the log level:
 	 * - WARN messages are colored yellow.
 	 * - ERROR messages are colored orange.
 	 * - FATAL messages are colored red.
 	 * 
-	 * @param message The log message content
-	 * @param dynamicParameters The dynamic parameters to include in the log message
-	 * @param formatIndex The index of the format to use for the log message
-	 * @param level The log level of the message
+	 * @param record The record to write
 	 * 
 	 */
   protected:
-	void log(const std::string&				 message,
-			 const std::vector<std::string>& dynamicParameters,
-			 size_t							 formatIndex,
-			 LogLevel						 level) override;
+	void write(const Record& record) override;
 };
 
 /**
@@ -623,6 +1272,35 @@ class LoggerFactory
 	 * @return A unique pointer to the created logger instance.
 	 */
 	virtual std::unique_ptr<T> create() = 0;
+
+	/**
+	 * @brief Make loggers created by this factory asynchronous.
+	 *
+	 * @param config The asynchronous logging configuration to apply
+	 */
+	void setAsync(const Logger::AsyncConfig& config) { m_asyncConfig = config; }
+	/**
+	 * @brief Make loggers created by this factory synchronous (the default).
+	 */
+	void setSync() { m_asyncConfig.reset(); }
+
+  protected:
+	/**
+	 * @brief Apply the factory's asynchronous configuration to a newly created logger.
+	 *
+	 * @details
+	 * Concrete factories call this once the logger is fully configured.
+	 *
+	 * @param logger The logger to configure
+	 */
+	void applyAsync(T& logger) const
+	{
+		if (m_asyncConfig)
+			logger.enableAsync(*m_asyncConfig);
+	}
+
+  private:
+	std::optional<Logger::AsyncConfig> m_asyncConfig;
 };
 
 /**
@@ -641,6 +1319,13 @@ class LoggerFactory
 class SimpleLoggerFactory: public LoggerFactory<SimpleLogger>
 {
   public:
+	/**
+	 * @brief Construct a new SimpleLoggerFactory
+	 *
+	 * @param source The value of the SOURCE token for created loggers
+	 */
+	explicit SimpleLoggerFactory(std::string source = "Zaphod"): m_source(std::move(source)) {}
+
 	/**
 	 * @brief Create a new SimpleLogger instance with default settings.
 	 *
@@ -648,9 +1333,56 @@ class SimpleLoggerFactory: public LoggerFactory<SimpleLogger>
 	 * This method initializes a SimpleLogger with a default log format that includes
 	 * the source, log level, timestamp, and message content. It also enables INFO and DEBUG
 	 * log levels and adds the console as a log destination by default.
+	 * If the factory was configured with @ref setAsync, the logger is made asynchronous.
 	 *
 	 * @return A unique pointer to the created SimpleLogger instance.
 	 */
 	std::unique_ptr<SimpleLogger> create() override;
+
+  private:
+	std::string m_source;
 };
-}	 // namespace zaphod::logging
\ No newline at end of file
+
+/**
+ * @brief Check whether a format string and its parameters form a valid format
+ *
+ * @details
+ * Compiles a temporary @ref Logger::Format and reports whether it is valid.
+ * Prefer constructing the Format once and checking @ref Logger::Format::isValid when the
+ * format is going to be used for logging.
+ *
+ * @param format The format string to check
+ * @param parameters The values of the static tokens in the format string
+ * @return true if the format is valid, false otherwise
+ */
+bool validateFormatParameters(const std::string& format, const std::unordered_map<std::string, std::string>& parameters);
+}	 // namespace zaphod::logging
+
+/**
+ * @brief Log through a logger's level method only if the level is enabled
+ *
+ * @details
+ * The arguments are not evaluated unless @ref zaphod::logging::Logger::isEnabled "isEnabled" returns true,
+ * and levels that are not [compiled in](@ref zaphod::logging::Logger::isLevelCompiled) expand to nothing.
+ *
+ * @code
+ * ZAPHOD_LOG_INFO(*logger, "Loaded {} meshes", countMeshes());
+ * @endcode
+ */
+#define ZAPHOD_LOG_IF_ENABLED(logger, level, method, ...)                   \
+	do                                                                      \
+	{                                                                       \
+		if ((logger).isEnabled(::zaphod::logging::Logger::LogLevel::level)) \
+			(logger).method(__VA_ARGS__);                                   \
+	} while (0)
+
+#ifdef ZAPHOD_LOG_STRIP_VERBOSE
+#define ZAPHOD_LOG_INFO(logger, ...)  ((void)0)
+#define ZAPHOD_LOG_DEBUG(logger, ...) ((void)0)
+#else
+#define ZAPHOD_LOG_INFO(logger, ...)  ZAPHOD_LOG_IF_ENABLED(logger, INFO, info, __VA_ARGS__)
+#define ZAPHOD_LOG_DEBUG(logger, ...) ZAPHOD_LOG_IF_ENABLED(logger, DEBUG, debug, __VA_ARGS__)
+#endif
+#define ZAPHOD_LOG_WARN(logger, ...)  ZAPHOD_LOG_IF_ENABLED(logger, WARN, warn, __VA_ARGS__)
+#define ZAPHOD_LOG_ERROR(logger, ...) ZAPHOD_LOG_IF_ENABLED(logger, ERROR, error, __VA_ARGS__)
+#define ZAPHOD_LOG_FATAL(logger, ...) ZAPHOD_LOG_IF_ENABLED(logger, FATAL, fatal, __VA_ARGS__)
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "util/result.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace zaphod::profiling
+{
+/**
+ * @brief A timed span of work on one track of the timeline
+ */
+struct Zone
+{
+	const char* name;		 // Must outlive the profiler, e.g. a string literal
+	int64_t		start;		 // Nanoseconds since the profiler was created
+	int64_t		duration;	 // Nanoseconds
+};
+
+/**
+ * @brief Frame time statistics over the recent frames, in milliseconds
+ */
+struct FrameStats
+{
+	uint32_t frameCount = 0;	// The number of frames the statistics cover
+	double	 average	= 0.0;
+	double	 p50		= 0.0;
+	double	 p99		= 0.0;
+	double	 max		= 0.0;
+};
+
+/**
+ * @brief Records a timeline of CPU and GPU work and the statistics of recent frame times.
+ *
+ * @details
+ * Work is marked with @ref ZAPHOD_PROFILE_ZONE, which times the enclosing scope. Zones are only
+ * recorded while a capture runs, between @ref startCapture and @ref stopCapture; otherwise a zone
+ * costs one relaxed load. Every thread records into its own buffer of @ref zonesPerTrack zones,
+ * with no locks and no allocation once the buffer exists, and zones that do not fit are dropped.
+ * The buffer of a thread that exits is reused by a later thread once the capture holding its zones
+ * is over, so threads that come and go do not add up.
+ * The GPU timings of the @ref render::GpuProfiler go onto a track of their own.
+ *
+ * A finished capture is written with @ref exportChromeTrace, as the JSON trace format that
+ * chrome://tracing and Perfetto (ui.perfetto.dev) open.
+ *
+ * Independently of captures, @ref markFrame keeps the last @ref frameHistorySize frame times,
+ * summarized by @ref getFrameStats.
+ *
+ * @code
+ * void Game::onUpdate(float deltaTime)
+ * {
+ *     ZAPHOD_PROFILE_ZONE("Game::onUpdate");
+ *     ...
+ * }
+ * @endcode
+ */
+class Profiler
+{
+  public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr uint32_t zonesPerTrack	   = 1 << 15;
+	static constexpr uint32_t frameHistorySize = 1024;
+
+	/**
+	 * @brief Get the profiler every zone is recorded to
+	 *
+	 * @return The profiler
+	 */
+	static Profiler& get();
+
+	// Non-copyable, non-movable
+	Profiler(const Profiler&)			 = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler(Profiler&&)				 = delete;
+	Profiler& operator=(Profiler&&)		 = delete;
+
+	/**
+	 * @brief Start a capture, discarding the zones of the previous one
+	 */
+	void startCapture();
+	/**
+	 * @brief Stop recording zones, the capture can be exported afterwards
+	 */
+	void stopCapture();
+	bool isCapturing() const { return m_isCapturing.load(std::memory_order_relaxed); }
+	/**
+	 * @brief Get the number of zones the current or last capture dropped because a track was full
+	 *
+	 * @return The number of dropped zones
+	 */
+	uint64_t getDroppedZoneCount() const { return m_droppedZones.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Write the last capture as a Chrome trace
+	 *
+	 * @details
+	 * Must not run while a capture is running or being started.
+	 *
+	 * @param path The file to write
+	 * @return Result::Code::SUCCESS if the file was written\n
+	 * Result::Code::IO_ERROR if it could not be written
+	 */
+	Result exportChromeTrace(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief Name the calling thread's track in exported traces
+	 *
+	 * @param name The name
+	 */
+	void setThreadName(std::string name);
+
+	/**
+	 * @brief Record a zone on the calling thread's track
+	 *
+	 * @param zone The zone, ignored if no capture is running
+	 */
+	void recordZone(const Zone& zone);
+	/**
+	 * @brief Record a zone on the GPU track
+	 *
+	 * @details
+	 * Called from one thread at a time, the one collecting the GPU timings.
+	 *
+	 * @param zone The zone, on the profiler's time base, ignored if no capture is running
+	 */
+	void recordGpuZone(const Zone& zone);
+
+	/**
+	 * @brief End a frame on the CPU, recording its time since the previous call
+	 *
+	 * @details
+	 * Called once per frame by the @ref App. While capturing, the frame also becomes a zone.
+	 */
+	void markFrame();
+	/**
+	 * @brief Record how long the GPU took for a frame
+	 *
+	 * @param milliseconds The time between the frame's first and last GPU timestamp
+	 */
+	void recordGpuFrame(double milliseconds);
+	/**
+	 * @brief Get the statistics of the recent CPU frame times
+	 *
+	 * @return The statistics, from the time between @ref markFrame calls
+	 */
+	FrameStats getFrameStats() const;
+	/**
+	 * @brief Get the statistics of the recent GPU frame times
+	 *
+	 * @return The statistics, from @ref recordGpuFrame
+	 */
+	FrameStats getGpuFrameStats() const;
+
+	/**
+	 * @brief Read the time zones are recorded in
+	 *
+	 * @return The nanoseconds since the profiler was created
+	 */
+	int64_t now() const { return toTimestamp(Clock::now()); }
+	int64_t toTimestamp(Clock::time_point time) const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_epoch).count();
+	}
+
+  private:
+	// The zones of one thread, or of the GPU. Only its owner writes, and publishes every zone
+	// through the count, so exporting reads it without locks.
+	struct Track
+	{
+		std::string				name;
+		uint32_t				id = 0;
+		std::unique_ptr<Zone[]> zones;
+		std::atomic<uint32_t>	count { 0 };
+		std::atomic<uint32_t>	capture { 0 };	  // The capture the count belongs to
+	};
+
+	// Hands a thread's track back to the profiler when the thread exits
+	struct ThreadTrack
+	{
+		Track* track = nullptr;
+		~ThreadTrack();
+	};
+
+	// The last frame times in a ring, written once per frame
+	struct FrameHistory
+	{
+		double	 times[frameHistorySize] {};
+		uint32_t next  = 0;
+		uint32_t count = 0;
+
+		void	   add(double milliseconds);
+		FrameStats summarize() const;
+	};
+
+	Profiler();
+
+	Track* getThreadTrack();
+	Track* createTrack(std::string name);
+	void   releaseTrack(Track* track);
+	void   record(Track& track, const Zone& zone);
+
+	const Clock::time_point m_epoch;
+	std::atomic<bool>		m_isCapturing { false };
+	std::atomic<uint32_t>	m_capture { 0 };	// Counts captures, tracks from earlier ones are empty
+	std::atomic<uint64_t>	m_droppedZones { 0 };
+
+	mutable std::mutex					m_trackMutex;	 // Guards the list, never a track's zones
+	std::vector<std::unique_ptr<Track>> m_tracks;
+	std::vector<Track*>					m_freeTracks;	 // Tracks of exited threads
+	Track*								m_gpuTrack = nullptr;
+
+	mutable std::mutex m_frameMutex;	// Guards the histories
+	FrameHistory	   m_cpuFrames;
+	FrameHistory	   m_gpuFrames;
+	Clock::time_point  m_lastFrame;	   // When the previous frame was marked, zero before the first
+
+	static thread_local ThreadTrack t_threadTrack;	  // Registered on the thread's first zone
+};
+
+/**
+ * @brief Times the scope it lives in, see @ref ZAPHOD_PROFILE_ZONE
+ */
+class ScopedZone
+{
+  public:
+	explicit ScopedZone(const char* name): m_name(name)
+	{
+		Profiler& profiler = Profiler::get();
+		m_start			   = profiler.isCapturing() ? profiler.now() : -1;
+	}
+	~ScopedZone()
+	{
+		if (m_start < 0)
+			return;
+		Profiler& profiler = Profiler::get();
+		profiler.recordZone({ m_name, m_start, profiler.now() - m_start });
+	}
+
+	// Non-copyable, non-movable
+	ScopedZone(const ScopedZone&)			 = delete;
+	ScopedZone& operator=(const ScopedZone&) = delete;
+
+  private:
+	const char* m_name;
+	int64_t		m_start;	// -1 when no capture was running as the zone began
+};
+}	 // namespace zaphod::profiling
+
+#define ZAPHOD_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ZAPHOD_PROFILE_CONCAT(a, b)		 ZAPHOD_PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Time the rest of the enclosing scope as a zone of the @ref zaphod::profiling::Profiler
+ *
+ * @details
+ * The name must outlive the profiler, e.g. a string literal. Expands to nothing unless the
+ * `ZAPHOD_PROFILER` CMake option defines `ZAPHOD_PROFILE`.
+ *
+ * @code
+ * ZAPHOD_PROFILE_ZONE("Upload textures");
+ * @endcode
+ */
+#ifdef ZAPHOD_PROFILE
+#define ZAPHOD_PROFILE_ZONE(name) ::zaphod::profiling::ScopedZone ZAPHOD_PROFILE_CONCAT(zaphodZone, __LINE__)(name)
+#else
+#define ZAPHOD_PROFILE_ZONE(name) ((void)0)
+#endif
+/**
+ * @brief Time the rest of the enclosing function, named after it
+ */
+#define ZAPHOD_PROFILE_FUNCTION() ZAPHOD_PROFILE_ZONE(__func__)
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "core/glfw_common.h"
+#include "util/flags.h"
+#include "util/mpmc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace zaphod
+{
+class Window;
+
+// GLFW key and mouse button codes, as flags
+enum class Key : uint32_t
+{
+};
+enum class MouseButton : uint32_t
+{
+};
+
+/**
+ * @brief One input event as a window's callbacks capture it, before it is folded into an @ref InputState.
+ */
+struct RawInputEvent
+{
+	enum class Type : uint8_t
+	{
+		KEY,			 // code is the GLFW key, action the GLFW action
+		MOUSE_BUTTON,	 // code is the GLFW mouse button, action the GLFW action
+		CURSOR,			 // x and y are the cursor position, unaccelerated while the cursor is captured
+		SCROLL,			 // x and y are the scroll offsets
+		CHAR,			 // code is the Unicode code point
+		FOCUS			 // code is 1 if the window gained focus, 0 if it lost it
+	};
+
+	Type	type   = Type::KEY;
+	int32_t code   = 0;
+	int32_t action = 0;
+	int32_t mods   = 0;
+	double	x	   = 0.0;
+	double	y	   = 0.0;
+	Window* window = nullptr;
+	int64_t time   = 0;	   // When the event was captured, in steady clock nanoseconds
+};
+
+/**
+ * @brief The input of one frame, immutable once published.
+ *
+ * @details
+ * Key and button states are @ref Flags, so the whole snapshot is a few hundred bytes and copying
+ * it or reading it from many threads touches a handful of cache lines. A key pressed and released
+ * within one frame still reports @ref wasKeyPressed and @ref wasKeyReleased, so short taps are
+ * never lost to the frame rate.
+ */
+class InputState
+{
+  public:
+	static constexpr uint32_t keyCount		= GLFW_KEY_LAST + 1;
+	static constexpr uint32_t buttonCount	= GLFW_MOUSE_BUTTON_LAST + 1;
+	static constexpr uint32_t maxTextLength = 32;	 // Code points typed per frame, the rest is dropped
+
+	// Whether a key is held at the end of the frame. Keys are GLFW key codes.
+	bool isKeyDown(int key) const { return m_keysDown.checkFlag(Key(key)); }
+	// Whether a key went down during the frame, whether or not it is still held
+	bool wasKeyPressed(int key) const { return m_keysPressed.checkFlag(Key(key)); }
+	// Whether a key went up during the frame
+	bool wasKeyReleased(int key) const { return m_keysReleased.checkFlag(Key(key)); }
+
+	// The same for mouse buttons, which are GLFW mouse button codes
+	bool isButtonDown(int button) const { return m_buttonsDown.checkFlag(MouseButton(button)); }
+	bool wasButtonPressed(int button) const { return m_buttonsPressed.checkFlag(MouseButton(button)); }
+	bool wasButtonReleased(int button) const { return m_buttonsReleased.checkFlag(MouseButton(button)); }
+
+	// The cursor position at the end of the frame, relative to the content area of the window it was last over
+	double getCursorX() const { return m_cursorX; }
+	double getCursorY() const { return m_cursorY; }
+	// How far the cursor moved during the frame, summed over every motion event, unaccelerated while captured
+	double getCursorDeltaX() const { return m_cursorDeltaX; }
+	double getCursorDeltaY() const { return m_cursorDeltaY; }
+	// The scrolling during the frame
+	double getScrollX() const { return m_scrollX; }
+	double getScrollY() const { return m_scrollY; }
+	// The GLFW modifier bits of the last key or button event
+	int getMods() const { return m_mods; }
+	// The code points typed during the frame, in order
+	std::u32string_view getText() const { return { m_text.data(), m_textLength }; }
+
+	// The window with input focus, nullptr if none has it. Only for comparison, it may have closed since.
+	const Window* getFocusedWindow() const { return m_focusedWindow; }
+	// The number of updates before this snapshot, 0 for the empty one before the first update
+	uint64_t getFrameNumber() const { return m_frameNumber; }
+	// The number of events folded into the snapshot
+	uint32_t getEventCount() const { return m_eventCount; }
+	// When the last of those events was captured, in steady clock nanoseconds, 0 if there were none
+	int64_t getLatestEventTime() const { return m_latestEventTime; }
+
+  private:
+	friend class InputSystem;
+
+	using KeyFlags	  = Flags<Key, keyCount>;
+	using ButtonFlags = Flags<MouseButton, buttonCount>;
+
+	KeyFlags							m_keysDown {};
+	KeyFlags							m_keysPressed {};
+	KeyFlags							m_keysReleased {};
+	ButtonFlags							m_buttonsDown {};
+	ButtonFlags							m_buttonsPressed {};
+	ButtonFlags							m_buttonsReleased {};
+	double								m_cursorX		  = 0.0;
+	double								m_cursorY		  = 0.0;
+	double								m_cursorDeltaX	  = 0.0;
+	double								m_cursorDeltaY	  = 0.0;
+	double								m_scrollX		  = 0.0;
+	double								m_scrollY		  = 0.0;
+	int32_t								m_mods			  = 0;
+	uint32_t							m_textLength	  = 0;
+	std::array<char32_t, maxTextLength>	m_text {};
+	const Window*						m_focusedWindow	  = nullptr;
+	uint64_t							m_frameNumber	  = 0;
+	uint32_t							m_eventCount	  = 0;
+	int64_t								m_latestEventTime = 0;
+};
+
+/**
+ * @brief Captures raw input events from any thread and publishes one @ref InputState per frame.
+ *
+ * @details
+ * Windows given the system with @ref Window::setInputSystem record every key, button, cursor,
+ * scroll, character and focus event into a fixed-capacity lock-free queue, which never allocates.
+ * Once per frame, right after the event pump, @ref update folds the queued events into a new
+ * snapshot and publishes it with a single atomic store, so update jobs on any worker read the
+ * frame's input with @ref getState, without locks and without seeing a half-built state:
+ * @code
+ * const InputState& input = app.getInputSystem().getState();
+ * if (input.isKeyDown(GLFW_KEY_W))
+ *     position += forward * speed * deltaTime;
+ * @endcode
+ *
+ * Events that arrive while the queue is full are dropped and counted. Losing focus releases every
+ * key and button, so a dropped or missed release never leaves one stuck.
+ */
+class InputSystem
+{
+  public:
+	static constexpr size_t defaultCapacity = 1024;
+
+	/**
+	 * @brief Construct a new InputSystem
+	 *
+	 * @param capacity The number of events that can be queued between two updates
+	 */
+	explicit InputSystem(size_t capacity = defaultCapacity);
+
+	// Non-copyable, non-movable
+	InputSystem(const InputSystem&)			   = delete;
+	InputSystem& operator=(const InputSystem&) = delete;
+	InputSystem(InputSystem&&)				   = delete;
+	InputSystem& operator=(InputSystem&&)	   = delete;
+
+	/**
+	 * @brief Queue an event for the next update, from any thread
+	 *
+	 * @param event The event
+	 * @return true if the event was queued, false if the queue was full and it was dropped
+	 */
+	bool record(const RawInputEvent& event);
+
+	/**
+	 * @brief Fold the queued events into a new snapshot and publish it, once per frame on one thread
+	 *
+	 * @return The new snapshot
+	 */
+	const InputState& update();
+
+	/**
+	 * @brief Get the latest snapshot, from any thread
+	 *
+	 * @return The snapshot, valid until the update after next, so a job may finish one frame late
+	 */
+	const InputState& getState() const { return *m_state.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Get the number of events dropped because the queue was full
+	 *
+	 * @return The number of dropped events since construction
+	 */
+	uint64_t getDroppedEventCount() const { return m_droppedEventCount.load(std::memory_order_relaxed); }
+
+  private:
+	void apply(InputState& state, const RawInputEvent& event);
+
+	MpmcQueue<RawInputEvent>	   m_events;
+	std::array<InputState, 3>	   m_states;	// The published snapshot, the one before it and the one being built
+	std::atomic<const InputState*> m_state;
+	uint32_t					   m_nextState	  = 1;
+	std::atomic<uint64_t>		   m_droppedEventCount { 0 };
+	const Window*				   m_cursorWindow = nullptr;	// The window the last cursor position belongs to
+};
+}	 // namespace zaphod
@@ -2,8 +2,15 @@
 
 #include "core/glfw_common.h"
 
+#include <functional>
+
 namespace zaphod
 {
+namespace events
+{
+class EventBus;
+}
+class InputSystem;
 
 //!  Window class for creating and managing application windows.
 /*!
@@ -18,8 +25,9 @@ class Window
 	 * @param width  - Width of the window in pixels.
 	 * @param height - Height of the window in pixels.
 	 * @param title  - Title of the window.
+	 * @param resizable - Whether the user can resize the window.
 	 */
-	Window(int width, int height, const char* title);
+	Window(int width, int height, const char* title, bool resizable = true);
 	~Window();
 
 	// Non-copyable, non-movable
@@ -35,11 +43,30 @@ class Window
 	*/
 	bool shouldClose() const;
 
-	//! Poll for and process window events.
-	/*
-		This function processes all pending events for the window.
+	//! Poll for and process the events of every window.
+	/*!
+		Runs the callbacks of all pending events, whichever window they belong to, so it is
+		called once per frame however many windows are open.
+	*/
+	static void pollEvents();
+	//! Wait for events of any window, then process them.
+	/*!
+		Sleeps until an event arrives or the timeout expires, used instead of pollEvents while the
+		application is idle.
+		@param timeout - The longest time to wait, in seconds.
 	*/
-	void pollEvents() const;
+	static void waitEvents(double timeout);
+
+	//! Check if the window has input focus.
+	/*!
+		@return true if the window is focused, false otherwise.
+	*/
+	bool isFocused() const;
+	//! Check if the window is minimized.
+	/*!
+		@return true if the window is iconified, false otherwise.
+	*/
+	bool isMinimized() const;
 	//! Get the underlying GLFW window.
 	/*! 
 		Retrieves the pointer to the GLFWwindow instance.
@@ -47,7 +74,72 @@ class Window
 	*/
 	GLFWwindow* getGLFWwindow() const { return m_window; }
 
+	//! Get the size of the window's framebuffer.
+	/*!
+		The framebuffer size is in pixels and may differ from the window size on high-DPI displays.
+		@param width  - Receives the width in pixels, 0 while minimized.
+		@param height - Receives the height in pixels, 0 while minimized.
+	*/
+	void getFramebufferSize(int& width, int& height) const;
+	//! Create a Vulkan surface for the window.
+	/*!
+		The caller owns the surface and must destroy it before the instance.
+		@param instance - The instance to create the surface with.
+		@return The surface, or VK_NULL_HANDLE if it could not be created.
+	*/
+	VkSurfaceKHR createSurface(VkInstance instance) const;
+
+	//! Route the window's input and window events to an event bus.
+	/*!
+		The window publishes the events declared in gui/window_events.h from within pollEvents and
+		waitEvents.
+		@param eventBus - The bus to publish to, or nullptr to stop publishing.
+	*/
+	void setEventBus(events::EventBus* eventBus) { m_eventBus = eventBus; }
+	//! Get the event bus the window publishes to.
+	/*!
+		@return The event bus, or nullptr if none is set.
+	*/
+	events::EventBus* getEventBus() const { return m_eventBus; }
+
+	//! Capture the window's keyboard, mouse and focus events into an input system.
+	/*!
+		Captured as they arrive, alongside the events published to the bus.
+		@param inputSystem - The system to record into, or nullptr to stop recording.
+	*/
+	void setInputSystem(InputSystem* inputSystem) { m_inputSystem = inputSystem; }
+	//! Get the input system the window records into.
+	/*!
+		@return The input system, or nullptr if none is set.
+	*/
+	InputSystem* getInputSystem() const { return m_inputSystem; }
+
+	//! Hide the cursor and lock it to the window, for mouse look.
+	/*!
+		While captured, the cursor moves without bounds and, where the platform supports it,
+		reports raw, unaccelerated mouse motion.
+		@param captured - Whether to capture the cursor.
+	*/
+	void setCursorCaptured(bool captured);
+	//! Check if the cursor is captured.
+	/*!
+		@return true if the cursor is captured, false otherwise.
+	*/
+	bool isCursorCaptured() const;
+
+	//! Set the function called when the window's contents need to be redrawn.
+	/*!
+		Called right away from within pollEvents or waitEvents, unlike the events on the bus. On
+		Windows the event pump blocks while a window is moved or resized, and this is the only
+		callback that still runs, so rendering from it keeps the window live.
+		@param callback - The function, or an empty one to remove it.
+	*/
+	void setRefreshCallback(std::function<void(Window&)> callback);
+
   private:
-	GLFWwindow* m_window = nullptr;
+	GLFWwindow*					 m_window	   = nullptr;
+	events::EventBus*			 m_eventBus	   = nullptr;
+	InputSystem*				 m_inputSystem = nullptr;
+	std::function<void(Window&)> m_refreshCallback;
 };
 }	 // namespace zaphod
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/events.h"
+
+namespace zaphod
+{
+class Window;
+}
+
+namespace zaphod::events
+{
+//! Published when the user asks to close a window.
+struct WindowCloseEvent: Event<WindowCloseEvent>
+{
+	Window* window;
+};
+
+//! Published when the framebuffer of a window changes size, in pixels.
+struct WindowResizeEvent: Event<WindowResizeEvent>
+{
+	Window* window;
+	int		width;
+	int		height;
+};
+
+//! Published when a window gains or loses input focus.
+struct WindowFocusEvent: Event<WindowFocusEvent>
+{
+	Window* window;
+	bool	isFocused;
+};
+
+//! Published when a key is pressed, repeated or released. Values are the GLFW key codes and actions.
+struct KeyEvent: Event<KeyEvent>
+{
+	Window* window;
+	int		key;
+	int		scancode;
+	int		action;
+	int		mods;
+};
+
+//! Published for every Unicode character typed into a window.
+struct CharEvent: Event<CharEvent>
+{
+	Window*	 window;
+	uint32_t codepoint;
+};
+
+//! Published when a mouse button is pressed or released. Values are the GLFW button codes and actions.
+struct MouseButtonEvent: Event<MouseButtonEvent>
+{
+	Window* window;
+	int		button;
+	int		action;
+	int		mods;
+};
+
+//! Published when the cursor moves, in screen coordinates relative to the window's content area.
+struct MouseMoveEvent: Event<MouseMoveEvent>
+{
+	Window* window;
+	double	x;
+	double	y;
+};
+
+//! Published when the mouse wheel or touchpad scrolls.
+struct MouseScrollEvent: Event<MouseScrollEvent>
+{
+	Window* window;
+	double	xOffset;
+	double	yOffset;
+};
+}	 // namespace zaphod::events
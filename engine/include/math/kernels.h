@@ -0,0 +1,193 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zaphod::math
+{
+/**
+ * @brief The instruction sets the kernels have a path for
+ */
+enum class SimdLevel : uint8_t
+{
+	SCALAR,	   // glm, on any CPU
+	SSE,	   // SSE2, on any x86-64 CPU
+	AVX2,	   // AVX2 and FMA, 8 elements at a time
+	NEON	   // On any AArch64 CPU
+};
+
+/**
+ * @brief Get the best instruction set of this CPU the build has kernels for, detected once
+ *
+ * @return The level
+ */
+SimdLevel getSupportedSimdLevel();
+/**
+ * @brief Get the instruction set the kernels run on, @ref getSupportedSimdLevel unless overridden
+ *
+ * @return The level
+ */
+SimdLevel getSimdLevel();
+/**
+ * @brief Make the kernels run on another instruction set, e.g. to compare paths in a benchmark
+ *
+ * @details
+ * Not synchronized with kernels running on other threads, which may still use the previous path.
+ *
+ * @param level The level, or SCALAR for a level this CPU or build does not support
+ * @return The level the kernels run on from now on
+ */
+SimdLevel setSimdLevel(SimdLevel level);
+
+/**
+ * @brief The name of a level, e.g. "AVX2"
+ */
+const char* toString(SimdLevel level);
+
+/**
+ * @brief The planes of a view frustum, as (a, b, c, d) with a point inside if ax + by + cz + d >= 0
+ *
+ * @details
+ * render::GpuCulling::extractFrustum gets them from a view-projection matrix.
+ */
+struct Frustum
+{
+	float planes[6][4];	   // Left, right, bottom, top, near, far, normalized
+};
+
+/**
+ * @brief Marks a root in the parents array of @ref propagateTransforms
+ */
+inline constexpr uint32_t noParent = UINT32_MAX;
+
+/**
+ * @brief Local transforms as one array per component: translation, unit rotation quaternion and scale
+ */
+struct TransformArrays
+{
+	const float* positionX;
+	const float* positionY;
+	const float* positionZ;
+	const float* rotationX;
+	const float* rotationY;
+	const float* rotationZ;
+	const float* rotationW;
+	const float* scaleX;
+	const float* scaleY;
+	const float* scaleZ;
+};
+
+/**
+ * @brief Bounding spheres as one array per component, the output of @ref transformSpheres
+ */
+struct SphereArrays
+{
+	float* x;
+	float* y;
+	float* z;
+	float* radius;
+};
+
+/**
+ * @brief Axis-aligned bounding boxes as one array per component of their center and half extent
+ */
+struct BoxArrays
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* extentX;
+	const float* extentY;
+	const float* extentZ;
+};
+
+/**
+ * @brief Build the matrices of translation, rotation and scale transforms
+ *
+ * @details
+ * Each matrix is translate * rotate * scale, as glm's translate, mat4_cast and scale compose them.
+ *
+ * @param local The transforms, count of each component
+ * @param count The number of transforms
+ * @param matrices Receives count matrices
+ */
+void composeTransforms(const TransformArrays& local, size_t count, glm::mat4* matrices);
+/**
+ * @brief Propagate a transform hierarchy: the world matrix of each node is its parent's times its own
+ *
+ * @details
+ * The nodes are a flattened hierarchy in which every parent comes before its children, as a
+ * depth-first or breadth-first walk from the roots orders them, so each world matrix only
+ * depends on ones computed before it.
+ *
+ * @param local The matrices of the nodes relative to their parents
+ * @param parents The index of the parent of each node, less than the node's, or @ref noParent for roots
+ * @param count The number of nodes
+ * @param world Receives count matrices relative to the world, must not overlap local
+ */
+void propagateTransforms(const glm::mat4* local, const uint32_t* parents, size_t count, glm::mat4* world);
+/**
+ * @brief Move bounding spheres to world space, into arrays ready for @ref cullSpheres
+ *
+ * @details
+ * The radius is scaled by the largest axis scale of the matrix, which keeps the sphere
+ * conservative under non-uniform scaling, as cull.comp does.
+ *
+ * @param world The object to world matrices
+ * @param local The spheres in object space, center then radius
+ * @param count The number of spheres
+ * @param spheres Receives count spheres
+ */
+void transformSpheres(const glm::mat4* world, const glm::vec4* local, size_t count, const SphereArrays& spheres);
+/**
+ * @brief Find the bounding spheres that intersect a frustum
+ *
+ * @param frustum The frustum, in the space of the spheres
+ * @param spheres The spheres, count of each component
+ * @param count The number of spheres
+ * @param visible Receives the indices of the visible spheres in increasing order, needs room for count
+ * @return The number of visible spheres
+ */
+size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible);
+/**
+ * @brief Find the boxes that intersect a frustum
+ *
+ * @details
+ * Like @ref cullSpheres, a box is visible unless it is entirely outside one plane, so boxes
+ * near the corners of the frustum can be reported visible.
+ *
+ * @param frustum The frustum, in the space of the boxes
+ * @param boxes The boxes, count of each component
+ * @param count The number of boxes
+ * @param visible Receives the indices of the visible boxes in increasing order, needs room for count
+ * @return The number of visible boxes
+ */
+size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible);
+
+namespace detail
+{
+// One path of the kernels, matrices as 16 floats each, column-major
+struct KernelTable
+{
+	void (*composeTransforms)(const TransformArrays& local, size_t count, float* matrices);
+	void (*propagateTransforms)(const float* local, const uint32_t* parents, size_t count, float* world);
+	void (*transformSpheres)(const float* world, const float* local, size_t count, const SphereArrays& spheres);
+	size_t (*cullSpheres)(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible);
+	size_t (*cullBoxes)(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible);
+};
+
+// The glm path over the elements from begin to count, on which the others finish what is left after their last full
+// register. Culling writes the visible indices from visible[0] and returns their number.
+void   composeTransformsScalar(const TransformArrays& local, size_t begin, size_t count, float* matrices);
+void   transformSpheresScalar(const float* world, const float* local, size_t begin, size_t count, const SphereArrays& spheres);
+size_t cullSpheresScalar(const Frustum& frustum, const SphereArrays& spheres, size_t begin, size_t count, uint32_t* visible);
+size_t cullBoxesScalar(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t count, uint32_t* visible);
+
+// The paths of the instruction sets, nullptr where the build has none
+const KernelTable* getSseKernels();
+const KernelTable* getAvx2Kernels();
+const KernelTable* getNeonKernels();
+}	 // namespace detail
+}	 // namespace zaphod::math
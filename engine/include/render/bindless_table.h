@@ -0,0 +1,139 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief One large descriptor set holding every texture and storage buffer, indexed from shaders.
+ *
+ * @details
+ * Instead of a descriptor set per draw, resources are added to the table once and shaders receive
+ * their indices, e.g. through push constants or in a storage buffer, so a draw binds nothing but
+ * the table. Every pipeline is created with @ref getPipelineLayout, which also has a push constant
+ * range of @ref pushConstantSize bytes for every stage, and binds the table once per command
+ * buffer with @ref bind.
+ *
+ * The set is created with descriptor indexing's update after bind: adding and removing resources
+ * never waits for the GPU, and slots that were never written may stay empty. Shaders declare the
+ * bindings with the layouts of engine/src/shaders/bindless.glsl:
+ * @code
+ * layout(set = 0, binding = 0) uniform sampler2D textures[];
+ * layout(set = 0, binding = 1, std430) readonly buffer Objects { ObjectData objects[]; } objectBuffers[];
+ * @endcode
+ *
+ * Resources can be added and removed from any thread. A removed index is reused for the next
+ * added resource, so it must not be removed while frames in flight may still read it; remove it
+ * with @ref Renderer::destroyLater.
+ */
+class BindlessTable
+{
+  public:
+	static constexpr uint32_t textureBinding   = 0;	   // Combined image samplers
+	static constexpr uint32_t bufferBinding	   = 1;	   // Storage buffers
+	static constexpr uint32_t pushConstantSize = 128;	 // The size every device supports
+	static constexpr uint32_t invalidIndex	   = UINT32_MAX;
+
+	struct Config
+	{
+		uint32_t maxTextures = 16384;	 // Lowered to the device's update after bind limits
+		uint32_t maxBuffers	 = 16384;
+	};
+
+	BindlessTable() = default;
+	~BindlessTable();
+
+	// Non-copyable, non-movable
+	BindlessTable(const BindlessTable&)			   = delete;
+	BindlessTable& operator=(const BindlessTable&) = delete;
+	BindlessTable(BindlessTable&&)				   = delete;
+	BindlessTable& operator=(BindlessTable&&)	   = delete;
+
+	/**
+	 * @brief Create the descriptor set, its layout and the pipeline layout
+	 *
+	 * @param device The device, must outlive the table or its @ref destroy call
+	 * @param config The options
+	 * @return The Result of creating the Vulkan objects
+	 */
+	Result initialize(const Device& device, const Config& config);
+	/**
+	 * @brief Destroy the Vulkan objects, the GPU must be done with them
+	 */
+	void destroy();
+
+	/**
+	 * @brief Add a texture
+	 *
+	 * @param imageView The view of the texture
+	 * @param sampler The sampler it is read with
+	 * @param layout The layout the image is in when shaders read it
+	 * @return The index of the texture in the table, @ref invalidIndex if the table is full
+	 */
+	uint32_t addTexture(VkImageView imageView, VkSampler sampler,
+						VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	/**
+	 * @brief Add a range of a storage buffer
+	 *
+	 * @param buffer The buffer, created with VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+	 * @param offset The start of the range, a multiple of minStorageBufferOffsetAlignment
+	 * @param range The size of the range, VK_WHOLE_SIZE for the rest of the buffer
+	 * @return The index of the buffer in the table, @ref invalidIndex if the table is full
+	 */
+	uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+	/**
+	 * @brief Free the index of a texture, no frame in flight may use it anymore
+	 *
+	 * @param index The index returned by @ref addTexture
+	 */
+	void removeTexture(uint32_t index);
+	/**
+	 * @brief Free the index of a buffer, no frame in flight may use it anymore
+	 *
+	 * @param index The index returned by @ref addBuffer
+	 */
+	void removeBuffer(uint32_t index);
+
+	/**
+	 * @brief Bind the table as set 0 of a command buffer
+	 *
+	 * @param commandBuffer The command buffer
+	 * @param bindPoint VK_PIPELINE_BIND_POINT_GRAPHICS or VK_PIPELINE_BIND_POINT_COMPUTE
+	 */
+	void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const;
+
+	VkDescriptorSetLayout getSetLayout() const { return m_setLayout; }
+	VkDescriptorSet		  getSet() const { return m_set; }
+	VkPipelineLayout	  getPipelineLayout() const { return m_pipelineLayout; }
+	uint32_t			  getTextureCapacity() const { return m_textures.capacity; }
+	uint32_t			  getBufferCapacity() const { return m_buffers.capacity; }
+
+  private:
+	// Hands out the indices of one binding, freed ones first
+	struct Slots
+	{
+		uint32_t			  capacity	= 0;
+		uint32_t			  nextIndex = 0;	// Every index from here on was never used
+		std::vector<uint32_t> freeIndices;
+
+		uint32_t allocate();
+		void	 release(uint32_t index);
+	};
+
+	const Device*		  m_device		   = nullptr;
+	VkDescriptorSetLayout m_setLayout	   = VK_NULL_HANDLE;
+	VkDescriptorPool	  m_pool		   = VK_NULL_HANDLE;
+	VkDescriptorSet		  m_set			   = VK_NULL_HANDLE;
+	VkPipelineLayout	  m_pipelineLayout = VK_NULL_HANDLE;
+
+	std::mutex m_mutex;	   // Guards the slots and the writes to the set
+	Slots	   m_textures;
+	Slots	   m_buffers;
+};
+}	 // namespace zaphod::render
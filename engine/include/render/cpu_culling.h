@@ -0,0 +1,88 @@
+#pragma once
+
+#include "math/kernels.h"
+#include "render/vulkan_common.h"
+#include "util/result.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace zaphod::render
+{
+class Renderer;
+
+/**
+ * @brief Frustum culls objects on the CPU and draws the visible ones with one indirect call.
+ *
+ * @details
+ * The counterpart of @ref GpuCulling for when the CPU needs the visible set as well, e.g. to sort,
+ * pick levels of detail or stream, or when the GPU is the busier of the two. The SIMD kernels of
+ * math/kernels.h test the bounding spheres, and the draws of the visible objects are written
+ * straight into frame data, which the GPU reads as the indirect buffer: nothing is copied or
+ * uploaded, and the draw count is known when the draw is recorded.
+ *
+ * The draws have the object's index as firstInstance, like those of @ref GpuCulling::cull, so the
+ * same @ref GpuCulling::Object buffer, pipeline and vertex shader serve both.
+ *
+ * @code
+ * math::transformSpheres(worldMatrices, localSpheres, count, spheres);
+ * culling.cull(renderer, GpuCulling::extractFrustum(viewProjection), spheres, meshes, draws);
+ * vkCmdBindIndexBuffer(frame->commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+ * CpuCulling::draw(frame->commandBuffer, draws);
+ * @endcode
+ *
+ * Not thread-safe, one instance per thread culling.
+ */
+class CpuCulling
+{
+  public:
+	/**
+	 * @brief Where the indices of an object are, as in @ref GpuCulling::Object
+	 */
+	struct Mesh
+	{
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t	 vertexOffset;
+	};
+
+	/**
+	 * @brief The draws of one culled set of objects, valid during the frame they were written in
+	 */
+	struct Draws
+	{
+		VkBuffer	 buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		uint32_t	 count	= 0;
+	};
+
+	/**
+	 * @brief Cull the objects and write the draws of the visible ones into the current frame's data
+	 *
+	 * @param renderer The renderer, inside a frame
+	 * @param frustum The frustum in the space of the spheres, see @ref GpuCulling::extractFrustum
+	 * @param spheres The bounding spheres of the objects, e.g. from math::transformSpheres
+	 * @param meshes The mesh of each object, as many as there are spheres
+	 * @param draws Receives the draws
+	 * @return Result::Code::SUCCESS if the draws were written, also when no object is visible\n
+	 * Result::Code::OUT_OF_MEMORY if the frame data ring is full, in which case draws is empty
+	 */
+	Result cull(Renderer& renderer, const math::Frustum& frustum, const math::SphereArrays& spheres, std::span<const Mesh> meshes,
+				Draws& draws);
+	/**
+	 * @brief Record the draw of the objects a @ref cull call found visible
+	 *
+	 * @param commandBuffer The command buffer, inside rendering, with the pipeline and index buffer bound
+	 * @param draws The draws
+	 */
+	static void draw(VkCommandBuffer commandBuffer, const Draws& draws);
+
+	// The indices of the objects the last cull found visible, in increasing order
+	std::span<const uint32_t> getVisible() const { return { m_visible.data(), m_visibleCount }; }
+
+  private:
+	std::vector<uint32_t> m_visible;	// Room for every object, keeps its capacity between frames
+	size_t				  m_visibleCount = 0;
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zaphod
+{
+namespace logging
+{
+class SimpleLogger;
+}
+
+namespace render
+{
+/**
+ * @brief The Vulkan instance, physical device and logical device.
+ *
+ * @details
+ * Targets Vulkan 1.3 and requires timeline semaphores, synchronization2 and dynamic rendering,
+ * so the rest of the renderer never needs render pass or framebuffer objects and synchronizes
+ * frames with a single timeline semaphore. Descriptor indexing and indirect draws with a count
+ * are required as well, for the @ref BindlessTable and GPU driven drawing.
+ *
+ * Creation happens in two steps because choosing a physical device needs a surface to check
+ * presentation support, and creating a surface needs the instance:
+ * @code
+ * device.createInstance(config);
+ * VkSurfaceKHR surface = window.createSurface(device.getInstance());
+ * device.createDevice(surface);
+ * @endcode
+ */
+class Device
+{
+  public:
+	/**
+	 * @brief Options for creating the instance and device
+	 */
+	struct Config
+	{
+		std::string applicationName = "Zaphod";
+		/**
+		 * @brief Enable VK_LAYER_KHRONOS_validation and report its messages through a logger.
+		 * Ignored if the layer is not installed.
+		 */
+#ifdef NDEBUG
+		bool enableValidation = false;
+#else
+		bool enableValidation = true;
+#endif
+		/**
+		 * @brief Prefer an integrated GPU, to save power on laptops
+		 */
+		bool preferIntegrated = false;
+	};
+
+	/**
+	 * @brief Queue family indices chosen for the device
+	 */
+	struct QueueFamilies
+	{
+		uint32_t graphics = UINT32_MAX;
+		uint32_t present  = UINT32_MAX;
+		uint32_t transfer = UINT32_MAX;	   // A family only for copies if there is one, else the graphics family
+	};
+
+	Device();
+	~Device();
+
+	// Non-copyable, non-movable
+	Device(const Device&)			 = delete;
+	Device& operator=(const Device&) = delete;
+	Device(Device&&)				 = delete;
+	Device& operator=(Device&&)		 = delete;
+
+	/**
+	 * @brief Create the Vulkan instance
+	 *
+	 * @param config The options to create the instance with
+	 * @return Result::Code::SUCCESS if the instance was created\n
+	 * Result::Code::ALREADY_INITIALIZED if there already is an instance\n
+	 * Result::Code::UNSUPPORTED if Vulkan 1.3 or the extensions GLFW needs are not available
+	 */
+	Result createInstance(const Config& config);
+	/**
+	 * @brief Pick a physical device and create the logical device and its queues
+	 *
+	 * @param surface A surface the device must be able to present to
+	 * @return Result::Code::SUCCESS if the device was created\n
+	 * Result::Code::NOT_INITIALIZED if there is no instance\n
+	 * Result::Code::UNSUPPORTED if no device supports the required version, features and extensions
+	 */
+	Result createDevice(VkSurfaceKHR surface);
+	/**
+	 * @brief Destroy the device and the instance, waiting for the device to be idle first
+	 */
+	void destroy();
+
+	/**
+	 * @brief Wait until every queue of the device is idle
+	 */
+	void waitIdle() const;
+
+	VkInstance						  getInstance() const { return m_instance; }
+	VkPhysicalDevice				  getPhysicalDevice() const { return m_physicalDevice; }
+	VkDevice						  getDevice() const { return m_device; }
+	const QueueFamilies&			  getQueueFamilies() const { return m_queueFamilies; }
+	VkQueue							  getGraphicsQueue() const { return m_graphicsQueue; }
+	VkQueue							  getPresentQueue() const { return m_presentQueue; }
+	VkQueue							  getTransferQueue() const { return m_transferQueue; }
+	const VkPhysicalDeviceProperties& getProperties() const { return m_properties; }
+	/**
+	 * @brief Get the UUIDs identifying the physical device and its driver
+	 *
+	 * @return The ID properties of the physical device
+	 */
+	const VkPhysicalDeviceIDProperties&		getIDProperties() const { return m_idProperties; }
+	/**
+	 * @brief Get the Vulkan 1.2 properties, e.g. the descriptor indexing limits
+	 *
+	 * @return The properties of the physical device
+	 */
+	const VkPhysicalDeviceVulkan12Properties& getVulkan12Properties() const { return m_vulkan12Properties; }
+	const VkPhysicalDeviceMemoryProperties&	getMemoryProperties() const { return m_memoryProperties; }
+	/**
+	 * @brief Check if VK_EXT_memory_budget is enabled, so heap budgets and usage can be queried
+	 *
+	 * @return True if the device reports memory budgets
+	 */
+	bool hasMemoryBudget() const { return m_hasMemoryBudget; }
+
+  private:
+	static VKAPI_ATTR VkBool32 VKAPI_CALL onDebugMessage(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+														 VkDebugUtilsMessageTypeFlagsEXT types,
+														 const VkDebugUtilsMessengerCallbackDataEXT* data, void* userData);
+
+	bool isSuitable(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, QueueFamilies& families) const;
+
+	Config								   m_config;
+	VkInstance							   m_instance		= VK_NULL_HANDLE;
+	VkDebugUtilsMessengerEXT			   m_debugMessenger	= VK_NULL_HANDLE;
+	VkPhysicalDevice					   m_physicalDevice	= VK_NULL_HANDLE;
+	VkDevice							   m_device			= VK_NULL_HANDLE;
+	VkQueue								   m_graphicsQueue	= VK_NULL_HANDLE;
+	VkQueue								   m_presentQueue	= VK_NULL_HANDLE;
+	VkQueue								   m_transferQueue	= VK_NULL_HANDLE;
+	QueueFamilies						   m_queueFamilies;
+	VkPhysicalDeviceProperties			   m_properties {};
+	VkPhysicalDeviceIDProperties		   m_idProperties {};
+	VkPhysicalDeviceVulkan12Properties	   m_vulkan12Properties {};
+	VkPhysicalDeviceMemoryProperties	   m_memoryProperties {};
+	bool								   m_hasMemoryBudget = false;
+	std::unique_ptr<logging::SimpleLogger> m_logger;	// Receives validation messages
+};
+}	 // namespace render
+}	 // namespace zaphod
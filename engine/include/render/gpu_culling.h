@@ -0,0 +1,145 @@
+#pragma once
+
+#include "math/kernels.h"
+#include "render/vulkan_common.h"
+
+#include <cstdint>
+#include <span>
+
+namespace zaphod::render
+{
+class Renderer;
+
+/**
+ * @brief Frustum culls objects on the GPU and draws the visible ones with one indirect call.
+ *
+ * @details
+ * The CPU cost of a frame no longer grows with the number of objects: every object is an
+ * @ref Object in a storage buffer, written once and updated only when it moves, and each frame
+ * records the same few commands however many there are.
+ *
+ * @ref cull dispatches cull.comp, one invocation per object, which tests the object's bounding
+ * sphere against the frustum and appends a VkDrawIndexedIndirectCommand for each visible object,
+ * with the object's index as firstInstance. @ref draw then consumes them with
+ * vkCmdDrawIndexedIndirectCount, the count coming from the same pass, so the CPU never reads it.
+ * The vertex shader finds its object through gl_InstanceIndex, see simple_shader_bindless.vert.
+ *
+ * @ref CpuCulling culls on the CPU instead and writes draws for the same objects and shaders.
+ *
+ * Every buffer is reached through the renderer's @ref BindlessTable. All meshes share one index
+ * buffer, bound before @ref draw, and one vertex buffer the vertex shader pulls from.
+ *
+ * @code
+ * culling.cull(frame->computeCommandBuffer, GpuCulling::extractFrustum(viewProjection), buffers);
+ * renderer.getBindlessTable().bind(frame->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+ * vkCmdBindPipeline(frame->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, indirectPipeline);
+ * vkCmdBindIndexBuffer(frame->commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+ * GpuCulling::draw(frame->commandBuffer, buffers);
+ * @endcode
+ */
+class GpuCulling
+{
+  public:
+	/**
+	 * @brief An object to cull and draw, matches ObjectData in bindless.glsl
+	 */
+	struct Object
+	{
+		float	 transform[16];		   // Object to world, column-major
+		float	 boundingSphere[4];	   // Center in object space, then the radius
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t	 vertexOffset;
+		uint32_t materialIndex;
+	};
+	static_assert(sizeof(Object) == 96, "Object must match the std430 layout of ObjectData");
+
+	/**
+	 * @brief The planes of a view frustum, shared with the CPU culling kernels
+	 */
+	using Frustum = math::Frustum;
+
+	/**
+	 * @brief The buffers of one culled set of objects
+	 */
+	struct Buffers
+	{
+		uint32_t objectCount = 0;
+		// Indices in the bindless table
+		uint32_t objects = 0;	 // Object array, objectCount of them
+		uint32_t draws	 = 0;	 // Room for objectCount draw commands
+		uint32_t count	 = 0;	 // The number of draws, one uint32_t at the start of the range
+		// The buffers and offsets of the draws and count ranges, with the INDIRECT_BUFFER and TRANSFER_DST usages
+		VkBuffer	 drawBuffer	 = VK_NULL_HANDLE;
+		VkDeviceSize drawOffset	 = 0;
+		VkBuffer	 countBuffer = VK_NULL_HANDLE;
+		VkDeviceSize countOffset = 0;
+	};
+
+	GpuCulling() = default;
+	~GpuCulling();
+
+	// Non-copyable, non-movable
+	GpuCulling(const GpuCulling&)			 = delete;
+	GpuCulling& operator=(const GpuCulling&) = delete;
+	GpuCulling(GpuCulling&&)				 = delete;
+	GpuCulling& operator=(GpuCulling&&)		 = delete;
+
+	/**
+	 * @brief Create the culling pipeline
+	 *
+	 * @details
+	 * The pipeline is rebuilt when the @ref ShaderReloader recompiles cull.comp.
+	 *
+	 * @param renderer The renderer, must outlive the culling or its @ref destroy call
+	 * @param code The SPIR-V of cull.comp, empty for the one embedded in the engine. Builds with
+	 * `ZAPHOD_SHADER_PACK` embed nothing and must pass the code from the pack
+	 * @return Result::Code::SUCCESS if the pipeline was created\n
+	 * Result::Code::INVALID_ARGUMENT if there is no code\n
+	 * The converted VkResult if creating the pipeline failed
+	 */
+	Result initialize(Renderer& renderer, std::span<const uint32_t> code = {});
+	/**
+	 * @brief Destroy the pipeline, the GPU must be done with it
+	 */
+	void destroy();
+
+	/**
+	 * @brief Record the culling pass
+	 *
+	 * @details
+	 * Resets the count, dispatches the pass and makes its output visible to indirect draws and
+	 * vertex shaders. Records into a command buffer outside of rendering, e.g.
+	 * @ref FrameContext::computeCommandBuffer.
+	 *
+	 * @param commandBuffer The command buffer
+	 * @param frustum The frustum in the space the object transforms lead to
+	 * @param buffers The objects and where the draws go
+	 */
+	void cull(VkCommandBuffer commandBuffer, const Frustum& frustum, const Buffers& buffers) const;
+	/**
+	 * @brief Record the draw of the objects a @ref cull pass found visible
+	 *
+	 * @param commandBuffer The command buffer, inside rendering, with the pipeline and index buffer bound
+	 * @param buffers The buffers passed to cull
+	 */
+	static void draw(VkCommandBuffer commandBuffer, const Buffers& buffers);
+
+	/**
+	 * @brief Get the frustum planes of a view-projection matrix
+	 *
+	 * @param viewProjection The column-major matrix, with Vulkan's 0 to 1 depth range
+	 * @return The normalized planes
+	 */
+	static Frustum extractFrustum(const float viewProjection[16]);
+
+	VkPipeline getPipeline() const { return m_pipeline; }
+
+  private:
+	Result createPipeline(VkShaderModule module);
+
+	Renderer*  m_renderer		= nullptr;
+	VkPipeline m_pipeline		= VK_NULL_HANDLE;
+	uint32_t   m_subscriptionId = 0;
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "core/profiler.h"
+#include "render/vulkan_common.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief Times GPU work with timestamp queries and hands the timings to the profiler.
+ *
+ * @details
+ * Every frame in flight has its own query pool. The @ref Renderer brackets each frame with
+ * @ref beginFrame and @ref endFrame, and once the frame slot comes around again, after the GPU
+ * has finished it, its timestamps are read without waiting: the frame's GPU time goes into
+ * @ref profiling::Profiler::getGpuFrameStats, and while a capture runs the frame and its zones
+ * become zones on the profiler's GPU track.
+ *
+ * Zones are recorded from any thread into any of the frame's command buffers with
+ * @ref ZAPHOD_PROFILE_GPU_ZONE, up to @ref maxZonesPerFrame per frame:
+ * @code
+ * ZAPHOD_PROFILE_GPU_ZONE(renderer.getGpuProfiler(), frame->commandBuffer, "Opaque");
+ * @endcode
+ *
+ * GPU timestamps are placed on the CPU timeline with the smallest offset for which no frame
+ * starts on the GPU before it was submitted, refined with every frame, so no extension for
+ * calibrated timestamps is needed.
+ */
+class GpuProfiler
+{
+  public:
+	static constexpr uint32_t maxZonesPerFrame = 256;
+	static constexpr uint32_t invalidZone	   = UINT32_MAX;
+
+	GpuProfiler() = default;
+	~GpuProfiler();
+
+	// Non-copyable, non-movable
+	GpuProfiler(const GpuProfiler&)			   = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+	GpuProfiler(GpuProfiler&&)				   = delete;
+	GpuProfiler& operator=(GpuProfiler&&)	   = delete;
+
+	/**
+	 * @brief Create the query pools
+	 *
+	 * @param device The device, must outlive the profiler or its @ref destroy call
+	 * @param framesInFlight The number of frames in flight
+	 * @return Result::Code::SUCCESS if the pools were created\n
+	 * Result::Code::UNSUPPORTED if the graphics queue cannot write timestamps\n
+	 * The converted VkResult if creating a pool failed
+	 */
+	Result initialize(const Device& device, uint32_t framesInFlight);
+	/**
+	 * @brief Destroy the query pools, the GPU must be done with them
+	 */
+	void destroy();
+	bool isInitialized() const { return m_device != nullptr; }
+
+	/**
+	 * @brief Collect the timings of the frame slot's last frame and begin timing a new one
+	 *
+	 * @param commandBuffer The frame's primary command buffer, outside of rendering
+	 * @param frameIndex The frame slot, the GPU must be done with its last frame
+	 */
+	void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	/**
+	 * @brief Finish timing the frame, right before it is submitted
+	 *
+	 * @param commandBuffer The frame's primary command buffer, its last command
+	 */
+	void endFrame(VkCommandBuffer commandBuffer);
+
+	/**
+	 * @brief Write the timestamp a zone starts at
+	 *
+	 * @param commandBuffer A command buffer of the current frame
+	 * @param name The name of the zone, must outlive the profiler
+	 * @return The zone to pass to @ref endZone, @ref invalidZone if the frame has no room left
+	 */
+	uint32_t beginZone(VkCommandBuffer commandBuffer, const char* name);
+	/**
+	 * @brief Write the timestamp a zone ends at
+	 *
+	 * @param commandBuffer The command buffer the zone began in
+	 * @param zone The zone returned by @ref beginZone
+	 */
+	void endZone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+  private:
+	// Query 0 and 1 time the frame, then every zone has a begin and an end query
+	static constexpr uint32_t queriesPerFrame = 2 + 2 * maxZonesPerFrame;
+
+	struct FrameQueries
+	{
+		VkQueryPool			  pool = VK_NULL_HANDLE;
+		const char*			  names[maxZonesPerFrame] {};
+		std::atomic<uint32_t> zoneCount { 0 };
+		int64_t				  submitTime  = 0;		  // On the profiler's clock
+		bool				  isSubmitted = false;	  // Whether the queries hold results
+	};
+
+	void collect(FrameQueries& frame);
+
+	const Device*					m_device	   = nullptr;
+	std::unique_ptr<FrameQueries[]> m_frames;
+	uint32_t						m_frameCount   = 0;
+	FrameQueries*					m_currentFrame = nullptr;
+	double							m_period	   = 1.0;	 // Nanoseconds per tick
+	uint64_t						m_validMask	   = 0;
+	int64_t							m_offset	   = INT64_MIN;	   // Added to GPU nanoseconds, for the CPU timeline
+	std::vector<uint64_t>			m_results;
+};
+
+/**
+ * @brief Times the GPU work recorded in its scope, see @ref ZAPHOD_PROFILE_GPU_ZONE
+ */
+class ScopedGpuZone
+{
+  public:
+	ScopedGpuZone(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name):
+		m_profiler(profiler), m_commandBuffer(commandBuffer), m_zone(profiler.beginZone(commandBuffer, name))
+	{
+	}
+	~ScopedGpuZone() { m_profiler.endZone(m_commandBuffer, m_zone); }
+
+	// Non-copyable, non-movable
+	ScopedGpuZone(const ScopedGpuZone&)			   = delete;
+	ScopedGpuZone& operator=(const ScopedGpuZone&) = delete;
+
+  private:
+	GpuProfiler&	m_profiler;
+	VkCommandBuffer m_commandBuffer;
+	uint32_t		m_zone;
+};
+}	 // namespace zaphod::render
+
+/**
+ * @brief Time the GPU work recorded into a command buffer in the rest of the enclosing scope
+ *
+ * @details
+ * Expands to nothing unless the `ZAPHOD_PROFILER` CMake option defines `ZAPHOD_PROFILE`.
+ */
+#ifdef ZAPHOD_PROFILE
+#define ZAPHOD_PROFILE_GPU_ZONE(profiler, commandBuffer, name) \
+	::zaphod::render::ScopedGpuZone ZAPHOD_PROFILE_CONCAT(zaphodGpuZone, __LINE__)(profiler, commandBuffer, name)
+#else
+#define ZAPHOD_PROFILE_GPU_ZONE(profiler, commandBuffer, name) ((void)0)
+#endif
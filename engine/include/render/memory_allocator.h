@@ -0,0 +1,191 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+#include "util/tlsf_allocator.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace zaphod::render
+{
+class Device;
+struct MemoryBlock;
+
+/**
+ * @brief What memory is used for, which decides the memory type it comes from
+ */
+enum class MemoryUsage
+{
+	GPU_ONLY,	 // Device local, e.g. vertex buffers and textures filled with copies
+	UPLOAD,		 // Host visible, written once by the CPU and copied from, e.g. staging buffers
+	DYNAMIC,	 // Host visible and preferably device local, rewritten by the CPU every frame
+	READBACK	 // Host visible and preferably cached, written by the GPU and read by the CPU
+};
+
+/**
+ * @brief A range of device memory, owned by the allocator it came from
+ */
+struct Allocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize   offset = 0;
+	VkDeviceSize   size	  = 0;
+	void*		   mapped = nullptr;	// Where the range is mapped, for host visible memory
+
+	MemoryBlock*			  block = nullptr;
+	TlsfAllocator::Allocation range;
+
+	bool isValid() const { return memory != VK_NULL_HANDLE; }
+};
+
+/**
+ * @brief A buffer bound to its own allocation
+ */
+struct Buffer
+{
+	VkBuffer   buffer = VK_NULL_HANDLE;
+	Allocation allocation;
+};
+
+/**
+ * @brief An image bound to its own allocation
+ */
+struct Image
+{
+	VkImage	   image = VK_NULL_HANDLE;
+	Allocation allocation;
+};
+
+/**
+ * @brief Sub-allocates buffers and images from a few large device memory blocks.
+ *
+ * @details
+ * Drivers limit the number of VkDeviceMemory objects, to as few as 4096, and allocating one is
+ * slow. The allocator instead allocates blocks of @ref Config::blockSize per memory type and
+ * places resources in them with a @ref TlsfAllocator, so allocating and freeing cost a few bit
+ * scans under a mutex. Resources larger than half a block get a dedicated allocation.
+ *
+ * Linear resources (buffers and linear images) and optimal images are kept in separate blocks, so
+ * bufferImageGranularity never applies. Host visible blocks stay mapped for their whole lifetime.
+ *
+ * With VK_EXT_memory_budget, blocks are only allocated while the heap stays within the budget the
+ * driver reports, trying smaller blocks before failing, and @ref getStatistics reports the budget
+ * and usage of every heap, including what other processes use.
+ *
+ * Per-frame data needs no freeing at all, see @ref RingBuffer.
+ */
+class MemoryAllocator
+{
+  public:
+	struct Config
+	{
+		VkDeviceSize blockSize = VkDeviceSize(64) << 20;	// Smaller for heaps under 1 GiB
+	};
+
+	/**
+	 * @brief The memory use of a heap
+	 */
+	struct HeapStatistics
+	{
+		VkDeviceSize blockBytes		  = 0;	  // Allocated from the driver by this allocator
+		VkDeviceSize allocatedBytes	  = 0;	  // Handed out to resources
+		VkDeviceSize largestFreeRange = 0;
+		uint32_t	 blockCount		  = 0;
+		uint32_t	 allocationCount  = 0;
+		// 0 when the free memory is one range, towards 1 the more it is split into small ranges
+		float		 fragmentation = 0.0f;
+		VkDeviceSize budget		   = 0;	   // What the process may use, the heap size without VK_EXT_memory_budget
+		VkDeviceSize usage		   = 0;	   // What the process uses, by every allocator
+	};
+
+	struct Statistics
+	{
+		std::vector<HeapStatistics> heaps;	  // Indexed like VkPhysicalDeviceMemoryProperties::memoryHeaps
+		uint32_t					deviceMemoryCount = 0;	  // VkDeviceMemory objects, blocks and dedicated
+	};
+
+	MemoryAllocator();
+	~MemoryAllocator();
+
+	// Non-copyable, non-movable
+	MemoryAllocator(const MemoryAllocator&)			   = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+	MemoryAllocator(MemoryAllocator&&)				   = delete;
+	MemoryAllocator& operator=(MemoryAllocator&&)	   = delete;
+
+	/**
+	 * @brief Set the device memory is allocated from
+	 *
+	 * @param device The device, must outlive the allocator or its @ref destroy call
+	 * @param config The options
+	 */
+	void initialize(const Device& device, const Config& config);
+	/**
+	 * @brief Free every block, every allocation must have been freed
+	 */
+	void destroy();
+
+	/**
+	 * @brief Allocate memory for a resource, can be called from any thread
+	 *
+	 * @param requirements The requirements of the resource
+	 * @param usage What the memory is used for
+	 * @param isLinear False for images with optimal tiling, true for everything else
+	 * @param allocation Receives the allocation
+	 * @return Result::Code::SUCCESS if the memory was allocated\n
+	 * Result::Code::UNSUPPORTED if no memory type is suitable\n
+	 * Result::Code::OUT_OF_MEMORY if the heap is full or over its budget
+	 */
+	Result allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, bool isLinear, Allocation& allocation);
+	/**
+	 * @brief Free an allocation, can be called from any thread
+	 *
+	 * @param allocation The allocation, reset to an invalid one
+	 */
+	void free(Allocation& allocation);
+
+	/**
+	 * @brief Create a buffer and bind it to new memory
+	 *
+	 * @param bufferInfo The buffer to create
+	 * @param usage What its memory is used for
+	 * @param buffer Receives the buffer
+	 * @return The Result of creating the buffer and allocating its memory
+	 */
+	Result createBuffer(const VkBufferCreateInfo& bufferInfo, MemoryUsage usage, Buffer& buffer);
+	void   destroyBuffer(Buffer& buffer);
+	/**
+	 * @brief Create an image and bind it to new memory
+	 *
+	 * @param imageInfo The image to create
+	 * @param usage What its memory is used for, usually GPU_ONLY
+	 * @param image Receives the image
+	 * @return The Result of creating the image and allocating its memory
+	 */
+	Result createImage(const VkImageCreateInfo& imageInfo, MemoryUsage usage, Image& image);
+	void   destroyImage(Image& image);
+
+	/**
+	 * @brief Get the memory use of every heap
+	 *
+	 * @return The statistics, with the budgets as of the call
+	 */
+	Statistics getStatistics() const;
+
+  private:
+	uint32_t	 findMemoryType(uint32_t typeBits, MemoryUsage usage) const;
+	VkDeviceSize getBlockSize(uint32_t memoryType) const;
+	void		 queryBudgets(VkDeviceSize* budgets, VkDeviceSize* usages) const;
+	Result		 allocateMemory(uint32_t memoryType, VkDeviceSize size, std::unique_ptr<MemoryBlock>& block) const;
+	void		 freeBlock(MemoryBlock& block) const;
+
+	const Device* m_device = nullptr;
+	Config		  m_config;
+
+	mutable std::mutex						  m_mutex;	  // Guards the blocks
+	std::vector<std::unique_ptr<MemoryBlock>> m_blocks[VK_MAX_MEMORY_TYPES][2];	   // Per memory type, optimal then linear
+	std::vector<std::unique_ptr<MemoryBlock>> m_dedicatedBlocks;
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief A VkPipelineCache persisted to disk between runs.
+ *
+ * @details
+ * Compiling pipelines from SPIR-V is the expensive part of creating them; with a warm cache the
+ * driver skips it. The cache file starts with a header identifying the device and driver that
+ * wrote it, and the size and hash of the data:
+ * - Data from another device, driver version or cache layout is discarded rather than handed to
+ *   the driver, which only has to tolerate data matching its own pipelineCacheUUID.
+ * - Truncated or corrupted files fail the size or hash check.
+ *
+ * The data itself must also start with a valid VkPipelineCacheHeaderVersionOne for the device.
+ * A rejected file is not an error, the cache starts empty and the file is replaced on @ref save.
+ */
+class PipelineCache
+{
+  public:
+	PipelineCache() = default;
+	~PipelineCache();
+
+	// Non-copyable, non-movable
+	PipelineCache(const PipelineCache&)			   = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+	PipelineCache(PipelineCache&&)				   = delete;
+	PipelineCache& operator=(PipelineCache&&)	   = delete;
+
+	/**
+	 * @brief Create the cache, seeded from a file if it holds valid data for the device
+	 *
+	 * @param device The device to create the cache for
+	 * @param path The cache file, empty to keep the cache in memory only
+	 * @return Result::Code::SUCCESS if the cache was created, whether or not the file was used\n
+	 * Result::Code::ALREADY_INITIALIZED if the cache exists\n
+	 * The converted VkResult if vkCreatePipelineCache failed
+	 */
+	Result initialize(const Device& device, const std::filesystem::path& path);
+	/**
+	 * @brief Write the cache to its file, skipped if nothing was added since it was loaded
+	 *
+	 * @return Result::Code::SUCCESS if the file is up to date\n
+	 * Result::Code::NOT_INITIALIZED if there is no cache\n
+	 * Result::Code::IO_ERROR if the file could not be written
+	 */
+	Result save();
+	/**
+	 * @brief Destroy the cache without saving it
+	 */
+	void destroy();
+
+	VkPipelineCache				 getCache() const { return m_cache; }
+	const std::filesystem::path& getPath() const { return m_path; }
+	/**
+	 * @brief Get the size of the data loaded from the file
+	 *
+	 * @return The size in bytes, 0 if the cache started empty
+	 */
+	size_t getLoadedSize() const { return m_loadedSize; }
+
+  private:
+	const Device*		  m_device = nullptr;
+	VkPipelineCache		  m_cache  = VK_NULL_HANDLE;
+	std::filesystem::path m_path;
+	size_t				  m_loadedSize = 0;
+	uint64_t			  m_loadedHash = 0;
+};
+}	 // namespace zaphod::render
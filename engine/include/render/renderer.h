@@ -0,0 +1,509 @@
+#pragma once
+
+#include "core/job_system.h"
+#include "render/bindless_table.h"
+#include "render/device.h"
+#include "render/gpu_profiler.h"
+#include "render/memory_allocator.h"
+#include "render/pipeline_cache.h"
+#include "render/ring_buffer.h"
+#include "render/shader_library.h"
+#include "render/shader_reloader.h"
+#include "render/swapchain.h"
+#include "render/upload_queue.h"
+#include "util/arena.h"
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace zaphod
+{
+class Window;
+
+namespace render
+{
+/**
+ * @brief What a frame is recorded into, valid between @ref Renderer::beginFrame and @ref Renderer::endFrame
+ *
+ * @details
+ * The window and its image are the ones @ref Renderer::selectWindow last switched to.
+ */
+struct FrameContext
+{
+	VkCommandBuffer	commandBuffer		 = VK_NULL_HANDLE;	  // The main thread's secondary buffer, see Renderer::record
+	VkCommandBuffer	computeCommandBuffer = VK_NULL_HANDLE;	  // Executes before rendering begins, main thread only
+	uint32_t		frameIndex			 = 0;				  // Which of the frames in flight, 0 to getFramesInFlight() - 1
+	uint64_t		frameNumber			 = 0;				  // Counts every frame, also the value its submission signals
+	Window*			window				 = nullptr;			  // The window commandBuffer renders to
+	uint32_t		imageIndex			 = 0;
+	VkImage			image				 = VK_NULL_HANDLE;
+	VkImageView		imageView			 = VK_NULL_HANDLE;
+	VkFormat		format				 = VK_FORMAT_UNDEFINED;
+	VkExtent2D		extent				 = { 0, 0 };
+};
+
+/**
+ * @brief Renders frames to a window with Vulkan 1.3.
+ *
+ * @details
+ * Up to @ref Config::framesInFlight frames are processed at once: while the GPU executes one
+ * frame, the CPU records the next. Each frame in flight owns its command pools, one per recording
+ * thread, and the primary command buffer the swapchain image is rendered with.
+ *
+ * The frame's rendering to the swapchain image is recorded in secondary command buffers, which
+ * the primary executes in order when the frame ends: the main thread records into
+ * @ref FrameContext::commandBuffer, and @ref record fans recording out to the job system's
+ * workers, each task into its own secondary buffer from its worker's pool. Work that has to run
+ * outside of rendering, e.g. compute passes producing the frame's indirect draws, is recorded into
+ * @ref FrameContext::computeCommandBuffer, which executes before the rendering begins.
+ *
+ * Every window rendered to, the one passed to @ref initialize and those added with
+ * @ref addWindow, has its own swapchain on the shared device. A frame acquires an image of every
+ * window that is not minimized and clears it to @ref Config::clearColor; @ref selectWindow
+ * switches which window the following commands render to. The frame is still one submission, and
+ * all windows are presented with a single vkQueuePresentKHR.
+ *
+ * Resources are reached through the renderer's @ref BindlessTable, which every pipeline shares
+ * the layout of.
+ *
+ * Frames are tracked with a single timeline semaphore. Submitting frame N signals the value N, so
+ * reusing the resources of a frame slot waits for the frame that used them last with
+ * vkWaitSemaphores, with no fence per frame. Only swapchain acquisition and presentation, which
+ * require binary semaphores, use them.
+ *
+ * @code
+ * if (FrameContext* frame = renderer.beginFrame())
+ * {
+ *     vkCmdDraw(frame->commandBuffer, 3, 1, 0, 0);
+ *     renderer.record(taskCount, [&](VkCommandBuffer commandBuffer, uint32_t task) { drawChunk(commandBuffer, task); });
+ *     renderer.endFrame();
+ * }
+ * @endcode
+ */
+class Renderer
+{
+  public:
+	static constexpr uint32_t maxFramesInFlight = 3;
+
+	/**
+	 * @brief Options for the renderer, set before @ref initialize
+	 */
+	struct Config
+	{
+		Device::Config device;
+		PresentMode	   presentMode = PresentMode::MAILBOX;
+		/**
+		 * @brief The number of frames the CPU may record ahead of the GPU, 1 to @ref maxFramesInFlight.
+		 * Two overlap recording and execution, three also absorb spikes at the cost of latency.
+		 */
+		uint32_t framesInFlight = 2;
+		/**
+		 * @brief The number of threads that record commands, each gets its own command pool per frame.
+		 * 0 uses the worker count of the @ref setJobSystem "job system". Other threads share one more pool.
+		 */
+		uint32_t		  recordingThreads = 0;
+		VkClearColorValue clearColor	   = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+		/**
+		 * @brief Where the pipeline cache is loaded from on initialization and saved to on shutdown,
+		 * empty to keep it in memory only
+		 */
+		std::filesystem::path pipelineCachePath = "pipeline_cache.bin";
+		/**
+		 * @brief Recompile shaders when their sources change, see @ref ShaderReloader. Only builds with the
+		 * `ZAPHOD_SHADER_HOT_RELOAD` CMake option, outside Release, watch anything
+		 */
+		bool hotReloadShaders = true;
+		/**
+		 * @brief Directories of application shaders to watch, the engine's own shaders are always watched
+		 */
+		std::vector<std::filesystem::path> shaderDirectories;
+		MemoryAllocator::Config			   memory;
+		/**
+		 * @brief The size of the ring @ref allocateFrameData allocates from, shared by every frame in flight
+		 */
+		VkDeviceSize		frameDataSize = VkDeviceSize(8) << 20;
+		UploadQueue::Config	  upload;
+		BindlessTable::Config bindless;
+	};
+
+	Renderer() = default;
+	~Renderer();
+
+	// Non-copyable, non-movable
+	Renderer(const Renderer&)			 = delete;
+	Renderer& operator=(const Renderer&) = delete;
+	Renderer(Renderer&&)				 = delete;
+	Renderer& operator=(Renderer&&)		 = delete;
+
+	/**
+	 * @brief Set the options for the renderer, ignored once it is initialized
+	 *
+	 * @param config The options
+	 */
+	void		  setConfig(const Config& config);
+	const Config& getConfig() const { return m_config; }
+	/**
+	 * @brief Set the job system @ref record schedules its tasks on, ignored once the renderer is initialized
+	 *
+	 * @param jobSystem The job system, or nullptr to record every task on the calling thread
+	 */
+	void setJobSystem(JobSystem* jobSystem);
+
+	/**
+	 * @brief Create the device, the swapchain for a window and the frames in flight
+	 *
+	 * @param window The first window to render to, the device is chosen to present to it
+	 * @return The Result of creating the Vulkan objects
+	 */
+	Result initialize(Window& window);
+	/**
+	 * @brief Wait for the GPU to finish and destroy every Vulkan object
+	 */
+	void shutdown();
+	bool isInitialized() const { return m_isInitialized; }
+
+	/**
+	 * @brief Render to another window, from the next frame on
+	 *
+	 * @param window The window, must outlive the renderer or its @ref removeWindow call
+	 * @return Result::Code::SUCCESS if the window's swapchain was created\n
+	 * Result::Code::NOT_INITIALIZED if the renderer is not initialized\n
+	 * Result::Code::INVALID_ARGUMENT if the window is rendered to already\n
+	 * Result::Code::UNSUPPORTED if the device cannot present to the window\n
+	 * The Result of creating the swapchain otherwise
+	 */
+	Result addWindow(Window& window);
+	/**
+	 * @brief Stop rendering to a window and destroy its swapchain
+	 *
+	 * @details
+	 * Waits for the device to be idle, as the window's images may still be presented.
+	 *
+	 * @param window The window
+	 * @return Result::Code::SUCCESS if the window was removed\n
+	 * Result::Code::INVALID_ARGUMENT if it is not rendered to\n
+	 * Result::Code::FAILURE if a frame is being recorded
+	 */
+	Result	 removeWindow(Window& window);
+	uint32_t getWindowCount() const { return static_cast<uint32_t>(m_targets.size()); }
+
+	/**
+	 * @brief Begin recording a frame
+	 *
+	 * @details
+	 * Waits until the frame slot is free, acquires a swapchain image and resets the slot's command
+	 * pools. The rendering to the image, cleared to @ref Config::clearColor, begins in @ref endFrame,
+	 * after what was recorded into @ref FrameContext::computeCommandBuffer.
+	 *
+	 * @return The frame to record into, rendering to the first window that has an image, or nullptr
+	 * if there is nothing to render to, e.g. while every window is minimized
+	 */
+	FrameContext* beginFrame();
+	/**
+	 * @brief Render the commands recorded from now on to another window
+	 *
+	 * @details
+	 * Ends the main thread's buffer and begins one for the window, the way @ref record does.
+	 * Tasks already scheduled keep rendering to the window that was selected when they were.
+	 * Selecting a window again later in the frame continues its rendering.
+	 *
+	 * @param window The window
+	 * @return The frame, now for the window, or nullptr if the window has no image this frame,
+	 * e.g. while it is minimized
+	 */
+	const FrameContext* selectWindow(const Window& window);
+	/**
+	 * @brief Finish recording the frame begun by @ref beginFrame, submit and present it
+	 *
+	 * @details
+	 * Waits for the tasks scheduled with @ref record, running some of them on the calling thread.
+	 */
+	void endFrame();
+	/**
+	 * @brief Record commands for the current frame on the job system's workers
+	 *
+	 * @details
+	 * Schedules one job per task and returns without waiting for them. Every task records into its
+	 * own secondary command buffer, allocated from the command pool of the worker running it and
+	 * continuing the frame's rendering. Secondary buffers inherit no state, so every task binds its
+	 * pipeline and sets its viewport and scissor.
+	 *
+	 * The buffers execute in the order they were recorded in: what the main thread recorded into
+	 * @ref FrameContext::commandBuffer before the call, then the tasks in order, then what it records
+	 * afterwards. The call switches FrameContext::commandBuffer to a new buffer for that.
+	 *
+	 * @param taskCount The number of tasks, a few per worker balance the load best
+	 * @param function The callable, invoked as `function(commandBuffer, task)` for every task. It is
+	 * copied or moved once into storage of the frame, which every job refers to, and destroyed in
+	 * @ref endFrame
+	 */
+	template<typename F>
+	void record(uint32_t taskCount, F&& function)
+	{
+		using Callable = std::decay_t<F>;
+		if (!m_isFrameActive || taskCount == 0)
+			return;
+
+		endMainThreadBuffer();
+		const uint32_t	firstSlot = reserveSecondaryBuffers(taskCount);
+		const Callable* callable  = storeRecordCallable<Callable>(std::forward<F>(function));
+		for (uint32_t task = 0; task < taskCount; ++task)
+		{
+			auto job = [this, callable, slot = firstSlot + task, task, format = m_context.format]
+			{
+				auto invoke = [](const void* callable, VkCommandBuffer commandBuffer, uint32_t index)
+				{ (*static_cast<const Callable*>(callable))(commandBuffer, index); };
+				recordTask(slot, task, format, invoke, callable);
+			};
+			if (m_jobSystem)
+				m_jobSystem->schedule(job, &m_recordingJobs);
+			else
+				job();
+		}
+		beginMainThreadBuffer();
+	}
+	/**
+	 * @brief Get the frame being recorded
+	 *
+	 * @return The frame, or nullptr outside @ref beginFrame and @ref endFrame
+	 */
+	const FrameContext* getCurrentFrame() const { return m_isFrameActive ? &m_context : nullptr; }
+
+	/**
+	 * @brief Get a recording thread's command pool for the frame being recorded
+	 *
+	 * @details
+	 * The pool is reset when its frame slot is reused, command buffers allocated from it only need
+	 * to be allocated once.
+	 *
+	 * @param thread The index of the recording thread, below @ref Config::recordingThreads, or
+	 * Config::recordingThreads for the pool the other threads share
+	 * @return The command pool
+	 */
+	VkCommandPool getCommandPool(uint32_t thread) const;
+
+	/**
+	 * @brief Wait until the GPU has finished every submitted frame
+	 */
+	void waitIdle() const;
+	/**
+	 * @brief Destroy objects once the GPU is done with them
+	 *
+	 * @details
+	 * Runs the function at the start of a later frame, once every frame submitted so far, including
+	 * the one being recorded, has finished executing. Replacing a pipeline, e.g. after a
+	 * @ref ShaderReloader "shader reload", thus never waits for the GPU.
+	 *
+	 * @param destroy The function destroying the objects, run on the main thread
+	 */
+	void destroyLater(std::function<void()> destroy);
+	/**
+	 * @brief Allocate data the GPU reads during the current frame, e.g. uniforms or dynamic vertices
+	 *
+	 * @details
+	 * The data comes from a host visible ring buffer usable as a uniform, storage, vertex, index,
+	 * indirect or transfer source buffer, and is released once the GPU is done with the frame. Can
+	 * be called from any thread.
+	 *
+	 * @param size The size in bytes
+	 * @param alignment The alignment of the offset, e.g. minUniformBufferOffsetAlignment for uniforms
+	 * @return The range, invalid if the ring is full
+	 */
+	RingBuffer::Allocation allocateFrameData(VkDeviceSize size, VkDeviceSize alignment = 256);
+	/**
+	 * @brief Make the current frame wait for an upload before it uses the resource
+	 *
+	 * @details
+	 * The frame's submission waits on the upload queue's timeline only if the upload has not
+	 * finished yet, and acquires the resources of every batch up to it from the transfer family.
+	 * Needed once, in the first frame using the resource.
+	 *
+	 * @param ticket The ticket returned by the @ref UploadQueue
+	 */
+	void useUpload(UploadQueue::Ticket ticket);
+
+	Device&		  getDevice() { return m_device; }
+	const Device& getDevice() const { return m_device; }
+	/**
+	 * @brief Get the swapchain presenting to a window
+	 *
+	 * @param window The window
+	 * @return The swapchain, or nullptr if the window is not rendered to
+	 */
+	const Swapchain* getSwapchain(const Window& window) const;
+	uint32_t		 getFramesInFlight() const { return static_cast<uint32_t>(m_frames.size()); }
+	/**
+	 * @brief Get the shader modules, shared by every pipeline created with the renderer's device
+	 *
+	 * @return The shader library
+	 */
+	ShaderLibrary& getShaderLibrary() { return m_shaderLibrary; }
+	/**
+	 * @brief Get the shader reloader, which the renderer updates at the start of every frame
+	 *
+	 * @return The reloader, running if @ref Config::hotReloadShaders is enabled
+	 */
+	ShaderReloader& getShaderReloader() { return m_shaderReloader; }
+	/**
+	 * @brief Get the allocator buffers and images should get their memory from
+	 *
+	 * @return The allocator
+	 */
+	MemoryAllocator& getMemoryAllocator() { return m_memoryAllocator; }
+	/**
+	 * @brief Get the queue resources are uploaded with, which the renderer flushes once per frame
+	 *
+	 * @return The upload queue
+	 */
+	UploadQueue& getUploadQueue() { return m_uploadQueue; }
+	/**
+	 * @brief Get the table of every texture and storage buffer shaders index
+	 *
+	 * @return The table, its pipeline layout is the one to create pipelines with
+	 */
+	BindlessTable&		 getBindlessTable() { return m_bindlessTable; }
+	const BindlessTable& getBindlessTable() const { return m_bindlessTable; }
+	/**
+	 * @brief Get the profiler timing the GPU work of every frame
+	 *
+	 * @return The profiler, uninitialized if the device has no timestamps on the graphics queue
+	 */
+	GpuProfiler& getGpuProfiler() { return m_gpuProfiler; }
+	/**
+	 * @brief Get the pipeline cache to create every pipeline with
+	 *
+	 * @return The cache, persisted to @ref Config::pipelineCachePath
+	 */
+	VkPipelineCache getPipelineCache() const { return m_pipelineCache.getCache(); }
+	/**
+	 * @brief Get the timeline semaphore signaled with the @ref FrameContext::frameNumber "number" of every frame
+	 *
+	 * @return The semaphore
+	 */
+	VkSemaphore getFrameTimeline() const { return m_frameTimeline; }
+
+  private:
+	// Padded to a cache line, every recording thread writes to its own
+	struct alignas(64) CommandPool
+	{
+		VkCommandPool				 pool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> secondaryBuffers;	  // Allocated once, reused after the pool is reset
+		size_t						 usedBuffers = 0;
+	};
+
+	struct Frame
+	{
+		std::vector<CommandPool> commandPools;	  // One per recording thread, then the shared one
+		VkCommandBuffer			 commandBuffer		  = VK_NULL_HANDLE;
+		VkCommandBuffer			 acquireCommandBuffer = VK_NULL_HANDLE;	   // Takes over uploaded resources, see useUpload
+		uint64_t				 timelineValue		  = 0;	  // Signaled once the GPU is done with the frame
+	};
+
+	// A window rendered to. Its images are acquired with one semaphore per frame slot.
+	struct WindowTarget
+	{
+		Window*		window	   = nullptr;
+		Swapchain	swapchain;
+		VkSemaphore	imageAcquired[maxFramesInFlight] {};
+		VkExtent2D	extent	   = { 0, 0 };	  // The framebuffer size the swapchain was last created for
+		uint32_t	imageIndex = 0;
+		bool		isRendered = false;	   // Has an image in the current frame
+		bool		isOutdated = false;
+	};
+
+	// Secondary buffers rendering to one window, up to the next segment's first buffer
+	struct Segment
+	{
+		uint32_t target;
+		uint32_t firstBuffer;
+	};
+
+	struct PendingDestruction
+	{
+		uint64_t			  frameNumber;	  // The last frame that may use the objects
+		std::function<void()> destroy;
+	};
+
+	using RecordFunction = void (*)(const void* callable, VkCommandBuffer commandBuffer, uint32_t task);
+
+	// A callable of @ref record that is not trivially destructible, destroyed once its jobs are done
+	struct RecordCallable
+	{
+		void* callable;
+		void (*destroy)(void* callable);
+	};
+
+	Result createFrames();
+	void   destroyFrames();
+	Result createTarget(Window& window, VkSurfaceKHR surface);
+	void   destroyTarget(WindowTarget& target);
+	bool   recreateSwapchain(WindowTarget& target, VkExtent2D extent);
+	void   selectTarget(uint32_t target);
+	void   renderTarget(VkCommandBuffer commandBuffer, uint32_t target);
+	void   runPendingDestructions(uint64_t completedFrame);
+
+	uint32_t		reserveSecondaryBuffers(uint32_t count);
+	void			recordTask(uint32_t slot, uint32_t task, VkFormat format, RecordFunction function, const void* callable);
+	VkCommandBuffer beginSecondaryBuffer(CommandPool& pool, VkFormat format);
+	void			beginMainThreadBuffer();
+	void			endMainThreadBuffer();
+	void			releaseRecordCallables();
+
+	template<typename C, typename F>
+	const C* storeRecordCallable(F&& function)
+	{
+		C* callable = new (m_recordCallableArena.allocate(sizeof(C), alignof(C))) C(std::forward<F>(function));
+		if constexpr (!std::is_trivially_destructible_v<C>)
+			m_recordCallables.push_back({ callable, [](void* object) { static_cast<C*>(object)->~C(); } });
+		return callable;
+	}
+
+	Config			   m_config;
+	bool			   m_isInitialized		 = false;
+	JobSystem*		   m_jobSystem			 = nullptr;
+	Device			   m_device;
+	MemoryAllocator	   m_memoryAllocator;
+	RingBuffer		   m_frameData;
+	UploadQueue		   m_uploadQueue;
+	BindlessTable	   m_bindlessTable;
+	GpuProfiler		   m_gpuProfiler;
+	ShaderLibrary	   m_shaderLibrary;
+	ShaderReloader	   m_shaderReloader;
+	PipelineCache	   m_pipelineCache;
+	std::vector<Frame> m_frames;
+	VkSemaphore		   m_frameTimeline		 = VK_NULL_HANDLE;
+	uint64_t		   m_frameNumber		 = 0;
+	uint64_t		   m_uploadWaitValue	 = 0;	 // The last upload ticket the current frame uses
+	FrameContext	   m_context;
+	bool			   m_isFrameActive		 = false;
+
+	std::vector<std::unique_ptr<WindowTarget>> m_targets;
+	uint32_t								   m_currentTarget = 0;	   // The one m_context renders to
+	std::vector<Segment>					   m_segments;			   // In recording order
+	// Reused by every frame's submission and presentation, one entry per window rendered to
+	std::vector<VkSemaphoreSubmitInfo> m_submitWaits;
+	std::vector<VkSemaphoreSubmitInfo> m_submitSignals;
+	std::vector<VkSwapchainKHR>		   m_presentSwapchains;
+	std::vector<uint32_t>			   m_presentImages;
+	std::vector<VkSemaphore>		   m_presentWaits;
+	std::vector<VkResult>			   m_presentResults;
+
+	// The current frame's secondary buffers in execution order, filled in by the recording jobs
+	std::vector<VkCommandBuffer> m_secondaryBuffers;
+	uint32_t					 m_mainThreadSlot = 0;	  // Where FrameContext::commandBuffer goes
+	JobCounter					 m_recordingJobs;
+	LinearArena					 m_recordCallableArena;	   // The callables of the current frame's record calls
+	std::vector<RecordCallable>	 m_recordCallables;
+	std::mutex					 m_sharedPoolMutex;	   // Guards the pool of the threads without their own
+
+	std::deque<PendingDestruction> m_pendingDestructions;	 // In frame order
+};
+}	 // namespace render
+}	 // namespace zaphod
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "render/memory_allocator.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace zaphod::render
+{
+/**
+ * @brief A persistently mapped buffer handed out front to back, for data the GPU reads once.
+ *
+ * @details
+ * Allocating bumps a head offset, and nothing is freed individually: everything allocated
+ * between two @ref close calls is tagged with a timeline value, e.g. the number of the frame that
+ * uses it, and @ref retire releases it once the GPU has signaled that value. Allocations wrap
+ * around to the start of the buffer, skipping what is left at the end, and fail while the oldest
+ * data is still in use, so the buffer needs to hold the data of every frame in flight.
+ *
+ * Used for per-frame uniform, vertex and staging data. Can be allocated from on any thread.
+ *
+ * @code
+ * RingBuffer::Allocation uniforms = ring.allocate(sizeof(Uniforms), minUniformBufferOffsetAlignment);
+ * std::memcpy(uniforms.data, &frameUniforms, sizeof(Uniforms));
+ * ring.close(frameNumber);      // At the end of the frame
+ * ring.retire(completedFrame);  // Once the GPU is done with it
+ * @endcode
+ */
+class RingBuffer
+{
+  public:
+	/**
+	 * @brief A range of the buffer, valid until the value it was closed with is retired
+	 */
+	struct Allocation
+	{
+		VkBuffer	 buffer	  = VK_NULL_HANDLE;
+		VkDeviceSize offset	  = 0;
+		VkDeviceSize size	  = 0;
+		void*		 data	  = nullptr;
+		uint64_t	 position = 0;	  // Where the range starts in the ring's ever growing offsets, see @ref close
+
+		bool isValid() const { return data != nullptr; }
+	};
+
+	RingBuffer() = default;
+	~RingBuffer();
+
+	// Non-copyable, non-movable
+	RingBuffer(const RingBuffer&)			 = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+	RingBuffer(RingBuffer&&)				 = delete;
+	RingBuffer& operator=(RingBuffer&&)		 = delete;
+
+	/**
+	 * @brief Create the buffer
+	 *
+	 * @param allocator The allocator its memory comes from, must outlive the ring or its @ref destroy call
+	 * @param size The size of the buffer in bytes
+	 * @param bufferUsage How the buffer is used, e.g. VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+	 * @param memoryUsage UPLOAD for staging data, DYNAMIC for data the GPU reads directly
+	 * @return The Result of creating the buffer
+	 */
+	Result initialize(MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags bufferUsage,
+					  MemoryUsage memoryUsage = MemoryUsage::DYNAMIC);
+	void   destroy();
+
+	/**
+	 * @brief Allocate a range of the buffer
+	 *
+	 * @param size The size of the range in bytes
+	 * @param alignment The alignment of its offset, a power of two
+	 * @return The range, invalid if the buffer is full
+	 */
+	Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+	/**
+	 * @brief Tag everything allocated since the last call, it stays in use until @ref retire reaches the value
+	 *
+	 * @param value The timeline value, must not be less than the one of the last call
+	 */
+	void close(uint64_t value);
+	/**
+	 * @brief Tag everything allocated before a position, leaving what comes after it for a later call
+	 *
+	 * @details
+	 * For allocations that are still being written and will only be used by a later value: closing
+	 * at the position of the oldest of them keeps every range from it onwards in use.
+	 *
+	 * @param value The timeline value, must not be less than the one of the last call
+	 * @param end The @ref Allocation::position of the first allocation to leave open
+	 */
+	void close(uint64_t value, uint64_t end);
+	/**
+	 * @brief Release what was closed with a value up to a completed one
+	 *
+	 * @param completedValue The value the timeline has reached
+	 */
+	void retire(uint64_t completedValue);
+
+	VkBuffer	 getBuffer() const { return m_buffer.buffer; }
+	VkDeviceSize getSize() const { return m_size; }
+	VkDeviceSize getUsedSize() const;
+
+  private:
+	struct Region
+	{
+		uint64_t value;
+		uint64_t end;	 // The head when it was closed
+	};
+
+	MemoryAllocator* m_allocator = nullptr;
+	Buffer			 m_buffer;
+	VkDeviceSize	 m_size = 0;
+
+	mutable std::mutex m_mutex;				// Guards everything below
+	uint64_t		   m_head		= 0;	// Offsets grow forever, the buffer offset is the remainder by m_size
+	uint64_t		   m_tail		= 0;	// The start of the oldest data in use
+	uint64_t		   m_closedHead	= 0;	// Where the last closed region ends
+	std::deque<Region> m_regions;
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief Creates every shader module once, keyed by the hash of its SPIR-V.
+ *
+ * @details
+ * Pipelines that share a shader, and pipelines recreated later, get the same module instead of
+ * the driver parsing the same SPIR-V again. Lookups take a shared lock, so pipelines can be
+ * created from several threads.
+ *
+ * Modules live until @ref clear or @ref destroy, the caller must not destroy them.
+ */
+class ShaderLibrary
+{
+  public:
+	ShaderLibrary() = default;
+	~ShaderLibrary();
+
+	// Non-copyable, non-movable
+	ShaderLibrary(const ShaderLibrary&)			   = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+	ShaderLibrary(ShaderLibrary&&)				   = delete;
+	ShaderLibrary& operator=(ShaderLibrary&&)	   = delete;
+
+	/**
+	 * @brief Set the device modules are created on
+	 *
+	 * @param device The device, must outlive the library or its @ref destroy call
+	 */
+	void initialize(const Device& device);
+	/**
+	 * @brief Destroy every module and forget the device
+	 */
+	void destroy();
+	/**
+	 * @brief Destroy every module, the device must not be using any of them
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the module for some SPIR-V, creating it the first time
+	 *
+	 * @param code The SPIR-V words; code that is not 4-byte aligned is copied before creation
+	 * @param size The size of the code in bytes, a multiple of 4
+	 * @return The module, or VK_NULL_HANDLE if it could not be created
+	 */
+	VkShaderModule getModule(const void* code, size_t size);
+	/**
+	 * @brief Get the module for some SPIR-V, if it was created before
+	 *
+	 * @param hash The hash of the code, see @ref hashCode
+	 * @return The module, or VK_NULL_HANDLE if there is none
+	 */
+	VkShaderModule findModule(uint64_t hash) const;
+
+	/**
+	 * @brief Compute the key a module is stored under
+	 *
+	 * @param code The SPIR-V
+	 * @param size The size of the code in bytes
+	 * @return The @ref hashBytes "FNV-1a hash" of the code
+	 */
+	static uint64_t hashCode(const void* code, size_t size);
+
+	size_t getModuleCount() const;
+
+  private:
+	const Device*								 m_device = nullptr;
+	mutable std::shared_mutex					 m_mutex;
+	std::unordered_map<uint64_t, VkShaderModule> m_modules;
+};
+}	 // namespace zaphod::render
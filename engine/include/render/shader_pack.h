@@ -0,0 +1,100 @@
+#pragma once
+
+#include "util/result.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace zaphod::render
+{
+/**
+ * @brief The layout of shader pack files, shared with the `zaphod-spirv-tool` that writes them
+ *
+ * @details
+ * A pack starts with a @ref Header, followed by one @ref Entry per shader, the names, and the
+ * SPIR-V of every shader starting on a 4-byte boundary. Offsets count from the start of the file.
+ */
+namespace shader_pack
+{
+inline constexpr char	  magic[4] = { 'Z', 'S', 'P', 'K' };
+inline constexpr uint32_t version  = 1;
+
+struct Header
+{
+	char	 magic[4];
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+};
+
+struct Entry
+{
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	uint32_t codeOffset;
+	uint32_t codeSize;	  // In bytes, a multiple of 4
+	uint64_t codeHash;	  // hashBytes of the code, the key ShaderLibrary stores it under
+};
+static_assert(sizeof(Header) == 16 && sizeof(Entry) == 24);
+}	 // namespace shader_pack
+
+/**
+ * @brief SPIR-V for many shaders, loaded from one pack file at runtime.
+ *
+ * @details
+ * With `ZAPHOD_SHADER_PACK` enabled the build bundles every shader into `shaders.zpk` next to the
+ * executables instead of embedding them in generated headers, so editing a shader only rebuilds
+ * the pack and no C++. Shaders are found by their source file name, e.g. "simple_shader.vert".
+ *
+ * @code
+ * ShaderPack pack;
+ * if (pack.load("shaders.zpk").isSuccess())
+ * {
+ *     std::span<const uint32_t> code = pack.find("simple_shader.vert");
+ *     VkShaderModule module = renderer.getShaderLibrary().getModule(code.data(), code.size_bytes());
+ * }
+ * @endcode
+ */
+class ShaderPack
+{
+  public:
+	/**
+	 * @brief Load a pack file, replacing the current contents
+	 *
+	 * @param path The pack file
+	 * @return Result::Code::SUCCESS if the pack was loaded\n
+	 * Result::Code::IO_ERROR if the file could not be read\n
+	 * Result::Code::INVALID_ARGUMENT if it is not a valid shader pack
+	 */
+	Result load(const std::filesystem::path& path);
+
+	/**
+	 * @brief Find a shader's SPIR-V
+	 *
+	 * @param name The file name of the shader's source
+	 * @return The code, empty if the pack has no such shader
+	 */
+	std::span<const uint32_t> find(std::string_view name) const;
+
+	size_t getShaderCount() const { return m_shaders.size(); }
+
+  private:
+	struct StringHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view text) const { return std::hash<std::string_view>()(text); }
+	};
+
+	using ShaderMap = std::unordered_map<std::string, std::span<const uint32_t>, StringHash, std::equal_to<>>;
+
+	std::vector<uint32_t> m_data;	 // The whole file, word aligned
+	ShaderMap			  m_shaders;
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace zaphod
+{
+namespace logging
+{
+class SimpleLogger;
+}
+
+namespace render
+{
+class ShaderLibrary;
+
+/**
+ * @brief Recompiles shaders when their sources change, while the application runs.
+ *
+ * @details
+ * A background thread polls the watched directories for modified GLSL files and runs glslc on
+ * every shader stage that changed, or that includes a file that changed, tracked through the
+ * depfiles glslc writes. Compiling never blocks a frame: the new SPIR-V waits until @ref update,
+ * which the renderer calls at the start of every frame, turns it into a module with the
+ * @ref ShaderLibrary and hands it to the shader's subscribers.
+ *
+ * Subscribers rebuild their pipelines with the new module and pass the old pipelines to
+ * @ref Renderer::destroyLater, which keeps them alive until the GPU is done with the frames that
+ * use them. Modules stay in the library, so undoing an edit gets the previous module back.
+ * A shader that fails to compile keeps its current version, the compiler's output is logged.
+ *
+ * @code
+ * renderer.getShaderReloader().subscribe("shaders/simple_shader.vert", [&](VkShaderModule module)
+ * {
+ *     renderer.destroyLater([device, old = pipeline] { vkDestroyPipeline(device, old, nullptr); });
+ *     pipeline = createPipeline(module);
+ * });
+ * @endcode
+ */
+class ShaderReloader
+{
+  public:
+	/**
+	 * @brief Invoked on the main thread with the module for a shader's new code
+	 */
+	using ReloadCallback = std::function<void(VkShaderModule module)>;
+
+	struct Config
+	{
+		std::vector<std::filesystem::path> directories;	   // Watched recursively, missing ones are skipped
+		std::filesystem::path			   compiler = "glslc";
+		std::chrono::milliseconds		   pollInterval { 250 };
+	};
+
+	ShaderReloader();
+	~ShaderReloader();
+
+	// Non-copyable, non-movable
+	ShaderReloader(const ShaderReloader&)			 = delete;
+	ShaderReloader& operator=(const ShaderReloader&) = delete;
+	ShaderReloader(ShaderReloader&&)				 = delete;
+	ShaderReloader& operator=(ShaderReloader&&)		 = delete;
+
+	/**
+	 * @brief Start watching for changes
+	 *
+	 * @param library The library modules for new code are created with
+	 * @param config What to watch and how to compile it
+	 * @return Result::Code::SUCCESS if the watcher thread was started\n
+	 * Result::Code::ALREADY_INITIALIZED if it is already running\n
+	 * Result::Code::INVALID_ARGUMENT if none of the directories exist
+	 */
+	Result start(ShaderLibrary& library, const Config& config);
+	/**
+	 * @brief Stop watching and drop every change not passed to @ref update yet
+	 */
+	void stop();
+	bool isRunning() const { return m_thread.joinable(); }
+
+	/**
+	 * @brief Be notified whenever a shader is recompiled, call from the main thread
+	 *
+	 * @details
+	 * Shaders are told apart by their normalized path, so stages with the same file name in
+	 * different directories each notify only their own subscribers.
+	 *
+	 * @param source The path of the shader's source, e.g. "shaders/simple_shader.vert"
+	 * @param callback The callback
+	 * @return An ID for @ref unsubscribe
+	 */
+	uint32_t subscribe(const std::filesystem::path& source, ReloadCallback callback);
+	void	 unsubscribe(uint32_t id);
+
+	/**
+	 * @brief Create modules for the shaders compiled since the last call and notify their subscribers
+	 *
+	 * @details
+	 * Call from the main thread while no frame is being recorded.
+	 */
+	void update();
+
+	uint64_t getReloadCount() const { return m_reloadCount; }
+
+  private:
+	// A compilation finished on the watcher thread, waiting for update
+	struct Compilation
+	{
+		std::string			  source;	 // The normalized path subscriptions are matched on
+		std::string			  name;		 // The file name, for messages
+		std::vector<uint32_t> code;		 // Empty if it failed
+		std::string			  output;	 // What the compiler printed
+	};
+
+	struct Subscription
+	{
+		uint32_t	   id;
+		std::string	   source;
+		ReloadCallback callback;
+	};
+
+	void run();
+	void scan(bool isFirstScan);
+	bool runCompiler(const std::string& arguments, std::string& output) const;
+	void compile(const std::string& source);
+	void readDependencies(const std::string& source, const std::filesystem::path& depfile);
+
+	ShaderLibrary*						   m_library = nullptr;
+	Config								   m_config;
+	std::filesystem::path				   m_outputDirectory;
+	std::unique_ptr<logging::SimpleLogger> m_logger;
+	std::vector<Subscription>			   m_subscriptions;
+	uint32_t							   m_nextSubscriptionID = 0;
+	uint64_t							   m_reloadCount		= 0;
+	std::thread							   m_thread;	  // Polls the directories and runs the compiler
+
+	// Only used by the watcher thread
+	std::unordered_map<std::string, std::filesystem::file_time_type> m_writeTimes;
+	std::unordered_map<std::string, std::unordered_set<std::string>> m_dependents;	  // File to the stages including it
+
+	std::mutex				 m_mutex;	// Guards everything below
+	std::condition_variable	 m_stopCondition;
+	bool					 m_isStopping = false;
+	std::vector<Compilation> m_compilations;
+};
+}	 // namespace render
+}	 // namespace zaphod
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "render/vulkan_common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief How presented images are synchronized with the display
+ *
+ * @details
+ * - VSYNC: FIFO, every image is shown for at least one refresh. Always available.
+ * - MAILBOX: The newest image replaces a queued one, low latency without tearing.
+ *   Falls back to IMMEDIATE, then VSYNC.
+ * - IMMEDIATE: Images are shown right away and may tear, the lowest latency.
+ *   Falls back to MAILBOX, then VSYNC.
+ */
+enum class PresentMode
+{
+	VSYNC,
+	MAILBOX,
+	IMMEDIATE
+};
+
+/**
+ * @brief A window surface and the swapchain presenting to it.
+ *
+ * @details
+ * Besides the images and their views, the swapchain owns one "ready to present" semaphore per
+ * image. Presentation can only wait on binary semaphores and an image's previous presentation is
+ * the only thing known to be done with its semaphore, so they belong to images rather than to
+ * frames in flight.
+ */
+class Swapchain
+{
+  public:
+	/**
+	 * @brief What a recreated swapchain leaves behind, destroyed once no frame in flight uses it
+	 */
+	struct Retired
+	{
+		VkSwapchainKHR			 swapchain = VK_NULL_HANDLE;
+		std::vector<VkImageView> imageViews;
+		std::vector<VkSemaphore> readySemaphores;
+
+		/**
+		 * @brief Destroy the old swapchain, its views and semaphores
+		 *
+		 * @param device The device the swapchain was created with
+		 */
+		void destroy(VkDevice device) const;
+	};
+
+	Swapchain() = default;
+	~Swapchain();
+
+	// Non-copyable, non-movable
+	Swapchain(const Swapchain&)			   = delete;
+	Swapchain& operator=(const Swapchain&) = delete;
+	Swapchain(Swapchain&&)				   = delete;
+	Swapchain& operator=(Swapchain&&)	   = delete;
+
+	/**
+	 * @brief Create the swapchain
+	 *
+	 * @param device The device to create it with
+	 * @param surface The surface to present to, the swapchain takes ownership of it
+	 * @param extent The framebuffer size of the window, used if the surface does not dictate one
+	 * @param presentMode The preferred present mode
+	 * @return The Result of creating the swapchain
+	 */
+	Result initialize(const Device& device, VkSurfaceKHR surface, VkExtent2D extent, PresentMode presentMode);
+	/**
+	 * @brief Recreate the swapchain, e.g. after the window was resized or it went out of date
+	 *
+	 * @details
+	 * The new swapchain is created with the current one as its oldSwapchain, so the presentation
+	 * engine hands the images over without the device going idle. The current swapchain is retired
+	 * by that, even if creating the new one fails, and moves to `retired` with its views and
+	 * semaphores, for the caller to destroy once the frames that use them have finished.
+	 *
+	 * @param extent The new framebuffer size of the window
+	 * @param retired Receives the old swapchain, empty if there was none
+	 * @return The Result of creating the new swapchain
+	 */
+	Result recreate(VkExtent2D extent, Retired& retired);
+	/**
+	 * @brief Destroy the swapchain and the surface
+	 */
+	void destroy();
+
+	/**
+	 * @brief Acquire the next image to render to
+	 *
+	 * @param signal The semaphore signaled once the image can be written
+	 * @param imageIndex Receives the index of the image
+	 * @return The result of vkAcquireNextImageKHR, VK_ERROR_OUT_OF_DATE_KHR or VK_SUBOPTIMAL_KHR
+	 * mean the swapchain should be recreated
+	 */
+	VkResult acquireNextImage(VkSemaphore signal, uint32_t& imageIndex);
+	/**
+	 * @brief Present an image, waiting for its @ref getReadySemaphore "ready semaphore"
+	 *
+	 * @param queue The queue to present on
+	 * @param imageIndex The index of the image
+	 * @return The result of vkQueuePresentKHR
+	 */
+	VkResult present(VkQueue queue, uint32_t imageIndex);
+
+	VkSwapchainKHR getSwapchain() const { return m_swapchain; }
+	VkSurfaceKHR   getSurface() const { return m_surface; }
+	VkFormat	   getFormat() const { return m_format; }
+	VkExtent2D	   getExtent() const { return m_extent; }
+	PresentMode	   getPresentMode() const { return m_presentMode; }
+
+	uint32_t	getImageCount() const { return static_cast<uint32_t>(m_images.size()); }
+	VkImage		getImage(uint32_t index) const { return m_images[index]; }
+	VkImageView getImageView(uint32_t index) const { return m_imageViews[index]; }
+	/**
+	 * @brief Get the semaphore to signal when an image is ready to be presented
+	 *
+	 * @param index The index of the image
+	 * @return The image's semaphore
+	 */
+	VkSemaphore getReadySemaphore(uint32_t index) const { return m_readySemaphores[index]; }
+
+  private:
+	Result create(VkExtent2D extent, Retired& retired);
+	void   destroyImages();
+
+	VkPresentModeKHR choosePresentMode() const;
+
+	const Device*			 m_device	   = nullptr;
+	VkSurfaceKHR			 m_surface	   = VK_NULL_HANDLE;
+	VkSwapchainKHR			 m_swapchain   = VK_NULL_HANDLE;
+	VkFormat				 m_format	   = VK_FORMAT_UNDEFINED;
+	VkColorSpaceKHR			 m_colorSpace  = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+	VkExtent2D				 m_extent	   = { 0, 0 };
+	PresentMode				 m_presentMode = PresentMode::VSYNC;
+	std::vector<VkImage>	 m_images;
+	std::vector<VkImageView> m_imageViews;
+	std::vector<VkSemaphore> m_readySemaphores;
+};
+}	 // namespace zaphod::render
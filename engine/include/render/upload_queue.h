@@ -0,0 +1,264 @@
+#pragma once
+
+#include "render/ring_buffer.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace zaphod::render
+{
+class Device;
+
+/**
+ * @brief Copies data into device local buffers and images through a staging ring, on the transfer queue.
+ *
+ * @details
+ * Uploading copies the data into a persistently mapped staging @ref RingBuffer on the calling
+ * thread, so it can be started from job system workers while assets load, and queues a copy. The
+ * overloads taking a @ref Writer let the caller produce the data in the ring instead, as
+ * @ref asset::AssetLoader decompresses assets.
+ * @ref flush records every queued copy into one command buffer, a batch, and submits it to the
+ * device's transfer queue, a family of its own on GPUs with DMA engines, so the copies run beside
+ * the frames instead of in front of them.
+ *
+ * Every batch signals its own value of a timeline semaphore, which the upload returns as a
+ * @ref Ticket: the graphics queue waits on the tickets of the resources a frame actually uses,
+ * see @ref Renderer::useUpload, and never on uploads still streaming in.
+ *
+ * With separate families, resources are exclusively owned by one of them at a time, so every copy
+ * is followed by a release of the resource to the graphics family, which the frame using it
+ * acquires with @ref recordAcquireBarriers. Uploads are meant to fill new resources: the contents
+ * of a resource the graphics queue used before are not preserved around the copied range.
+ *
+ * @code
+ * UploadQueue::Ticket ticket;
+ * uploadQueue.uploadBuffer(vertexBuffer, 0, vertices.data(), verticesSize, ticket);  // On a worker
+ * renderer.useUpload(ticket);  // In the first frame drawing with it
+ * @endcode
+ */
+class UploadQueue
+{
+  public:
+	/**
+	 * @brief The timeline value of the batch an upload is in, reached once its copy has finished
+	 */
+	using Ticket = uint64_t;
+	/**
+	 * @brief Writes the data of an upload into the staging memory it is given, false if it could not
+	 *
+	 * @details
+	 * The memory is write-combined on most systems, so it should be written front to back and never
+	 * read back.
+	 */
+	using Writer = std::function<bool(void* staging)>;
+
+	struct Config
+	{
+		/**
+		 * @brief The size of the staging ring, which holds the data of every batch the GPU has not finished
+		 */
+		VkDeviceSize stagingSize = VkDeviceSize(64) << 20;
+	};
+
+	UploadQueue() = default;
+	~UploadQueue();
+
+	// Non-copyable, non-movable
+	UploadQueue(const UploadQueue&)			   = delete;
+	UploadQueue& operator=(const UploadQueue&) = delete;
+	UploadQueue(UploadQueue&&)				   = delete;
+	UploadQueue& operator=(UploadQueue&&)	   = delete;
+
+	/**
+	 * @brief Create the staging ring and the timeline semaphore
+	 *
+	 * @param device The device, must outlive the queue or its @ref destroy call
+	 * @param allocator The allocator the staging memory comes from, the same lifetime requirement applies
+	 * @param config The options
+	 * @return The Result of creating the Vulkan objects
+	 */
+	Result initialize(const Device& device, MemoryAllocator& allocator, const Config& config);
+	/**
+	 * @brief Wait for every submitted batch and destroy the Vulkan objects, dropping the queued copies
+	 */
+	void destroy();
+
+	/**
+	 * @brief Queue a copy into a buffer, can be called from any thread
+	 *
+	 * @param buffer The buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and exclusive sharing
+	 * @param offset Where the data goes in the buffer
+	 * @param data The data, copied before the call returns
+	 * @param size The size of the data in bytes
+	 * @param ticket Receives the ticket of the upload
+	 * @return Result::Code::SUCCESS if the copy was queued\n
+	 * Result::Code::INVALID_ARGUMENT if the data is larger than the staging ring\n
+	 * Result::Code::OUT_OF_MEMORY if the staging ring is full, try again after a later @ref flush
+	 */
+	Result uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size, Ticket& ticket);
+	/**
+	 * @brief Queue a copy into a subresource of an image, can be called from any thread
+	 *
+	 * @details
+	 * The previous contents of the copied subresources are discarded, the region should cover
+	 * them entirely.
+	 *
+	 * @param image The image, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT and exclusive sharing
+	 * @param region The region to copy, its bufferOffset is ignored
+	 * @param finalLayout The layout the image is in once the copy has finished, e.g.
+	 * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	 * @param data The texels, laid out as region describes them
+	 * @param size The size of the texels in bytes
+	 * @param ticket Receives the ticket of the upload
+	 * @return The same codes as @ref uploadBuffer
+	 */
+	Result uploadImage(VkImage image, const VkBufferImageCopy& region, VkImageLayout finalLayout, const void* data,
+					   VkDeviceSize size, Ticket& ticket);
+	/**
+	 * @brief Queue a copy into a buffer of data written straight into the staging ring, can be called from any thread
+	 *
+	 * @details
+	 * Saves a copy for data that is produced rather than already in memory, e.g. decompressed
+	 * assets. The writer runs on the calling thread before the call returns, without holding any
+	 * lock, so a slow writer never holds up @ref flush: the copy joins whichever batch is being
+	 * filled once it is done. If it fails, nothing is copied, and its staging memory stays in use
+	 * until the next batch has finished.
+	 *
+	 * @param buffer The buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and exclusive sharing
+	 * @param offset Where the data goes in the buffer
+	 * @param size The size of the data in bytes
+	 * @param writer Writes the data
+	 * @param ticket Receives the ticket of the upload
+	 * @return The same codes as the other overload, and Result::Code::FAILURE if the writer failed
+	 */
+	Result uploadBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const Writer& writer, Ticket& ticket);
+	/**
+	 * @brief Queue copies into subresources of an image of data written straight into the staging ring
+	 *
+	 * @details
+	 * As the buffer overload, e.g. for every mip level of a texture at once. The previous contents
+	 * of the copied subresources are discarded, each region should cover one entirely.
+	 *
+	 * @param image The image, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT and exclusive sharing
+	 * @param regions The regions to copy, one per subresource, their bufferOffset counts from the start of the data
+	 * @param finalLayout The layout the image is in once the copies have finished
+	 * @param size The size of the data in bytes
+	 * @param writer Writes the data
+	 * @param ticket Receives the ticket of the upload
+	 * @return The same codes as the buffer overload
+	 */
+	Result uploadImage(VkImage image, std::span<const VkBufferImageCopy> regions, VkImageLayout finalLayout, VkDeviceSize size,
+					   const Writer& writer, Ticket& ticket);
+
+	/**
+	 * @brief Submit the queued copies as one batch, called by the renderer once per frame
+	 *
+	 * @details
+	 * Uploads still writing to the staging ring are left to a later batch rather than waited for.
+	 * Must be called on the thread that submits to the graphics queue, the transfer queue may be the
+	 * same queue.
+	 *
+	 * @return The Result of submitting the batch, Result::Code::SUCCESS if there was nothing to submit
+	 */
+	Result flush();
+	/**
+	 * @brief Record the acquisition of the resources released by the batches up to a ticket
+	 *
+	 * @details
+	 * Only records anything if the transfer family differs from the graphics family. The command
+	 * buffer must run on the graphics queue after a wait on the ticket, and before the resources
+	 * are used. Every batch is acquired once, by the first call reaching its ticket. Must be called
+	 * on the thread calling @ref flush.
+	 *
+	 * @param commandBuffer A command buffer of the graphics family, outside of rendering
+	 * @param ticket The last ticket to acquire the resources of
+	 * @return True if barriers were recorded
+	 */
+	bool recordAcquireBarriers(VkCommandBuffer commandBuffer, Ticket ticket);
+	/**
+	 * @brief Check if @ref recordAcquireBarriers would record anything
+	 *
+	 * @param ticket The last ticket to acquire the resources of
+	 * @return True if a batch up to the ticket has resources to acquire
+	 */
+	bool hasPendingAcquires(Ticket ticket) const { return !m_acquires.empty() && m_acquires.front().value <= ticket; }
+
+	/**
+	 * @brief Check if an upload has finished copying
+	 *
+	 * @param ticket The ticket of the upload
+	 * @return True if the copy has finished
+	 */
+	bool isComplete(Ticket ticket) const { return ticket <= getCompletedValue(); }
+	/**
+	 * @brief Get the ticket of the last batch the GPU has finished
+	 *
+	 * @return The ticket, 0 before the first batch finishes
+	 */
+	Ticket getCompletedValue() const;
+	/**
+	 * @brief Get the ticket of the last batch submitted by @ref flush
+	 *
+	 * @return The ticket, 0 before the first batch is submitted
+	 */
+	Ticket		getSubmittedValue() const { return m_nextValue - 1; }
+	VkSemaphore getTimeline() const { return m_timeline; }
+	bool		isInitialized() const { return m_device != nullptr; }
+
+  private:
+	struct BufferCopy
+	{
+		VkBuffer	 buffer;
+		VkBufferCopy region;
+	};
+
+	struct ImageCopy
+	{
+		VkImage			  image;
+		VkBufferImageCopy region;
+		VkImageLayout	  finalLayout;
+	};
+
+	struct Batch
+	{
+		VkCommandPool	pool		  = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		uint64_t		value		  = 0;
+	};
+
+	// The graphics family's halves of the ownership transfers of a batch
+	struct Acquire
+	{
+		uint64_t							value;
+		std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+		std::vector<VkImageMemoryBarrier2>	imageBarriers;
+	};
+
+	Result reserve(VkDeviceSize size, RingBuffer::Allocation& staging);
+	void   endWrite(const RingBuffer::Allocation& staging);	   // With m_copyMutex held
+	Result beginBatch(Batch& batch);
+
+	const Device* m_device = nullptr;
+	RingBuffer	  m_staging;
+	VkDeviceSize  m_stagingAlignment = 16;
+	VkSemaphore	  m_timeline		 = VK_NULL_HANDLE;
+	uint32_t	  m_transferFamily	 = 0;
+	uint32_t	  m_graphicsFamily	 = 0;
+
+	// Guards everything up to m_nextValue, held by flush and by uploads reserving staging memory or
+	// queuing their copies, never while a writer runs
+	std::mutex				m_copyMutex;
+	std::vector<BufferCopy> m_bufferCopies;
+	std::vector<ImageCopy>	m_imageCopies;
+	std::vector<uint64_t>	m_writingUploads;	 // The ring positions of the uploads whose writer is running
+	uint64_t				m_nextValue = 1;	 // The value of the batch being filled
+
+	std::deque<Batch>	m_submittedBatches;	   // In submission order
+	std::vector<Batch>	m_freeBatches;
+	std::deque<Acquire> m_acquires;	   // In submission order, only with separate families
+};
+}	 // namespace zaphod::render
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/glfw_common.h"
+#include "util/result.h"
+
+#include <string>
+
+namespace zaphod::render
+{
+/**
+ * @brief Get the name of a VkResult value
+ *
+ * @param result The value to name
+ * @return The name of the enumerator, e.g. "VK_ERROR_DEVICE_LOST"
+ */
+const char* toString(VkResult result);
+
+/**
+ * @brief Convert a VkResult into a @ref Result
+ *
+ * @param result The value returned by a Vulkan call
+ * @param what A short description of the call, included in the message on failure
+ * @return Result::Code::SUCCESS for VK_SUCCESS and other non-error codes\n
+ * Result::Code::OUT_OF_MEMORY for host and device memory exhaustion\n
+ * Result::Code::UNSUPPORTED for missing layers, extensions, features and formats\n
+ * Result::Code::FAILURE for every other error
+ */
+Result makeResult(VkResult result, const std::string& what);
+}	 // namespace zaphod::render
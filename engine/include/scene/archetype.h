@@ -0,0 +1,147 @@
+#pragma once
+
+#include "scene/component.h"
+#include "scene/entity.h"
+#include "util/pool.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zaphod::scene
+{
+/**
+ * @brief Stores every entity that has exactly one set of components.
+ *
+ * @details
+ * Entities live in chunks of @ref chunkSize bytes. Within a chunk every component type has its
+ * own array, aligned to a cache line, after the array of entity handles (structure of arrays), so
+ * a system reading two components of thousands of entities streams through two contiguous arrays.
+ * Removing an entity moves the last entity of the last chunk into its place, so the rows of a chunk
+ * are always packed and every chunk but the last is full.
+ *
+ * Chunks come from the world's @ref FixedPool and go back to it when they empty. Archetypes are
+ * created by the @ref World and live as long as it does.
+ */
+class Archetype
+{
+  public:
+	static constexpr size_t	  chunkSize		  = 16 * 1024;
+	static constexpr size_t	  columnAlignment = maxComponentAlignment;
+	static constexpr uint16_t noColumn		  = UINT16_MAX;
+
+	/**
+	 * @brief Where an entity's components are
+	 */
+	struct Location
+	{
+		uint32_t chunk = 0;
+		uint32_t row   = 0;
+	};
+
+	/**
+	 * @brief The archetypes reached by adding or removing one component type, cached by the world
+	 */
+	struct Edge
+	{
+		ComponentId component;
+		Archetype*	add	   = nullptr;
+		Archetype*	remove = nullptr;
+	};
+
+	/**
+	 * @brief Construct a new Archetype
+	 *
+	 * @param mask The component types of its entities
+	 * @param chunkPool The pool of @ref chunkSize byte slots aligned to @ref columnAlignment, must outlive the archetype
+	 */
+	Archetype(const ComponentMask& mask, FixedPool& chunkPool);
+	~Archetype();
+
+	// Non-copyable, non-movable
+	Archetype(const Archetype&)			   = delete;
+	Archetype& operator=(const Archetype&) = delete;
+	Archetype(Archetype&&)				   = delete;
+	Archetype& operator=(Archetype&&)	   = delete;
+
+	const ComponentMask& getMask() const { return m_mask; }
+	// The number of component types, each stored in one column
+	uint16_t getColumnCount() const { return static_cast<uint16_t>(m_columns.size()); }
+	// The column of a component type, @ref noColumn if the archetype does not have it
+	uint16_t getColumn(ComponentId component) const
+	{
+		const uint32_t index = static_cast<uint32_t>(component);
+		return index < maxComponentTypes ? m_columnOf[index] : noColumn;
+	}
+	ComponentId getColumnComponent(uint16_t column) const { return m_columns[column].component; }
+	uint32_t	getColumnSize(uint16_t column) const { return m_columns[column].size; }
+
+	// The number of entities a chunk holds
+	uint32_t getChunkCapacity() const { return m_chunkCapacity; }
+	size_t	 getChunkCount() const { return m_chunks.size(); }
+	uint32_t getEntityCount() const { return m_entityCount; }
+	uint32_t getChunkEntityCount(size_t chunk) const { return m_chunks[chunk].count; }
+
+	// The entities of a chunk, getChunkEntityCount of them
+	Entity* getEntities(size_t chunk) const { return reinterpret_cast<Entity*>(m_chunks[chunk].data); }
+	// The array of one component type in a chunk
+	void* getColumnData(size_t chunk, uint16_t column) const { return m_chunks[chunk].data + m_columns[column].offset; }
+	// One entity's component
+	void* getComponent(const Location& location, uint16_t column) const
+	{
+		return m_chunks[location.chunk].data + m_columns[column].offset + size_t(location.row) * m_columns[column].size;
+	}
+
+	/**
+	 * @brief Add a row for an entity at the end, its components are left uninitialized
+	 *
+	 * @param entity The entity
+	 * @return Where its components are
+	 */
+	Location allocate(Entity entity);
+	/**
+	 * @brief Remove a row, filling it with the last row
+	 *
+	 * @param location The row to remove
+	 * @return The entity moved into the row, an invalid entity if the row was the last
+	 */
+	Entity remove(const Location& location);
+
+	/**
+	 * @brief Get the cached transitions for a component type, creating an empty entry on first use
+	 *
+	 * @param component The component type added or removed
+	 * @return The entry
+	 */
+	Edge& getEdge(ComponentId component);
+
+  private:
+	struct Column
+	{
+		ComponentId component;
+		uint32_t	size;
+		uint32_t	offset;	   // From the start of the chunk
+	};
+
+	struct Chunk
+	{
+		std::byte* data;
+		uint32_t   count;
+	};
+
+	size_t layOut(uint32_t capacity);
+	void   addChunk();
+	void   freeChunk(Chunk& chunk);
+
+	ComponentMask							m_mask;
+	std::vector<Column>						m_columns;
+	std::array<uint16_t, maxComponentTypes>	m_columnOf;
+	std::vector<Edge>						m_edges;
+	FixedPool&								m_chunkPool;
+	size_t									m_chunkBytes	= chunkSize;	// More if one entity does not fit
+	uint32_t								m_chunkCapacity	= 0;
+	std::vector<Chunk>						m_chunks;
+	uint32_t								m_entityCount	= 0;
+};
+}	 // namespace zaphod::scene
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "scene/component.h"
+#include "scene/entity.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace zaphod::scene
+{
+/**
+ * @brief Records structural changes to a @ref World, to apply them once no query iterates it.
+ *
+ * @details
+ * Creating and destroying entities and adding and removing components move entities between
+ * archetypes, which invalidates the chunks a query is iterating. Systems running on job workers
+ * record those changes instead, one buffer per worker, and the world applies them in order with
+ * @ref World::apply once the jobs are done:
+ * @code
+ * query.parallelForEach<Health>(jobs, [&](Entity entity, Health& health)
+ * {
+ *     if (health.value <= 0.0f)
+ *         commandBuffers[jobs.getCurrentWorkerIndex()].destroy(entity);
+ * });
+ * for (CommandBuffer& commands : commandBuffers)
+ *     world.apply(commands);
+ * @endcode
+ *
+ * Commands are packed into one byte buffer that keeps its capacity when the buffer is applied, so a
+ * buffer that has seen a frame's worth of commands records the next frames without allocating.
+ * Commands on entities that are gone by the time they apply are skipped.
+ *
+ * Not thread-safe.
+ */
+class CommandBuffer
+{
+  public:
+	/**
+	 * @brief Record creating an entity with components
+	 *
+	 * @param components The components of the entity
+	 */
+	template<typename... Ts>
+	void create(const Ts&... components)
+	{
+		writeHeader(Type::CREATE, {}, invalidComponent, sizeof...(Ts));
+		(writeComponent(getComponentId<Ts>(), &components, sizeof(Ts)), ...);
+	}
+	/**
+	 * @brief Record destroying an entity
+	 *
+	 * @param entity The entity
+	 */
+	void destroy(Entity entity) { writeHeader(Type::DESTROY, entity, invalidComponent, 0); }
+	/**
+	 * @brief Record adding a component to an entity, or overwriting the one it has
+	 *
+	 * @param entity The entity
+	 * @param component The value of the component
+	 */
+	template<typename T>
+	void add(Entity entity, const T& component)
+	{
+		writeHeader(Type::ADD, entity, getComponentId<T>(), sizeof(T));
+		writeBytes(&component, sizeof(T));
+	}
+	/**
+	 * @brief Record removing a component from an entity
+	 *
+	 * @param entity The entity
+	 */
+	template<typename T>
+	void remove(Entity entity)
+	{
+		writeHeader(Type::REMOVE, entity, getComponentId<T>(), 0);
+	}
+
+	bool isEmpty() const { return m_data.empty(); }
+	// The number of commands recorded since the buffer was last applied or cleared
+	uint32_t getCommandCount() const { return m_commandCount; }
+	/**
+	 * @brief Drop every recorded command, keeping the memory for the next ones
+	 */
+	void clear()
+	{
+		m_data.clear();
+		m_commandCount = 0;
+	}
+
+  private:
+	friend class World;
+
+	enum class Type : uint8_t
+	{
+		CREATE,
+		DESTROY,
+		ADD,
+		REMOVE
+	};
+
+	struct Header
+	{
+		Type		type;
+		Entity		entity;
+		ComponentId component;
+		uint32_t	count;	  // CREATE: the number of components that follow, ADD: the size of the component
+	};
+
+	struct ComponentHeader
+	{
+		ComponentId component;
+		uint32_t	size;
+	};
+
+	void writeBytes(const void* data, size_t size)
+	{
+		const size_t offset = m_data.size();
+		m_data.resize(offset + size);
+		std::memcpy(m_data.data() + offset, data, size);
+	}
+	void writeHeader(Type type, Entity entity, ComponentId component, uint32_t count)
+	{
+		const Header header { type, entity, component, count };
+		writeBytes(&header, sizeof(header));
+		++m_commandCount;
+	}
+	void writeComponent(ComponentId component, const void* data, uint32_t size)
+	{
+		const ComponentHeader header { component, size };
+		writeBytes(&header, sizeof(header));
+		writeBytes(data, size);
+	}
+
+	std::vector<std::byte> m_data;
+	uint32_t			   m_commandCount = 0;
+};
+}	 // namespace zaphod::scene
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "util/flags.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace zaphod::scene
+{
+/**
+ * @brief The number of component types a program can register
+ */
+inline constexpr uint32_t maxComponentTypes = 256;
+/**
+ * @brief The largest component, bigger data belongs in its own storage referenced from a component
+ */
+inline constexpr size_t maxComponentSize = 1024;
+/**
+ * @brief The strictest alignment of a component, that of the chunks they are stored in
+ */
+inline constexpr size_t maxComponentAlignment = 64;
+
+/**
+ * @brief Identifies a component type, in the order the types were first used
+ */
+enum class ComponentId : uint32_t
+{
+};
+/**
+ * @brief The id of types registered beyond @ref maxComponentTypes, which the world ignores
+ */
+inline constexpr ComponentId invalidComponent = ComponentId(UINT32_MAX);
+
+/**
+ * @brief A set of component types, the key of an archetype and the filter of a query
+ */
+using ComponentMask = Flags<ComponentId, maxComponentTypes>;
+
+/**
+ * @brief How a component type is stored
+ */
+struct ComponentInfo
+{
+	uint32_t size	   = 0;
+	uint32_t alignment = 0;
+};
+
+/**
+ * @brief The component types of the program, shared by every world.
+ *
+ * @details
+ * Types are registered the first time @ref getComponentId sees them, from any thread.
+ */
+class ComponentRegistry
+{
+  public:
+	/**
+	 * @brief Register a component type
+	 *
+	 * @param info The size and alignment of the type
+	 * @return The id of the type, @ref invalidComponent once @ref maxComponentTypes types are registered
+	 */
+	static ComponentId registerComponent(const ComponentInfo& info);
+	/**
+	 * @brief Get how a registered component type is stored
+	 *
+	 * @param id The id of the type, not @ref invalidComponent
+	 * @return The size and alignment of the type
+	 */
+	static const ComponentInfo& getInfo(ComponentId id);
+	/**
+	 * @brief Get the number of registered component types
+	 *
+	 * @return The number of types
+	 */
+	static uint32_t getCount();
+};
+
+/**
+ * @brief Get the id of a component type, registering it on first use
+ *
+ * @details
+ * Components are plain data: the world moves them between chunks with memcpy and never runs
+ * their destructors, so they must be trivially copyable and trivially destructible.
+ *
+ * @tparam T The component type
+ * @return The id of the type
+ */
+template<typename T>
+ComponentId getComponentId()
+{
+	// `const T` is the same component as `T`, with the same id
+	if constexpr (!std::is_same_v<T, std::remove_cv_t<T>>)
+		return getComponentId<std::remove_cv_t<T>>();
+	else
+	{
+		static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+					  "Components are moved with memcpy and never destroyed");
+		static_assert(sizeof(T) <= maxComponentSize, "Components this large belong in their own storage");
+		static_assert(alignof(T) <= maxComponentAlignment, "Chunks are only aligned to a cache line");
+
+		static const ComponentId id = ComponentRegistry::registerComponent({ uint32_t(sizeof(T)), uint32_t(alignof(T)) });
+		return id;
+	}
+}
+
+/**
+ * @brief Build the mask of a set of component types
+ *
+ * @tparam Ts The component types
+ * @return The mask with the types set
+ */
+template<typename... Ts>
+ComponentMask makeComponentMask()
+{
+	ComponentMask mask;
+	(mask.setFlag(getComponentId<Ts>()), ...);
+	return mask;
+}
+}	 // namespace zaphod::scene
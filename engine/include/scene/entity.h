@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace zaphod::scene
+{
+/**
+ * @brief A handle to an entity of a @ref World.
+ *
+ * @details
+ * The index is reused once the entity is destroyed, the generation tells the old handles apart
+ * from the entity that reuses it.
+ */
+struct Entity
+{
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	uint32_t index		= invalidIndex;
+	uint32_t generation = 0;
+
+	bool isValid() const { return index != invalidIndex; }
+	bool operator==(const Entity& other) const = default;
+};
+}	 // namespace zaphod::scene
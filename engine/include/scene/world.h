@@ -0,0 +1,410 @@
+#pragma once
+
+#include "core/job_system.h"
+#include "scene/archetype.h"
+#include "scene/command_buffer.h"
+#include "scene/component.h"
+#include "scene/entity.h"
+#include "util/hash.h"
+#include "util/pool.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace zaphod::scene
+{
+class World;
+
+/**
+ * @brief One chunk of an archetype, as @ref Query::forEachChunk hands it out.
+ */
+class ChunkView
+{
+  public:
+	ChunkView(const Archetype& archetype, size_t chunk): m_archetype(archetype), m_chunk(chunk) {}
+
+	const Archetype& getArchetype() const { return m_archetype; }
+	uint32_t		 getCount() const { return m_archetype.getChunkEntityCount(m_chunk); }
+	const Entity*	 getEntities() const { return m_archetype.getEntities(m_chunk); }
+	/**
+	 * @brief Get the array of a component type in the chunk
+	 *
+	 * @return getCount() components, nullptr if the archetype does not have the type
+	 */
+	template<typename T>
+	T* get() const
+	{
+		const uint16_t column = m_archetype.getColumn(getComponentId<T>());
+		return column == Archetype::noColumn ? nullptr : static_cast<T*>(m_archetype.getColumnData(m_chunk, column));
+	}
+
+  private:
+	const Archetype& m_archetype;
+	size_t			 m_chunk;
+};
+
+/**
+ * @brief Finds the archetypes of a world that have some component types and lack others.
+ *
+ * @details
+ * The matching archetypes are cached: the world only ever adds archetypes, so each call checks
+ * just the ones created since the last, and iterating a query costs nothing per archetype that does
+ * not match. The components are handed to the function as references into the chunk arrays:
+ * @code
+ * Query movers = world.query<Position, const Velocity>();
+ * movers.forEach<Position, const Velocity>([&](Position& position, const Velocity& velocity)
+ * {
+ *     position.value += velocity.value * deltaTime;
+ * });
+ * @endcode
+ * The function may take the entity first, `(Entity, Position&, const Velocity&)`. The types passed
+ * to the iteration calls must be among the query's required types.
+ *
+ * The world must not change structurally while a query iterates it, record the changes into a
+ * @ref CommandBuffer instead. A query is used from one thread at a time, @ref parallelForEach
+ * spreads one call over the job workers.
+ */
+class Query
+{
+  public:
+	/**
+	 * @brief Construct a new Query
+	 *
+	 * @param world The world to query, must outlive the query
+	 * @param required The component types an entity must have
+	 * @param excluded The component types an entity must not have
+	 */
+	Query(World& world, const ComponentMask& required, const ComponentMask& excluded = {}):
+		m_world(world), m_required(required), m_excluded(excluded)
+	{
+	}
+
+	/**
+	 * @brief Skip the entities that have some component types as well
+	 *
+	 * @return The query, for chaining
+	 */
+	template<typename... Ts>
+	Query& exclude()
+	{
+		m_excluded |= makeComponentMask<Ts...>();
+		m_checkedArchetypes = 0;
+		m_archetypes.clear();
+		return *this;
+	}
+
+	const ComponentMask& getRequired() const { return m_required; }
+	const ComponentMask& getExcluded() const { return m_excluded; }
+
+	/**
+	 * @brief Get the archetypes that match, bringing the cache up to date
+	 *
+	 * @return The matching archetypes, in the order the world created them
+	 */
+	const std::vector<Archetype*>& getArchetypes();
+	/**
+	 * @brief Count the entities that match
+	 *
+	 * @return The number of entities
+	 */
+	size_t getEntityCount();
+
+	/**
+	 * @brief Call a function with the components of every matching entity
+	 *
+	 * @param function Called as `function(Ts&...)` or `function(Entity, Ts&...)`
+	 */
+	template<typename... Ts, typename F>
+	void forEach(F&& function)
+	{
+		for (Archetype* archetype : getArchetypes())
+		{
+			for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk)
+				forEachInChunk<Ts...>(*archetype, chunk, function);
+		}
+	}
+	/**
+	 * @brief Call a function with every chunk of the matching archetypes
+	 *
+	 * @details
+	 * For systems that work on whole arrays at a time, e.g. with SIMD.
+	 *
+	 * @param function Called as `function(const ChunkView&)`
+	 */
+	template<typename F>
+	void forEachChunk(F&& function)
+	{
+		for (Archetype* archetype : getArchetypes())
+		{
+			for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk)
+				function(ChunkView(*archetype, chunk));
+		}
+	}
+
+	/**
+	 * @brief Call a function with the components of every matching entity, spread over the job workers
+	 *
+	 * @details
+	 * Every chunk is processed by one worker, so the function runs concurrently for entities of
+	 * different chunks. Returns once every entity has been processed.
+	 *
+	 * @param jobs The job system to run on
+	 * @param function Called as `function(Ts&...)` or `function(Entity, Ts&...)`, from any worker
+	 * @param chunksPerJob The number of chunks each job processes
+	 */
+	template<typename... Ts, typename F>
+	void parallelForEach(JobSystem& jobs, F&& function, size_t chunksPerJob = 1)
+	{
+		gatherChunks();
+		jobs.parallelFor(m_chunks.size(), chunksPerJob,
+						 [this, &function](size_t begin, size_t end)
+						 {
+							 for (size_t i = begin; i < end; ++i)
+								 forEachInChunk<Ts...>(*m_chunks[i].archetype, m_chunks[i].chunk, function);
+						 });
+	}
+	/**
+	 * @brief Call a function with every chunk of the matching archetypes, spread over the job workers
+	 *
+	 * @param jobs The job system to run on
+	 * @param function Called as `function(const ChunkView&)`, from any worker
+	 * @param chunksPerJob The number of chunks each job processes
+	 */
+	template<typename F>
+	void parallelForEachChunk(JobSystem& jobs, F&& function, size_t chunksPerJob = 1)
+	{
+		gatherChunks();
+		jobs.parallelFor(m_chunks.size(), chunksPerJob,
+						 [this, &function](size_t begin, size_t end)
+						 {
+							 for (size_t i = begin; i < end; ++i)
+								 function(ChunkView(*m_chunks[i].archetype, m_chunks[i].chunk));
+						 });
+	}
+
+  private:
+	struct ChunkRef
+	{
+		const Archetype* archetype;
+		size_t			 chunk;
+	};
+
+	template<typename... Ts, typename F>
+	static void forEachInChunk(const Archetype& archetype, size_t chunk, F& function)
+	{
+		const uint32_t		  count	   = archetype.getChunkEntityCount(chunk);
+		const Entity*		  entities = archetype.getEntities(chunk);
+		std::tuple<Ts*...>	  arrays { getChunkArray<Ts>(archetype, chunk)... };
+		std::apply(
+			[&](Ts*... array)
+			{
+				for (uint32_t row = 0; row < count; ++row)
+				{
+					if constexpr (std::is_invocable_v<F&, Entity, Ts&...>)
+						function(entities[row], array[row]...);
+					else
+						function(array[row]...);
+				}
+			},
+			arrays);
+	}
+
+	template<typename T>
+	static T* getChunkArray(const Archetype& archetype, size_t chunk)
+	{
+		// Matching archetypes only have the columns of the required types
+		const uint16_t column = archetype.getColumn(getComponentId<T>());
+		assert(column != Archetype::noColumn && "Query iterated with a component type that is not among its required types");
+		return static_cast<T*>(archetype.getColumnData(chunk, column));
+	}
+
+	void gatherChunks();
+
+	World&					m_world;
+	ComponentMask			m_required;
+	ComponentMask			m_excluded;
+	std::vector<Archetype*> m_archetypes;
+	size_t					m_checkedArchetypes = 0;	// The world's archetypes already matched against
+	std::vector<ChunkRef>	m_chunks;					// Reused by the parallel calls
+};
+
+/**
+ * @brief Entities and their components, stored by archetype.
+ *
+ * @details
+ * An entity's components live in the @ref Archetype of its exact set of component types, in
+ * 16 KiB chunks of contiguous arrays. Adding or removing a component moves the entity to another
+ * archetype; the transitions are cached on the archetypes, so after the first time that is a
+ * lookup and a copy of the entity's components. Iterate the entities with a @ref Query, and defer
+ * structural changes made during iteration with a @ref CommandBuffer.
+ *
+ * Pointers and references to components are invalidated by any structural change.
+ *
+ * Not thread-safe, except that queries may run their functions on many workers.
+ */
+class World
+{
+  public:
+	World();
+	~World();
+
+	// Non-copyable, non-movable
+	World(const World&)			   = delete;
+	World& operator=(const World&) = delete;
+	World(World&&)				   = delete;
+	World& operator=(World&&)	   = delete;
+
+	/**
+	 * @brief Create an entity
+	 *
+	 * @param components The components of the entity
+	 * @return The entity
+	 */
+	template<typename... Ts>
+	Entity create(const Ts&... components)
+	{
+		const ComponentData data[] = { { getComponentId<Ts>(), &components }..., { invalidComponent, nullptr } };
+		return createRaw(data, sizeof...(Ts));
+	}
+	/**
+	 * @brief Destroy an entity and its components
+	 *
+	 * @param entity The entity, ignored if it is not alive
+	 */
+	void destroy(Entity entity);
+	bool isAlive(Entity entity) const
+	{
+		return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation &&
+			   m_records[entity.index].archetype;
+	}
+
+	/**
+	 * @brief Add a component to an entity, or overwrite the one it has
+	 *
+	 * @param entity The entity
+	 * @param component The value of the component
+	 * @return The component, nullptr if the entity is not alive
+	 */
+	template<typename T>
+	T* add(Entity entity, const T& component = {})
+	{
+		return static_cast<T*>(addRaw(entity, getComponentId<T>(), &component));
+	}
+	/**
+	 * @brief Remove a component from an entity
+	 *
+	 * @param entity The entity, ignored if it is not alive or does not have the component
+	 */
+	template<typename T>
+	void remove(Entity entity)
+	{
+		removeRaw(entity, getComponentId<T>());
+	}
+	/**
+	 * @brief Get a component of an entity
+	 *
+	 * @param entity The entity
+	 * @return The component, nullptr if the entity is not alive or does not have it
+	 */
+	template<typename T>
+	T* get(Entity entity) const
+	{
+		return static_cast<T*>(getRaw(entity, getComponentId<T>()));
+	}
+	template<typename T>
+	bool has(Entity entity) const
+	{
+		return getRaw(entity, getComponentId<T>()) != nullptr;
+	}
+
+	/**
+	 * @brief Make a query for the entities that have some component types
+	 *
+	 * @return The query, keep it to reuse its cache
+	 */
+	template<typename... Ts>
+	Query query()
+	{
+		return Query(*this, makeComponentMask<Ts...>());
+	}
+
+	/**
+	 * @brief Apply the commands of a buffer in the order they were recorded, then clear it
+	 *
+	 * @param commands The buffer
+	 */
+	void apply(CommandBuffer& commands);
+
+	uint32_t getEntityCount() const { return m_entityCount; }
+	// Every archetype, in the order they were created, the first one has no components
+	const std::vector<std::unique_ptr<Archetype>>& getArchetypes() const { return m_archetypes; }
+
+	/**
+	 * @brief A component given to @ref createRaw
+	 */
+	struct ComponentData
+	{
+		ComponentId component;
+		const void* data;
+	};
+	/**
+	 * @brief Create an entity from untyped components
+	 *
+	 * @param components The components
+	 * @param count The number of components
+	 * @return The entity
+	 */
+	Entity createRaw(const ComponentData* components, size_t count);
+	/**
+	 * @brief Add an untyped component to an entity, or overwrite the one it has
+	 *
+	 * @param entity The entity
+	 * @param component The component type
+	 * @param data The value, ComponentRegistry::getInfo(component).size bytes
+	 * @return The component, nullptr if the entity is not alive or the type is invalid
+	 */
+	void* addRaw(Entity entity, ComponentId component, const void* data);
+	void  removeRaw(Entity entity, ComponentId component);
+	void* getRaw(Entity entity, ComponentId component) const;
+
+  private:
+	struct Record
+	{
+		Archetype*			archetype = nullptr;	// nullptr while the index is free
+		Archetype::Location location;
+		uint32_t			generation = 0;
+	};
+
+	struct MaskHash
+	{
+		size_t operator()(const ComponentMask& mask) const
+		{
+			return static_cast<size_t>(hashBytes(mask.getWords().data(), sizeof(mask.getWords())));
+		}
+	};
+
+	Archetype* getArchetype(const ComponentMask& mask);
+	Archetype* getAddTarget(Archetype& archetype, ComponentId component);
+	Archetype* getRemoveTarget(Archetype& archetype, ComponentId component);
+	void	   moveEntity(Entity entity, Archetype& target);
+	void	   place(Entity entity, Archetype& archetype);
+
+	FixedPool												  m_chunkPool;
+	std::vector<std::unique_ptr<Archetype>>					  m_archetypes;
+	std::unordered_map<ComponentMask, Archetype*, MaskHash>	  m_archetypesByMask;
+	std::vector<Record>										  m_records;	// Indexed by Entity::index
+	std::vector<uint32_t>									  m_freeIndices;
+	uint32_t												  m_entityCount = 0;
+	std::vector<ComponentData>								  m_createScratch;	  // Reused when applying commands
+
+	friend class Query;
+};
+}	 // namespace zaphod::scene
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace zaphod
+{
+/**
+ * @brief A bump allocator that frees everything at once.
+ *
+ * @details
+ * Allocations are carved out of large blocks by advancing a cursor, so they cost a few
+ * instructions and never touch the global heap once the arena is warm. Individual allocations
+ * cannot be freed; @ref reset releases all of them together, which makes the arena a natural fit
+ * for data that lives for exactly one frame.
+ *
+ * When a block is exhausted a new one (at least twice the requested size) is chained on. On the
+ * next @ref reset the chain is replaced by a single block large enough for everything that was
+ * allocated, so after a warm-up frame a steady workload fits in one block.
+ *
+ * @note Destructors of objects created in the arena are never run, only trivially destructible
+ * types should be stored in it.
+ */
+class LinearArena
+{
+  public:
+	/**
+	 * @brief The size of the first block if none is given
+	 */
+	static constexpr size_t defaultBlockSize = 64 << 10;
+
+	/**
+	 * @brief Construct a new LinearArena
+	 *
+	 * @param blockSize The size of the first block in bytes, it is allocated lazily
+	 */
+	explicit LinearArena(size_t blockSize = defaultBlockSize): m_blockSize(std::max(blockSize, sizeof(Block) * 2)) {}
+	~LinearArena() { freeBlocks(); }
+
+	// Non-copyable, non-movable
+	LinearArena(const LinearArena&)			   = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+	LinearArena(LinearArena&&)				   = delete;
+	LinearArena& operator=(LinearArena&&)	   = delete;
+
+	/**
+	 * @brief Allocate uninitialized memory
+	 *
+	 * @param size The number of bytes to allocate
+	 * @param alignment The alignment of the allocation, must be a power of two
+	 * @return A pointer to the memory, valid until the next @ref reset
+	 */
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+	{
+		// Compared as addresses, alignment padding can carry start past the end of the block
+		auto start = reinterpret_cast<uintptr_t>(alignUp(m_cursor, alignment));
+		auto end   = reinterpret_cast<uintptr_t>(m_end);
+		if (!m_cursor || start > end || end - start < size)
+		{
+			addBlock(size + alignment);
+			start = reinterpret_cast<uintptr_t>(alignUp(m_cursor, alignment));
+		}
+		assert(start + size <= reinterpret_cast<uintptr_t>(m_end) && "Arena allocation overruns its block");
+		m_cursor = reinterpret_cast<std::byte*>(start) + size;
+		m_used += size;
+		return reinterpret_cast<void*>(start);
+	}
+
+	/**
+	 * @brief Allocate an uninitialized array
+	 *
+	 * @tparam T The element type
+	 * @param count The number of elements
+	 * @return A pointer to the first element
+	 */
+	template<typename T>
+	T* allocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Arena allocations are never destroyed");
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	/**
+	 * @brief Construct an object in the arena
+	 *
+	 * @tparam T The type of the object
+	 * @param args The constructor arguments
+	 * @return A pointer to the object
+	 */
+	template<typename T, typename... Args>
+	T* create(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Arena allocations are never destroyed");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Copy a string into the arena
+	 *
+	 * @param text The string to copy
+	 * @return A view of the copy
+	 */
+	std::string_view copyString(std::string_view text)
+	{
+		if (text.empty())
+			return std::string_view();
+		char* copy = static_cast<char*>(allocate(text.size(), 1));
+		std::memcpy(copy, text.data(), text.size());
+		return std::string_view(copy, text.size());
+	}
+
+	/**
+	 * @brief Copy an array into the arena
+	 *
+	 * @tparam T The element type, must be trivially copyable
+	 * @param values The values to copy
+	 * @return A view of the copy
+	 */
+	template<typename T>
+	std::span<const T> copyArray(std::span<const T> values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable arrays can be copied into an arena");
+		if (values.empty())
+			return std::span<const T>();
+		T* copy = allocateArray<T>(values.size());
+		std::memcpy(copy, values.data(), values.size_bytes());
+		return std::span<const T>(copy, values.size());
+	}
+
+	/**
+	 * @brief Release every allocation
+	 *
+	 * @details
+	 * If more than one block was in use they are merged into a single block of their total size.
+	 */
+	void reset()
+	{
+		if (m_blocks && m_blocks->next)
+		{
+			size_t capacity = 0;
+			for (Block* block = m_blocks; block; block = block->next)
+				capacity += block->size;
+			freeBlocks();
+			m_blockSize = capacity;
+			addBlock(0);
+		}
+		else if (m_blocks)
+			m_cursor = reinterpret_cast<std::byte*>(m_blocks + 1);
+		m_used = 0;
+	}
+
+	/**
+	 * @brief Get the number of bytes allocated since the last reset, excluding alignment padding
+	 *
+	 * @return The number of bytes in use
+	 */
+	size_t getUsed() const { return m_used; }
+
+  private:
+	struct alignas(std::max_align_t) Block
+	{
+		Block* next;
+		size_t size;
+	};
+
+	static std::byte* alignUp(std::byte* pointer, size_t alignment)
+	{
+		auto address = reinterpret_cast<uintptr_t>(pointer);
+		return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+	}
+
+	void addBlock(size_t required)
+	{
+		size_t size	 = std::max(m_blockSize, (required + sizeof(Block)) * 2);
+		auto*  block = static_cast<Block*>(::operator new(size));
+		*block		 = Block { m_blocks, size };
+
+		m_blocks	= block;
+		m_cursor	= reinterpret_cast<std::byte*>(block + 1);
+		m_end		= reinterpret_cast<std::byte*>(block) + size;
+		m_blockSize = std::max(m_blockSize, size);
+	}
+
+	void freeBlocks()
+	{
+		while (m_blocks)
+		{
+			Block* next = m_blocks->next;
+			::operator delete(m_blocks);
+			m_blocks = next;
+		}
+		m_cursor = m_end = nullptr;
+	}
+
+	Block*	   m_blocks = nullptr;
+	std::byte* m_cursor = nullptr;
+	std::byte* m_end	= nullptr;
+	size_t	   m_blockSize;
+	size_t	   m_used = 0;
+};
+}	 // namespace zaphod
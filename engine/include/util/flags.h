@@ -1,65 +1,231 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <type_traits>
 #include <vector>
 
 namespace zaphod
 {
-template<typename Flag>
+/**
+ * @brief A set of enum values, one bit per value.
+ *
+ * @details
+ * The bits are kept in an array of 64-bit words, enough for `Bits` values, so a set can hold
+ * hundreds of keys or component types. The bulk operations are branch-free loops over the words,
+ * which the compiler unrolls and vectorizes for wide sets. Every operation is constexpr, and
+ * neither the initializer list nor the vector constructor allocates:
+ * @code
+ * constexpr Flags<Component, 256> required { Component::TRANSFORM, Component::MESH };
+ * if (archetype.checkAllFlags(required))
+ *     ...
+ * @endcode
+ *
+ * The overloads taking a raw mask work on the first 64 values, where the bit of a value is
+ * `1 << value`. Values outside of the set's range are ignored.
+ *
+ * @tparam Flag The enum, whose values are the bit indices. If it has an `EMPTY` value, it must be 0.
+ * @tparam Bits The number of values the set can hold
+ */
+template<typename Flag, size_t Bits = 64>
 class Flags
 {
 	static_assert(std::is_enum_v<Flag>);
-	static_assert(std::is_same_v<std::underlying_type_t<Flag>, uint32_t>);
-	static_assert(static_cast<std::underlying_type_t<Flag>>(Flag::EMPTY) == 0, "The enum's 'EMPTY' value must be 0.");
+	static_assert(Bits > 0);
 
   public:
-	Flags(): flags(0) {}
-	Flags(uint32_t flags): flags(flags) {}
-	Flags(std::vector<Flag> flags) : flags(0)
+	using Word						  = uint64_t;
+	static constexpr size_t bitCount  = Bits;
+	static constexpr size_t wordCount = (Bits + 63) / 64;
+
+	constexpr Flags()
+	{
+		if constexpr (requires { Flag::EMPTY; })
+			static_assert(static_cast<std::underlying_type_t<Flag>>(Flag::EMPTY) == 0, "The enum's 'EMPTY' value must be 0.");
+	}
+	constexpr Flags(const Word flags): Flags() { m_words[0] = flags & getWordMask(0); }
+	constexpr Flags(std::initializer_list<Flag> flags): Flags()
 	{
 		for (const auto& flag : flags)
-			this->flags |= (1 << static_cast<uint32_t>(flag));
+			setFlag(flag);
+	}
+	Flags(const std::vector<Flag>& flags): Flags()
+	{
+		for (const auto& flag : flags)
+			setFlag(flag);
 	}
 
-	void updateFlags(const uint32_t flags) { this->flags |= flags; }
-	void operator|=(const uint32_t flags) { this->flags |= flags; }
-	void updateFlags(const Flags& other) { flags |= other.flags; }
-	void operator|=(const Flags& other) { flags |= other.flags; }
+	constexpr void updateFlags(const Word flags) { m_words[0] |= flags & getWordMask(0); }
+	constexpr void operator|=(const Word flags) { updateFlags(flags); }
+	constexpr void updateFlags(const Flags& other)
+	{
+		for (size_t i = 0; i < wordCount; ++i)
+			m_words[i] |= other.m_words[i];
+	}
+	constexpr void operator|=(const Flags& other) { updateFlags(other); }
 
-	void setFlags(const uint32_t flags) { this->flags = flags; }
-	void operator=(const uint32_t flags) { this->flags = flags; }
-	void setFlags(const Flags& other) { flags = other.flags; }
+	constexpr void setFlags(const Word flags)
+	{
+		reset();
+		m_words[0] = flags & getWordMask(0);
+	}
+	constexpr void operator=(const Word flags) { setFlags(flags); }
+	constexpr void setFlags(const Flags& other) { m_words = other.m_words; }
 	//void operator=(const Flags& other) { flags = other.flags; }
-	void setFlag(const Flag flag, const bool enable = true)
+	constexpr void setFlag(const Flag flag, const bool enable = true)
 	{
+		const size_t index = getIndex(flag);
+		if (index >= Bits)
+			return;
 		if (enable)
-			flags |= (1 << static_cast<uint32_t>(flag));
+			m_words[index / 64] |= getBit(index);
 		else
-			flags &= ~(1 << static_cast<uint32_t>(flag));
+			m_words[index / 64] &= ~getBit(index);
+	}
+	constexpr void operator|=(const Flag flag) { setFlag(flag); }
+	constexpr void operator=(const Flag flag)
+	{
+		reset();
+		setFlag(flag);
 	}
-	void operator|=(const Flag flag) { flags |= (1 << static_cast<uint32_t>(flag)); }
-	void operator=(const Flag flag) { flags = (1 << static_cast<uint32_t>(flag)); }
 
-	void operator&=(const uint32_t flag) { flags &= flag; }
-	void operator&=(const Flags& other) { flags &= other.flags; }
-	void operator&=(const Flag flag) { flags &= (1 << static_cast<uint32_t>(flag)); }
+	constexpr void operator&=(const Word flag)
+	{
+		reset(1);
+		m_words[0] &= flag;
+	}
+	constexpr void operator&=(const Flags& other)
+	{
+		for (size_t i = 0; i < wordCount; ++i)
+			m_words[i] &= other.m_words[i];
+	}
+	constexpr void operator&=(const Flag flag)
+	{
+		const bool isSet = checkFlag(flag);
+		reset();
+		setFlag(flag, isSet);
+	}
 
-	void unsetFlags(const uint32_t flag) { flags &= ~flag; }
-	void unsetFlags(const Flags& other) { flags &= ~other.flags; }
-	void unsetFlag(const Flag flag) { flags &= ~(1 << static_cast<uint32_t>(flag)); }
+	constexpr void unsetFlags(const Word flag) { m_words[0] &= ~flag; }
+	constexpr void unsetFlags(const Flags& other)
+	{
+		for (size_t i = 0; i < wordCount; ++i)
+			m_words[i] &= ~other.m_words[i];
+	}
+	constexpr void unsetFlag(const Flag flag) { setFlag(flag, false); }
 
-	uint32_t operator&(const uint32_t flag) const { return flags & flag; }
-	Flags	 operator&(const Flags& other) const { return Flags(flags & other.flags); }
-	Flags	 operator&(const Flag flag) const { return Flags(flags & (1 << static_cast<uint32_t>(flag))); }
+	constexpr Word	operator&(const Word flag) const { return m_words[0] & flag; }
+	constexpr Flags operator&(const Flags& other) const
+	{
+		Flags result = *this;
+		result &= other;
+		return result;
+	}
+	constexpr Flags operator&(const Flag flag) const
+	{
+		Flags result;
+		result.setFlag(flag, checkFlag(flag));
+		return result;
+	}
+	constexpr Flags operator|(const Flags& other) const
+	{
+		Flags result = *this;
+		result |= other;
+		return result;
+	}
+	// The flags set in this set but not in the other
+	constexpr Flags without(const Flags& other) const
+	{
+		Flags result = *this;
+		result.unsetFlags(other);
+		return result;
+	}
 
-	bool checkFlags(const uint32_t flag) const { return (flags & flag) != 0; }
-	bool checkFlags(const Flags& other) const { return (flags & other.flags) != 0; }
-	bool checkFlag(const Flag flag) const { return (flags & (1 << static_cast<uint32_t>(flag))) != 0; }
+	constexpr bool checkFlags(const Word flag) const { return (m_words[0] & flag) != 0; }
+	// Whether any flag is set in both sets
+	constexpr bool checkFlags(const Flags& other) const
+	{
+		Word common = 0;
+		for (size_t i = 0; i < wordCount; ++i)
+			common |= m_words[i] & other.m_words[i];
+		return common != 0;
+	}
+	// Whether every flag set in the other set is set in this one
+	constexpr bool checkAllFlags(const Flags& other) const
+	{
+		Word missing = 0;
+		for (size_t i = 0; i < wordCount; ++i)
+			missing |= other.m_words[i] & ~m_words[i];
+		return missing == 0;
+	}
+	constexpr bool checkFlag(const Flag flag) const
+	{
+		const size_t index = getIndex(flag);
+		return index < Bits && (m_words[index / 64] & getBit(index)) != 0;
+	}
 
-	void reset() { flags = 0; }
+	constexpr bool isEmpty() const
+	{
+		Word any = 0;
+		for (size_t i = 0; i < wordCount; ++i)
+			any |= m_words[i];
+		return any == 0;
+	}
+	constexpr size_t countFlags() const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < wordCount; ++i)
+			count += static_cast<size_t>(std::popcount(m_words[i]));
+		return count;
+	}
+	/**
+	 * @brief Call a function with every set flag, in ascending order
+	 *
+	 * @details
+	 * Skips a whole word of unset flags at a time and jumps straight to the next set bit within one.
+	 *
+	 * @param function A callable taking a `Flag`
+	 */
+	template<typename Function>
+	constexpr void forEachFlag(Function&& function) const
+	{
+		for (size_t i = 0; i < wordCount; ++i)
+		{
+			for (Word bits = m_words[i]; bits != 0; bits &= bits - 1)
+			{
+				const size_t index = i * 64 + static_cast<size_t>(std::countr_zero(bits));
+				function(static_cast<Flag>(static_cast<std::underlying_type_t<Flag>>(index)));
+			}
+		}
+	}
+
+	constexpr const std::array<Word, wordCount>& getWords() const { return m_words; }
+
+	constexpr bool operator==(const Flags& other) const { return m_words == other.m_words; }
+
+	constexpr void reset() { reset(0); }
 
   private:
-	uint32_t flags = 0;
+	static constexpr size_t getIndex(const Flag flag)
+	{
+		return static_cast<size_t>(static_cast<std::make_unsigned_t<std::underlying_type_t<Flag>>>(flag));
+	}
+	static constexpr Word getBit(const size_t index) { return Word(1) << (index % 64); }
+	// The bits of a word that belong to the set, all but the top ones of the last word
+	static constexpr Word getWordMask(const size_t word)
+	{
+		return word + 1 < wordCount || Bits % 64 == 0 ? ~Word(0) : getBit(Bits) - 1;
+	}
+
+	constexpr void reset(const size_t firstWord)
+	{
+		for (size_t i = firstWord; i < wordCount; ++i)
+			m_words[i] = 0;
+	}
+
+	std::array<Word, wordCount> m_words {};
 };
 }	 // namespace zaphod
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace zaphod
+{
+/**
+ * @brief The 64-bit FNV-1a offset basis, the seed of a new hash
+ */
+inline constexpr uint64_t fnvOffsetBasis = 0xcbf29ce484222325ull;
+
+/**
+ * @brief Hash bytes with 64-bit FNV-1a
+ *
+ * @details
+ * Not cryptographic, meant to key caches by content. Passing the result of a previous call as
+ * the seed hashes the concatenation of both inputs.
+ *
+ * @param data The bytes to hash
+ * @param size The number of bytes
+ * @param seed The hash to continue from
+ * @return The hash of the bytes
+ */
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = fnvOffsetBasis)
+{
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	uint64_t	hash  = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/**
+ * @brief Hash a string with 64-bit FNV-1a, usable at compile time
+ *
+ * @param text The string to hash
+ * @param seed The hash to continue from
+ * @return The hash of the characters of the string
+ */
+constexpr uint64_t hashString(std::string_view text, uint64_t seed = fnvOffsetBasis)
+{
+	uint64_t hash = seed;
+	for (char character : text)
+	{
+		hash ^= static_cast<unsigned char>(character);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+}	 // namespace zaphod
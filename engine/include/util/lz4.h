@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace zaphod
+{
+/**
+ * @brief The largest size @ref lz4Compress can produce from a number of bytes
+ *
+ * @param size The number of bytes to compress
+ * @return The capacity that always fits the compressed bytes
+ */
+constexpr size_t lz4CompressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compress bytes into an LZ4 block
+ *
+ * @details
+ * Writes the raw LZ4 block format, without the frame around it, so the compressed size and the
+ * original size have to be stored next to the block. Greedy and single pass: meant for offline
+ * tools, the point of LZ4 is how fast @ref lz4Decompress is.
+ *
+ * @param source The bytes to compress
+ * @param size The number of bytes
+ * @param destination Receives the block
+ * @param capacity The size of the destination, @ref lz4CompressBound always fits
+ * @return The size of the block, 0 if it does not fit or size is 0
+ */
+size_t lz4Compress(const void* source, size_t size, void* destination, size_t capacity);
+
+/**
+ * @brief Decompress an LZ4 block
+ *
+ * @details
+ * Every length and offset is checked against the buffers, so a corrupted block fails instead of
+ * reading or writing out of bounds.
+ *
+ * @param source The block
+ * @param size The size of the block
+ * @param destination Receives the bytes
+ * @param decompressedSize The number of bytes the block decompresses to
+ * @return True if the block decompressed to exactly decompressedSize bytes
+ */
+bool lz4Decompress(const void* source, size_t size, void* destination, size_t decompressedSize);
+}	 // namespace zaphod
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "util/arena.h"
+#include "util/pool.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace zaphod
+{
+/**
+ * @brief Lets standard pmr containers allocate from a @ref LinearArena.
+ *
+ * @details
+ * Deallocation does nothing, the memory comes back when the arena is reset, so a container in
+ * the arena must not outlive the reset. The elements are still destroyed by the container, unlike
+ * objects created in the arena directly. Growing containers leave their old buffers behind until
+ * the reset, reserve them up front where the size is known:
+ * @code
+ * std::pmr::vector<DrawItem> visible(&app.getFrameResource());
+ * visible.reserve(drawCount);
+ * @endcode
+ *
+ * Not thread-safe.
+ */
+class ArenaResource: public std::pmr::memory_resource
+{
+  public:
+	/**
+	 * @brief Construct a new ArenaResource
+	 *
+	 * @param arena The arena to allocate from, must outlive the resource
+	 */
+	explicit ArenaResource(LinearArena& arena): m_arena(arena) {}
+
+	LinearArena& getArena() const { return m_arena; }
+
+  private:
+	void* do_allocate(size_t bytes, size_t alignment) override { return m_arena.allocate(bytes, alignment); }
+	void  do_deallocate(void*, size_t, size_t) override {}
+	bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	LinearArena& m_arena;
+};
+
+/**
+ * @brief Lets standard pmr containers allocate from a @ref FixedPool.
+ *
+ * @details
+ * Meant for node-based containers, whose nodes all have one size: allocations that fit a slot
+ * come from the pool, and the rest, e.g. the bucket array of an unordered map, go to the
+ * upstream resource. Size the slots for the container's node:
+ * @code
+ * PoolResource nodes(sizeof(std::pair<const uint32_t, Entity>) + 2 * sizeof(void*));
+ * std::pmr::map<uint32_t, Entity> entities(&nodes);
+ * @endcode
+ *
+ * Not thread-safe.
+ */
+class PoolResource: public std::pmr::memory_resource
+{
+  public:
+	/**
+	 * @brief Construct a new PoolResource
+	 *
+	 * @param slotSize The largest allocation served from the pool
+	 * @param slotsPerChunk How many slots each chunk of the pool holds
+	 * @param upstream Serves allocations that do not fit a slot, must outlive the resource
+	 */
+	explicit PoolResource(size_t slotSize, size_t slotsPerChunk = FixedPool::defaultSlotsPerChunk,
+						  std::pmr::memory_resource* upstream = std::pmr::get_default_resource()):
+		m_pool(slotSize, alignof(std::max_align_t), slotsPerChunk), m_upstream(upstream)
+	{
+	}
+
+	FixedPool&		 getPool() { return m_pool; }
+	const FixedPool& getPool() const { return m_pool; }
+
+  private:
+	bool isPooled(size_t bytes, size_t alignment) const
+	{
+		return bytes <= m_pool.getSlotSize() && alignment <= alignof(std::max_align_t);
+	}
+
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		return isPooled(bytes, alignment) ? m_pool.allocate() : m_upstream->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+	{
+		if (isPooled(bytes, alignment))
+			m_pool.free(pointer);
+		else
+			m_upstream->deallocate(pointer, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	FixedPool				   m_pool;
+	std::pmr::memory_resource* m_upstream;
+};
+}	 // namespace zaphod
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace zaphod
+{
+/**
+ * @brief A bounded lock-free multi-producer multi-consumer queue.
+ *
+ * @details
+ * Each cell carries a sequence number that tells producers and consumers whether it is
+ * free or holds a value for the current lap, so pushes and pops only contend on a single
+ * compare-and-swap of their respective position counter. Values are constructed in place
+ * through @ref tryPushWith and read in place through @ref tryPopWith, which avoids copying
+ * large elements more than once.
+ *
+ * @note The capacity is rounded up to a power of two.
+ *
+ * @tparam T The element type (must be default constructible)
+ */
+template<typename T>
+class MpmcQueue
+{
+  public:
+	/**
+	 * @brief Construct a new MpmcQueue
+	 *
+	 * @param capacity The minimum number of elements the queue can hold
+	 */
+	explicit MpmcQueue(size_t capacity):
+		m_capacity(std::bit_ceil(capacity < 2 ? size_t(2) : capacity)),
+		m_mask(m_capacity - 1),
+		m_cells(std::make_unique<Cell[]>(m_capacity))
+	{
+		for (size_t i = 0; i < m_capacity; ++i)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Non-copyable, non-movable
+	MpmcQueue(const MpmcQueue&)			   = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+	/**
+	 * @brief Try to push a value by writing it in place
+	 *
+	 * @param writer A callable taking a `T&` that fills in the claimed cell
+	 * @return true if a cell was claimed, false if the queue is full
+	 */
+	template<typename Writer>
+	bool tryPushWith(Writer&& writer)
+	{
+		size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell&	  cell	   = m_cells[position & m_mask];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff	   = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+			if (diff == 0)
+			{
+				if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					writer(cell.value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false;	 // Full
+			else
+				position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Try to pop a value by reading it in place
+	 *
+	 * @param reader A callable taking a `T&` that consumes the claimed cell
+	 * @return true if a value was popped, false if the queue is empty
+	 */
+	template<typename Reader>
+	bool tryPopWith(Reader&& reader)
+	{
+		size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell&	  cell	   = m_cells[position & m_mask];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff	   = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+			if (diff == 0)
+			{
+				if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					reader(cell.value);
+					cell.sequence.store(position + m_capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false;	 // Empty
+			else
+				position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Try to push a copy of a value
+	 *
+	 * @param value The value to push
+	 * @return true if the value was pushed, false if the queue is full
+	 */
+	bool tryPush(const T& value)
+	{
+		return tryPushWith([&](T& cell) { cell = value; });
+	}
+	/**
+	 * @brief Try to push a value by moving it
+	 *
+	 * @param value The value to push
+	 * @return true if the value was pushed, false if the queue is full
+	 */
+	bool tryPush(T&& value)
+	{
+		return tryPushWith([&](T& cell) { cell = std::move(value); });
+	}
+	/**
+	 * @brief Try to pop a value
+	 *
+	 * @param value Receives the popped value
+	 * @return true if a value was popped, false if the queue is empty
+	 */
+	bool tryPop(T& value)
+	{
+		return tryPopWith([&](T& cell) { value = std::move(cell); });
+	}
+
+	/**
+	 * @brief Check whether the queue looked empty at the time of the call
+	 *
+	 * @return true if there were no values to pop, false otherwise
+	 */
+	bool isEmpty() const
+	{
+		return m_dequeuePosition.load(std::memory_order_acquire) >= m_enqueuePosition.load(std::memory_order_acquire);
+	}
+	/**
+	 * @brief Get the number of elements the queue can hold
+	 *
+	 * @return The capacity of the queue
+	 */
+	size_t getCapacity() const { return m_capacity; }
+
+  private:
+	struct alignas(64) Cell
+	{
+		std::atomic<size_t> sequence;
+		T					value {};
+	};
+
+	size_t					m_capacity;
+	size_t					m_mask;
+	std::unique_ptr<Cell[]> m_cells;
+
+	alignas(64) std::atomic<size_t> m_enqueuePosition { 0 };
+	alignas(64) std::atomic<size_t> m_dequeuePosition { 0 };
+};
+}	 // namespace zaphod
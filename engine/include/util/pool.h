@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace zaphod
+{
+/**
+ * @brief Hands out memory slots of one size and takes them back in any order.
+ *
+ * @details
+ * Slots are carved out of chunks of @ref getSlotsPerChunk slots each, and freed slots are kept
+ * in a free list threaded through the slots themselves, so allocating and freeing are a few
+ * instructions and touch the global heap only when every slot of every chunk is in use. A pool
+ * grown to its peak once, or warmed up front with @ref reserve, never allocates again.
+ *
+ * Chunks are only returned to the heap when the pool is destroyed or @ref release is called.
+ *
+ * Not thread-safe.
+ */
+class FixedPool
+{
+  public:
+	/**
+	 * @brief The number of slots in a chunk if none is given
+	 */
+	static constexpr size_t defaultSlotsPerChunk = 64;
+
+	/**
+	 * @brief Construct a new FixedPool
+	 *
+	 * @param slotSize The size of every slot in bytes
+	 * @param alignment The alignment of every slot, must be a power of two
+	 * @param slotsPerChunk How many slots each chunk holds, chunks are allocated lazily
+	 */
+	explicit FixedPool(size_t slotSize, size_t alignment = alignof(std::max_align_t),
+					   size_t slotsPerChunk = defaultSlotsPerChunk):
+		m_alignment(std::max(alignment, alignof(Chunk))),
+		m_stride(alignUp(std::max(slotSize, sizeof(FreeSlot)), std::max(alignment, alignof(FreeSlot)))),
+		m_slotsPerChunk(std::max<size_t>(slotsPerChunk, 1))
+	{
+	}
+	~FixedPool() { release(); }
+
+	// Non-copyable, non-movable
+	FixedPool(const FixedPool&)			   = delete;
+	FixedPool& operator=(const FixedPool&) = delete;
+	FixedPool(FixedPool&&)				   = delete;
+	FixedPool& operator=(FixedPool&&)	   = delete;
+
+	/**
+	 * @brief Allocate an uninitialized slot
+	 *
+	 * @return A pointer to the slot, valid until it is freed or the pool is released
+	 */
+	void* allocate()
+	{
+		if (!m_freeSlots)
+			addChunk();
+		FreeSlot* slot = m_freeSlots;
+		m_freeSlots	   = slot->next;
+		++m_liveCount;
+		return slot;
+	}
+
+	/**
+	 * @brief Return a slot to the pool
+	 *
+	 * @param slot A slot allocated from this pool, nullptr is ignored
+	 */
+	void free(void* slot)
+	{
+		if (!slot)
+			return;
+		m_freeSlots = new (slot) FreeSlot { m_freeSlots };
+		--m_liveCount;
+	}
+
+	/**
+	 * @brief Add chunks until the pool holds at least a number of slots
+	 *
+	 * @param slotCount The number of slots, in use or free
+	 */
+	void reserve(size_t slotCount)
+	{
+		while (m_chunkCount * m_slotsPerChunk < slotCount)
+			addChunk();
+	}
+
+	/**
+	 * @brief Free every chunk, no slot may be in use
+	 */
+	void release()
+	{
+		while (m_chunks)
+		{
+			Chunk* next = m_chunks->next;
+			::operator delete(m_chunks, std::align_val_t(m_alignment));
+			m_chunks = next;
+		}
+		m_freeSlots	 = nullptr;
+		m_chunkCount = 0;
+		m_liveCount	 = 0;
+	}
+
+	size_t getSlotSize() const { return m_stride; }
+	size_t getSlotsPerChunk() const { return m_slotsPerChunk; }
+	/**
+	 * @brief Get the number of slots allocated and not yet freed
+	 *
+	 * @return The number of live slots
+	 */
+	size_t getLiveCount() const { return m_liveCount; }
+	/**
+	 * @brief Get the number of slots in all chunks, in use or free
+	 *
+	 * @return The capacity
+	 */
+	size_t getCapacity() const { return m_chunkCount * m_slotsPerChunk; }
+
+  private:
+	struct Chunk
+	{
+		Chunk* next;
+	};
+
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	static constexpr size_t alignUp(size_t size, size_t alignment) { return (size + alignment - 1) & ~(alignment - 1); }
+
+	void addChunk()
+	{
+		// The slots start after the header, at the slot alignment
+		const size_t header = alignUp(sizeof(Chunk), m_alignment);
+		void*		 memory = ::operator new(header + m_stride * m_slotsPerChunk, std::align_val_t(m_alignment));
+		auto*		 chunk	= new (memory) Chunk { m_chunks };
+		m_chunks			= chunk;
+		++m_chunkCount;
+
+		// Thread the new slots onto the free list back to front, so they are handed out in address order
+		std::byte* slots = reinterpret_cast<std::byte*>(chunk) + header;
+		for (size_t i = m_slotsPerChunk; i-- > 0;)
+			m_freeSlots = new (slots + i * m_stride) FreeSlot { m_freeSlots };
+	}
+
+	size_t	  m_alignment;
+	size_t	  m_stride;
+	size_t	  m_slotsPerChunk;
+	Chunk*	  m_chunks	   = nullptr;
+	FreeSlot* m_freeSlots  = nullptr;
+	size_t	  m_chunkCount = 0;
+	size_t	  m_liveCount  = 0;
+};
+
+/**
+ * @brief A @ref FixedPool of objects of one type.
+ *
+ * @details
+ * For objects that are created and destroyed often and individually, e.g. per entity or per
+ * request, without a heap allocation each time:
+ * @code
+ * ObjectPool<Particle> particles;
+ * particles.reserve(4096);
+ * Particle* particle = particles.create(position, velocity);
+ * ...
+ * particles.destroy(particle);
+ * @endcode
+ *
+ * @note Objects still alive when the pool is destroyed are not destructed, destroy them first.
+ *
+ * Not thread-safe.
+ */
+template<typename T>
+class ObjectPool
+{
+  public:
+	/**
+	 * @brief Construct a new ObjectPool
+	 *
+	 * @param objectsPerChunk How many objects each chunk holds
+	 */
+	explicit ObjectPool(size_t objectsPerChunk = FixedPool::defaultSlotsPerChunk):
+		m_pool(sizeof(T), alignof(T), objectsPerChunk)
+	{
+	}
+
+	/**
+	 * @brief Construct an object in the pool
+	 *
+	 * @param args The constructor arguments
+	 * @return A pointer to the object, pass it to @ref destroy
+	 */
+	template<typename... Args>
+	T* create(Args&&... args)
+	{
+		return new (m_pool.allocate()) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Destruct an object and return its memory to the pool
+	 *
+	 * @param object An object created by this pool, nullptr is ignored
+	 */
+	void destroy(T* object)
+	{
+		if (!object)
+			return;
+		object->~T();
+		m_pool.free(object);
+	}
+
+	/**
+	 * @brief Make room for a number of objects without allocating later
+	 *
+	 * @param count The number of objects, alive or not
+	 */
+	void reserve(size_t count) { m_pool.reserve(count); }
+
+	size_t getLiveCount() const { return m_pool.getLiveCount(); }
+	size_t getCapacity() const { return m_pool.getCapacity(); }
+
+  private:
+	FixedPool m_pool;
+};
+}	 // namespace zaphod
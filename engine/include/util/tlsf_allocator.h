@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace zaphod
+{
+/**
+ * @brief A two-level segregated fit allocator of ranges in an address space it does not own.
+ *
+ * @details
+ * Hands out offsets into a range of @ref getSize units, e.g. bytes of a VkDeviceMemory block, and
+ * keeps its bookkeeping on the CPU, so the memory itself is never touched. Free ranges are sorted
+ * into size classes: a power of two picks the first level, and each power of two is split
+ * linearly into @ref secondLevelCount classes. A bitmap per level finds a class with a range large
+ * enough in constant time, with a few bit scans, so allocating and freeing take the same time
+ * however many ranges there are. Freed ranges are merged with free neighbours immediately.
+ *
+ * The waste is bounded by the class granularity: a range is at most 1/@ref secondLevelCount
+ * larger than requested, plus the alignment.
+ *
+ * Not thread-safe.
+ */
+class TlsfAllocator
+{
+  public:
+	static constexpr uint32_t secondLevelLog2  = 5;
+	static constexpr uint32_t secondLevelCount = 1 << secondLevelLog2;
+	static constexpr uint32_t firstLevelCount  = 64 - secondLevelLog2 + 1;
+	static constexpr uint64_t invalidOffset	   = UINT64_MAX;
+	static constexpr uint32_t invalidNode	   = UINT32_MAX;
+
+	/**
+	 * @brief An allocated range, pass it back to @ref free
+	 */
+	struct Allocation
+	{
+		uint64_t offset = invalidOffset;
+		uint32_t node	= invalidNode;
+
+		bool isValid() const { return offset != invalidOffset; }
+	};
+
+	/**
+	 * @brief Construct a new TlsfAllocator
+	 *
+	 * @param size The size of the range to allocate from
+	 */
+	explicit TlsfAllocator(uint64_t size = 0) { reset(size); }
+
+	/**
+	 * @brief Forget every allocation and start over with one free range
+	 *
+	 * @param size The size of the range to allocate from
+	 */
+	void reset(uint64_t size)
+	{
+		m_nodes.clear();
+		m_unusedNodes.clear();
+		m_firstLevelBitmap = 0;
+		std::fill(std::begin(m_secondLevelBitmaps), std::end(m_secondLevelBitmaps), 0u);
+		for (auto& heads : m_freeHeads)
+			std::fill(std::begin(heads), std::end(heads), invalidNode);
+		m_size			  = size;
+		m_freeSize		  = 0;
+		m_allocationCount = 0;
+		if (size > 0)
+			insertFree(createNode(0, size, invalidNode, invalidNode));
+	}
+
+	/**
+	 * @brief Allocate a range
+	 *
+	 * @param size The size of the range, more than 0
+	 * @param alignment The alignment of its offset, a power of two
+	 * @return The range, invalid if there is no free range large enough
+	 */
+	Allocation allocate(uint64_t size, uint64_t alignment = 1)
+	{
+		alignment = std::max<uint64_t>(alignment, 1);
+		if (size == 0 || size > m_freeSize || alignment - 1 > m_size - size)
+			return {};
+
+		// Rounding the request up to the next class makes every range in the class found large enough
+		const uint64_t requiredSize = size + alignment - 1;
+		uint64_t	   searchSize	= requiredSize;
+		if (searchSize >= secondLevelCount)
+			searchSize += (uint64_t(1) << (std::bit_width(searchSize) - 1 - secondLevelLog2)) - 1;
+		uint32_t firstLevel, secondLevel;
+		mapping(searchSize, firstLevel, secondLevel);
+		uint32_t index = findFree(firstLevel, secondLevel);
+		if (index == invalidNode)
+		{
+			// Only the request's own class may still have a range that fits, e.g. when it is the whole space
+			mapping(requiredSize, firstLevel, secondLevel);
+			index = m_freeHeads[firstLevel][secondLevel];
+			while (index != invalidNode && !fits(m_nodes[index], size, alignment))
+				index = m_nodes[index].nextFree;
+			if (index == invalidNode)
+				return {};
+		}
+		removeFree(index);
+
+		// Give the space in front of the aligned offset back, then what is left behind the allocation
+		const uint64_t alignedOffset = (m_nodes[index].offset + alignment - 1) & ~(alignment - 1);
+		if (const uint64_t padding = alignedOffset - m_nodes[index].offset; padding > 0)
+		{
+			const uint32_t front = createNode(m_nodes[index].offset, padding, m_nodes[index].previous, index);
+			if (m_nodes[front].previous != invalidNode)
+				m_nodes[m_nodes[front].previous].next = front;
+			m_nodes[index].previous = front;
+			m_nodes[index].offset	= alignedOffset;
+			m_nodes[index].size -= padding;
+			insertFree(front);
+		}
+		if (const uint64_t remainder = m_nodes[index].size - size; remainder > 0)
+		{
+			const uint32_t back = createNode(alignedOffset + size, remainder, index, m_nodes[index].next);
+			if (m_nodes[back].next != invalidNode)
+				m_nodes[m_nodes[back].next].previous = back;
+			m_nodes[index].next = back;
+			m_nodes[index].size = size;
+			insertFree(back);
+		}
+
+		++m_allocationCount;
+		return { alignedOffset, index };
+	}
+
+	/**
+	 * @brief Free a range, merging it with the free ranges around it
+	 *
+	 * @param allocation The range returned by @ref allocate
+	 */
+	void free(Allocation allocation)
+	{
+		if (!allocation.isValid())
+			return;
+
+		uint32_t index = allocation.node;
+		--m_allocationCount;
+		if (const uint32_t previous = m_nodes[index].previous; previous != invalidNode && m_nodes[previous].isFree)
+		{
+			removeFree(previous);
+			m_nodes[previous].size += m_nodes[index].size;
+			unlink(index);
+			index = previous;
+		}
+		if (const uint32_t next = m_nodes[index].next; next != invalidNode && m_nodes[next].isFree)
+		{
+			removeFree(next);
+			m_nodes[index].size += m_nodes[next].size;
+			unlink(next);
+		}
+		insertFree(index);
+	}
+
+	uint64_t getSize() const { return m_size; }
+	uint64_t getFreeSize() const { return m_freeSize; }
+	uint32_t getAllocationCount() const { return m_allocationCount; }
+	bool	 isEmpty() const { return m_allocationCount == 0; }
+	/**
+	 * @brief Get the size of the largest free range, what the largest unaligned allocation could get
+	 *
+	 * @return The size
+	 */
+	uint64_t getLargestFreeRange() const
+	{
+		if (m_firstLevelBitmap == 0)
+			return 0;
+		// The largest range is in the highest class that has any
+		const uint32_t firstLevel  = 63 - std::countl_zero(m_firstLevelBitmap);
+		const uint32_t secondLevel = 31 - std::countl_zero(m_secondLevelBitmaps[firstLevel]);
+		uint64_t	   largest	   = 0;
+		for (uint32_t i = m_freeHeads[firstLevel][secondLevel]; i != invalidNode; i = m_nodes[i].nextFree)
+			largest = std::max(largest, m_nodes[i].size);
+		return largest;
+	}
+
+  private:
+	struct Node
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t previous;	  // The ranges before and after it in the address space
+		uint32_t next;
+		uint32_t previousFree = invalidNode;	// The ranges in the same free list
+		uint32_t nextFree	  = invalidNode;
+		bool	 isFree		  = false;
+	};
+
+	static void mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		if (size < secondLevelCount)
+		{
+			firstLevel	= 0;
+			secondLevel = static_cast<uint32_t>(size);
+			return;
+		}
+		const uint32_t highestBit = static_cast<uint32_t>(std::bit_width(size)) - 1;
+		firstLevel				  = highestBit - secondLevelLog2 + 1;
+		secondLevel				  = static_cast<uint32_t>(size >> (highestBit - secondLevelLog2)) - secondLevelCount;
+	}
+
+	static bool fits(const Node& node, uint64_t size, uint64_t alignment)
+	{
+		const uint64_t alignedOffset = (node.offset + alignment - 1) & ~(alignment - 1);
+		return alignedOffset - node.offset + size <= node.size;
+	}
+
+	uint32_t findFree(uint32_t firstLevel, uint32_t secondLevel) const
+	{
+		if (firstLevel >= firstLevelCount)
+			return invalidNode;
+		uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			const uint64_t firstLevelMap = firstLevel + 1 < 64 ? m_firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+			if (firstLevelMap == 0)
+				return invalidNode;
+			firstLevel	   = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+			secondLevelMap = m_secondLevelBitmaps[firstLevel];
+		}
+		return m_freeHeads[firstLevel][std::countr_zero(secondLevelMap)];
+	}
+
+	uint32_t createNode(uint64_t offset, uint64_t size, uint32_t previous, uint32_t next)
+	{
+		uint32_t index;
+		if (!m_unusedNodes.empty())
+		{
+			index = m_unusedNodes.back();
+			m_unusedNodes.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+		m_nodes[index] = Node { offset, size, previous, next };
+		return index;
+	}
+
+	// Takes a range out of the address space list, its neighbour has absorbed it
+	void unlink(uint32_t index)
+	{
+		const Node& node = m_nodes[index];
+		if (node.previous != invalidNode)
+			m_nodes[node.previous].next = node.next;
+		if (node.next != invalidNode)
+			m_nodes[node.next].previous = node.previous;
+		m_unusedNodes.push_back(index);
+	}
+
+	void insertFree(uint32_t index)
+	{
+		Node&	 node = m_nodes[index];
+		uint32_t firstLevel, secondLevel;
+		mapping(node.size, firstLevel, secondLevel);
+		uint32_t& head	  = m_freeHeads[firstLevel][secondLevel];
+		node.isFree		  = true;
+		node.previousFree = invalidNode;
+		node.nextFree	  = head;
+		if (head != invalidNode)
+			m_nodes[head].previousFree = index;
+		head = index;
+		m_firstLevelBitmap |= uint64_t(1) << firstLevel;
+		m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+		m_freeSize += node.size;
+	}
+
+	void removeFree(uint32_t index)
+	{
+		Node&	 node = m_nodes[index];
+		uint32_t firstLevel, secondLevel;
+		mapping(node.size, firstLevel, secondLevel);
+		if (node.previousFree != invalidNode)
+			m_nodes[node.previousFree].nextFree = node.nextFree;
+		else
+			m_freeHeads[firstLevel][secondLevel] = node.nextFree;
+		if (node.nextFree != invalidNode)
+			m_nodes[node.nextFree].previousFree = node.previousFree;
+		if (m_freeHeads[firstLevel][secondLevel] == invalidNode)
+		{
+			m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (m_secondLevelBitmaps[firstLevel] == 0)
+				m_firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+		}
+		node.isFree = false;
+		m_freeSize -= node.size;
+	}
+
+	std::vector<Node>	  m_nodes;
+	std::vector<uint32_t> m_unusedNodes;	// Indices of merged nodes, reused before growing m_nodes
+	uint64_t			  m_firstLevelBitmap = 0;
+	uint32_t			  m_secondLevelBitmaps[firstLevelCount] {};
+	uint32_t			  m_freeHeads[firstLevelCount][secondLevelCount];
+	uint64_t			  m_size			= 0;
+	uint64_t			  m_freeSize		= 0;
+	uint32_t			  m_allocationCount = 0;
+};
+}	 // namespace zaphod
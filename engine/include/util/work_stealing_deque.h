@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace zaphod
+{
+/**
+ * @brief A bounded Chase-Lev work-stealing deque.
+ *
+ * @details
+ * The owning thread pushes and pops at the bottom without contention, while other threads steal
+ * from the top with a single compare-and-swap. Only the last remaining element is contended
+ * between the owner and thieves. The memory ordering follows Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (2013).
+ *
+ * @note The capacity is rounded up to a power of two and the deque does not grow.
+ *
+ * @tparam T The element type, must be trivially copyable and lock-free as an atomic (e.g. a pointer)
+ */
+template<typename T>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free,
+				  "WorkStealingDeque elements must be small trivially copyable values");
+
+  public:
+	/**
+	 * @brief Construct a new WorkStealingDeque
+	 *
+	 * @param capacity The minimum number of elements the deque can hold
+	 */
+	explicit WorkStealingDeque(size_t capacity):
+		m_capacity(std::bit_ceil(capacity < 2 ? size_t(2) : capacity)),
+		m_mask(m_capacity - 1),
+		m_buffer(std::make_unique<std::atomic<T>[]>(m_capacity))
+	{
+	}
+
+	// Non-copyable, non-movable
+	WorkStealingDeque(const WorkStealingDeque&)			   = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	/**
+	 * @brief Push an element at the bottom, may only be called by the owning thread
+	 *
+	 * @param value The element to push
+	 * @return true if the element was pushed, false if the deque is full
+	 */
+	bool push(T value)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		int64_t top	   = m_top.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(m_capacity))
+			return false;
+
+		m_buffer[static_cast<size_t>(bottom) & m_mask].store(value, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/**
+	 * @brief Pop the most recently pushed element, may only be called by the owning thread
+	 *
+	 * @param value Receives the element
+	 * @return true if an element was popped, false if the deque is empty
+	 */
+	bool pop(T& value)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);	  // Empty
+			return false;
+		}
+
+		value = m_buffer[static_cast<size_t>(bottom) & m_mask].load(std::memory_order_relaxed);
+		if (top != bottom)
+			return true;
+
+		// Last element, race the thieves for it
+		bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	/**
+	 * @brief Steal the oldest element, may be called by any thread
+	 *
+	 * @param value Receives the element
+	 * @return true if an element was stolen, false if the deque is empty or another thread won the race
+	 */
+	bool steal(T& value)
+	{
+		int64_t top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+			return false;
+
+		value = m_buffer[static_cast<size_t>(top) & m_mask].load(std::memory_order_relaxed);
+		return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Check if the deque looks empty, the result may be stale immediately
+	 *
+	 * @return true if the deque was empty when checked
+	 */
+	bool isEmpty() const { return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed); }
+
+	size_t getCapacity() const { return m_capacity; }
+
+  private:
+	const size_t					  m_capacity;
+	const size_t					  m_mask;
+	std::unique_ptr<std::atomic<T>[]> m_buffer;
+	alignas(64) std::atomic<int64_t> m_top { 0 };
+	alignas(64) std::atomic<int64_t> m_bottom { 0 };
+};
+}	 // namespace zaphod
@@ -0,0 +1,97 @@
+#include "asset/asset_loader.h"
+
+#include "core/job_system.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace zaphod::asset
+{
+namespace
+{
+using TextureRegions = std::array<VkBufferImageCopy, asset_package::maxMipCount>;
+
+// The copies of every mip level, false if the entry is not a texture the data of which matches its info
+bool getTextureRegions(const AssetPackage::Entry& entry, TextureRegions& regions)
+{
+	if (entry.type != asset_package::AssetType::TEXTURE)
+		return false;
+	const asset_package::TextureInfo info = asset_package::getInfo<asset_package::TextureInfo>(entry);
+	if (info.width == 0 || info.height == 0 || info.texelSize == 0 || info.mipCount == 0
+		|| info.mipCount > static_cast<uint32_t>(std::bit_width(std::max(info.width, info.height)))
+		|| asset_package::getMipOffset(info, info.mipCount) != entry.size)
+		return false;
+
+	for (uint32_t level = 0; level < info.mipCount; ++level)
+	{
+		VkBufferImageCopy& region				= regions[level];
+		region									= {};
+		region.bufferOffset						= asset_package::getMipOffset(info, level);
+		region.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel		= level;
+		region.imageSubresource.baseArrayLayer	= 0;
+		region.imageSubresource.layerCount		= 1;
+		region.imageExtent						= { asset_package::getMipExtent(info.width, level),
+													asset_package::getMipExtent(info.height, level), 1 };
+	}
+	return true;
+}
+}	 // namespace
+
+void AssetLoader::loadBuffer(const AssetPackage& package, const AssetPackage::Entry& entry, VkBuffer buffer,
+							 VkDeviceSize offset, Load& load, JobCounter& counter)
+{
+	package.prefetch(entry);
+	m_jobs.schedule(
+		[this, &package, &entry, buffer, offset, &load]
+		{
+			ZAPHOD_PROFILE_ZONE("AssetLoader::loadBuffer");
+
+			// A failed read is reported as itself rather than as the upload's FAILURE
+			Result readResult;
+			auto   read = [&](void* staging)
+			{
+				readResult = package.read(entry, staging);
+				return readResult.isSuccess();
+			};
+			load.result = m_uploads.uploadBuffer(buffer, offset, entry.size, read, load.ticket);
+			if (readResult.isFailure())
+				load.result = readResult;
+		},
+		&counter);
+}
+
+void AssetLoader::loadTexture(const AssetPackage& package, const AssetPackage::Entry& entry, VkImage image,
+							  VkImageLayout finalLayout, Load& load, JobCounter& counter)
+{
+	package.prefetch(entry);
+	m_jobs.schedule(
+		[this, &package, &entry, image, finalLayout, &load]
+		{
+			ZAPHOD_PROFILE_ZONE("AssetLoader::loadTexture");
+
+			TextureRegions regions;
+			if (!getTextureRegions(entry, regions))
+			{
+				load.result =
+					Result(Result::Code::INVALID_ARGUMENT, std::string(package.getName(entry)) + " is not a valid texture");
+				return;
+			}
+			const uint32_t mipCount = asset_package::getInfo<asset_package::TextureInfo>(entry).mipCount;
+
+			Result readResult;
+			auto   read = [&](void* staging)
+			{
+				readResult = package.read(entry, staging);
+				return readResult.isSuccess();
+			};
+			load.result = m_uploads.uploadImage(image, std::span(regions.data(), mipCount), finalLayout, entry.size, read,
+												load.ticket);
+			if (readResult.isFailure())
+				load.result = readResult;
+		},
+		&counter);
+}
+}	 // namespace zaphod::asset
@@ -0,0 +1,328 @@
+#include "asset/asset_package.h"
+
+#include "util/hash.h"
+#include "util/lz4.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace zaphod::asset
+{
+namespace asset_package
+{
+namespace
+{
+template<typename T>
+void append(std::string& data, const T& value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}	 // namespace
+
+std::string compressBlob(std::string_view data)
+{
+	std::string		  blob;
+	std::vector<char> block(lz4CompressBound(lz4ChunkSize));
+	for (size_t offset = 0; offset < data.size(); offset += lz4ChunkSize)
+	{
+		const size_t chunkSize = std::min<size_t>(data.size() - offset, lz4ChunkSize);
+		size_t		 blockSize = lz4Compress(data.data() + offset, chunkSize, block.data(), block.size());
+		uint32_t	 header	   = static_cast<uint32_t>(blockSize);
+		const char*	 bytes	   = block.data();
+		if (blockSize == 0 || blockSize >= chunkSize)
+		{
+			header	  = static_cast<uint32_t>(chunkSize) | rawChunkBit;
+			bytes	  = data.data() + offset;
+			blockSize = chunkSize;
+		}
+		append(blob, header);
+		blob.append(bytes, blockSize);
+	}
+	return blob.size() + blobAlignment <= data.size() ? blob : std::string();
+}
+
+Result buildPackage(std::vector<CookedAsset>& assets, bool compress, std::string& file)
+{
+	// AssetPackage finds assets by binary search
+	std::sort(assets.begin(), assets.end(), [](const CookedAsset& a, const CookedAsset& b) { return a.name < b.name; });
+	for (size_t i = 1; i < assets.size(); ++i)
+	{
+		if (assets[i].name == assets[i - 1].name)
+			return Result(Result::Code::INVALID_ARGUMENT, "More than one asset is named " + assets[i].name);
+	}
+
+	Header header {};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version	  = version;
+	header.entryCount = static_cast<uint32_t>(assets.size());
+
+	// Header, entry table and names, then every blob on a page boundary
+	std::vector<std::string> blobs(assets.size());
+	size_t					 offset = sizeof(header) + assets.size() * sizeof(Entry);
+	for (CookedAsset& asset : assets)
+	{
+		asset.entry.nameOffset = static_cast<uint32_t>(offset);
+		asset.entry.nameLength = static_cast<uint32_t>(asset.name.size());
+		offset += asset.name.size();
+	}
+	for (size_t i = 0; i < assets.size(); ++i)
+	{
+		Entry& entry	  = assets[i].entry;
+		entry.compression = Compression::NONE;
+		if (compress)
+			blobs[i] = compressBlob(assets[i].data);
+		if (blobs[i].empty())
+			blobs[i] = std::move(assets[i].data);
+		else
+			entry.compression = Compression::LZ4;
+
+		entry.size		 = entry.compression == Compression::LZ4 ? assets[i].data.size() : blobs[i].size();
+		offset			 = (offset + blobAlignment - 1) & ~(blobAlignment - 1);
+		entry.offset	 = offset;
+		entry.storedSize = blobs[i].size();
+		entry.hash		 = hashBytes(blobs[i].data(), blobs[i].size());
+		offset += blobs[i].size();
+	}
+
+	file.clear();
+	file.reserve(offset);
+	append(file, header);
+	for (const CookedAsset& asset : assets)
+		append(file, asset.entry);
+	for (const CookedAsset& asset : assets)
+		file += asset.name;
+	for (size_t i = 0; i < assets.size(); ++i)
+	{
+		file.resize(assets[i].entry.offset, '\0');
+		file += blobs[i];
+	}
+	return Result(Result::Code::SUCCESS);
+}
+}	 // namespace asset_package
+
+struct AssetPackage::Mapping
+{
+#ifdef _WIN32
+	HANDLE file	   = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+	void*  base = nullptr;
+	size_t size = 0;
+};
+
+AssetPackage::AssetPackage() = default;
+
+AssetPackage::~AssetPackage()
+{
+	close();
+}
+
+Result AssetPackage::open(const std::filesystem::path& path)
+{
+	// Maps the whole file read only, whatever was opened before a failure is left for close
+	auto mapFile = [&path](Mapping& mapping)
+	{
+#ifdef _WIN32
+		mapping.file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+								   nullptr);
+		if (mapping.file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(mapping.file, &size) || size.QuadPart == 0)
+			return false;
+		mapping.mapping = CreateFileMappingW(mapping.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping.mapping)
+			return false;
+		mapping.base = MapViewOfFile(mapping.mapping, FILE_MAP_READ, 0, 0, 0);
+		mapping.size = static_cast<size_t>(size.QuadPart);
+		return mapping.base != nullptr;
+#else
+		mapping.file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (mapping.file < 0)
+			return false;
+		struct stat status;
+		if (fstat(mapping.file, &status) != 0 || status.st_size == 0)
+			return false;
+		void* base = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, mapping.file, 0);
+		if (base == MAP_FAILED)
+			return false;
+		mapping.base = base;
+		mapping.size = static_cast<size_t>(status.st_size);
+		return true;
+#endif
+	};
+
+	close();
+	m_mapping = std::make_unique<Mapping>();
+	if (!mapFile(*m_mapping))
+	{
+		close();
+		return Result(Result::Code::IO_ERROR, "Failed to map " + path.string());
+	}
+
+	const auto*	 data	 = static_cast<const std::byte*>(m_mapping->base);
+	const size_t size	 = m_mapping->size;
+	auto		 invalid = [this, &path](const char* reason)
+	{
+		close();
+		return Result(Result::Code::INVALID_ARGUMENT, path.string() + " is not a valid asset package: " + reason);
+	};
+
+	asset_package::Header header;
+	if (size < sizeof(header))
+		return invalid("truncated header");
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, asset_package::magic, sizeof(header.magic)) != 0)
+		return invalid("wrong magic");
+	if (header.version != asset_package::version)
+		return invalid("unsupported version");
+	if (header.entryCount > (size - sizeof(header)) / sizeof(Entry))
+		return invalid("truncated entry table");
+
+	// The mapping is page aligned, so the table right after the header is aligned for its entries
+	const std::span<const Entry> entries(reinterpret_cast<const Entry*>(data + sizeof(header)), header.entryCount);
+	std::string_view			 previousName;
+	for (const Entry& entry : entries)
+	{
+		if (size_t(entry.nameOffset) + entry.nameLength > size || entry.offset > size || entry.storedSize > size - entry.offset)
+			return invalid("entry out of bounds");
+		if (entry.offset % asset_package::blobAlignment != 0)
+			return invalid("unaligned blob");
+		if (entry.compression != asset_package::Compression::NONE && entry.compression != asset_package::Compression::LZ4)
+			return invalid("unknown compression");
+		if (entry.compression == asset_package::Compression::NONE && entry.storedSize != entry.size)
+			return invalid("uncompressed blob of the wrong size");
+
+		// find relies on the order
+		const std::string_view name(reinterpret_cast<const char*>(data) + entry.nameOffset, entry.nameLength);
+		if (&entry != entries.data() && name <= previousName)
+			return invalid("entries not sorted by name");
+		previousName = name;
+	}
+
+	m_data	  = data;
+	m_size	  = size;
+	m_entries = entries;
+	return Result(Result::Code::SUCCESS);
+}
+
+void AssetPackage::close()
+{
+	if (m_mapping)
+	{
+#ifdef _WIN32
+		if (m_mapping->base)
+			UnmapViewOfFile(m_mapping->base);
+		if (m_mapping->mapping)
+			CloseHandle(m_mapping->mapping);
+		if (m_mapping->file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_mapping->file);
+#else
+		if (m_mapping->base)
+			munmap(m_mapping->base, m_mapping->size);
+		if (m_mapping->file >= 0)
+			::close(m_mapping->file);
+#endif
+		m_mapping.reset();
+	}
+	m_data	  = nullptr;
+	m_size	  = 0;
+	m_entries = {};
+}
+
+const AssetPackage::Entry* AssetPackage::find(std::string_view name) const
+{
+	auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name,
+							   [this](const Entry& entry, std::string_view key) { return getName(entry) < key; });
+	return it != m_entries.end() && getName(*it) == name ? &*it : nullptr;
+}
+
+std::string_view AssetPackage::getName(const Entry& entry) const
+{
+	return std::string_view(reinterpret_cast<const char*>(m_data) + entry.nameOffset, entry.nameLength);
+}
+
+std::span<const std::byte> AssetPackage::getBlob(const Entry& entry) const
+{
+	return std::span<const std::byte>(m_data + entry.offset, entry.storedSize);
+}
+
+void AssetPackage::prefetch(const Entry& entry) const
+{
+	if (entry.storedSize == 0)
+		return;
+
+	// Blobs start on a page, which is all either call needs
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range { const_cast<std::byte*>(m_data + entry.offset), entry.storedSize };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise(const_cast<std::byte*>(m_data + entry.offset), entry.storedSize, MADV_WILLNEED);
+#endif
+}
+
+Result AssetPackage::read(const Entry& entry, void* destination) const
+{
+	const std::span<const std::byte> blob = getBlob(entry);
+	if (entry.compression == asset_package::Compression::NONE)
+	{
+		std::memcpy(destination, blob.data(), blob.size());
+		return Result(Result::Code::SUCCESS);
+	}
+
+	// Each chunk is decompressed where it stays in the cache, as LZ4 reads back what it has written
+	thread_local std::vector<std::byte> scratch(asset_package::lz4ChunkSize);
+	const std::byte*					in		  = blob.data();
+	const std::byte* const				end		  = in + blob.size();
+	auto*								out		  = static_cast<std::byte*>(destination);
+	auto								corrupted = [this, &entry]
+	{ return Result(Result::Code::INVALID_ARGUMENT, "Corrupted asset " + std::string(getName(entry))); };
+	for (uint64_t remaining = entry.size; remaining > 0;)
+	{
+		const size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(remaining, asset_package::lz4ChunkSize));
+		uint32_t	 blockSize;
+		if (static_cast<size_t>(end - in) < sizeof(blockSize))
+			return corrupted();
+		std::memcpy(&blockSize, in, sizeof(blockSize));
+		in += sizeof(blockSize);
+
+		const bool isRaw = (blockSize & asset_package::rawChunkBit) != 0;
+		blockSize &= ~asset_package::rawChunkBit;
+		if (blockSize > static_cast<size_t>(end - in) || (isRaw && blockSize != chunkSize))
+			return corrupted();
+		if (isRaw)
+			std::memcpy(out, in, chunkSize);
+		else if (lz4Decompress(in, blockSize, scratch.data(), chunkSize))
+			std::memcpy(out, scratch.data(), chunkSize);
+		else
+			return corrupted();
+		in += blockSize;
+		out += chunkSize;
+		remaining -= chunkSize;
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+Result AssetPackage::verify(const Entry& entry) const
+{
+	const std::span<const std::byte> blob = getBlob(entry);
+	if (hashBytes(blob.data(), blob.size()) != entry.hash)
+		return Result(Result::Code::INVALID_ARGUMENT, "Corrupted asset " + std::string(getName(entry)));
+	return Result(Result::Code::SUCCESS);
+}
+}	 // namespace zaphod::asset
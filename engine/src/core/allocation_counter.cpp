@@ -0,0 +1,167 @@
+#include "core/allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace zaphod
+{
+namespace
+{
+// Constant-initialized, so allocations during static initialization are counted as well
+std::atomic<uint64_t> allocationCount { 0 };
+
+#ifdef ZAPHOD_COUNT_ALLOCATIONS
+void* allocate(size_t size) noexcept
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (size == 0)
+		size = 1;
+	for (;;)
+	{
+		if (void* memory = std::malloc(size))
+			return memory;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			return nullptr;
+		handler();
+	}
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) noexcept
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	const size_t bytes = static_cast<size_t>(alignment);
+	// aligned_alloc wants a multiple of the alignment
+	size = size == 0 ? bytes : (size + bytes - 1) & ~(bytes - 1);
+	for (;;)
+	{
+#ifdef _WIN32
+		if (void* memory = _aligned_malloc(size, bytes))
+			return memory;
+#else
+		if (void* memory = std::aligned_alloc(bytes, size))
+			return memory;
+#endif
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			return nullptr;
+		handler();
+	}
+}
+
+void freeAligned(void* memory) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+#endif
+}	 // namespace
+
+uint64_t getHeapAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+bool isHeapAllocationCounted()
+{
+#ifdef ZAPHOD_COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+}	 // namespace zaphod
+
+#ifdef ZAPHOD_COUNT_ALLOCATIONS
+// The replacements of every form of the global operator new and delete, defined once for the program
+void* operator new(size_t size)
+{
+	if (void* memory = zaphod::allocate(size))
+		return memory;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return zaphod::allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return zaphod::allocate(size);
+}
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* memory = zaphod::allocateAligned(size, alignment))
+		return memory;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return zaphod::allocateAligned(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return zaphod::allocateAligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	zaphod::freeAligned(memory);
+}
+#endif
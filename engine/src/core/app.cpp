@@ -1,9 +1,12 @@
 #include "core/app.h"
 
+#include "core/allocation_counter.h"
 #include "core/glfw_common.h"
 #include "core/logger.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 namespace zaphod {
     bool App::initialize(int argc, char** argv) {
@@ -11,9 +14,16 @@ namespace zaphod {
 
         // Engine-level initialization (GLFW, Vulkan, etc.)
         // Initialize GLFW
-        if (!glfwInit()) {
+        if (!m_headless && !glfwInit()) {
             return false;
-		}
+        }
+
+        // Created on this thread, which becomes the job system's main thread
+        m_jobSystem = std::make_unique<JobSystem>();
+        m_commandBuffers.resize(m_jobSystem->getWorkerCount());
+
+        // F11 captures a profile, F12 logs frame time percentiles
+        m_profilerKeySubscription = m_eventBus.subscribe<events::KeyEvent, &App::onProfilerKey>(*this);
 
         m_initialized = onInitialize();
         return m_initialized;
@@ -24,45 +34,286 @@ namespace zaphod {
 
         m_running = true;
 
-        auto lastTime = std::chrono::high_resolution_clock::now();
+        auto logger = logging::SimpleLoggerFactory().create();
+        logger->setLogLevelFlag(logging::Logger::LogLevel::WARN);
+        logger->setLogLevelFlag(logging::Logger::LogLevel::ERROR);
+        logger->setEventSink(&m_logEventSink);
 
-        m_windows.emplace_back(std::make_unique<Window>(1280, 720, "Zaphod Engine"));
+        profiling::Profiler& profiler = profiling::Profiler::get();
+        profiler.setThreadName("Main");
 
-        auto logger = logging::SimpleLoggerFactory().create();
+        // Without a window the renderer stays uninitialized, and beginFrame never returns a frame
+        if (!m_headless) {
+            if (m_windows.empty() && !openWindow(1280, 720, "Zaphod Engine")) {
+                logger->log<logging::Logger::LogLevel::ERROR>("Failed to open the main window");
+                shutdown();
+                return -1;
+            }
+
+            // Record tasks run on the job workers, each with its own command pools
+            m_renderer.setJobSystem(m_jobSystem.get());
+            Result rendererResult = m_renderer.initialize(*m_windows.front());
+            if (rendererResult.isFailure()) {
+                logger->log<logging::Logger::LogLevel::ERROR>("Failed to initialize the renderer: {}", rendererResult.message);
+                shutdown();
+                return -1;
+            }
+            // Windows onInitialize opened besides the main one share its device
+            for (size_t i = 1; i < m_windows.size(); ++i) {
+                Result windowResult = m_renderer.addWindow(*m_windows[i]);
+                if (windowResult.isFailure()) {
+                    logger->log<logging::Logger::LogLevel::ERROR>("Failed to render to a window: {}", windowResult.message);
+                }
+            }
+
+            // VSYNC pacing follows the refresh rate of the display the window opens on
+            if (GLFWmonitor* monitor = glfwGetPrimaryMonitor()) {
+                if (const GLFWvidmode* videoMode = glfwGetVideoMode(monitor)) {
+                    m_framePacer.setRefreshRate(videoMode->refreshRate);
+                }
+            }
+        }
 
+        // Taken after window and renderer setup, which would otherwise count towards the first frame
+        auto lastTime = std::chrono::steady_clock::now();
+        m_allocationCount = getHeapAllocationCount();
         while (m_running) {
-            auto currentTime = std::chrono::high_resolution_clock::now();
-            float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
+            // Release last frame's arena allocations and count what the last frame took from the heap
+            m_frameArena.reset();
+            const uint64_t allocationCount = getHeapAllocationCount();
+            m_frameAllocationCount = allocationCount - m_allocationCount;
+            m_allocationCount = allocationCount;
+
+            auto currentTime = std::chrono::steady_clock::now();
+            double frameTime = std::chrono::duration<double>(currentTime - lastTime).count();
             lastTime = currentTime;
 
-            // Handle window events, input, etc.
+            // Handle window events, input, etc. of every window at once. While idle, sleep until an
+            // event arrives (or the idle timeout passes) instead of spinning.
+            const bool idle = isIdle();
+            if (!m_windows.empty()) {
+                ZAPHOD_PROFILE_ZONE("App::pollEvents");
+                m_isPollingEvents = true;
+                m_pumpStart = FramePacer::Clock::now();
+                if (idle) {
+                    Window::waitEvents(m_framePacer.getIdleTimeout());
+                } else {
+                    Window::pollEvents();
+                }
+                m_isPollingEvents = false;
+            }
+
+            // Publish this frame's input snapshot before anything reads it
+            {
+                ZAPHOD_PROFILE_ZONE("InputSystem::update");
+                m_inputSystem.update();
+            }
+
+            // Deliver, in one batch, everything published by this frame's window callbacks, the previous
+            // frame's update and render, and the records logged since. Events published from here on
+            // wait for the next frame.
+            {
+                ZAPHOD_PROFILE_ZONE("EventBus::dispatch");
+                m_logEventSink.publish(m_eventBus);
+                m_eventBus.dispatch();
+            }
+
+            // Run work that jobs handed back to the main thread (GLFW calls, etc.)
+            {
+                ZAPHOD_PROFILE_ZONE("JobSystem::runMainThreadJobs");
+                m_jobSystem->runMainThreadJobs();
+            }
+
+            m_alpha = advanceSimulation(frameTime);
+            renderFrame();
+
+            if (m_isCaptureToggled) {
+                if (!profiler.isCapturing()) {
+                    profiler.startCapture();
+                } else {
+                    profiler.stopCapture();
+                    Result exportResult = profiler.exportChromeTrace(m_profileCapturePath);
+                    if (exportResult.isFailure()) {
+                        logger->log<logging::Logger::LogLevel::ERROR>("Failed to export the profile: {}", exportResult.message);
+                    } else {
+                        logger->report("Wrote the profile to {}, {} zones dropped",
+                                       m_profileCapturePath.string(),
+                                       profiler.getDroppedZoneCount());
+                    }
+                }
+                m_isCaptureToggled = false;
+            }
+            if (m_areStatsRequested) {
+                auto round = [](double milliseconds) { return std::round(milliseconds * 100.0) / 100.0; };
+                const profiling::FrameStats cpu = profiler.getFrameStats();
+                const profiling::FrameStats gpu = profiler.getGpuFrameStats();
+                // Requested reports are logged at INFO whatever the level flags, and survive Release stripping
+                logger->report("CPU frame over {} frames: p50 {} ms, p99 {} ms, max {} ms",
+                               cpu.frameCount, round(cpu.p50), round(cpu.p99), round(cpu.max));
+                logger->report("GPU frame over {} frames: p50 {} ms, p99 {} ms, max {} ms",
+                               gpu.frameCount, round(gpu.p50), round(gpu.p99), round(gpu.max));
+                if (isHeapAllocationCounted()) {
+                    logger->report("Last frame: {} heap allocations, {} bytes in the frame arena",
+                                   m_frameAllocationCount, m_frameArena.getUsed());
+                }
+                m_areStatsRequested = false;
+            }
+
+            // Closing the main window ends the application, any other window just closes
             for (auto& window : m_windows) {
-                window->pollEvents();
-			}
-
-            onUpdate(deltaTime);
-            onRender();
-
-            // Check for window close, etc.
-			for (auto& window : m_windows)
-			{
-				if (window->shouldClose())
-				{
-					m_running = false;
-				}
-			}
+                if (window->shouldClose()) {
+                    closeWindow(*window);
+                }
+            }
+            closePendingWindows();
+
+            if (idle) {
+                m_framePacer.reset();    // Waiting for events paced this frame
+            } else {
+                ZAPHOD_PROFILE_ZONE("FramePacer::waitForNextFrame");
+                m_framePacer.waitForNextFrame();
+            }
+            profiler.markFrame();
         }
 
         shutdown();
         return 0;
     }
 
+    void App::setFixedTimestep(double step, uint32_t maxStepsPerFrame) {
+        m_fixedTimestep = step > 0.0 ? step : 0.0;
+        m_maxStepsPerFrame = maxStepsPerFrame > 0 ? maxStepsPerFrame : 1;
+        m_accumulator = 0.0;
+    }
+
+    void App::setVariableTimestep() {
+        m_fixedTimestep = 0.0;
+        m_accumulator = 0.0;
+    }
+
+    float App::advanceSimulation(double frameTime) {
+        ZAPHOD_PROFILE_ZONE("App::onUpdate");
+        if (!isFixedTimestep()) {
+            onUpdate(static_cast<float>(frameTime));
+            applyCommandBuffers();
+            return 1.0f;
+        }
+
+        m_accumulator += frameTime;
+        uint32_t steps = 0;
+        while (m_accumulator >= m_fixedTimestep && steps < m_maxStepsPerFrame) {
+            onUpdate(static_cast<float>(m_fixedTimestep));
+            applyCommandBuffers();
+            m_accumulator -= m_fixedTimestep;
+            ++steps;
+        }
+
+        // Out of catch-up budget, the simulation falls behind real time instead of spiralling
+        if (m_accumulator >= m_fixedTimestep) {
+            m_accumulator = std::fmod(m_accumulator, m_fixedTimestep);
+        }
+        return static_cast<float>(m_accumulator / m_fixedTimestep);
+    }
+
+    void App::applyCommandBuffers() {
+        // onUpdate waits for the jobs it starts, so no query is iterating the world any more
+        for (scene::CommandBuffer& commands : m_commandBuffers) {
+            if (!commands.isEmpty()) {
+                m_world.apply(commands);
+            }
+        }
+    }
+
+    void App::onProfilerKey(const events::KeyEvent& event) {
+        if (event.action != GLFW_PRESS) return;
+
+        if (event.key == GLFW_KEY_F11) {
+            m_isCaptureToggled = true;
+        } else if (event.key == GLFW_KEY_F12) {
+            m_areStatsRequested = true;
+        }
+    }
+
+    Window* App::openWindow(int width, int height, const char* title, bool resizable) {
+        if (m_headless) return nullptr;
+
+        auto window = std::make_unique<Window>(width, height, title, resizable);
+        if (!window->getGLFWwindow()) return nullptr;
+        window->setEventBus(&m_eventBus);
+        window->setInputSystem(&m_inputSystem);
+#if defined(_WIN32) || defined(__APPLE__)
+        // Only these block the event pump while a window is dragged or resized
+        window->setRefreshCallback([this](Window&) { onWindowRefresh(); });
+#endif
+
+        // Before run() starts the renderer, it picks up every window opened so far
+        if (m_renderer.isInitialized() && m_renderer.addWindow(*window).isFailure()) return nullptr;
+        m_windows.push_back(std::move(window));
+        return m_windows.back().get();
+    }
+
+    void App::closeWindow(Window& window) {
+        if (&window == getMainWindow()) {
+            m_running = false;
+        } else if (std::find(m_closingWindows.begin(), m_closingWindows.end(), &window) == m_closingWindows.end()) {
+            m_closingWindows.push_back(&window);
+        }
+    }
+
+    void App::closePendingWindows() {
+        for (Window* closing : m_closingWindows) {
+            m_renderer.removeWindow(*closing);
+            std::erase_if(m_windows, [closing](const std::unique_ptr<Window>& window) { return window.get() == closing; });
+        }
+        m_closingWindows.clear();
+    }
+
+    void App::renderFrame() {
+        if (m_renderer.beginFrame()) {
+            {
+                ZAPHOD_PROFILE_ZONE("App::onRender");
+                onRender(m_alpha);
+            }
+            m_renderer.endFrame();
+        }
+    }
+
+    void App::onWindowRefresh() {
+        // While Windows drags or resizes a window, or macOS live-resizes one, the event pump does not
+        // return until the mouse is released, and only refreshes get through. Rendering from them keeps
+        // every window live with the last simulated state. A pump that has not been running for a frame
+        // period yet is about to return, and run() renders the frame itself.
+        if (!m_isPollingEvents) return;
+        const FramePacer::Clock::time_point now = FramePacer::Clock::now();
+        if (now - m_pumpStart < m_framePacer.getFramePeriod()) return;
+        m_pumpStart = now;
+        ZAPHOD_PROFILE_ZONE("App::onWindowRefresh");
+        renderFrame();
+    }
+
+    bool App::isIdle() const {
+        if (!m_framePacer.getConfig().throttleWhenIdle || m_windows.empty()) return false;
+
+        // Idle when no window could be interacted with
+        for (const auto& window : m_windows) {
+            if (window->isFocused() && !window->isMinimized()) return false;
+        }
+        return true;
+    }
+
     void App::shutdown() {
         if (!m_initialized) return;
 
         onShutdown();
 
         // Engine-level cleanup
+        m_renderer.shutdown();
+        m_closingWindows.clear();
+        m_windows.clear();    // After the renderer, which destroys their surfaces
+        m_jobSystem.reset();    // Finishes every job still in flight
+        m_commandBuffers.clear();
+        m_eventBus.unsubscribe(m_profilerKeySubscription);
+        m_profilerKeySubscription = events::EventBus::invalidSubscription;
 
         m_initialized = false;
         m_running = false;
@@ -0,0 +1,157 @@
+#include "core/async_logger.h"
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zaphod::logging
+{
+AsyncLogBackend::AsyncLogBackend(Logger& logger, const Logger::AsyncConfig& config):
+	m_logger(logger), m_overflowPolicy(config.overflowPolicy), m_queue(config.capacity)
+{
+	m_thread = std::thread([this] { run(); });
+}
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+	m_running.store(false);
+	wake();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool AsyncLogBackend::enqueue(const Logger::Record& record)
+{
+	bool isTruncated = false;
+	auto encode		 = [&](Entry& entry)
+	{
+		entry.time			 = record.time.time_since_epoch().count();
+		entry.formatIndex	 = static_cast<uint32_t>(record.formatIndex);
+		entry.level			 = record.level;
+		size_t used			 = std::min(record.message.size(), payloadCapacity);
+		entry.messageLength	 = static_cast<uint16_t>(used);
+		std::memcpy(entry.payload, record.message.data(), used);
+
+		size_t parameterCount = std::min(record.dynamicParameters.size(), maxDynamicParameters);
+		isTruncated			  = used < record.message.size() || parameterCount < record.dynamicParameters.size();
+		entry.parameterCount  = static_cast<uint16_t>(parameterCount);
+		for (size_t i = 0; i < parameterCount; ++i)
+		{
+			const std::string_view parameter = record.dynamicParameters[i];
+			size_t				   length	 = std::min(parameter.size(), payloadCapacity - used);
+			isTruncated |= length < parameter.size();
+			entry.parameterLengths[i] = static_cast<uint16_t>(length);
+			std::memcpy(entry.payload + used, parameter.data(), length);
+			used += length;
+		}
+	};
+
+	while (!m_queue.tryPushWith(encode))
+	{
+		switch (m_overflowPolicy)
+		{
+		case Logger::OverflowPolicy::DROP_NEWEST: m_droppedNewest.fetch_add(1, std::memory_order_relaxed); return false;
+		case Logger::OverflowPolicy::DROP_OLDEST:
+			if (m_queue.tryPopWith([](Entry&) {}))
+			{
+				m_droppedOldest.fetch_add(1, std::memory_order_relaxed);
+				m_consumed.fetch_add(1, std::memory_order_release);
+			}
+			break;
+		case Logger::OverflowPolicy::BLOCK:
+			wake();
+			std::this_thread::yield();
+			break;
+		}
+	}
+
+	if (isTruncated)
+		m_truncated.fetch_add(1, std::memory_order_relaxed);
+	m_enqueued.fetch_add(1, std::memory_order_release);
+	wake();
+	return true;
+}
+
+void AsyncLogBackend::flush()
+{
+	const uint64_t target = m_enqueued.load(std::memory_order_acquire);
+	while (m_consumed.load(std::memory_order_acquire) < target)
+	{
+		wake();
+		std::this_thread::yield();
+	}
+}
+
+AsyncLogBackend::Statistics AsyncLogBackend::getStatistics() const
+{
+	Statistics statistics;
+	statistics.enqueued		 = m_enqueued.load(std::memory_order_relaxed);
+	statistics.written		 = m_written.load(std::memory_order_relaxed);
+	statistics.droppedNewest = m_droppedNewest.load(std::memory_order_relaxed);
+	statistics.droppedOldest = m_droppedOldest.load(std::memory_order_relaxed);
+	statistics.truncated	 = m_truncated.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+void AsyncLogBackend::run()
+{
+#ifdef ZAPHOD_PROFILE
+	profiling::Profiler::get().setThreadName("Log sink");
+#endif
+	auto consume = [this](Entry& entry) { write(entry); };
+	for (;;)
+	{
+		if (m_queue.tryPopWith(consume))
+		{
+			m_written.fetch_add(1, std::memory_order_relaxed);
+			m_consumed.fetch_add(1, std::memory_order_release);
+			continue;
+		}
+		if (!m_running.load())
+			break;	  // Stopped and drained
+
+		m_logger.flushDestinations();
+
+		// Announce that we are about to sleep, then re-check so a producer that pushed
+		// in between either sees the flag or its record is picked up here
+		std::unique_lock lock(m_sleepMutex);
+		m_sleeping.store(true);
+		if (m_queue.isEmpty() && m_running.load())
+			m_wakeCondition.wait_for(lock, idleInterval);
+		m_sleeping.store(false);
+	}
+}
+
+void AsyncLogBackend::write(const Entry& entry)
+{
+	ZAPHOD_PROFILE_ZONE("AsyncLogBackend::write");
+	std::string_view parameters[maxDynamicParameters];
+	size_t			 offset = entry.messageLength;
+	for (size_t i = 0; i < entry.parameterCount; ++i)
+	{
+		parameters[i] = std::string_view(entry.payload + offset, entry.parameterLengths[i]);
+		offset += entry.parameterLengths[i];
+	}
+
+	Logger::Record record;
+	record.message			 = std::string_view(entry.payload, entry.messageLength);
+	record.dynamicParameters = std::span<const std::string_view>(parameters, entry.parameterCount);
+	record.formatIndex		 = entry.formatIndex;
+	record.level			 = entry.level;
+	record.time				 = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(entry.time));
+	m_logger.write(record);
+}
+
+void AsyncLogBackend::wake()
+{
+	if (m_sleeping.load())
+	{
+		// Taking the lock guarantees the sink thread is either before its re-check or waiting
+		{
+			std::lock_guard lock(m_sleepMutex);
+		}
+		m_wakeCondition.notify_one();
+	}
+}
+}	 // namespace zaphod::logging
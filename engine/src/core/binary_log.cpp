@@ -0,0 +1,198 @@
+#include "core/binary_log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace zaphod::logging
+{
+namespace
+{
+template<typename T>
+void appendValue(std::string& output, const T& value)
+{
+	output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename Length>
+void appendString(std::string& output, std::string_view text)
+{
+	Length length = static_cast<Length>(std::min<size_t>(text.size(), std::numeric_limits<Length>::max()));
+	appendValue(output, length);
+	output.append(text.data(), length);
+}
+
+void appendFormat(std::string& output, uint32_t index, const Logger::Format& format)
+{
+	appendValue(output, binary_log::ChunkType::FORMAT);
+	appendValue(output, index);
+	appendString<uint32_t>(output, format.getFormatString());
+	appendValue(output, static_cast<uint32_t>(format.getStaticTokens().size()));
+	for (const auto& [token, value] : format.getStaticTokens())
+	{
+		appendString<uint32_t>(output, token);
+		appendString<uint32_t>(output, value);
+	}
+}
+}	 // namespace
+
+Result BinaryLogWriter::open(const LogFileWriter::Config& config, const std::vector<Logger::Format>& formats)
+{
+	LogFileWriter::Config binaryConfig = config;
+	binaryConfig.append				   = false;
+	binaryConfig.fileHeader			   = encodeHeader(formats);
+	return m_file.open(binaryConfig);
+}
+
+void BinaryLogWriter::setFormats(const std::vector<Logger::Format>& formats)
+{
+	std::string chunks;
+	for (size_t i = 0; i < formats.size(); ++i)
+		appendFormat(chunks, static_cast<uint32_t>(i), formats[i]);
+	m_file.write(chunks);
+	m_file.setFileHeader(encodeHeader(formats));
+}
+
+void BinaryLogWriter::write(const Logger::Record& record)
+{
+	thread_local std::string buffer;
+	buffer.clear();
+
+	size_t parameterCount = std::min<size_t>(record.dynamicParameters.size(), UINT8_MAX);
+	appendValue(buffer, binary_log::ChunkType::RECORD);
+	appendValue(buffer, static_cast<uint8_t>(record.level));
+	appendValue(buffer, static_cast<uint32_t>(record.formatIndex));
+	appendValue(buffer, static_cast<int64_t>(record.time.time_since_epoch().count()));
+	appendString<uint16_t>(buffer, record.message);
+	appendValue(buffer, static_cast<uint8_t>(parameterCount));
+	for (size_t i = 0; i < parameterCount; ++i)
+		appendString<uint16_t>(buffer, record.dynamicParameters[i]);
+
+	m_file.write(buffer, record.level == Logger::LogLevel::FATAL);
+}
+
+std::string BinaryLogWriter::encodeHeader(const std::vector<Logger::Format>& formats) const
+{
+	std::string header(binary_log::magic, sizeof(binary_log::magic));
+	appendValue(header, binary_log::version);
+	appendValue(header, static_cast<int64_t>(std::chrono::system_clock::period::num));
+	appendValue(header, static_cast<int64_t>(std::chrono::system_clock::period::den));
+	for (size_t i = 0; i < formats.size(); ++i)
+		appendFormat(header, static_cast<uint32_t>(i), formats[i]);
+	return header;
+}
+
+Result BinaryLogReader::open(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return Result(Result::Code::IO_ERROR, "Failed to open " + path.string());
+	m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	m_offset = 0;
+	m_formats.clear();
+
+	std::string_view magic;
+	uint32_t		 version = 0;
+	if (!readString(magic, sizeof(binary_log::magic)) || magic != std::string_view(binary_log::magic, sizeof(binary_log::magic)))
+		return Result(Result::Code::INVALID_ARGUMENT, path.string() + " is not a binary log file");
+	if (!read(version) || version != binary_log::version)
+		return Result(Result::Code::INVALID_ARGUMENT, "Unsupported binary log version " + std::to_string(version));
+	if (!read(m_periodNumerator) || !read(m_periodDenominator) || m_periodDenominator == 0)
+		return Result(Result::Code::INVALID_ARGUMENT, path.string() + " has a truncated header");
+	return Result(Result::Code::SUCCESS);
+}
+
+bool BinaryLogReader::next(Entry& entry)
+{
+	binary_log::ChunkType type;
+	while (read(type))
+	{
+		if (type == binary_log::ChunkType::FORMAT)
+		{
+			if (!readFormat())
+				return false;
+			continue;
+		}
+		if (type != binary_log::ChunkType::RECORD)
+			return false;	 // Corrupt
+
+		uint8_t	 level;
+		int64_t	 ticks;
+		uint16_t length;
+		uint8_t	 parameterCount;
+		if (!read(level) || !read(entry.formatIndex) || !read(ticks) || !read(length) || !readString(entry.message, length) ||
+			!read(parameterCount))
+			return false;
+
+		entry.dynamicParameters.resize(parameterCount);
+		for (auto& parameter : entry.dynamicParameters)
+			if (!read(length) || !readString(parameter, length))
+				return false;
+
+		// The writer's tick period may differ from ours, e.g. a log recorded on another platform
+		std::chrono::duration<long double> seconds(static_cast<long double>(ticks) * m_periodNumerator / m_periodDenominator);
+		entry.level = static_cast<Logger::LogLevel>(level);
+		entry.time	= std::chrono::system_clock::time_point(
+			 std::chrono::duration_cast<std::chrono::system_clock::duration>(seconds));
+		return true;
+	}
+	return false;
+}
+
+const Logger::Format* BinaryLogReader::getFormat(uint32_t index) const
+{
+	if (index >= m_formats.size() || !m_formats[index])
+		return nullptr;
+	return &*m_formats[index];
+}
+
+const Logger::Format::ParameterMap& BinaryLogReader::getStaticTokens(uint32_t index) const
+{
+	static const Logger::Format::ParameterMap empty;
+	const Logger::Format*					  format = getFormat(index);
+	return format ? format->getStaticTokens() : empty;
+}
+
+bool BinaryLogReader::readFormat()
+{
+	uint32_t		 index, length, staticCount;
+	std::string_view formatString;
+	if (!read(index) || !read(length) || !readString(formatString, length) || !read(staticCount))
+		return false;
+
+	Logger::Format::ParameterMap staticTokens;
+	for (uint32_t i = 0; i < staticCount; ++i)
+	{
+		std::string_view token, value;
+		if (!read(length) || !readString(token, length) || !read(length) || !readString(value, length))
+			return false;
+		staticTokens.emplace(token, value);
+	}
+
+	if (index >= m_formats.size())
+		m_formats.resize(index + 1);
+	m_formats[index].emplace(std::string(formatString), staticTokens);
+	return true;
+}
+
+template<typename T>
+bool BinaryLogReader::read(T& value)
+{
+	if (m_data.size() - m_offset < sizeof(T))
+		return false;
+	std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+	m_offset += sizeof(T);
+	return true;
+}
+
+bool BinaryLogReader::readString(std::string_view& value, size_t length)
+{
+	if (m_data.size() - m_offset < length)
+		return false;
+	value = std::string_view(m_data.data() + m_offset, length);
+	m_offset += length;
+	return true;
+}
+}	 // namespace zaphod::logging
@@ -0,0 +1,155 @@
+#include "core/event_bus.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zaphod::events
+{
+void EventBus::unsubscribe(SubscriptionId id)
+{
+	EventTypeId type = static_cast<EventTypeId>(id >> 32);
+	if (id == invalidSubscription || type >= m_subscribers.size())
+		return;
+
+	SubscriberList& subscribers = m_subscribers[type];
+	auto			it			= std::find_if(subscribers.delegates.begin(),
+								   subscribers.delegates.end(),
+								   [id](const Delegate& delegate) { return delegate.id == id; });
+	if (it == subscribers.delegates.end())
+		return;
+
+	if (m_isDispatching)
+	{
+		// The delegate list may be being iterated, remove the delegate once the dispatch is done
+		it->invoke			   = nullptr;
+		subscribers.hasRemoved = true;
+	}
+	else
+		subscribers.delegates.erase(it);
+}
+
+void EventBus::dispatch()
+{
+	if (m_isDispatching)
+		return;
+
+	// Swap buffers first, everything published from here on is for the next dispatch
+	FrameQueue& queue = m_queues[m_writeQueue];
+	m_writeQueue ^= 1;
+
+	m_isDispatching = true;
+	if (m_deliveryOrder == DeliveryOrder::BY_TYPE)
+	{
+		for (EventTypeId type : queue.pendingTypes)
+			deliverBatch(type, queue.arrays[type]);
+	}
+	else
+	{
+		for (const QueuedEvent& queued : queue.order)
+		{
+			const EventArray& array = queue.arrays[queued.type];
+			const std::byte*  event = array.events + static_cast<size_t>(array.stride) * queued.index;
+			deliverImmediate(queued.type, *reinterpret_cast<const EventBase*>(event));
+		}
+	}
+	m_isDispatching = false;
+
+	for (SubscriberList& subscribers : m_subscribers)
+	{
+		if (subscribers.hasRemoved)
+		{
+			std::erase_if(subscribers.delegates, [](const Delegate& delegate) { return delegate.invoke == nullptr; });
+			subscribers.hasRemoved = false;
+		}
+	}
+	resetQueue(queue);
+}
+
+EventBus::SubscriptionId EventBus::addSubscriber(EventTypeId type, void* context, Invoke invoke)
+{
+	if (type >= m_subscribers.size())
+		m_subscribers.resize(type + 1);
+
+	SubscriptionId id = (static_cast<SubscriptionId>(type) << 32) | m_nextSubscription++;
+	m_subscribers[type].delegates.push_back(Delegate { context, invoke, id });
+	return id;
+}
+
+void* EventBus::allocateEvent(EventTypeId type, size_t size, size_t alignment)
+{
+	FrameQueue& queue = m_queues[m_writeQueue];
+	if (type >= queue.arrays.size())
+		queue.arrays.resize(type + 1);
+
+	EventArray& array = queue.arrays[type];
+	if (array.count == array.capacity)
+	{
+		// Grow geometrically, the old array stays valid until the arena is reset
+		uint32_t   capacity = std::max<uint32_t>(16, array.capacity * 2);
+		std::byte* events	= static_cast<std::byte*>(queue.arena.allocate(size * capacity, alignment));
+		if (array.count > 0)
+			std::memcpy(events, array.events, size * array.count);
+		else
+			queue.pendingTypes.push_back(type);
+		array.events   = events;
+		array.capacity = capacity;
+		array.stride   = static_cast<uint32_t>(size);
+	}
+
+	queue.order.push_back(QueuedEvent { type, array.count });
+	return array.events + static_cast<size_t>(array.stride) * array.count++;
+}
+
+void EventBus::deliverBatch(EventTypeId type, const EventArray& array)
+{
+	if (type >= m_subscribers.size())
+		return;
+
+	// Each subscriber gets the whole batch in one run. The list is re-read every step since
+	// handlers may subscribe, which can move it.
+	for (size_t s = 0; s < m_subscribers[type].delegates.size(); ++s)
+	{
+		for (uint32_t i = 0; i < array.count; ++i)
+		{
+			const Delegate& delegate = m_subscribers[type].delegates[s];
+			if (!delegate.invoke)
+				break;
+			delegate.invoke(delegate.context,
+							*reinterpret_cast<const EventBase*>(array.events + static_cast<size_t>(array.stride) * i));
+		}
+	}
+}
+
+void EventBus::deliverImmediate(EventTypeId type, const EventBase& event)
+{
+	if (type >= m_subscribers.size())
+		return;
+
+	// Tombstone unsubscriptions made by handlers, even outside a queued dispatch
+	bool wasDispatching = m_isDispatching;
+	m_isDispatching		= true;
+	for (size_t s = 0; s < m_subscribers[type].delegates.size(); ++s)
+	{
+		const Delegate& delegate = m_subscribers[type].delegates[s];
+		if (delegate.invoke)
+			delegate.invoke(delegate.context, event);
+	}
+	m_isDispatching = wasDispatching;
+
+	SubscriberList& subscribers = m_subscribers[type];
+	if (!m_isDispatching && subscribers.hasRemoved)
+	{
+		std::erase_if(subscribers.delegates, [](const Delegate& delegate) { return delegate.invoke == nullptr; });
+		subscribers.hasRemoved = false;
+	}
+}
+
+void EventBus::resetQueue(FrameQueue& queue)
+{
+	for (EventTypeId type : queue.pendingTypes)
+		queue.arrays[type] = EventArray();
+	queue.pendingTypes.clear();
+	queue.order.clear();
+	queue.arena.reset();
+}
+}	 // namespace zaphod::events
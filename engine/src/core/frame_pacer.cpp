@@ -0,0 +1,79 @@
+#include "core/frame_pacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace zaphod
+{
+namespace
+{
+// Upper bound of the adaptive spin window, sleeping is always cheaper beyond this
+constexpr FramePacer::Clock::duration maximumSpin = std::chrono::milliseconds(4);
+}	 // namespace
+
+FramePacer::FramePacer(): FramePacer(Config()) {}
+
+FramePacer::FramePacer(const Config& config): m_config(config), m_spinWindow(config.minimumSpin) {}
+
+void FramePacer::setConfig(const Config& config)
+{
+	m_config	 = config;
+	m_spinWindow = std::max<Clock::duration>(m_spinWindow, config.minimumSpin);
+	reset();
+}
+
+void FramePacer::setRefreshRate(double refreshRate)
+{
+	m_refreshRate = refreshRate > 0.0 ? refreshRate : 60.0;
+}
+
+FramePacer::Clock::duration FramePacer::getFramePeriod() const
+{
+	double rate = 0.0;
+	switch (m_config.mode)
+	{
+	case Mode::UNLIMITED: return Clock::duration::zero();
+	case Mode::TARGET_FPS: rate = m_config.targetFps; break;
+	case Mode::VSYNC: rate = m_refreshRate; break;
+	}
+	if (rate <= 0.0)
+		return Clock::duration::zero();
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+}
+
+void FramePacer::waitForNextFrame()
+{
+	const Clock::duration period = getFramePeriod();
+	if (period == Clock::duration::zero())
+		return;
+
+	Clock::time_point now = Clock::now();
+	if (!m_hasDeadline)
+	{
+		m_deadline	  = now;
+		m_hasDeadline = true;
+	}
+	m_deadline += period;
+	if (m_deadline < now - period)
+		m_deadline = now;	 // Fell more than a frame behind, do not try to catch up
+
+	// Sleep through most of the wait and adapt the spin window to how late we are woken up
+	if (m_deadline - now > m_spinWindow)
+	{
+		Clock::time_point wakeTarget = m_deadline - m_spinWindow;
+		std::this_thread::sleep_until(wakeTarget);
+		Clock::duration lateness = Clock::now() - wakeTarget;
+		Clock::duration target	 = std::clamp<Clock::duration>(lateness * 5 / 4, m_config.minimumSpin, maximumSpin);
+		// Grow quickly when woken late, shrink slowly when woken on time
+		m_spinWindow = target > m_spinWindow ? target : m_spinWindow - (m_spinWindow - target) / 16;
+	}
+
+	while (Clock::now() < m_deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::reset()
+{
+	m_hasDeadline = false;
+}
+}	 // namespace zaphod
@@ -0,0 +1,263 @@
+#include "core/job_system.h"
+
+#include "core/profiler.h"
+
+#include <functional>
+
+namespace zaphod
+{
+namespace
+{
+// Identifies the worker the calling thread belongs to
+thread_local const JobSystem* t_jobSystem	= nullptr;
+thread_local uint32_t		  t_workerIndex = 0;
+
+// How many times an idle worker looks for work again before going to sleep
+constexpr int idleSpinCount = 64;
+
+uint32_t nextRandom()
+{
+	thread_local uint32_t state = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+}	 // namespace
+
+JobSystem::JobSystem(uint32_t workerThreads):
+	m_externalQueue(sharedQueueCapacity),
+	m_mainThreadQueue(sharedQueueCapacity),
+	m_mainThreadId(std::this_thread::get_id())
+{
+	if (workerThreads == 0)
+		workerThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+	// Worker 0 is the calling thread, it runs jobs while waiting
+	for (uint32_t i = 0; i <= workerThreads; ++i)
+		m_workers.push_back(std::make_unique<Worker>());
+	t_jobSystem	  = this;
+	t_workerIndex = 0;
+
+	for (uint32_t i = 1; i <= workerThreads; ++i)
+		m_workers[i]->thread = std::thread([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem()
+{
+	while (m_pendingJobs.load(std::memory_order_acquire) > 0)
+	{
+		if (!runOneJob())
+			std::this_thread::yield();
+	}
+	runMainThreadJobs();
+
+	m_running.store(false, std::memory_order_release);
+	m_wakeSignal.fetch_add(1);
+	m_wakeSignal.notify_all();
+	for (auto& worker : m_workers)
+	{
+		if (worker->thread.joinable())
+			worker->thread.join();
+	}
+	if (t_jobSystem == this)
+		t_jobSystem = nullptr;
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+	while (!counter.isDone())
+	{
+		if (!runOneJob())
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::runMainThreadJobs()
+{
+	// Bounded, so jobs that queue more main thread work cannot keep us here forever
+	Job* job = nullptr;
+	for (size_t i = 0; i < sharedQueueCapacity && m_mainThreadQueue.tryPop(job); ++i)
+		execute(job);
+}
+
+Job* JobSystem::allocateJob()
+{
+	Worker* worker = getCurrentWorker();
+	if (!worker)
+	{
+		Job* job			 = new Job;
+		job->isHeapAllocated = true;
+		return job;
+	}
+
+	for (;;)
+	{
+		for (size_t attempt = 0; attempt < jobsPerWorker; ++attempt)
+		{
+			Job& job = worker->jobs[worker->nextJob++ & (jobsPerWorker - 1)];
+			if (!job.inUse.load(std::memory_order_acquire))
+			{
+				job.inUse.store(true, std::memory_order_relaxed);
+				return &job;
+			}
+		}
+		// Every slot is in flight, help finish some
+		if (!runOneJob())
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::submit(Job* job)
+{
+	m_pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+	Worker* worker = getCurrentWorker();
+	if (!worker || !worker->deque.push(job))
+	{
+		while (!m_externalQueue.tryPush(job))
+		{
+			if (!runOneJob())
+				std::this_thread::yield();
+		}
+	}
+	wakeWorkers();
+}
+
+void JobSystem::pushMainThreadJob(Job* job)
+{
+	while (!m_mainThreadQueue.tryPush(job))
+	{
+		if (isMainThread())
+			runMainThreadJobs();
+		else if (!runOneJob())
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::addContinuation(JobCounter& dependency, Job* job)
+{
+	dependency.lock();
+	bool isWaiting = dependency.m_value.load(std::memory_order_acquire) > 0;
+	if (isWaiting)
+	{
+		job->next				   = dependency.m_continuations;
+		dependency.m_continuations = job;
+	}
+	dependency.unlock();
+	return isWaiting;
+}
+
+void JobSystem::execute(Job* job)
+{
+	JobCounter* counter = job->counter;
+	{
+		ZAPHOD_PROFILE_ZONE("Job");
+		job->run(*job);
+	}
+	if (job->isHeapAllocated)
+		delete job;
+	else
+		job->inUse.store(false, std::memory_order_release);
+
+	if (!counter)
+		return;
+
+	// The lock keeps waiters from seeing the counter as done (and destroying it) until we are finished with it
+	Job* continuations = nullptr;
+	counter->lock();
+	if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		continuations			 = counter->m_continuations;
+		counter->m_continuations = nullptr;
+	}
+	counter->unlock();
+
+	while (continuations)
+	{
+		Job* next = continuations->next;
+		submit(continuations);
+		continuations = next;
+	}
+}
+
+Job* JobSystem::findJob()
+{
+	Job*	job	   = nullptr;
+	Worker* worker = getCurrentWorker();
+	if (worker && worker->deque.pop(job))
+		return job;
+	if (m_externalQueue.tryPop(job))
+		return job;
+
+	// Steal from the other workers, starting at a random one so thieves spread out
+	const size_t count = m_workers.size();
+	const size_t start = nextRandom() % count;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Worker* victim = m_workers[(start + i) % count].get();
+		if (victim != worker && victim->deque.steal(job))
+			return job;
+	}
+	return nullptr;
+}
+
+bool JobSystem::runOneJob()
+{
+	Job* job = findJob();
+	if (!job)
+		return false;
+	execute(job);
+	m_pendingJobs.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+	t_jobSystem	  = this;
+	t_workerIndex = index;
+#ifdef ZAPHOD_PROFILE
+	profiling::Profiler::get().setThreadName("Worker " + std::to_string(index));
+#endif
+
+	while (m_running.load(std::memory_order_acquire))
+	{
+		bool hasRun = false;
+		for (int i = 0; i < idleSpinCount && !hasRun; ++i)
+		{
+			hasRun = runOneJob();
+			if (!hasRun)
+				std::this_thread::yield();
+		}
+		if (hasRun)
+			continue;
+
+		// Read the signal before the last look for work, so a job submitted after that look
+		// changes the signal and the wait returns immediately
+		uint32_t signal = m_wakeSignal.load();
+		if (runOneJob())
+			continue;
+		m_sleepingWorkers.fetch_add(1);
+		if (m_running.load(std::memory_order_acquire))
+			m_wakeSignal.wait(signal);
+		m_sleepingWorkers.fetch_sub(1);
+	}
+}
+
+void JobSystem::wakeWorkers()
+{
+	m_wakeSignal.fetch_add(1);
+	if (m_sleepingWorkers.load() > 0)
+		m_wakeSignal.notify_one();
+}
+
+uint32_t JobSystem::getCurrentWorkerIndex() const
+{
+	return t_jobSystem == this ? t_workerIndex : invalidWorkerIndex;
+}
+
+JobSystem::Worker* JobSystem::getCurrentWorker()
+{
+	return t_jobSystem == this ? m_workers[t_workerIndex].get() : nullptr;
+}
+}	 // namespace zaphod
@@ -0,0 +1,106 @@
+#include "core/log_clock.h"
+
+#include <ctime>
+
+namespace zaphod::logging
+{
+std::shared_ptr<const LogClock> LogClock::getDefault()
+{
+	static const std::shared_ptr<const LogClock> clock = std::make_shared<CoarseLogClock>();
+	return clock;
+}
+
+TimePrecision LogClock::getFinestPrecision() const
+{
+	const std::chrono::nanoseconds resolution = getResolution();
+	if (resolution <= std::chrono::microseconds(1))
+		return TimePrecision::MICROSECONDS;
+	if (resolution <= std::chrono::milliseconds(1))
+		return TimePrecision::MILLISECONDS;
+	if (resolution <= std::chrono::milliseconds(10))
+		return TimePrecision::CENTISECONDS;
+	return TimePrecision::SECONDS;
+}
+
+CoarseLogClock::CoarseLogClock()
+{
+	calibrate(readMonotonic());
+}
+
+std::chrono::system_clock::time_point CoarseLogClock::now() const
+{
+	int64_t monotonic = readMonotonic();
+	if (monotonic >= m_nextCalibration.load(std::memory_order_relaxed))
+		calibrate(monotonic);
+
+	auto sinceEpoch = std::chrono::nanoseconds(monotonic + m_offset.load(std::memory_order_relaxed));
+	return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+}
+
+int64_t CoarseLogClock::readMonotonic()
+{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+	return static_cast<int64_t>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int64_t CoarseLogClock::readResolution()
+{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+	timespec resolution;
+	if (clock_getres(CLOCK_MONOTONIC_COARSE, &resolution) == 0)
+		return static_cast<int64_t>(resolution.tv_sec) * 1'000'000'000 + resolution.tv_nsec;
+	return 10'000'000;	  // The tick of a 100 Hz kernel, the coarsest in use
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::duration(1)).count();
+#endif
+}
+
+void CoarseLogClock::calibrate(int64_t monotonic) const
+{
+	int64_t wallClock =
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	m_offset.store(wallClock - monotonic, std::memory_order_relaxed);
+	m_nextCalibration.store(monotonic + std::chrono::nanoseconds(calibrationInterval).count(), std::memory_order_relaxed);
+}
+
+std::string_view TimestampCache::format(std::chrono::system_clock::time_point time, TimePrecision precision)
+{
+	auto	second = std::chrono::floor<std::chrono::seconds>(time);
+	int64_t count  = second.time_since_epoch().count();
+	if (count != m_cachedSecond)
+	{
+		std::time_t seconds = static_cast<std::time_t>(count);
+		std::tm		localTime {};
+#ifdef _WIN32
+		localtime_s(&localTime, &seconds);
+#else
+		localtime_r(&seconds, &localTime);
+#endif
+		m_prefixLength = std::strftime(m_buffer, sizeof(m_buffer), "%Y-%m-%d %H:%M:%S", &localTime);
+		m_cachedSecond = count;
+	}
+
+	size_t digits = 0;
+	switch (precision)
+	{
+	case TimePrecision::SECONDS: return std::string_view(m_buffer, m_prefixLength);
+	case TimePrecision::CENTISECONDS: digits = 2; break;
+	case TimePrecision::MILLISECONDS: digits = 3; break;
+	case TimePrecision::MICROSECONDS: digits = 6; break;
+	}
+
+	auto fraction = std::chrono::duration_cast<std::chrono::microseconds>(time - second).count();
+	for (size_t i = digits; i < 6; ++i)
+		fraction /= 10;
+	char* end = m_buffer + m_prefixLength + 1 + digits;
+	m_buffer[m_prefixLength] = '.';
+	for (char* c = end - 1; c > m_buffer + m_prefixLength; --c, fraction /= 10)
+		*c = static_cast<char>('0' + fraction % 10);
+	return std::string_view(m_buffer, m_prefixLength + 1 + digits);
+}
+}	 // namespace zaphod::logging
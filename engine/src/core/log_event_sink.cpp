@@ -0,0 +1,57 @@
+#include "core/log_event_sink.h"
+
+#include "core/event_bus.h"
+#include "core/events.h"
+
+#include <algorithm>
+
+namespace zaphod::events
+{
+void LogEventSink::push(const logging::Logger::Record& record)
+{
+	std::lock_guard lock(m_mutex);
+	Entry&			entry = m_pending.entries.emplace_back();
+	entry.textOffset	  = m_pending.text.size();
+	entry.messageLength	  = static_cast<uint32_t>(record.message.size());
+	entry.parameterCount  = static_cast<uint32_t>(std::min(record.dynamicParameters.size(), std::size(entry.parameterLengths)));
+	entry.formatIndex	  = record.formatIndex;
+	entry.level			  = record.level;
+	m_pending.text.append(record.message);
+	for (uint32_t i = 0; i < entry.parameterCount; ++i)
+	{
+		entry.parameterLengths[i] = static_cast<uint32_t>(record.dynamicParameters[i].size());
+		m_pending.text.append(record.dynamicParameters[i]);
+	}
+}
+
+size_t LogEventSink::publish(EventBus& bus)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		std::swap(m_pending, m_publishing);
+	}
+
+	// LogEvent::create copies the views into the bus arena, so the buffer can be reused right away
+	const std::string_view text = m_publishing.text;
+	for (const Entry& entry : m_publishing.entries)
+	{
+		std::string_view parameters[logging::Logger::maxDynamicParameters];
+		size_t			 offset = entry.textOffset + entry.messageLength;
+		for (uint32_t i = 0; i < entry.parameterCount; ++i)
+		{
+			parameters[i] = text.substr(offset, entry.parameterLengths[i]);
+			offset += entry.parameterLengths[i];
+		}
+		bus.publish(LogEvent::create(bus.getArena(),
+									 text.substr(entry.textOffset, entry.messageLength),
+									 std::span<const std::string_view>(parameters, entry.parameterCount),
+									 entry.level,
+									 entry.formatIndex));
+	}
+
+	const size_t count = m_publishing.entries.size();
+	m_publishing.text.clear();
+	m_publishing.entries.clear();
+	return count;
+}
+}	 // namespace zaphod::events
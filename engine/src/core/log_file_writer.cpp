@@ -0,0 +1,352 @@
+#include "core/log_file_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace zaphod::logging
+{
+struct LogFileWriter::Mapping
+{
+#ifdef _WIN32
+	HANDLE file	   = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+	char*  base		= nullptr;
+	size_t capacity = 0;
+};
+
+namespace
+{
+#ifdef _WIN32
+bool openMappedFile(const LogFileWriter::Config& config, HANDLE& file, uint64_t& size)
+{
+	file = CreateFileW(config.path.c_str(),
+					   GENERIC_READ | GENERIC_WRITE,
+					   FILE_SHARE_READ,
+					   nullptr,
+					   config.append ? OPEN_ALWAYS : CREATE_ALWAYS,
+					   FILE_ATTRIBUTE_NORMAL,
+					   nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	size = static_cast<uint64_t>(fileSize.QuadPart);
+	return true;
+}
+#endif
+
+std::filesystem::path rotatedPath(const std::filesystem::path& path, uint32_t index)
+{
+	return std::filesystem::path(path).concat("." + std::to_string(index));
+}
+}	 // namespace
+
+LogFileWriter::LogFileWriter() = default;
+
+LogFileWriter::~LogFileWriter()
+{
+	close();
+}
+
+Result LogFileWriter::open(const Config& config)
+{
+	std::lock_guard lock(m_mutex);
+	closeFile();
+
+	m_config			 = config;
+	size_t pageCount	 = (std::max(config.bufferSize, pageSize) + pageSize - 1) / pageSize;
+	size_t newBufferSize = pageCount * pageSize;
+	if (!config.memoryMapped && newBufferSize != m_bufferSize)
+	{
+		if (m_buffer)
+			::operator delete(m_buffer, std::align_val_t(pageSize));
+		m_buffer	 = static_cast<char*>(::operator new(newBufferSize, std::align_val_t(pageSize)));
+		m_bufferSize = newBufferSize;
+	}
+	return openFile();
+}
+
+void LogFileWriter::close()
+{
+	std::lock_guard lock(m_mutex);
+	closeFile();
+	if (m_buffer)
+	{
+		::operator delete(m_buffer, std::align_val_t(pageSize));
+		m_buffer	 = nullptr;
+		m_bufferSize = 0;
+	}
+}
+
+bool LogFileWriter::isOpen() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_file || m_mapping;
+}
+
+void LogFileWriter::write(std::string_view text, bool isUrgent)
+{
+	std::lock_guard lock(m_mutex);
+	if (!m_file && !m_mapping)
+		return;
+
+	if (shouldRotate(text.size()))
+		rotate();
+	if (m_mapping)
+		appendMapped(text);
+	else if (m_file)
+		append(text);
+
+	if (isUrgent || std::chrono::steady_clock::now() - m_lastFlush >= m_config.flushInterval)
+		flushBuffer();
+}
+
+void LogFileWriter::flush()
+{
+	std::lock_guard lock(m_mutex);
+	flushBuffer();
+}
+
+void LogFileWriter::flushIfDue()
+{
+	std::lock_guard lock(m_mutex);
+	if (std::chrono::steady_clock::now() - m_lastFlush >= m_config.flushInterval)
+		flushBuffer();
+}
+
+void LogFileWriter::setFileHeader(std::string header)
+{
+	std::lock_guard lock(m_mutex);
+	m_config.fileHeader = std::move(header);
+}
+
+uint64_t LogFileWriter::getFileSize() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_fileSize;
+}
+
+Result LogFileWriter::openFile()
+{
+	m_fileSize	= 0;
+	m_openedAt	= std::chrono::steady_clock::now();
+	m_lastFlush = m_openedAt;
+
+	if (m_config.memoryMapped)
+	{
+		auto mapping = std::make_unique<Mapping>();
+#ifdef _WIN32
+		if (!openMappedFile(m_config, mapping->file, m_fileSize))
+			return Result(Result::Code::IO_ERROR, "Failed to open log file " + m_config.path.string());
+#else
+		mapping->file = ::open(m_config.path.c_str(), O_RDWR | O_CREAT | (m_config.append ? 0 : O_TRUNC), 0644);
+		if (mapping->file < 0)
+			return Result(Result::Code::IO_ERROR, "Failed to open log file " + m_config.path.string());
+		struct stat status;
+		if (fstat(mapping->file, &status) == 0)
+			m_fileSize = static_cast<uint64_t>(status.st_size);
+#endif
+		m_mapping = std::move(mapping);
+		if (!growMapping(static_cast<size_t>(m_fileSize) + m_config.fileHeader.size() + 1))
+		{
+			closeFile();
+			return Result(Result::Code::IO_ERROR, "Failed to map log file " + m_config.path.string());
+		}
+		if (m_fileSize == 0)
+			appendMapped(m_config.fileHeader);
+		return Result(Result::Code::SUCCESS);
+	}
+
+	m_file = std::fopen(m_config.path.string().c_str(), m_config.append ? "ab" : "wb");
+	if (!m_file)
+		return Result(Result::Code::IO_ERROR, "Failed to open log file " + m_config.path.string());
+	std::setvbuf(m_file, nullptr, _IONBF, 0);	 // Records are already batched in m_buffer
+
+	std::error_code error;
+	uintmax_t		size = std::filesystem::file_size(m_config.path, error);
+	if (!error)
+		m_fileSize = size;
+	if (m_fileSize == 0)
+		append(m_config.fileHeader);
+	return Result(Result::Code::SUCCESS);
+}
+
+void LogFileWriter::closeFile()
+{
+	flushBuffer();
+
+	if (m_file)
+	{
+		std::fclose(m_file);
+		m_file = nullptr;
+	}
+
+	if (m_mapping)
+	{
+		// Give back the unused tail of the last mapping step
+#ifdef _WIN32
+		if (m_mapping->base)
+		{
+			FlushViewOfFile(m_mapping->base, 0);
+			UnmapViewOfFile(m_mapping->base);
+		}
+		if (m_mapping->mapping)
+			CloseHandle(m_mapping->mapping);
+		if (m_mapping->file != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER size;
+			size.QuadPart = static_cast<LONGLONG>(m_fileSize);
+			SetFilePointerEx(m_mapping->file, size, nullptr, FILE_BEGIN);
+			SetEndOfFile(m_mapping->file);
+			CloseHandle(m_mapping->file);
+		}
+#else
+		if (m_mapping->base)
+			munmap(m_mapping->base, m_mapping->capacity);
+		if (m_mapping->file >= 0)
+		{
+			// On failure the file keeps some zero padding after the last record
+			[[maybe_unused]] int truncated = ftruncate(m_mapping->file, static_cast<off_t>(m_fileSize));
+			::close(m_mapping->file);
+		}
+#endif
+		m_mapping.reset();
+	}
+}
+
+void LogFileWriter::flushBuffer()
+{
+	m_lastFlush = std::chrono::steady_clock::now();
+
+	if (m_mapping)
+	{
+		if (!m_mapping->base)
+			return;
+#ifdef _WIN32
+		FlushViewOfFile(m_mapping->base, 0);
+#else
+		msync(m_mapping->base, m_mapping->capacity, MS_ASYNC);
+#endif
+		return;
+	}
+
+	if (m_file && m_used > 0)
+	{
+		// The unwritten tail is dropped, so the size used for rotation matches the file
+		size_t written = std::fwrite(m_buffer, 1, m_used, m_file);
+		if (written < m_used)
+		{
+			m_fileSize -= m_used - written;
+			std::clearerr(m_file);
+		}
+	}
+	m_used = 0;
+}
+
+bool LogFileWriter::shouldRotate(size_t incoming) const
+{
+	if (m_config.maxFileSize > 0 && m_fileSize > 0 && m_fileSize + incoming > m_config.maxFileSize)
+		return true;
+	if (m_config.rotationInterval.count() > 0 && std::chrono::steady_clock::now() - m_openedAt >= m_config.rotationInterval)
+		return true;
+	return false;
+}
+
+void LogFileWriter::rotate()
+{
+	closeFile();
+
+	std::error_code error;
+	if (m_config.maxRotatedFiles == 0)
+		std::filesystem::remove(m_config.path, error);
+	else
+	{
+		std::filesystem::remove(rotatedPath(m_config.path, m_config.maxRotatedFiles), error);
+		for (uint32_t i = m_config.maxRotatedFiles - 1; i > 0; --i)
+			std::filesystem::rename(rotatedPath(m_config.path, i), rotatedPath(m_config.path, i + 1), error);
+		std::filesystem::rename(m_config.path, rotatedPath(m_config.path, 1), error);
+	}
+
+	openFile();
+}
+
+void LogFileWriter::append(std::string_view text)
+{
+	m_fileSize += text.size();
+	while (!text.empty())
+	{
+		size_t length = std::min(text.size(), m_bufferSize - m_used);
+		std::memcpy(m_buffer + m_used, text.data(), length);
+		m_used += length;
+		text.remove_prefix(length);
+		if (m_used == m_bufferSize)
+			flushBuffer();	  // Full, page-aligned write
+	}
+}
+
+void LogFileWriter::appendMapped(std::string_view text)
+{
+	size_t offset = static_cast<size_t>(m_fileSize);
+	// A failed growth leaves no view, the record is dropped and the next one retries the mapping
+	if (offset + text.size() > m_mapping->capacity && !growMapping(offset + text.size()))
+		return;
+	if (!m_mapping->base)
+		return;
+	std::memcpy(m_mapping->base + offset, text.data(), text.size());
+	m_fileSize += text.size();
+}
+
+bool LogFileWriter::growMapping(size_t required)
+{
+	size_t growth	= std::max(m_config.mappingGrowth, pageSize);
+	size_t capacity = (required + growth - 1) / growth * growth;
+
+#ifdef _WIN32
+	if (m_mapping->base)
+		UnmapViewOfFile(m_mapping->base);
+	if (m_mapping->mapping)
+		CloseHandle(m_mapping->mapping);
+	m_mapping->base		= nullptr;
+	m_mapping->mapping	= nullptr;
+	m_mapping->capacity = 0;
+
+	uint64_t size	   = capacity;
+	m_mapping->mapping = CreateFileMappingW(
+		m_mapping->file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+	if (!m_mapping->mapping)
+		return false;
+	m_mapping->base = static_cast<char*>(MapViewOfFile(m_mapping->mapping, FILE_MAP_WRITE, 0, 0, capacity));
+#else
+	if (m_mapping->base)
+		munmap(m_mapping->base, m_mapping->capacity);
+	m_mapping->base		= nullptr;
+	m_mapping->capacity = 0;
+
+	if (ftruncate(m_mapping->file, static_cast<off_t>(capacity)) != 0)
+		return false;
+	void* base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_mapping->file, 0);
+	if (base == MAP_FAILED)
+		return false;
+	m_mapping->base = static_cast<char*>(base);
+#endif
+	m_mapping->capacity = capacity;
+	return m_mapping->base != nullptr;
+}
+}	 // namespace zaphod::logging
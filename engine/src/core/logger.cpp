@@ -1,170 +1,482 @@
 #include "core/logger.h"
 
-#include <regex>
-#include <set>
+#include "core/async_logger.h"
+#include "core/binary_log.h"
+#include "core/log_event_sink.h"
+
+#include <algorithm>
+#include <cstdio>
 
 namespace zaphod::logging
 {
-Result Logger::Format::validateFormatString(const std::string& formatString)
+namespace
 {
-	return Result(Result::Code::SUCCESS);
-}
+constexpr std::string_view specialTokenNames[] = { "MESSAGE", "LEVEL", "TIME" };
 
-Result Logger::Format::validateStaticTokens(const Logger::Format::ParameterMap& staticTokens)
+bool isSpecialToken(std::string_view token)
 {
-	return Result(Result::Code::SUCCESS);
+	return std::find(std::begin(specialTokenNames), std::end(specialTokenNames), token) != std::end(specialTokenNames);
 }
 
-Result Logger::Format::validate(const std::string& formatString, const Logger::Format::ParameterMap& staticTokens)
+bool isTokenName(std::string_view token)
 {
-	Result formatResult		 = validateFormatString(formatString);
-	Result staticTokenResult = validateStaticTokens(staticTokens);
-
-	if (!formatResult.isSuccess())
-		return formatResult;
-	if (!staticTokenResult.isSuccess())
-		return staticTokenResult;
-	return Result(Result::Code::SUCCESS);
+	if (token.empty())
+		return false;
+	return std::all_of(token.begin(),
+					   token.end(),
+					   [](char c) { return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; });
 }
 
-bool validateFormatParameters(const std::string& format, const std::unordered_map<std::string, std::string>& parameters)
+bool containsToken(const std::vector<std::string>& tokens, std::string_view token)
 {
-	std::regex			  placeholder_regex(R"((\\)?%\{(!)?(\*)?((?:[A-Z]*[0-9]*_*)*)\}%)");
-	auto				  words_begin	  = std::sregex_iterator(format.begin(), format.end(), placeholder_regex);
-	auto				  words_end		  = std::sregex_iterator();
-	std::set<std::string> specialTokenSet = { "MESSAGE", "LEVEL", "TIME" };
+	return std::find(tokens.begin(), tokens.end(), token) != tokens.end();
+}
+}	 // namespace
 
-	// Uses regex to find all placeholders in the format string
+Result Logger::Format::validateFormatString(const std::string& formatString)
+{
+	std::string				 literals;
+	std::vector<Segment>	 segments;
 	std::vector<std::string> staticTokens;
 	std::vector<std::string> dynamicTokens;
 	std::vector<std::string> specialTokens;
-	for (std::sregex_iterator i = words_begin; i != words_end; ++i)
+
+	auto appendLiteral = [&](std::string_view text)
+	{
+		if (text.empty())
+			return;
+		if (!segments.empty() && segments.back().type == Segment::Type::LITERAL)
+			segments.back().length += static_cast<uint32_t>(text.size());	 // Literals are contiguous, extend the span
+		else
+			segments.push_back(
+				{ Segment::Type::LITERAL, static_cast<uint32_t>(literals.size()), static_cast<uint32_t>(text.size()) });
+		literals.append(text);
+	};
+	auto isDuplicate = [&](std::string_view token)
+	{ return containsToken(staticTokens, token) || containsToken(dynamicTokens, token) || containsToken(specialTokens, token); };
+
+	const std::string_view format(formatString);
+	size_t				   literalStart = 0;
+	size_t				   position		= 0;
+	while (position < format.size())
 	{
-		auto match = *i;
+		bool   isEscaped = format[position] == '\\' && format.substr(position + 1, 2) == "%{";
+		size_t open		 = isEscaped ? position + 1 : position;
+		if (format.substr(open, 2) != "%{")
+		{
+			++position;
+			continue;
+		}
 
-		if (match[1].matched)
-			continue;	 // Skip escaped placeholders
+		size_t close = format.find("}%", open + 2);
+		if (close == std::string_view::npos)
+			return Result(Result::Code::INVALID_ARGUMENT,
+						  "Unterminated placeholder at position " + std::to_string(open) + " of format string");
 
-		if (specialTokenSet.find(match[4].str()) != specialTokenSet.end())
+		if (isEscaped)
 		{
-			if (match[3].matched)
-			{
-				if (match[2].matched)
-				{
-					if (std::find(staticTokens.begin(), staticTokens.end(), match[4].str()) == staticTokens.end() &&
-						std::find(specialTokens.begin(), specialTokens.end(), match[4].str()) == specialTokens.end())
-					{
-						if (std::find(dynamicTokens.begin(), dynamicTokens.end(), match[4].str()) == dynamicTokens.end())
-							dynamicTokens.emplace_back(match[4].str());	   // Add dynamic token
-						else
-							return false;	 // Duplicate token found
-					}
-					else
-						return false;	 // Duplicate token found
-					continue;			 // Special token is dynamic, skip adding to static tokens
-				}
-				else
-					return false;	 // '*' not allowed for special tokens unless the override '!' is used
-			}
-			else
-			{
-				if (!match[2].matched)
-				{
-					if (std::find(specialTokens.begin(), specialTokens.end(), match[4].str()) == specialTokens.end())
-						specialTokens.emplace_back(match[4].str());	   // Add dynamic token
-					else
-						return false;	 // Duplicate token found
-
-					continue;	 // Special token not overriden, skip
-				}
-			}
+			// Drop the '\' and keep the placeholder as literal text
+			appendLiteral(format.substr(literalStart, position - literalStart));
+			literalStart = open;
+			position	 = close + 2;
+			continue;
 		}
-		else
+
+		appendLiteral(format.substr(literalStart, open - literalStart));
+		literalStart = position = close + 2;
+
+		std::string_view token		= format.substr(open + 2, close - open - 2);
+		bool			 isOverride = token.starts_with('!');
+		if (isOverride)
+			token.remove_prefix(1);
+		bool isDynamic = token.starts_with('*');
+		if (isDynamic)
+			token.remove_prefix(1);
+
+		if (!isTokenName(token))
+			return Result(Result::Code::INVALID_ARGUMENT,
+						  "Malformed placeholder '" + std::string(format.substr(open, close + 2 - open)) + "'");
+		if (isDuplicate(token))
+			return Result(Result::Code::INVALID_ARGUMENT, "Duplicate token '" + std::string(token) + "'");
+
+		if (isSpecialToken(token))
 		{
-			if (match[2].matched)
-				return false;	 // '!' not allowed for non special tokens
-			if (match[3].matched)
-			{
+			if (isOverride && token == "MESSAGE")
+				return Result(Result::Code::INVALID_ARGUMENT, "The MESSAGE token may not be overridden");
+			if (isDynamic && !isOverride)
+				return Result(Result::Code::INVALID_ARGUMENT,
+							  "Special token '" + std::string(token) + "' may only be dynamic if it is overridden with '!'");
 
-				if (std::find(staticTokens.begin(), staticTokens.end(), match[4].str()) == staticTokens.end())
-				{
-					if (std::find(dynamicTokens.begin(), dynamicTokens.end(), match[4].str()) == dynamicTokens.end())
-						dynamicTokens.emplace_back(match[4].str());	   // Add dynamic token
-					else
-						return false;	 // Duplicate token found
-				}
-				else
-					return false;	 // Duplicate token found
-
-				continue;	 // Token is dynamic, skip adding to static tokens
+			if (!isOverride)
+			{
+				Segment::Type type = token == "MESSAGE" ? Segment::Type::MESSAGE
+								   : token == "LEVEL"	? Segment::Type::LEVEL
+														: Segment::Type::TIME;
+				segments.push_back({ type });
+				specialTokens.emplace_back(token);
+				continue;
 			}
 		}
+		else if (isOverride)
+			return Result(Result::Code::INVALID_ARGUMENT,
+						  "'!' is not allowed for non special token '" + std::string(token) + "'");
 
-		if (std::find(dynamicTokens.begin(), dynamicTokens.end(), match[4].str()) == dynamicTokens.end())
+		if (isDynamic)
 		{
-			if (std::find(staticTokens.begin(), staticTokens.end(), match[4].str()) == staticTokens.end())
-				staticTokens.emplace_back(match[4].str());
-			else
-				return false;	 // Duplicate token found
+			segments.push_back({ Segment::Type::DYNAMIC, static_cast<uint32_t>(dynamicTokens.size()) });
+			dynamicTokens.emplace_back(token);
 		}
 		else
-			return false;	 // Duplicate token found
+		{
+			segments.push_back({ Segment::Type::STATIC, static_cast<uint32_t>(staticTokens.size()) });
+			staticTokens.emplace_back(token);
+		}
+	}
+	appendLiteral(format.substr(literalStart));
+
+	if (!containsToken(specialTokens, "MESSAGE"))
+		return Result(Result::Code::INVALID_ARGUMENT, "The MESSAGE token is mandatory");
+
+	m_formatString	   = formatString;
+	m_literals		   = std::move(literals);
+	m_segments		   = std::move(segments);
+	m_staticTokenNames = std::move(staticTokens);
+	m_dynamicTokens	   = std::move(dynamicTokens);
+	m_specialTokens	   = std::move(specialTokens);
+	m_staticValues.assign(m_staticTokenNames.size(), std::string());
+	return Result(Result::Code::SUCCESS);
+}
+
+Result Logger::Format::validateStaticTokens(const Logger::Format::ParameterMap& staticTokens)
+{
+	for (const auto& [token, value] : staticTokens)
+	{
+		if (!isTokenName(token))
+			return Result(Result::Code::INVALID_ARGUMENT, "Malformed static token '" + token + "'");
+		if (token == "MESSAGE")
+			return Result(Result::Code::INVALID_ARGUMENT, "The MESSAGE token may not be given a static value");
+		if (isSpecialToken(token) && !containsToken(m_staticTokenNames, token))
+			return Result(Result::Code::INVALID_ARGUMENT,
+						  "Special token '" + token + "' may only be given a value if it is overridden in the format string");
 	}
 
-	bool isMessageInFormat = false;
-	for (const auto& placeholder : staticTokens)
+	std::vector<std::string> values;
+	values.reserve(m_staticTokenNames.size());
+	for (const auto& token : m_staticTokenNames)
 	{
-		if (placeholder.size() == 0)
-			return false;	 // Empty placeholder found
+		auto it = staticTokens.find(token);
+		if (it == staticTokens.end())
+			return Result(Result::Code::INVALID_ARGUMENT, "Missing value for static token '" + token + "'");
+		values.push_back(it->second);
+	}
+
+	m_staticValues = std::move(values);
+	if (&staticTokens != &m_staticTokens)
+		m_staticTokens = staticTokens;
+	return Result(Result::Code::SUCCESS);
+}
 
-		if (placeholder == "MESSAGE")
-			isMessageInFormat = true;	 // Message placeholder found in format string
+Result Logger::Format::validate(const std::string& formatString, const Logger::Format::ParameterMap& staticTokens)
+{
+	Result formatResult = validateFormatString(formatString);
+	m_isFormatValid		= formatResult.isSuccess();
+	if (!m_isFormatValid)
+	{
+		m_isValid = false;
+		return formatResult;
+	}
 
-		if (parameters.find(placeholder) == parameters.end())
-		{
-			return false;	 // Placeholder not found in parameters
-		}
-		else if (parameters.size() != 0)
+	Result staticTokenResult = validateStaticTokens(staticTokens);
+	m_isValid				 = staticTokenResult.isSuccess();
+	return staticTokenResult;
+}
+
+void Logger::Format::setStaticToken(const std::string& token, const std::string& value)
+{
+	auto it = std::find(m_staticTokenNames.begin(), m_staticTokenNames.end(), token);
+	if (it == m_staticTokenNames.end())
+		return;
+
+	m_staticTokens.insert_or_assign(token, value);
+	if (m_isValid)
+		m_staticValues[it - m_staticTokenNames.begin()] = value;
+	else
+		m_isValid = m_isFormatValid && validateStaticTokens(m_staticTokens).isSuccess();	// The token may have been the missing one
+}
+
+void Logger::Format::render(std::string&					   output,
+							std::string_view				   message,
+							LogLevel						   level,
+							std::string_view				   time,
+							std::span<const std::string_view> dynamicParameters) const
+{
+	if (!m_isValid)
+		return;
+
+	for (const Segment& segment : m_segments)
+	{
+		switch (segment.type)
 		{
-			if (placeholder == "MESSAGE")
-				return false;	 // MESSAGE should not be in parameters
-			else if (placeholder == "LEVEL")
-				return false;	 // LEVEL should not be in parameters
-			else if (placeholder == "TIME")
-				return false;	 // TIME should not be in parameters
+		case Segment::Type::LITERAL: output.append(m_literals, segment.offset, segment.length); break;
+		case Segment::Type::STATIC: output.append(m_staticValues[segment.offset]); break;
+		case Segment::Type::DYNAMIC:
+			if (segment.offset < dynamicParameters.size())
+				output.append(dynamicParameters[segment.offset]);
+			break;
+		case Segment::Type::MESSAGE: output.append(message); break;
+		case Segment::Type::LEVEL: output.append(Logger::getLogLevelName(level)); break;
+		case Segment::Type::TIME: output.append(time); break;
 		}
 	}
-	if (isMessageInFormat)
-		return true;	// All placeholders are valid and MESSAGE is present in format string
-	else
-		return false;	 // MESSAGE placeholder is mandatory
 }
 
+bool validateFormatParameters(const std::string& format, const std::unordered_map<std::string, std::string>& parameters)
+{
+	return Logger::Format(format, parameters).isValid();
+}
+
+std::string_view Logger::getLogLevelName(LogLevel level)
+{
+	switch (level)
+	{
+	case LogLevel::INFO: return "INFO";
+	case LogLevel::DEBUG: return "DEBUG";
+	case LogLevel::WARN: return "WARN";
+	case LogLevel::ERROR: return "ERROR";
+	case LogLevel::FATAL: return "FATAL";
+	default: return "";
+	}
+}
+
+Logger::Logger() = default;
+
+Logger::~Logger() = default;
+
 void Logger::addFormat(const Format& format)
 {
+	std::unique_lock lock(m_formatMutex);
 	m_formats.push_back(format);
+	if (m_binaryWriter)
+		m_binaryWriter->setFormats(m_formats);
+}
+
+void Logger::removeFormat(const size_t index)
+{
+	std::unique_lock lock(m_formatMutex);
+	if (index < m_formats.size())
+		m_formats.erase(m_formats.begin() + index);
+	if (m_binaryWriter)
+		m_binaryWriter->setFormats(m_formats);
 }
 
 void Logger::setFormat(const size_t index, const Format& format)
 {
+	std::unique_lock lock(m_formatMutex);
 	m_formats[index] = format;
+	if (m_binaryWriter)
+		m_binaryWriter->setFormats(m_formats);
 }
 
 void Logger::updateFormatParameter(const size_t index, const std::string& token, const std::string& value)
 {
-	auto format = m_formats.at(index);
+	std::unique_lock lock(m_formatMutex);
+	auto& format = m_formats.at(index);
 	format.setStaticToken(token, value);
+	if (m_binaryWriter)
+		m_binaryWriter->setFormats(m_formats);
+}
+
+void Logger::enableAsync(const AsyncConfig& config)
+{
+	disableAsync();
+	m_asyncBackend = std::make_unique<AsyncLogBackend>(*this, config);
+}
+
+void Logger::disableAsync()
+{
+	m_asyncBackend.reset();	   // The backend drains its queue before stopping
+}
+
+void Logger::flush()
+{
+	if (m_asyncBackend)
+		m_asyncBackend->flush();
+	if (m_fileWriter)
+		m_fileWriter->flush();
+	if (m_binaryWriter)
+		m_binaryWriter->flush();
+}
+
+Result Logger::setLogFile(const LogFileWriter::Config& config)
+{
+	if (!m_fileWriter)
+		m_fileWriter = std::make_unique<LogFileWriter>();
+
+	Result result = m_fileWriter->open(config);
+	if (result.isSuccess())
+		addDestination(LogDestination::FILE);
+	return result;
+}
+
+void Logger::closeLogFile()
+{
+	flush();
+	removeDestination(LogDestination::FILE);
+	m_fileWriter.reset();
+}
+
+Result Logger::setBinaryLogFile(const LogFileWriter::Config& config)
+{
+	if (!m_binaryWriter)
+		m_binaryWriter = std::make_unique<BinaryLogWriter>();
+
+	std::shared_lock formatLock(m_formatMutex);
+	Result			 result = m_binaryWriter->open(config, m_formats);
+	formatLock.unlock();
+	if (result.isSuccess())
+		addDestination(LogDestination::BINARY);
+	return result;
+}
+
+void Logger::closeBinaryLogFile()
+{
+	flush();
+	removeDestination(LogDestination::BINARY);
+	m_binaryWriter.reset();
+}
+
+void Logger::setEventSink(events::LogEventSink* sink)
+{
+	m_eventSink = sink;
+	if (sink)
+		addDestination(LogDestination::EVENTS);
+	else
+		removeDestination(LogDestination::EVENTS);
+}
+
+void Logger::writeToFile(std::string_view line, LogLevel level)
+{
+	if (m_fileWriter && m_destinations.contains(LogDestination::FILE))
+		m_fileWriter->write(line, level == LogLevel::FATAL);
+}
+
+void Logger::writeToBinaryLog(const Record& record)
+{
+	if (m_binaryWriter && m_destinations.contains(LogDestination::BINARY))
+		m_binaryWriter->write(record);
+}
+
+void Logger::writeToEvents(const Record& record)
+{
+	if (m_eventSink && m_destinations.contains(LogDestination::EVENTS))
+		m_eventSink->push(record);
+}
+
+void Logger::flushDestinations()
+{
+	if (m_fileWriter)
+		m_fileWriter->flushIfDue();
+	if (m_binaryWriter)
+		m_binaryWriter->flushIfDue();
+}
+
+void Logger::log(std::string_view				   message,
+				 std::span<const std::string_view> dynamicParameters,
+				 size_t							   formatIndex,
+				 LogLevel						   level)
+{
+	if (isEnabled(level))
+		submit(message, dynamicParameters, formatIndex, level);
+}
+
+void Logger::submit(std::string_view				  message,
+					std::span<const std::string_view> dynamicParameters,
+					size_t							  formatIndex,
+					LogLevel						  level)
+{
+	Record record { message, dynamicParameters, formatIndex, level, m_clock->now() };
+	if (!m_asyncBackend)
+	{
+		write(record);
+		return;
+	}
+
+	m_asyncBackend->enqueue(record);
+	if (level == LogLevel::FATAL)
+		m_asyncBackend->flush();	// The application is likely about to go down
+}
+
+bool Logger::renderMessage(std::string& output, const Record& record) const
+{
+	std::shared_lock lock(m_formatMutex);
+	if (record.formatIndex >= m_formats.size() || !m_formats[record.formatIndex].isValid())
+		return false;
+
+	// Called from the logging threads (or the sink thread), so every thread keeps its own cache
+	thread_local TimestampCache timestampCache;
+	m_formats[record.formatIndex].render(output,
+										 record.message,
+										 record.level,
+										 timestampCache.format(record.time, std::min(m_timePrecision, m_clockPrecision)),
+										 record.dynamicParameters);
+	return true;
+}
+
+void SimpleLogger::write(const Record& record)
+{
+	writeToBinaryLog(record);
+	writeToEvents(record);
+	if (!hasTextDestination())
+		return;
+
+	// Reused across calls so steady-state logging does not reallocate
+	thread_local std::string buffer;
+	buffer.clear();
+	if (!renderMessage(buffer, record))
+		return;
+	buffer.push_back('\n');
+
+	if (m_destinations.contains(LogDestination::CONSOLE))
+		std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+	writeToFile(buffer, record.level);
+}
+
+void ErrorLogger::write(const Record& record)
+{
+	writeToBinaryLog(record);
+	writeToEvents(record);
+	if (!hasTextDestination())
+		return;
+
+	thread_local std::string buffer;
+	buffer.clear();
+	if (!renderMessage(buffer, record))
+		return;
+	buffer.push_back('\n');
+
+	if (m_destinations.contains(LogDestination::CONSOLE))
+	{
+		const char* color = record.level == LogLevel::WARN	  ? "\x1b[33m"
+						  : record.level == LogLevel::ERROR ? "\x1b[38;5;208m"
+															: "\x1b[31m";
+		std::fputs(color, stderr);
+		std::fwrite(buffer.data(), 1, buffer.size() - 1, stderr);
+		std::fputs("\x1b[0m\n", stderr);
+	}
+	writeToFile(buffer, record.level);
 }
 
 std::unique_ptr<SimpleLogger> SimpleLoggerFactory::create()
 {
 	auto logger = std::make_unique<SimpleLogger>();
 
-	Logger::Format defaultFormat(std::string(SimpleLogger::defaultFormatString), Logger::Format::ParameterMap {});
+	Logger::Format defaultFormat(std::string(SimpleLogger::defaultFormatString),
+								 Logger::Format::ParameterMap { { "SOURCE", m_source } });
 	logger->addFormat(defaultFormat);
 	logger->addDestination(Logger::LogDestination::CONSOLE);
 	logger->setLogLevelFlags({ Logger::LogLevel::INFO, Logger::LogLevel::DEBUG });
-	return std::move(logger);	
+	applyAsync(*logger);
+	return logger;
 }
 
-}	 // namespace zaphod::logging
\ No newline at end of file
+}	 // namespace zaphod::logging
@@ -0,0 +1,237 @@
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string_view>
+
+namespace zaphod::profiling
+{
+namespace
+{
+// Zone names are mostly literals, but __func__ of an operator may hold quotes
+void writeJsonString(std::ofstream& stream, const std::string_view text)
+{
+	stream.put('"');
+	for (const char c : text)
+	{
+		if (c == '"' || c == '\\')
+			stream.put('\\');
+		if (static_cast<unsigned char>(c) >= 0x20)
+			stream.put(c);
+	}
+	stream.put('"');
+}
+}	 // namespace
+
+thread_local Profiler::ThreadTrack Profiler::t_threadTrack;
+
+Profiler::ThreadTrack::~ThreadTrack()
+{
+	if (track)
+		Profiler::get().releaseTrack(track);
+}
+
+Profiler& Profiler::get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler(): m_epoch(Clock::now())
+{
+	m_gpuTrack = createTrack("GPU");
+}
+
+void Profiler::startCapture()
+{
+	// Tracks notice the new capture on their next zone and start over
+	m_droppedZones.store(0, std::memory_order_relaxed);
+	m_capture.fetch_add(1, std::memory_order_relaxed);
+	m_isCapturing.store(true, std::memory_order_release);
+}
+
+void Profiler::stopCapture()
+{
+	m_isCapturing.store(false, std::memory_order_release);
+}
+
+Result Profiler::exportChromeTrace(const std::filesystem::path& path) const
+{
+	std::ofstream stream(path, std::ios::trunc);
+	if (!stream)
+		return Result(Result::Code::IO_ERROR, "Failed to open " + path.string());
+
+	const uint32_t capture = m_capture.load(std::memory_order_relaxed);
+	std::lock_guard lock(m_trackMutex);
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool isFirst = true;
+	for (const std::unique_ptr<Track>& track : m_tracks)
+	{
+		stream << (isFirst ? "\n" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << track->id
+			   << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+		writeJsonString(stream, track->name);
+		stream << "}}";
+		isFirst = false;
+
+		const uint32_t count = track->count.load(std::memory_order_acquire);
+		if (track->capture.load(std::memory_order_relaxed) != capture)
+			continue;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			// Microseconds with nanosecond precision
+			const Zone& zone = track->zones[i];
+			char		times[64];
+			std::snprintf(times, sizeof(times), ",\"ts\":%.3f,\"dur\":%.3f}", zone.start / 1000.0, zone.duration / 1000.0);
+			stream << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << track->id << ",\"name\":";
+			writeJsonString(stream, zone.name);
+			stream << times;
+		}
+	}
+	stream << "\n]}\n";
+	if (!stream)
+		return Result(Result::Code::IO_ERROR, "Failed to write " + path.string());
+	return Result(Result::Code::SUCCESS);
+}
+
+void Profiler::setThreadName(std::string name)
+{
+	Track*			track = getThreadTrack();
+	std::lock_guard lock(m_trackMutex);
+	track->name = std::move(name);
+}
+
+void Profiler::recordZone(const Zone& zone)
+{
+	if (isCapturing())
+		record(*getThreadTrack(), zone);
+}
+
+void Profiler::recordGpuZone(const Zone& zone)
+{
+	if (isCapturing())
+		record(*m_gpuTrack, zone);
+}
+
+void Profiler::markFrame()
+{
+	const Clock::time_point now = Clock::now();
+	if (m_lastFrame != Clock::time_point())
+	{
+		if (isCapturing())
+			recordZone({ "Frame", toTimestamp(m_lastFrame), toTimestamp(now) - toTimestamp(m_lastFrame) });
+
+		std::lock_guard lock(m_frameMutex);
+		m_cpuFrames.add(std::chrono::duration<double, std::milli>(now - m_lastFrame).count());
+	}
+	m_lastFrame = now;
+}
+
+void Profiler::recordGpuFrame(double milliseconds)
+{
+	std::lock_guard lock(m_frameMutex);
+	m_gpuFrames.add(milliseconds);
+}
+
+FrameStats Profiler::getFrameStats() const
+{
+	std::lock_guard lock(m_frameMutex);
+	return m_cpuFrames.summarize();
+}
+
+FrameStats Profiler::getGpuFrameStats() const
+{
+	std::lock_guard lock(m_frameMutex);
+	return m_gpuFrames.summarize();
+}
+
+Profiler::Track* Profiler::getThreadTrack()
+{
+	if (!t_threadTrack.track)
+		t_threadTrack.track = createTrack("Thread");
+	return t_threadTrack.track;
+}
+
+Profiler::Track* Profiler::createTrack(std::string name)
+{
+	{
+		// A thread that exited during the current capture keeps its zones in the trace until the next one
+		const uint32_t capture	  = m_capture.load(std::memory_order_relaxed);
+		auto		   isReusable = [capture](const Track* track)
+		{
+			return track->capture.load(std::memory_order_relaxed) != capture
+				   || track->count.load(std::memory_order_relaxed) == 0;
+		};
+		std::lock_guard lock(m_trackMutex);
+		auto			it = std::find_if(m_freeTracks.begin(), m_freeTracks.end(), isReusable);
+		if (it != m_freeTracks.end())
+		{
+			Track* track = *it;
+			m_freeTracks.erase(it);
+			track->name = std::move(name);
+			return track;
+		}
+	}
+
+	auto track	 = std::make_unique<Track>();
+	track->name	 = std::move(name);
+	track->zones = std::make_unique<Zone[]>(zonesPerTrack);
+
+	std::lock_guard lock(m_trackMutex);
+	track->id = static_cast<uint32_t>(m_tracks.size());
+	m_tracks.push_back(std::move(track));
+	return m_tracks.back().get();
+}
+
+void Profiler::releaseTrack(Track* track)
+{
+	std::lock_guard lock(m_trackMutex);
+	m_freeTracks.push_back(track);
+}
+
+void Profiler::record(Track& track, const Zone& zone)
+{
+	const uint32_t capture = m_capture.load(std::memory_order_relaxed);
+	uint32_t	   count   = track.count.load(std::memory_order_relaxed);
+	if (track.capture.load(std::memory_order_relaxed) != capture)
+	{
+		track.capture.store(capture, std::memory_order_relaxed);
+		count = 0;
+	}
+	if (count == zonesPerTrack)
+	{
+		m_droppedZones.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	track.zones[count] = zone;
+	track.count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::FrameHistory::add(double milliseconds)
+{
+	times[next] = milliseconds;
+	next		= (next + 1) % frameHistorySize;
+	count		= std::min(count + 1, frameHistorySize);
+}
+
+FrameStats Profiler::FrameHistory::summarize() const
+{
+	FrameStats stats;
+	stats.frameCount = count;
+	if (count == 0)
+		return stats;
+
+	// The ring is full before it wraps, so its first count entries are the frames
+	double sorted[frameHistorySize];
+	std::copy(times, times + count, sorted);
+	std::sort(sorted, sorted + count);
+	double sum = 0.0;
+	for (uint32_t i = 0; i < count; ++i)
+		sum += sorted[i];
+	stats.average = sum / count;
+	stats.p50	  = sorted[count / 2];
+	stats.p99	  = sorted[std::min(count - 1, count * 99 / 100)];
+	stats.max	  = sorted[count - 1];
+	return stats;
+}
+}	 // namespace zaphod::profiling
@@ -0,0 +1,118 @@
+#include "gui/input_system.h"
+
+#include <algorithm>
+
+namespace zaphod
+{
+InputSystem::InputSystem(size_t capacity): m_events(capacity), m_state(&m_states[0])
+{
+}
+
+bool InputSystem::record(const RawInputEvent& event)
+{
+	if (m_events.tryPush(event))
+		return true;
+	m_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+const InputState& InputSystem::update()
+{
+	// Carry the held keys, the cursor and the focus over from the last snapshot, the rest is per frame
+	InputState& state = m_states[m_nextState];
+	state			  = getState();
+	state.m_keysPressed.reset();
+	state.m_keysReleased.reset();
+	state.m_buttonsPressed.reset();
+	state.m_buttonsReleased.reset();
+	state.m_cursorDeltaX	= 0.0;
+	state.m_cursorDeltaY	= 0.0;
+	state.m_scrollX			= 0.0;
+	state.m_scrollY			= 0.0;
+	state.m_textLength		= 0;
+	state.m_eventCount		= 0;
+	state.m_latestEventTime = 0;
+	++state.m_frameNumber;
+
+	// Bounded by the capacity, so producers on other threads cannot keep the frame from finishing
+	const size_t capacity = m_events.getCapacity();
+	for (size_t i = 0; i < capacity && m_events.tryPopWith([&](RawInputEvent& event) { apply(state, event); }); ++i)
+		;
+
+	m_state.store(&state, std::memory_order_release);
+	m_nextState = (m_nextState + 1) % m_states.size();
+	return state;
+}
+
+void InputSystem::apply(InputState& state, const RawInputEvent& event)
+{
+	++state.m_eventCount;
+	state.m_latestEventTime = std::max(state.m_latestEventTime, event.time);
+
+	switch (event.type)
+	{
+	case RawInputEvent::Type::KEY:
+		state.m_mods = event.mods;
+		if (event.action == GLFW_PRESS)
+		{
+			state.m_keysDown.setFlag(Key(event.code));
+			state.m_keysPressed.setFlag(Key(event.code));
+		}
+		else if (event.action == GLFW_RELEASE)
+		{
+			state.m_keysDown.unsetFlag(Key(event.code));
+			state.m_keysReleased.setFlag(Key(event.code));
+		}
+		break;
+	case RawInputEvent::Type::MOUSE_BUTTON:
+		state.m_mods = event.mods;
+		if (event.action == GLFW_PRESS)
+		{
+			state.m_buttonsDown.setFlag(MouseButton(event.code));
+			state.m_buttonsPressed.setFlag(MouseButton(event.code));
+		}
+		else if (event.action == GLFW_RELEASE)
+		{
+			state.m_buttonsDown.unsetFlag(MouseButton(event.code));
+			state.m_buttonsReleased.setFlag(MouseButton(event.code));
+		}
+		break;
+	case RawInputEvent::Type::CURSOR:
+		// Positions in different windows are relative to different origins, so moving over to
+		// another window starts a new delta instead of jumping by the distance between them
+		if (event.window == m_cursorWindow)
+		{
+			state.m_cursorDeltaX += event.x - state.m_cursorX;
+			state.m_cursorDeltaY += event.y - state.m_cursorY;
+		}
+		state.m_cursorX = event.x;
+		state.m_cursorY = event.y;
+		m_cursorWindow	= event.window;
+		break;
+	case RawInputEvent::Type::SCROLL:
+		state.m_scrollX += event.x;
+		state.m_scrollY += event.y;
+		break;
+	case RawInputEvent::Type::CHAR:
+		if (state.m_textLength < InputState::maxTextLength)
+			state.m_text[state.m_textLength++] = static_cast<char32_t>(event.code);
+		break;
+	case RawInputEvent::Type::FOCUS:
+		if (event.code != 0)
+		{
+			state.m_focusedWindow = event.window;
+			break;
+		}
+		if (state.m_focusedWindow == event.window)
+			state.m_focusedWindow = nullptr;
+
+		// The window will not report the releases, so held keys and buttons are released here
+		state.m_keysReleased |= state.m_keysDown;
+		state.m_buttonsReleased |= state.m_buttonsDown;
+		state.m_keysDown.reset();
+		state.m_buttonsDown.reset();
+		m_cursorWindow = nullptr;
+		break;
+	}
+}
+}	 // namespace zaphod
@@ -1,25 +1,175 @@
 #include "gui/window.h"
 
+#include "core/event_bus.h"
+#include "gui/input_system.h"
+#include "gui/window_events.h"
+
+#include <chrono>
+#include <utility>
+
 namespace zaphod
 {
-Window::Window(int width, int height, const char* title) {
+namespace
+{
+Window* getWindow(GLFWwindow* glfwWindow)
+{
+	return static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow));
+}
+
+// Forwards a GLFW callback to the bus of the window it was raised for
+template<typename T, typename... Args>
+void publish(Window* window, Args... args)
+{
+	if (window->getEventBus())
+		window->getEventBus()->publish(T { {}, window, args... });
+}
+
+// Hands the input of a GLFW callback to the input system of the window it was raised for
+void record(Window* window, RawInputEvent::Type type, int code, int action = 0, int mods = 0, double x = 0.0, double y = 0.0)
+{
+	InputSystem* inputSystem = window->getInputSystem();
+	if (!inputSystem)
+		return;
+	const auto time = std::chrono::steady_clock::now().time_since_epoch();
+	inputSystem->record({ type, code, action, mods, x, y, window,
+						  std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() });
+}
+}	 // namespace
+
+Window::Window(int width, int height, const char* title, bool resizable) {
 	// Initialize GLFW window
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);	   // Disable window resizing for now
+	glfwWindowHint(GLFW_RESIZABLE, resizable ? GLFW_TRUE : GLFW_FALSE);
 
 	m_window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+	if (!m_window)
+		return;
+	glfwSetWindowUserPointer(m_window, this);
+
+	using namespace events;
+	using Type = RawInputEvent::Type;
+
+	// Installed once, each callback checks for a bus and an input system when it is raised
+	glfwSetWindowCloseCallback(m_window, [](GLFWwindow* window) { publish<WindowCloseEvent>(getWindow(window)); });
+	glfwSetFramebufferSizeCallback(m_window,
+								   [](GLFWwindow* window, int width, int height)
+								   { publish<WindowResizeEvent>(getWindow(window), width, height); });
+	glfwSetWindowFocusCallback(m_window,
+							   [](GLFWwindow* glfwWindow, int focused)
+							   {
+								   Window* window = getWindow(glfwWindow);
+								   record(window, Type::FOCUS, focused == GLFW_TRUE ? 1 : 0);
+								   publish<WindowFocusEvent>(window, focused == GLFW_TRUE);
+							   });
+	glfwSetKeyCallback(m_window,
+					   [](GLFWwindow* glfwWindow, int key, int scancode, int action, int mods)
+					   {
+						   Window* window = getWindow(glfwWindow);
+						   record(window, Type::KEY, key, action, mods);
+						   publish<KeyEvent>(window, key, scancode, action, mods);
+					   });
+	glfwSetCharCallback(m_window,
+						[](GLFWwindow* glfwWindow, unsigned int codepoint)
+						{
+							Window* window = getWindow(glfwWindow);
+							record(window, Type::CHAR, static_cast<int>(codepoint));
+							publish<CharEvent>(window, uint32_t(codepoint));
+						});
+	glfwSetMouseButtonCallback(m_window,
+							   [](GLFWwindow* glfwWindow, int button, int action, int mods)
+							   {
+								   Window* window = getWindow(glfwWindow);
+								   record(window, Type::MOUSE_BUTTON, button, action, mods);
+								   publish<MouseButtonEvent>(window, button, action, mods);
+							   });
+	glfwSetCursorPosCallback(m_window,
+							 [](GLFWwindow* glfwWindow, double x, double y)
+							 {
+								 Window* window = getWindow(glfwWindow);
+								 record(window, Type::CURSOR, 0, 0, 0, x, y);
+								 publish<MouseMoveEvent>(window, x, y);
+							 });
+	glfwSetScrollCallback(m_window,
+						  [](GLFWwindow* glfwWindow, double xOffset, double yOffset)
+						  {
+							  Window* window = getWindow(glfwWindow);
+							  record(window, Type::SCROLL, 0, 0, 0, xOffset, yOffset);
+							  publish<MouseScrollEvent>(window, xOffset, yOffset);
+						  });
 }
 
-Window::~Window() {}
+Window::~Window()
+{
+	if (m_window)
+		glfwDestroyWindow(m_window);
+}
 
 bool Window::shouldClose() const
 {
 	return glfwWindowShouldClose(m_window);
 }
 
-void Window::pollEvents() const {
+void Window::pollEvents()
+{
 	glfwPollEvents();
 }
+
+void Window::waitEvents(double timeout)
+{
+	glfwWaitEventsTimeout(timeout);
+}
+
+bool Window::isFocused() const
+{
+	return glfwGetWindowAttrib(m_window, GLFW_FOCUSED) == GLFW_TRUE;
+}
+
+bool Window::isMinimized() const
+{
+	return glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) == GLFW_TRUE;
+}
+
+void Window::getFramebufferSize(int& width, int& height) const
+{
+	glfwGetFramebufferSize(m_window, &width, &height);
+}
+
+VkSurfaceKHR Window::createSurface(VkInstance instance) const
+{
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	if (glfwCreateWindowSurface(instance, m_window, nullptr, &surface) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+	return surface;
+}
+
+void Window::setCursorCaptured(bool captured)
+{
+	glfwSetInputMode(m_window, GLFW_CURSOR, captured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+	if (glfwRawMouseMotionSupported())
+		glfwSetInputMode(m_window, GLFW_RAW_MOUSE_MOTION, captured ? GLFW_TRUE : GLFW_FALSE);
+}
+
+bool Window::isCursorCaptured() const
+{
+	return glfwGetInputMode(m_window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED;
+}
+
+void Window::setRefreshCallback(std::function<void(Window&)> callback)
+{
+	m_refreshCallback = std::move(callback);
+	if (!m_refreshCallback)
+	{
+		glfwSetWindowRefreshCallback(m_window, nullptr);
+		return;
+	}
+	glfwSetWindowRefreshCallback(m_window,
+								 [](GLFWwindow* glfwWindow)
+								 {
+									 auto* window = static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow));
+									 if (window && window->m_refreshCallback)
+										 window->m_refreshCallback(*window);
+								 });
+}
 }	 // namespace zaphod
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "math/kernels.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <atomic>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace zaphod::math
+{
+static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "The kernels treat matrices as 16 floats");
+static_assert(sizeof(glm::vec4) == 4 * sizeof(float), "The kernels treat spheres as 4 floats");
+
+namespace
+{
+// Matrices are 16 floats, column-major
+void propagateTransformsScalar(const float* local, const uint32_t* parents, size_t count, float* world)
+{
+	const glm::mat4* in	 = reinterpret_cast<const glm::mat4*>(local);
+	glm::mat4*		 out = reinterpret_cast<glm::mat4*>(world);
+	for (size_t i = 0; i < count; ++i)
+		out[i] = parents[i] == noParent ? in[i] : out[parents[i]] * in[i];
+}
+
+constexpr detail::KernelTable scalarKernels {
+	[](const TransformArrays& local, size_t count, float* matrices)
+	{ detail::composeTransformsScalar(local, 0, count, matrices); },
+	propagateTransformsScalar,
+	[](const float* world, const float* local, size_t count, const SphereArrays& spheres)
+	{ detail::transformSpheresScalar(world, local, 0, count, spheres); },
+	[](const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible)
+	{ return detail::cullSpheresScalar(frustum, spheres, 0, count, visible); },
+	[](const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible)
+	{ return detail::cullBoxesScalar(frustum, boxes, 0, count, visible); }
+};
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+	int info[4];
+	__cpuid(info, 1);
+	const bool hasFma	= info[2] & (1 << 12);
+	const bool hasXsave = info[2] & (1 << 27);
+	const bool hasAvx	= info[2] & (1 << 28);
+	const bool savesYmm = hasXsave && (_xgetbv(0) & 0x6) == 0x6;	// The OS saves the AVX registers
+	__cpuidex(info, 7, 0);
+	return hasFma && hasAvx && savesYmm && (info[1] & (1 << 5));
+#elif defined(__x86_64__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+const detail::KernelTable* getKernels(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SCALAR: return &scalarKernels;
+	case SimdLevel::SSE: return detail::getSseKernels();
+	case SimdLevel::AVX2: return cpuHasAvx2() ? detail::getAvx2Kernels() : nullptr;
+	case SimdLevel::NEON: return detail::getNeonKernels();
+	}
+	return nullptr;
+}
+
+SimdLevel detectSimdLevel()
+{
+	for (SimdLevel level : { SimdLevel::AVX2, SimdLevel::NEON, SimdLevel::SSE })
+	{
+		if (getKernels(level))
+			return level;
+	}
+	return SimdLevel::SCALAR;
+}
+
+// Function-local so kernels called during static initialization find it initialized
+struct Dispatch
+{
+	Dispatch(): supportedLevel(detectSimdLevel()), level(supportedLevel), kernels(getKernels(supportedLevel)) {}
+
+	const SimdLevel							supportedLevel;
+	std::atomic<SimdLevel>					level;
+	std::atomic<const detail::KernelTable*> kernels;
+};
+
+Dispatch& getDispatch()
+{
+	static Dispatch dispatch;
+	return dispatch;
+}
+
+const detail::KernelTable& getKernels()
+{
+	return *getDispatch().kernels.load(std::memory_order_relaxed);
+}
+}	 // namespace
+
+void detail::composeTransformsScalar(const TransformArrays& local, size_t begin, size_t count, float* matrices)
+{
+	glm::mat4* out = reinterpret_cast<glm::mat4*>(matrices);
+	for (size_t i = begin; i < count; ++i)
+	{
+		const glm::quat rotation(local.rotationW[i], local.rotationX[i], local.rotationY[i], local.rotationZ[i]);
+		glm::mat4		matrix = glm::mat4_cast(rotation);
+		matrix[0] *= local.scaleX[i];
+		matrix[1] *= local.scaleY[i];
+		matrix[2] *= local.scaleZ[i];
+		matrix[3] = glm::vec4(local.positionX[i], local.positionY[i], local.positionZ[i], 1.0f);
+		out[i]	  = matrix;
+	}
+}
+
+void detail::transformSpheresScalar(const float* world, const float* local, size_t begin, size_t count,
+										const SphereArrays& spheres)
+{
+	const glm::mat4* matrices = reinterpret_cast<const glm::mat4*>(world);
+	const glm::vec4* in		  = reinterpret_cast<const glm::vec4*>(local);
+	for (size_t i = begin; i < count; ++i)
+	{
+		const glm::mat4& matrix = matrices[i];
+		const glm::vec4	 center = matrix * glm::vec4(in[i].x, in[i].y, in[i].z, 1.0f);
+		const float		 scale	= glm::sqrt(glm::max(glm::max(glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+															  glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]))),
+													 glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))));
+		spheres.x[i]			= center.x;
+		spheres.y[i]			= center.y;
+		spheres.z[i]			= center.z;
+		spheres.radius[i]		= in[i].w * scale;
+	}
+}
+
+size_t detail::cullSpheresScalar(const Frustum& frustum, const SphereArrays& spheres, size_t begin, size_t count,
+								  uint32_t* visible)
+{
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < count; ++i)
+	{
+		const glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+		bool			inside = true;
+		for (const float* plane : frustum.planes)
+			inside = inside && glm::dot(glm::vec3(plane[0], plane[1], plane[2]), center) + plane[3] >= -spheres.radius[i];
+
+		// Written either way, kept only if visible, so the loop does not branch on the result
+		visible[visibleCount] = static_cast<uint32_t>(i);
+		visibleCount += inside;
+	}
+	return visibleCount;
+}
+
+size_t detail::cullBoxesScalar(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t count, uint32_t* visible)
+{
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < count; ++i)
+	{
+		const glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+		const glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		bool			inside = true;
+		for (const float* plane : frustum.planes)
+		{
+			// The distance of the box's corner furthest along the normal
+			const glm::vec3 normal(plane[0], plane[1], plane[2]);
+			inside = inside && glm::dot(normal, center) + glm::dot(glm::abs(normal), extent) + plane[3] >= 0.0f;
+		}
+
+		visible[visibleCount] = static_cast<uint32_t>(i);
+		visibleCount += inside;
+	}
+	return visibleCount;
+}
+
+SimdLevel getSupportedSimdLevel()
+{
+	return getDispatch().supportedLevel;
+}
+
+SimdLevel getSimdLevel()
+{
+	return getDispatch().level.load(std::memory_order_relaxed);
+}
+
+SimdLevel setSimdLevel(SimdLevel level)
+{
+	const detail::KernelTable* kernels = getKernels(level);
+	if (!kernels)
+	{
+		level	= SimdLevel::SCALAR;
+		kernels = &scalarKernels;
+	}
+	Dispatch& dispatch = getDispatch();
+	dispatch.kernels.store(kernels, std::memory_order_relaxed);
+	dispatch.level.store(level, std::memory_order_relaxed);
+	return level;
+}
+
+const char* toString(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SCALAR: return "Scalar";
+	case SimdLevel::SSE: return "SSE";
+	case SimdLevel::AVX2: return "AVX2";
+	case SimdLevel::NEON: return "NEON";
+	}
+	return "Unknown";
+}
+
+void composeTransforms(const TransformArrays& local, size_t count, glm::mat4* matrices)
+{
+	getKernels().composeTransforms(local, count, reinterpret_cast<float*>(matrices));
+}
+
+void propagateTransforms(const glm::mat4* local, const uint32_t* parents, size_t count, glm::mat4* world)
+{
+	getKernels().propagateTransforms(reinterpret_cast<const float*>(local), parents, count, reinterpret_cast<float*>(world));
+}
+
+void transformSpheres(const glm::mat4* world, const glm::vec4* local, size_t count, const SphereArrays& spheres)
+{
+	getKernels().transformSpheres(reinterpret_cast<const float*>(world), reinterpret_cast<const float*>(local), count, spheres);
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible)
+{
+	return getKernels().cullSpheres(frustum, spheres, count, visible);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible)
+{
+	return getKernels().cullBoxes(frustum, boxes, count, visible);
+}
+}	 // namespace zaphod::math
@@ -0,0 +1,260 @@
+#include "math/kernels.h"
+
+// The build compiles this file alone for AVX2 and FMA, and only calls it once the CPU reports both. Nothing here may
+// call an inline function other files use as well, e.g. from glm or the standard library: the linker keeps one copy,
+// and if it is the AVX2 one every path runs AVX2 instructions.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace zaphod::math::detail
+{
+#if defined(__AVX2__)
+namespace
+{
+constexpr size_t lanes = 8;
+
+// Store 4 registers holding one column's rows of 8 matrices as that column of each matrix
+void storeColumns(const __m256 rows[4], float* matrices, int column)
+{
+	for (int half = 0; half < 2; ++half)
+	{
+		__m128 r0 = half ? _mm256_extractf128_ps(rows[0], 1) : _mm256_castps256_ps128(rows[0]);
+		__m128 r1 = half ? _mm256_extractf128_ps(rows[1], 1) : _mm256_castps256_ps128(rows[1]);
+		__m128 r2 = half ? _mm256_extractf128_ps(rows[2], 1) : _mm256_castps256_ps128(rows[2]);
+		__m128 r3 = half ? _mm256_extractf128_ps(rows[3], 1) : _mm256_castps256_ps128(rows[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		float* first = matrices + half * 4 * 16 + column * 4;
+		_mm_storeu_ps(first, r0);
+		_mm_storeu_ps(first + 16, r1);
+		_mm_storeu_ps(first + 32, r2);
+		_mm_storeu_ps(first + 48, r3);
+	}
+}
+
+// Load 8 vectors of 4 floats, stride floats apart, and transpose them: element i of each in register i
+void loadTransposed(const float* data, size_t stride, __m256 rows[4])
+{
+	__m128 halves[2][4];
+	for (int half = 0; half < 2; ++half)
+	{
+		const float* first = data + half * 4 * stride;
+		for (size_t vector = 0; vector < 4; ++vector)
+			halves[half][vector] = _mm_loadu_ps(first + vector * stride);
+		_MM_TRANSPOSE4_PS(halves[half][0], halves[half][1], halves[half][2], halves[half][3]);
+	}
+	for (int row = 0; row < 4; ++row)
+		rows[row] = _mm256_set_m128(halves[1][row], halves[0][row]);
+}
+
+void composeTransforms(const TransformArrays& local, size_t count, float* matrices)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one  = _mm256_set1_ps(1.0f);
+	size_t		 i	  = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m256 x	= _mm256_loadu_ps(local.rotationX + i);
+		const __m256 y	= _mm256_loadu_ps(local.rotationY + i);
+		const __m256 z	= _mm256_loadu_ps(local.rotationZ + i);
+		const __m256 w	= _mm256_loadu_ps(local.rotationW + i);
+		const __m256 x2 = _mm256_add_ps(x, x);
+		const __m256 y2 = _mm256_add_ps(y, y);
+		const __m256 z2 = _mm256_add_ps(z, z);
+		const __m256 xx = _mm256_mul_ps(x, x2);
+		const __m256 yy = _mm256_mul_ps(y, y2);
+		const __m256 zz = _mm256_mul_ps(z, z2);
+		const __m256 xy = _mm256_mul_ps(x, y2);
+		const __m256 xz = _mm256_mul_ps(x, z2);
+		const __m256 yz = _mm256_mul_ps(y, z2);
+		const __m256 wx = _mm256_mul_ps(w, x2);
+		const __m256 wy = _mm256_mul_ps(w, y2);
+		const __m256 wz = _mm256_mul_ps(w, z2);
+		const __m256 sx = _mm256_loadu_ps(local.scaleX + i);
+		const __m256 sy = _mm256_loadu_ps(local.scaleY + i);
+		const __m256 sz = _mm256_loadu_ps(local.scaleZ + i);
+
+		// Element [column][row] of the eight matrices, as glm's mat3_cast builds the rotation
+		const __m256 m[4][4] = {
+			{ _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+			  _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero },
+			{ _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+			  _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero },
+			{ _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+			  _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero },
+			{ _mm256_loadu_ps(local.positionX + i), _mm256_loadu_ps(local.positionY + i), _mm256_loadu_ps(local.positionZ + i),
+			  one }
+		};
+		for (int column = 0; column < 4; ++column)
+			storeColumns(m[column], matrices + i * 16, column);
+	}
+	composeTransformsScalar(local, i, count, matrices);
+}
+
+void propagateTransforms(const float* local, const uint32_t* parents, size_t count, float* world)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* in	 = local + i * 16;
+		float*		 out = world + i * 16;
+		if (parents[i] == noParent)
+		{
+			_mm256_storeu_ps(out, _mm256_loadu_ps(in));
+			_mm256_storeu_ps(out + 8, _mm256_loadu_ps(in + 8));
+			continue;
+		}
+
+		// Two columns of the product at a time: each parent column in both halves, weighted by the element of the
+		// first local column in the low half and of the second in the high one
+		const float* parent = world + parents[i] * 16;
+		const __m256 p0		= _mm256_broadcast_ps(reinterpret_cast<const __m128*>(parent));
+		const __m256 p1		= _mm256_broadcast_ps(reinterpret_cast<const __m128*>(parent + 4));
+		const __m256 p2		= _mm256_broadcast_ps(reinterpret_cast<const __m128*>(parent + 8));
+		const __m256 p3		= _mm256_broadcast_ps(reinterpret_cast<const __m128*>(parent + 12));
+		for (int column = 0; column < 4; column += 2)
+		{
+			const __m256 l		= _mm256_loadu_ps(in + column * 4);
+			__m256		 result = _mm256_mul_ps(p0, _mm256_permute_ps(l, 0x00));
+			result				= _mm256_fmadd_ps(p1, _mm256_permute_ps(l, 0x55), result);
+			result				= _mm256_fmadd_ps(p2, _mm256_permute_ps(l, 0xAA), result);
+			result				= _mm256_fmadd_ps(p3, _mm256_permute_ps(l, 0xFF), result);
+			_mm256_storeu_ps(out + column * 4, result);
+		}
+	}
+}
+
+void transformSpheres(const float* world, const float* local, size_t count, const SphereArrays& spheres)
+{
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		// c[column][row] of the eight matrices, and the x, y, z and radius of the eight spheres
+		__m256 c[4][4];
+		for (int column = 0; column < 4; ++column)
+			loadTransposed(world + i * 16 + column * 4, 16, c[column]);
+		__m256 sphere[4];
+		loadTransposed(local + i * 4, 4, sphere);
+
+		__m256 center[3];
+		for (int row = 0; row < 3; ++row)
+		{
+			center[row] = _mm256_fmadd_ps(c[0][row], sphere[0], c[3][row]);
+			center[row] = _mm256_fmadd_ps(c[1][row], sphere[1], center[row]);
+			center[row] = _mm256_fmadd_ps(c[2][row], sphere[2], center[row]);
+		}
+		__m256 scale = _mm256_setzero_ps();
+		for (int column = 0; column < 3; ++column)
+		{
+			const __m256* axis			= c[column];
+			__m256		  lengthSquared = _mm256_mul_ps(axis[0], axis[0]);
+			lengthSquared				= _mm256_fmadd_ps(axis[1], axis[1], lengthSquared);
+			lengthSquared				= _mm256_fmadd_ps(axis[2], axis[2], lengthSquared);
+			scale						= _mm256_max_ps(scale, lengthSquared);
+		}
+		_mm256_storeu_ps(spheres.x + i, center[0]);
+		_mm256_storeu_ps(spheres.y + i, center[1]);
+		_mm256_storeu_ps(spheres.z + i, center[2]);
+		_mm256_storeu_ps(spheres.radius + i, _mm256_mul_ps(sphere[3], _mm256_sqrt_ps(scale)));
+	}
+	transformSpheresScalar(world, local, i, count, spheres);
+}
+
+// Append the indices of the lanes set in mask, writing every lane so the loop does not branch on them
+size_t appendVisible(int mask, size_t first, uint32_t* visible, size_t visibleCount)
+{
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		visible[visibleCount] = static_cast<uint32_t>(first + lane);
+		visibleCount += (mask >> lane) & 1;
+	}
+	return visibleCount;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible)
+{
+	__m256 planes[6][4];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = _mm256_set1_ps(frustum.planes[plane][element]);
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m256 x		   = _mm256_loadu_ps(spheres.x + i);
+		const __m256 y		   = _mm256_loadu_ps(spheres.y + i);
+		const __m256 z		   = _mm256_loadu_ps(spheres.z + i);
+		const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+		__m256		 inside	   = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const __m256* plane : planes)
+		{
+			__m256 distance = _mm256_fmadd_ps(plane[0], x, plane[3]);
+			distance		= _mm256_fmadd_ps(plane[1], y, distance);
+			distance		= _mm256_fmadd_ps(plane[2], z, distance);
+			inside			= _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+		visibleCount = appendVisible(_mm256_movemask_ps(inside), i, visible, visibleCount);
+	}
+	return visibleCount + cullSpheresScalar(frustum, spheres, i, count, visible + visibleCount);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible)
+{
+	// The normals and their absolute values, which give the extent of a box along them
+	__m256 planes[6][4];
+	__m256 absNormals[6][3];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = _mm256_set1_ps(frustum.planes[plane][element]);
+		for (int element = 0; element < 3; ++element)
+		{
+			const float value		   = frustum.planes[plane][element];
+			absNormals[plane][element] = _mm256_set1_ps(value < 0.0f ? -value : value);
+		}
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m256 x		= _mm256_loadu_ps(boxes.centerX + i);
+		const __m256 y		= _mm256_loadu_ps(boxes.centerY + i);
+		const __m256 z		= _mm256_loadu_ps(boxes.centerZ + i);
+		const __m256 ex		= _mm256_loadu_ps(boxes.extentX + i);
+		const __m256 ey		= _mm256_loadu_ps(boxes.extentY + i);
+		const __m256 ez		= _mm256_loadu_ps(boxes.extentZ + i);
+		__m256		 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const __m256* p		   = planes[plane];
+			const __m256* a		   = absNormals[plane];
+			__m256		  distance = _mm256_fmadd_ps(p[0], x, p[3]);
+			distance			   = _mm256_fmadd_ps(p[1], y, distance);
+			distance			   = _mm256_fmadd_ps(p[2], z, distance);
+			distance			   = _mm256_fmadd_ps(a[0], ex, distance);
+			distance			   = _mm256_fmadd_ps(a[1], ey, distance);
+			distance			   = _mm256_fmadd_ps(a[2], ez, distance);
+			inside				   = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+		visibleCount = appendVisible(_mm256_movemask_ps(inside), i, visible, visibleCount);
+	}
+	return visibleCount + cullBoxesScalar(frustum, boxes, i, count, visible + visibleCount);
+}
+}	 // namespace
+
+const KernelTable* getAvx2Kernels()
+{
+	static constexpr KernelTable kernels { composeTransforms, propagateTransforms, transformSpheres, cullSpheres, cullBoxes };
+	return &kernels;
+}
+#else
+const KernelTable* getAvx2Kernels()
+{
+	return nullptr;
+}
+#endif
+}	 // namespace zaphod::math::detail
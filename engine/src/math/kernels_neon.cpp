@@ -0,0 +1,237 @@
+#include "math/kernels.h"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace zaphod::math::detail
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+namespace
+{
+constexpr size_t lanes = 4;
+
+// Element i of each register in register i
+void transpose(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3)
+{
+	const float32x4x2_t r01 = vtrnq_f32(r0, r1);	// r0[0] r1[0] r0[2] r1[2], r0[1] r1[1] r0[3] r1[3]
+	const float32x4x2_t r23 = vtrnq_f32(r2, r3);
+	r0						= vcombine_f32(vget_low_f32(r01.val[0]), vget_low_f32(r23.val[0]));
+	r1						= vcombine_f32(vget_low_f32(r01.val[1]), vget_low_f32(r23.val[1]));
+	r2						= vcombine_f32(vget_high_f32(r01.val[0]), vget_high_f32(r23.val[0]));
+	r3						= vcombine_f32(vget_high_f32(r01.val[1]), vget_high_f32(r23.val[1]));
+}
+
+void composeTransforms(const TransformArrays& local, size_t count, float* matrices)
+{
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one  = vdupq_n_f32(1.0f);
+	size_t			  i	   = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const float32x4_t x	 = vld1q_f32(local.rotationX + i);
+		const float32x4_t y	 = vld1q_f32(local.rotationY + i);
+		const float32x4_t z	 = vld1q_f32(local.rotationZ + i);
+		const float32x4_t w	 = vld1q_f32(local.rotationW + i);
+		const float32x4_t x2 = vaddq_f32(x, x);
+		const float32x4_t y2 = vaddq_f32(y, y);
+		const float32x4_t z2 = vaddq_f32(z, z);
+		const float32x4_t xx = vmulq_f32(x, x2);
+		const float32x4_t yy = vmulq_f32(y, y2);
+		const float32x4_t zz = vmulq_f32(z, z2);
+		const float32x4_t xy = vmulq_f32(x, y2);
+		const float32x4_t xz = vmulq_f32(x, z2);
+		const float32x4_t yz = vmulq_f32(y, z2);
+		const float32x4_t wx = vmulq_f32(w, x2);
+		const float32x4_t wy = vmulq_f32(w, y2);
+		const float32x4_t wz = vmulq_f32(w, z2);
+		const float32x4_t sx = vld1q_f32(local.scaleX + i);
+		const float32x4_t sy = vld1q_f32(local.scaleY + i);
+		const float32x4_t sz = vld1q_f32(local.scaleZ + i);
+
+		// Element [column][row] of the four matrices, as glm's mat3_cast builds the rotation
+		float32x4_t m[4][4] = {
+			{ vmulq_f32(vsubq_f32(one, vaddq_f32(yy, zz)), sx), vmulq_f32(vaddq_f32(xy, wz), sx),
+			  vmulq_f32(vsubq_f32(xz, wy), sx), zero },
+			{ vmulq_f32(vsubq_f32(xy, wz), sy), vmulq_f32(vsubq_f32(one, vaddq_f32(xx, zz)), sy),
+			  vmulq_f32(vaddq_f32(yz, wx), sy), zero },
+			{ vmulq_f32(vaddq_f32(xz, wy), sz), vmulq_f32(vsubq_f32(yz, wx), sz),
+			  vmulq_f32(vsubq_f32(one, vaddq_f32(xx, yy)), sz), zero },
+			{ vld1q_f32(local.positionX + i), vld1q_f32(local.positionY + i), vld1q_f32(local.positionZ + i), one }
+		};
+		for (int column = 0; column < 4; ++column)
+		{
+			// Now the column of each matrix
+			transpose(m[column][0], m[column][1], m[column][2], m[column][3]);
+			for (size_t matrix = 0; matrix < lanes; ++matrix)
+				vst1q_f32(matrices + (i + matrix) * 16 + column * 4, m[column][matrix]);
+		}
+	}
+	composeTransformsScalar(local, i, count, matrices);
+}
+
+void propagateTransforms(const float* local, const uint32_t* parents, size_t count, float* world)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* in	 = local + i * 16;
+		float*		 out = world + i * 16;
+		if (parents[i] == noParent)
+		{
+			vst1q_f32_x4(out, vld1q_f32_x4(in));
+			continue;
+		}
+
+		// Each column of the product is the parent's columns weighted by the lanes of the local one
+		const float32x4x4_t p = vld1q_f32_x4(world + parents[i] * 16);
+		const float32x4x4_t l = vld1q_f32_x4(in);
+		float32x4x4_t		result;
+		for (int column = 0; column < 4; ++column)
+		{
+			result.val[column] = vmulq_laneq_f32(p.val[0], l.val[column], 0);
+			result.val[column] = vfmaq_laneq_f32(result.val[column], p.val[1], l.val[column], 1);
+			result.val[column] = vfmaq_laneq_f32(result.val[column], p.val[2], l.val[column], 2);
+			result.val[column] = vfmaq_laneq_f32(result.val[column], p.val[3], l.val[column], 3);
+		}
+		vst1q_f32_x4(out, result);
+	}
+}
+
+void transformSpheres(const float* world, const float* local, size_t count, const SphereArrays& spheres)
+{
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		// c[column][row] of the four matrices
+		float32x4_t c[4][4];
+		for (int column = 0; column < 4; ++column)
+		{
+			const float* first = world + i * 16 + column * 4;
+			for (int matrix = 0; matrix < 4; ++matrix)
+				c[column][matrix] = vld1q_f32(first + matrix * 16);
+			transpose(c[column][0], c[column][1], c[column][2], c[column][3]);
+		}
+		// The spheres are contiguous, so the load can deinterleave them
+		const float32x4x4_t sphere = vld4q_f32(local + i * 4);
+
+		float32x4_t center[3];
+		for (int row = 0; row < 3; ++row)
+		{
+			center[row] = vfmaq_f32(c[3][row], c[0][row], sphere.val[0]);
+			center[row] = vfmaq_f32(center[row], c[1][row], sphere.val[1]);
+			center[row] = vfmaq_f32(center[row], c[2][row], sphere.val[2]);
+		}
+		float32x4_t scale = vdupq_n_f32(0.0f);
+		for (int column = 0; column < 3; ++column)
+		{
+			const float32x4_t* axis			 = c[column];
+			float32x4_t		   lengthSquared = vmulq_f32(axis[0], axis[0]);
+			lengthSquared					 = vfmaq_f32(lengthSquared, axis[1], axis[1]);
+			lengthSquared					 = vfmaq_f32(lengthSquared, axis[2], axis[2]);
+			scale							 = vmaxq_f32(scale, lengthSquared);
+		}
+		vst1q_f32(spheres.x + i, center[0]);
+		vst1q_f32(spheres.y + i, center[1]);
+		vst1q_f32(spheres.z + i, center[2]);
+		vst1q_f32(spheres.radius + i, vmulq_f32(sphere.val[3], vsqrtq_f32(scale)));
+	}
+	transformSpheresScalar(world, local, i, count, spheres);
+}
+
+// Append the indices of the lanes set in inside, writing every lane so the loop does not branch on them
+size_t appendVisible(uint32x4_t inside, size_t first, uint32_t* visible, size_t visibleCount)
+{
+	uint32_t mask[lanes];
+	vst1q_u32(mask, inside);
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		visible[visibleCount] = static_cast<uint32_t>(first + lane);
+		visibleCount += mask[lane] & 1;
+	}
+	return visibleCount;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible)
+{
+	float32x4_t planes[6][4];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = vdupq_n_f32(frustum.planes[plane][element]);
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const float32x4_t x			= vld1q_f32(spheres.x + i);
+		const float32x4_t y			= vld1q_f32(spheres.y + i);
+		const float32x4_t z			= vld1q_f32(spheres.z + i);
+		const float32x4_t negRadius = vnegq_f32(vld1q_f32(spheres.radius + i));
+		uint32x4_t		  inside	= vdupq_n_u32(UINT32_MAX);
+		for (const float32x4_t* plane : planes)
+		{
+			float32x4_t distance = vfmaq_f32(plane[3], plane[0], x);
+			distance			 = vfmaq_f32(distance, plane[1], y);
+			distance			 = vfmaq_f32(distance, plane[2], z);
+			inside				 = vandq_u32(inside, vcgeq_f32(distance, negRadius));
+		}
+		visibleCount = appendVisible(inside, i, visible, visibleCount);
+	}
+	return visibleCount + cullSpheresScalar(frustum, spheres, i, count, visible + visibleCount);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible)
+{
+	// The normals and their absolute values, which give the extent of a box along them
+	float32x4_t planes[6][4];
+	float32x4_t absNormals[6][3];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = vdupq_n_f32(frustum.planes[plane][element]);
+		for (int element = 0; element < 3; ++element)
+			absNormals[plane][element] = vabsq_f32(planes[plane][element]);
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const float32x4_t x		 = vld1q_f32(boxes.centerX + i);
+		const float32x4_t y		 = vld1q_f32(boxes.centerY + i);
+		const float32x4_t z		 = vld1q_f32(boxes.centerZ + i);
+		const float32x4_t ex	 = vld1q_f32(boxes.extentX + i);
+		const float32x4_t ey	 = vld1q_f32(boxes.extentY + i);
+		const float32x4_t ez	 = vld1q_f32(boxes.extentZ + i);
+		uint32x4_t		  inside = vdupq_n_u32(UINT32_MAX);
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const float32x4_t* p		= planes[plane];
+			const float32x4_t* a		= absNormals[plane];
+			float32x4_t		   distance = vfmaq_f32(p[3], p[0], x);
+			distance					= vfmaq_f32(distance, p[1], y);
+			distance					= vfmaq_f32(distance, p[2], z);
+			distance					= vfmaq_f32(distance, a[0], ex);
+			distance					= vfmaq_f32(distance, a[1], ey);
+			distance					= vfmaq_f32(distance, a[2], ez);
+			inside						= vandq_u32(inside, vcgezq_f32(distance));
+		}
+		visibleCount = appendVisible(inside, i, visible, visibleCount);
+	}
+	return visibleCount + cullBoxesScalar(frustum, boxes, i, count, visible + visibleCount);
+}
+}	 // namespace
+
+const KernelTable* getNeonKernels()
+{
+	static constexpr KernelTable kernels { composeTransforms, propagateTransforms, transformSpheres, cullSpheres, cullBoxes };
+	return &kernels;
+}
+#else
+const KernelTable* getNeonKernels()
+{
+	return nullptr;
+}
+#endif
+}	 // namespace zaphod::math::detail
@@ -0,0 +1,230 @@
+#include "math/kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace zaphod::math::detail
+{
+#if defined(__x86_64__) || defined(_M_X64)
+namespace
+{
+constexpr size_t lanes = 4;
+
+void composeTransforms(const TransformArrays& local, size_t count, float* matrices)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one  = _mm_set1_ps(1.0f);
+	size_t		 i	  = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m128 x	= _mm_loadu_ps(local.rotationX + i);
+		const __m128 y	= _mm_loadu_ps(local.rotationY + i);
+		const __m128 z	= _mm_loadu_ps(local.rotationZ + i);
+		const __m128 w	= _mm_loadu_ps(local.rotationW + i);
+		const __m128 x2 = _mm_add_ps(x, x);
+		const __m128 y2 = _mm_add_ps(y, y);
+		const __m128 z2 = _mm_add_ps(z, z);
+		const __m128 xx = _mm_mul_ps(x, x2);
+		const __m128 yy = _mm_mul_ps(y, y2);
+		const __m128 zz = _mm_mul_ps(z, z2);
+		const __m128 xy = _mm_mul_ps(x, y2);
+		const __m128 xz = _mm_mul_ps(x, z2);
+		const __m128 yz = _mm_mul_ps(y, z2);
+		const __m128 wx = _mm_mul_ps(w, x2);
+		const __m128 wy = _mm_mul_ps(w, y2);
+		const __m128 wz = _mm_mul_ps(w, z2);
+		const __m128 sx = _mm_loadu_ps(local.scaleX + i);
+		const __m128 sy = _mm_loadu_ps(local.scaleY + i);
+		const __m128 sz = _mm_loadu_ps(local.scaleZ + i);
+
+		// Element [column][row] of the four matrices, as glm's mat3_cast builds the rotation
+		__m128 m[4][4] = {
+			{ _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+			  _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero },
+			{ _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+			  _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero },
+			{ _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+			  _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero },
+			{ _mm_loadu_ps(local.positionX + i), _mm_loadu_ps(local.positionY + i), _mm_loadu_ps(local.positionZ + i), one }
+		};
+		for (int column = 0; column < 4; ++column)
+		{
+			// Now the column of each matrix
+			_MM_TRANSPOSE4_PS(m[column][0], m[column][1], m[column][2], m[column][3]);
+			for (size_t matrix = 0; matrix < lanes; ++matrix)
+				_mm_storeu_ps(matrices + (i + matrix) * 16 + column * 4, m[column][matrix]);
+		}
+	}
+	composeTransformsScalar(local, i, count, matrices);
+}
+
+void propagateTransforms(const float* local, const uint32_t* parents, size_t count, float* world)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* in	 = local + i * 16;
+		float*		 out = world + i * 16;
+		if (parents[i] == noParent)
+		{
+			for (int column = 0; column < 4; ++column)
+				_mm_storeu_ps(out + column * 4, _mm_loadu_ps(in + column * 4));
+			continue;
+		}
+
+		// Each column of the product is the parent's columns weighted by the elements of the local one
+		const float* parent = world + parents[i] * 16;
+		const __m128 p0		= _mm_loadu_ps(parent);
+		const __m128 p1		= _mm_loadu_ps(parent + 4);
+		const __m128 p2		= _mm_loadu_ps(parent + 8);
+		const __m128 p3		= _mm_loadu_ps(parent + 12);
+		for (int column = 0; column < 4; ++column)
+		{
+			const float* l		= in + column * 4;
+			__m128		 result = _mm_mul_ps(p0, _mm_set1_ps(l[0]));
+			result				= _mm_add_ps(result, _mm_mul_ps(p1, _mm_set1_ps(l[1])));
+			result				= _mm_add_ps(result, _mm_mul_ps(p2, _mm_set1_ps(l[2])));
+			result				= _mm_add_ps(result, _mm_mul_ps(p3, _mm_set1_ps(l[3])));
+			_mm_storeu_ps(out + column * 4, result);
+		}
+	}
+}
+
+// Load four vectors of 4 floats, stride floats apart, and transpose them: element i of each in register i
+void loadTransposed(const float* data, size_t stride, __m128& r0, __m128& r1, __m128& r2, __m128& r3)
+{
+	r0 = _mm_loadu_ps(data);
+	r1 = _mm_loadu_ps(data + stride);
+	r2 = _mm_loadu_ps(data + stride * 2);
+	r3 = _mm_loadu_ps(data + stride * 3);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+void transformSpheres(const float* world, const float* local, size_t count, const SphereArrays& spheres)
+{
+	size_t i = 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		// c[column][row] of the four matrices
+		__m128 c[4][4];
+		for (int column = 0; column < 4; ++column)
+			loadTransposed(world + i * 16 + column * 4, 16, c[column][0], c[column][1], c[column][2], c[column][3]);
+		__m128 x, y, z, radius;
+		loadTransposed(local + i * 4, 4, x, y, z, radius);
+
+		__m128 center[3];
+		for (int row = 0; row < 3; ++row)
+		{
+			center[row] = _mm_add_ps(_mm_mul_ps(c[0][row], x), _mm_mul_ps(c[1][row], y));
+			center[row] = _mm_add_ps(center[row], _mm_add_ps(_mm_mul_ps(c[2][row], z), c[3][row]));
+		}
+		__m128 scale = _mm_setzero_ps();
+		for (int column = 0; column < 3; ++column)
+		{
+			const __m128* axis			= c[column];
+			const __m128  lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(axis[0], axis[0]), _mm_mul_ps(axis[1], axis[1])),
+													 _mm_mul_ps(axis[2], axis[2]));
+			scale						= _mm_max_ps(scale, lengthSquared);
+		}
+		_mm_storeu_ps(spheres.x + i, center[0]);
+		_mm_storeu_ps(spheres.y + i, center[1]);
+		_mm_storeu_ps(spheres.z + i, center[2]);
+		_mm_storeu_ps(spheres.radius + i, _mm_mul_ps(radius, _mm_sqrt_ps(scale)));
+	}
+	transformSpheresScalar(world, local, i, count, spheres);
+}
+
+// Append the indices of the lanes set in mask, writing every lane so the loop does not branch on them
+size_t appendVisible(int mask, size_t first, uint32_t* visible, size_t visibleCount)
+{
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		visible[visibleCount] = static_cast<uint32_t>(first + lane);
+		visibleCount += (mask >> lane) & 1;
+	}
+	return visibleCount;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, size_t count, uint32_t* visible)
+{
+	__m128 planes[6][4];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = _mm_set1_ps(frustum.planes[plane][element]);
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m128 x		   = _mm_loadu_ps(spheres.x + i);
+		const __m128 y		   = _mm_loadu_ps(spheres.y + i);
+		const __m128 z		   = _mm_loadu_ps(spheres.z + i);
+		const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+		__m128		 inside	   = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const __m128* plane : planes)
+		{
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[0], x), _mm_mul_ps(plane[1], y)),
+											   _mm_add_ps(_mm_mul_ps(plane[2], z), plane[3]));
+			inside				  = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+		visibleCount = appendVisible(_mm_movemask_ps(inside), i, visible, visibleCount);
+	}
+	return visibleCount + cullSpheresScalar(frustum, spheres, i, count, visible + visibleCount);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, size_t count, uint32_t* visible)
+{
+	// The normals and their absolute values, which give the extent of a box along them
+	__m128 planes[6][4];
+	__m128 absNormals[6][3];
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		for (int element = 0; element < 4; ++element)
+			planes[plane][element] = _mm_set1_ps(frustum.planes[plane][element]);
+		for (int element = 0; element < 3; ++element)
+		{
+			const float value		   = frustum.planes[plane][element];
+			absNormals[plane][element] = _mm_set1_ps(value < 0.0f ? -value : value);
+		}
+	}
+
+	size_t visibleCount = 0;
+	size_t i			= 0;
+	for (; i + lanes <= count; i += lanes)
+	{
+		const __m128 x		= _mm_loadu_ps(boxes.centerX + i);
+		const __m128 y		= _mm_loadu_ps(boxes.centerY + i);
+		const __m128 z		= _mm_loadu_ps(boxes.centerZ + i);
+		const __m128 ex		= _mm_loadu_ps(boxes.extentX + i);
+		const __m128 ey		= _mm_loadu_ps(boxes.extentY + i);
+		const __m128 ez		= _mm_loadu_ps(boxes.extentZ + i);
+		__m128		 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			const __m128* p		   = planes[plane];
+			const __m128* a		   = absNormals[plane];
+			const __m128  distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[0], x), _mm_mul_ps(p[1], y)),
+												_mm_add_ps(_mm_mul_ps(p[2], z), p[3]));
+			const __m128  extent   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], ex), _mm_mul_ps(a[1], ey)), _mm_mul_ps(a[2], ez));
+			inside				   = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+		}
+		visibleCount = appendVisible(_mm_movemask_ps(inside), i, visible, visibleCount);
+	}
+	return visibleCount + cullBoxesScalar(frustum, boxes, i, count, visible + visibleCount);
+}
+}	 // namespace
+
+const KernelTable* getSseKernels()
+{
+	static constexpr KernelTable kernels { composeTransforms, propagateTransforms, transformSpheres, cullSpheres, cullBoxes };
+	return &kernels;
+}
+#else
+const KernelTable* getSseKernels()
+{
+	return nullptr;
+}
+#endif
+}	 // namespace zaphod::math::detail
@@ -0,0 +1,214 @@
+#include "render/bindless_table.h"
+
+#include "render/device.h"
+
+#include <algorithm>
+
+namespace zaphod::render
+{
+uint32_t BindlessTable::Slots::allocate()
+{
+	if (!freeIndices.empty())
+	{
+		const uint32_t index = freeIndices.back();
+		freeIndices.pop_back();
+		return index;
+	}
+	return nextIndex < capacity ? nextIndex++ : invalidIndex;
+}
+
+void BindlessTable::Slots::release(uint32_t index)
+{
+	if (index < nextIndex)
+		freeIndices.push_back(index);
+}
+
+BindlessTable::~BindlessTable()
+{
+	destroy();
+}
+
+Result BindlessTable::initialize(const Device& device, const Config& config)
+{
+	if (m_device)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The bindless table already exists");
+
+	const VkPhysicalDeviceVulkan12Properties& limits = device.getVulkan12Properties();
+	m_textures.capacity = std::min({ config.maxTextures, limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+									 limits.maxDescriptorSetUpdateAfterBindSampledImages });
+	m_buffers.capacity	= std::min({ config.maxBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+									 limits.maxDescriptorSetUpdateAfterBindStorageBuffers });
+	if (m_textures.capacity == 0 || m_buffers.capacity == 0)
+		return Result(Result::Code::INVALID_ARGUMENT, "The bindless table needs room for textures and buffers");
+
+	VkDescriptorSetLayoutBinding bindings[2] {};
+	bindings[0].binding			= textureBinding;
+	bindings[0].descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = m_textures.capacity;
+	bindings[0].stageFlags		= VK_SHADER_STAGE_ALL;
+	bindings[1].binding			= bufferBinding;
+	bindings[1].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount = m_buffers.capacity;
+	bindings[1].stageFlags		= VK_SHADER_STAGE_ALL;
+
+	// Slots are written while frames using other slots are in flight, and the unused ones stay empty
+	const VkDescriptorBindingFlags bindingFlags[2] = {
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+			| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+			| VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+	};
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo {};
+	bindingFlagsInfo.sType		   = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount  = 2;
+	bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo {};
+	layoutInfo.sType		= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext		= &bindingFlagsInfo;
+	layoutInfo.flags		= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = 2;
+	layoutInfo.pBindings	= bindings;
+
+	VkDevice vkDevice = device.getDevice();
+	m_device		  = &device;
+	VkResult result	  = vkCreateDescriptorSetLayout(vkDevice, &layoutInfo, nullptr, &m_setLayout);
+	if (result != VK_SUCCESS)
+	{
+		destroy();
+		return makeResult(result, "vkCreateDescriptorSetLayout");
+	}
+
+	const VkDescriptorPoolSize poolSizes[2] = { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_textures.capacity },
+												{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_buffers.capacity } };
+	VkDescriptorPoolCreateInfo poolInfo {};
+	poolInfo.sType		   = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags		   = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets	   = 1;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes	   = poolSizes;
+	result				   = vkCreateDescriptorPool(vkDevice, &poolInfo, nullptr, &m_pool);
+	if (result != VK_SUCCESS)
+	{
+		destroy();
+		return makeResult(result, "vkCreateDescriptorPool");
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo {};
+	allocateInfo.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool		= m_pool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts		= &m_setLayout;
+	result							= vkAllocateDescriptorSets(vkDevice, &allocateInfo, &m_set);
+	if (result != VK_SUCCESS)
+	{
+		destroy();
+		return makeResult(result, "vkAllocateDescriptorSets");
+	}
+
+	VkPushConstantRange pushConstants {};
+	pushConstants.stageFlags = VK_SHADER_STAGE_ALL;
+	pushConstants.offset	 = 0;
+	pushConstants.size		 = pushConstantSize;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+	pipelineLayoutInfo.sType				  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount		  = 1;
+	pipelineLayoutInfo.pSetLayouts			  = &m_setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges	  = &pushConstants;
+	result = vkCreatePipelineLayout(vkDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+	if (result != VK_SUCCESS)
+	{
+		destroy();
+		return makeResult(result, "vkCreatePipelineLayout");
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+void BindlessTable::destroy()
+{
+	if (!m_device)
+		return;
+
+	VkDevice device = m_device->getDevice();
+	if (m_pipelineLayout != VK_NULL_HANDLE)
+		vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
+	// Destroying the pool frees the set
+	if (m_pool != VK_NULL_HANDLE)
+		vkDestroyDescriptorPool(device, m_pool, nullptr);
+	if (m_setLayout != VK_NULL_HANDLE)
+		vkDestroyDescriptorSetLayout(device, m_setLayout, nullptr);
+	m_pipelineLayout = VK_NULL_HANDLE;
+	m_pool			 = VK_NULL_HANDLE;
+	m_set			 = VK_NULL_HANDLE;
+	m_setLayout		 = VK_NULL_HANDLE;
+	m_textures		 = Slots();
+	m_buffers		 = Slots();
+	m_device		 = nullptr;
+}
+
+uint32_t BindlessTable::addTexture(VkImageView imageView, VkSampler sampler, VkImageLayout layout)
+{
+	if (!m_device)
+		return invalidIndex;
+
+	std::lock_guard lock(m_mutex);
+	const uint32_t	index = m_textures.allocate();
+	if (index == invalidIndex)
+		return invalidIndex;
+
+	VkDescriptorImageInfo imageInfo { sampler, imageView, layout };
+	VkWriteDescriptorSet  write {};
+	write.sType			  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet		  = m_set;
+	write.dstBinding	  = textureBinding;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo	  = &imageInfo;
+	vkUpdateDescriptorSets(m_device->getDevice(), 1, &write, 0, nullptr);
+	return index;
+}
+
+uint32_t BindlessTable::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	if (!m_device)
+		return invalidIndex;
+
+	std::lock_guard lock(m_mutex);
+	const uint32_t	index = m_buffers.allocate();
+	if (index == invalidIndex)
+		return invalidIndex;
+
+	VkDescriptorBufferInfo bufferInfo { buffer, offset, range };
+	VkWriteDescriptorSet   write {};
+	write.sType			  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet		  = m_set;
+	write.dstBinding	  = bufferBinding;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo	  = &bufferInfo;
+	vkUpdateDescriptorSets(m_device->getDevice(), 1, &write, 0, nullptr);
+	return index;
+}
+
+void BindlessTable::removeTexture(uint32_t index)
+{
+	// The descriptor stays as it is, partially bound slots only have to be valid when shaders read them
+	std::lock_guard lock(m_mutex);
+	m_textures.release(index);
+}
+
+void BindlessTable::removeBuffer(uint32_t index)
+{
+	std::lock_guard lock(m_mutex);
+	m_buffers.release(index);
+}
+
+void BindlessTable::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const
+{
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, m_pipelineLayout, 0, 1, &m_set, 0, nullptr);
+}
+}	 // namespace zaphod::render
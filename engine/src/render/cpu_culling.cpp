@@ -0,0 +1,45 @@
+#include "render/cpu_culling.h"
+
+#include "core/profiler.h"
+#include "render/renderer.h"
+
+namespace zaphod::render
+{
+Result CpuCulling::cull(Renderer& renderer, const math::Frustum& frustum, const math::SphereArrays& spheres,
+						std::span<const Mesh> meshes, Draws& draws)
+{
+	ZAPHOD_PROFILE_ZONE("CpuCulling::cull");
+
+	draws = {};
+	if (m_visible.size() < meshes.size())
+		m_visible.resize(meshes.size());
+	m_visibleCount = math::cullSpheres(frustum, spheres, meshes.size(), m_visible.data());
+	if (m_visibleCount == 0)
+		return Result(Result::Code::SUCCESS);
+
+	const RingBuffer::Allocation allocation =
+		renderer.allocateFrameData(m_visibleCount * sizeof(VkDrawIndexedIndirectCommand), alignof(VkDrawIndexedIndirectCommand));
+	if (!allocation.isValid())
+		return Result(Result::Code::OUT_OF_MEMORY, "The frame data ring is full");
+
+	// Written front to back and never read, as frame data is write-combined on most GPUs
+	VkDrawIndexedIndirectCommand* commands = static_cast<VkDrawIndexedIndirectCommand*>(allocation.data);
+	for (size_t i = 0; i < m_visibleCount; ++i)
+	{
+		const uint32_t object = m_visible[i];
+		const Mesh&	   mesh	  = meshes[object];
+		commands[i]			  = { mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, object };
+	}
+
+	draws.buffer = allocation.buffer;
+	draws.offset = allocation.offset;
+	draws.count	 = static_cast<uint32_t>(m_visibleCount);
+	return Result(Result::Code::SUCCESS);
+}
+
+void CpuCulling::draw(VkCommandBuffer commandBuffer, const Draws& draws)
+{
+	if (draws.count > 0)
+		vkCmdDrawIndexedIndirect(commandBuffer, draws.buffer, draws.offset, draws.count, sizeof(VkDrawIndexedIndirectCommand));
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,359 @@
+#include "render/device.h"
+
+#include "core/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace zaphod::render
+{
+namespace
+{
+constexpr const char* validationLayer = "VK_LAYER_KHRONOS_validation";
+
+bool hasLayer(const char* name)
+{
+	uint32_t count = 0;
+	vkEnumerateInstanceLayerProperties(&count, nullptr);
+	std::vector<VkLayerProperties> layers(count);
+	vkEnumerateInstanceLayerProperties(&count, layers.data());
+	return std::any_of(layers.begin(), layers.end(),
+					   [name](const VkLayerProperties& layer) { return std::strcmp(layer.layerName, name) == 0; });
+}
+
+bool hasDeviceExtension(VkPhysicalDevice physicalDevice, const char* name)
+{
+	uint32_t count = 0;
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+	std::vector<VkExtensionProperties> extensions(count);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+	return std::any_of(extensions.begin(), extensions.end(), [name](const VkExtensionProperties& extension)
+					   { return std::strcmp(extension.extensionName, name) == 0; });
+}
+
+// A family made for copies runs them on the DMA engines, beside the graphics work
+uint32_t findTransferFamily(VkPhysicalDevice physicalDevice, uint32_t graphicsFamily)
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueFamilies.data());
+
+	uint32_t computeFamily = UINT32_MAX;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const VkQueueFlags flags = queueFamilies[i].queueFlags;
+		if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+			continue;
+		if (!(flags & VK_QUEUE_COMPUTE_BIT))
+			return i;
+		if (computeFamily == UINT32_MAX)
+			computeFamily = i;
+	}
+	return computeFamily != UINT32_MAX ? computeFamily : graphicsFamily;
+}
+
+// What BindlessTable needs: large arrays of descriptors, written while command buffers using others are pending
+void enableBindlessFeatures(VkPhysicalDeviceVulkan12Features& features)
+{
+	features.descriptorIndexing							   = VK_TRUE;
+	features.runtimeDescriptorArray						   = VK_TRUE;
+	features.descriptorBindingPartiallyBound			   = VK_TRUE;
+	features.descriptorBindingUpdateUnusedWhilePending	   = VK_TRUE;
+	features.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+	features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	features.shaderSampledImageArrayNonUniformIndexing	   = VK_TRUE;
+	features.shaderStorageBufferArrayNonUniformIndexing	   = VK_TRUE;
+}
+
+bool hasBindlessFeatures(const VkPhysicalDeviceVulkan12Features& features)
+{
+	return features.descriptorIndexing && features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound
+		&& features.descriptorBindingUpdateUnusedWhilePending && features.descriptorBindingSampledImageUpdateAfterBind
+		&& features.descriptorBindingStorageBufferUpdateAfterBind && features.shaderSampledImageArrayNonUniformIndexing
+		&& features.shaderStorageBufferArrayNonUniformIndexing;
+}
+}	 // namespace
+
+Device::Device()  = default;
+Device::~Device() { destroy(); }
+
+Result Device::createInstance(const Config& config)
+{
+	if (m_instance != VK_NULL_HANDLE)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The Vulkan instance already exists");
+	m_config = config;
+
+	uint32_t apiVersion = VK_API_VERSION_1_0;
+	vkEnumerateInstanceVersion(&apiVersion);
+	if (apiVersion < VK_API_VERSION_1_3)
+		return Result(Result::Code::UNSUPPORTED, "The Vulkan loader does not support Vulkan 1.3");
+
+	uint32_t	 glfwExtensionCount = 0;
+	const char** glfwExtensions		= glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	if (!glfwExtensions)
+		return Result(Result::Code::UNSUPPORTED, "GLFW found no Vulkan support for window surfaces");
+	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	std::vector<const char*> layers;
+
+	bool enableValidation = m_config.enableValidation && hasLayer(validationLayer);
+	if (enableValidation)
+	{
+		layers.push_back(validationLayer);
+		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+		m_logger = logging::SimpleLoggerFactory("Vulkan").create();
+		m_logger->setLogLevelFlags(
+			{ logging::Logger::LogLevel::INFO, logging::Logger::LogLevel::WARN, logging::Logger::LogLevel::ERROR });
+	}
+
+	VkApplicationInfo applicationInfo {};
+	applicationInfo.sType			   = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	applicationInfo.pApplicationName   = m_config.applicationName.c_str();
+	applicationInfo.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
+	applicationInfo.pEngineName		   = "Zaphod";
+	applicationInfo.engineVersion	   = VK_MAKE_API_VERSION(0, 1, 0, 0);
+	applicationInfo.apiVersion		   = VK_API_VERSION_1_3;
+
+	VkDebugUtilsMessengerCreateInfoEXT messengerInfo {};
+	messengerInfo.sType			  = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	messengerInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT
+								  | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	messengerInfo.messageType	  = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+								  | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+	messengerInfo.pfnUserCallback = &Device::onDebugMessage;
+	messengerInfo.pUserData		  = this;
+
+	VkInstanceCreateInfo instanceInfo {};
+	instanceInfo.sType					 = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pNext					 = enableValidation ? &messengerInfo : nullptr;	   // Also covers instance creation
+	instanceInfo.pApplicationInfo		 = &applicationInfo;
+	instanceInfo.enabledLayerCount		 = static_cast<uint32_t>(layers.size());
+	instanceInfo.ppEnabledLayerNames	 = layers.data();
+	instanceInfo.enabledExtensionCount	 = static_cast<uint32_t>(extensions.size());
+	instanceInfo.ppEnabledExtensionNames = extensions.data();
+
+	VkResult result = vkCreateInstance(&instanceInfo, nullptr, &m_instance);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkCreateInstance");
+
+	if (enableValidation)
+	{
+		auto createMessenger = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+			vkGetInstanceProcAddr(m_instance, "vkCreateDebugUtilsMessengerEXT"));
+		if (createMessenger)
+			createMessenger(m_instance, &messengerInfo, nullptr, &m_debugMessenger);
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+Result Device::createDevice(VkSurfaceKHR surface)
+{
+	if (m_instance == VK_NULL_HANDLE)
+		return Result(Result::Code::NOT_INITIALIZED, "The Vulkan instance must be created before the device");
+	if (m_device != VK_NULL_HANDLE)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The Vulkan device already exists");
+
+	uint32_t count = 0;
+	vkEnumeratePhysicalDevices(m_instance, &count, nullptr);
+	std::vector<VkPhysicalDevice> physicalDevices(count);
+	vkEnumeratePhysicalDevices(m_instance, &count, physicalDevices.data());
+
+	// Prefer the requested kind of GPU, then any suitable one in enumeration order
+	const VkPhysicalDeviceType preferredType =
+		m_config.preferIntegrated ? VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU : VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+	for (VkPhysicalDevice physicalDevice : physicalDevices)
+	{
+		QueueFamilies families;
+		if (!isSuitable(physicalDevice, surface, families))
+			continue;
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		if (m_physicalDevice == VK_NULL_HANDLE || properties.deviceType == preferredType)
+		{
+			m_physicalDevice = physicalDevice;
+			m_queueFamilies	 = families;
+			m_properties	 = properties;
+			if (properties.deviceType == preferredType)
+				break;
+		}
+	}
+	if (m_physicalDevice == VK_NULL_HANDLE)
+		return Result(Result::Code::UNSUPPORTED, "No GPU supports Vulkan 1.3 with presentation to the window");
+
+	m_vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+	m_idProperties.sType	   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+	m_idProperties.pNext	   = &m_vulkan12Properties;
+	VkPhysicalDeviceProperties2 properties2 {};
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = &m_idProperties;
+	vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+	m_queueFamilies.transfer = findTransferFamily(m_physicalDevice, m_queueFamilies.graphics);
+
+	const float				queuePriority = 1.0f;
+	VkDeviceQueueCreateInfo queueInfos[3] {};
+	uint32_t				queueInfoCount = 0;
+	for (uint32_t family : { m_queueFamilies.graphics, m_queueFamilies.present, m_queueFamilies.transfer })
+	{
+		auto isCreated = [&](const VkDeviceQueueCreateInfo& queueInfo) { return queueInfo.queueFamilyIndex == family; };
+		if (std::any_of(queueInfos, queueInfos + queueInfoCount, isCreated))
+			continue;
+		VkDeviceQueueCreateInfo& queueInfo = queueInfos[queueInfoCount++];
+		queueInfo.sType					   = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueInfo.queueFamilyIndex		   = family;
+		queueInfo.queueCount			   = 1;
+		queueInfo.pQueuePriorities		   = &queuePriority;
+	}
+
+	VkPhysicalDeviceVulkan13Features features13 {};
+	features13.sType			= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+	features13.synchronization2 = VK_TRUE;
+	features13.dynamicRendering = VK_TRUE;
+
+	VkPhysicalDeviceVulkan12Features features12 {};
+	features12.sType			 = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.pNext			 = &features13;
+	features12.timelineSemaphore = VK_TRUE;
+	features12.drawIndirectCount = VK_TRUE;
+	enableBindlessFeatures(features12);
+
+	VkPhysicalDeviceFeatures2 features {};
+	features.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext								= &features12;
+	features.features.multiDrawIndirect			= VK_TRUE;
+	features.features.drawIndirectFirstInstance	= VK_TRUE;
+
+	// Memory budgets are optional, without them allocations are only checked against the heap sizes
+	std::vector<const char*> extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	m_hasMemoryBudget					= hasDeviceExtension(m_physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (m_hasMemoryBudget)
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	VkDeviceCreateInfo deviceInfo {};
+	deviceInfo.sType				   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.pNext				   = &features;
+	deviceInfo.queueCreateInfoCount	   = queueInfoCount;
+	deviceInfo.pQueueCreateInfos	   = queueInfos;
+	deviceInfo.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
+	deviceInfo.ppEnabledExtensionNames = extensions.data();
+
+	VkResult result = vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device);
+	if (result != VK_SUCCESS)
+	{
+		m_physicalDevice  = VK_NULL_HANDLE;
+		m_hasMemoryBudget = false;
+		return makeResult(result, "vkCreateDevice");
+	}
+
+	vkGetDeviceQueue(m_device, m_queueFamilies.graphics, 0, &m_graphicsQueue);
+	vkGetDeviceQueue(m_device, m_queueFamilies.present, 0, &m_presentQueue);
+	vkGetDeviceQueue(m_device, m_queueFamilies.transfer, 0, &m_transferQueue);
+	return Result(Result::Code::SUCCESS);
+}
+
+void Device::destroy()
+{
+	if (m_device != VK_NULL_HANDLE)
+	{
+		vkDeviceWaitIdle(m_device);
+		vkDestroyDevice(m_device, nullptr);
+		m_device		  = VK_NULL_HANDLE;
+		m_graphicsQueue	  = VK_NULL_HANDLE;
+		m_presentQueue	  = VK_NULL_HANDLE;
+		m_transferQueue	  = VK_NULL_HANDLE;
+		m_physicalDevice  = VK_NULL_HANDLE;
+		m_hasMemoryBudget = false;
+	}
+	if (m_debugMessenger != VK_NULL_HANDLE)
+	{
+		auto destroyMessenger = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+			vkGetInstanceProcAddr(m_instance, "vkDestroyDebugUtilsMessengerEXT"));
+		if (destroyMessenger)
+			destroyMessenger(m_instance, m_debugMessenger, nullptr);
+		m_debugMessenger = VK_NULL_HANDLE;
+	}
+	if (m_instance != VK_NULL_HANDLE)
+	{
+		vkDestroyInstance(m_instance, nullptr);
+		m_instance = VK_NULL_HANDLE;
+	}
+	m_logger.reset();
+}
+
+void Device::waitIdle() const
+{
+	if (m_device != VK_NULL_HANDLE)
+		vkDeviceWaitIdle(m_device);
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL Device::onDebugMessage(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+													  VkDebugUtilsMessageTypeFlagsEXT,
+													  const VkDebugUtilsMessengerCallbackDataEXT* data, void* userData)
+{
+	auto* device = static_cast<Device*>(userData);
+	if (!device->m_logger)
+		return VK_FALSE;
+
+	using LogLevel = logging::Logger::LogLevel;
+	std::string_view message(data->pMessage);
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+		device->m_logger->log<LogLevel::ERROR>("{}", message);
+	else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+		device->m_logger->log<LogLevel::WARN>("{}", message);
+	else
+		device->m_logger->info(message);
+	return VK_FALSE;
+}
+
+bool Device::isSuitable(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, QueueFamilies& families) const
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (properties.apiVersion < VK_API_VERSION_1_3 || !hasDeviceExtension(physicalDevice, VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+		return false;
+
+	VkPhysicalDeviceVulkan13Features features13 {};
+	features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+	VkPhysicalDeviceVulkan12Features features12 {};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.pNext = &features13;
+	VkPhysicalDeviceFeatures2 features {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &features12;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+	if (!features12.timelineSemaphore || !features13.synchronization2 || !features13.dynamicRendering)
+		return false;
+	if (!features12.drawIndirectCount || !features.features.multiDrawIndirect || !features.features.drawIndirectFirstInstance)
+		return false;
+	if (!hasBindlessFeatures(features12))
+		return false;
+
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueFamilies.data());
+
+	// Prefer one family for both, so swapchain images never change queue ownership
+	families = QueueFamilies();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		VkBool32 canPresent = VK_FALSE;
+		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &canPresent);
+		bool canDraw = (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+
+		if (canDraw && canPresent)
+		{
+			families.graphics = i;
+			families.present  = i;
+			return true;
+		}
+		if (canDraw && families.graphics == UINT32_MAX)
+			families.graphics = i;
+		if (canPresent && families.present == UINT32_MAX)
+			families.present = i;
+	}
+	return families.graphics != UINT32_MAX && families.present != UINT32_MAX;
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,186 @@
+#include "render/gpu_culling.h"
+
+#include "render/renderer.h"
+
+#ifndef ZAPHOD_SHADER_PACK
+#include "shaders/cull.comp.spv.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace zaphod::render
+{
+namespace
+{
+constexpr uint32_t workgroupSize = 64;	  // local_size_x of cull.comp
+
+// CullConstants in cull.comp
+struct CullConstants
+{
+	float	 planes[6][4];
+	uint32_t objectCount;
+	uint32_t objects;
+	uint32_t draws;
+	uint32_t count;
+};
+static_assert(sizeof(CullConstants) <= BindlessTable::pushConstantSize);
+
+void memoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+				   VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+{
+	VkMemoryBarrier2 barrier {};
+	barrier.sType		  = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	barrier.srcStageMask  = srcStage;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstStageMask  = dstStage;
+	barrier.dstAccessMask = dstAccess;
+
+	VkDependencyInfo dependency {};
+	dependency.sType			  = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.memoryBarrierCount = 1;
+	dependency.pMemoryBarriers	  = &barrier;
+	vkCmdPipelineBarrier2(commandBuffer, &dependency);
+}
+}	 // namespace
+
+GpuCulling::~GpuCulling()
+{
+	destroy();
+}
+
+Result GpuCulling::initialize(Renderer& renderer, std::span<const uint32_t> code)
+{
+	if (m_renderer)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The GPU culling pipeline already exists");
+#ifndef ZAPHOD_SHADER_PACK
+	if (code.empty())
+		code = cull_comp;
+#endif
+	if (code.empty())
+		return Result(Result::Code::INVALID_ARGUMENT, "No SPIR-V for cull.comp");
+
+	VkShaderModule module = renderer.getShaderLibrary().getModule(code.data(), code.size_bytes());
+	if (module == VK_NULL_HANDLE)
+		return Result(Result::Code::FAILURE, "Failed to create the cull.comp module");
+	m_renderer	  = &renderer;
+	Result result = createPipeline(module);
+	if (result.isFailure())
+	{
+		m_renderer = nullptr;
+		return result;
+	}
+
+#ifdef ZAPHOD_SHADER_HOT_RELOAD
+	// The old pipeline may still be used by frames in flight
+	auto reload = [this](VkShaderModule reloaded)
+	{
+		VkDevice   device = m_renderer->getDevice().getDevice();
+		VkPipeline old	  = m_pipeline;
+		if (createPipeline(reloaded).isSuccess())
+			m_renderer->destroyLater([device, old] { vkDestroyPipeline(device, old, nullptr); });
+	};
+	m_subscriptionId =
+		renderer.getShaderReloader().subscribe(std::filesystem::path(ZAPHOD_SHADER_SOURCE_DIR) / "cull.comp", reload);
+#endif
+	return result;
+}
+
+void GpuCulling::destroy()
+{
+	if (!m_renderer)
+		return;
+
+#ifdef ZAPHOD_SHADER_HOT_RELOAD
+	m_renderer->getShaderReloader().unsubscribe(m_subscriptionId);
+#endif
+	if (m_pipeline != VK_NULL_HANDLE)
+		vkDestroyPipeline(m_renderer->getDevice().getDevice(), m_pipeline, nullptr);
+	m_pipeline = VK_NULL_HANDLE;
+	m_renderer = nullptr;
+}
+
+void GpuCulling::cull(VkCommandBuffer commandBuffer, const Frustum& frustum, const Buffers& buffers) const
+{
+	// The previous frame's draws must have read the buffers before they are overwritten
+	memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+				  VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				  VK_ACCESS_2_NONE);
+	vkCmdFillBuffer(commandBuffer, buffers.countBuffer, buffers.countOffset, sizeof(uint32_t), 0);
+	if (buffers.objectCount > 0)
+	{
+		memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					  VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+					  VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+		CullConstants constants {};
+		std::copy(&frustum.planes[0][0], &frustum.planes[0][0] + 24, &constants.planes[0][0]);
+		constants.objectCount = buffers.objectCount;
+		constants.objects	  = buffers.objects;
+		constants.draws		  = buffers.draws;
+		constants.count		  = buffers.count;
+
+		const BindlessTable& table = m_renderer->getBindlessTable();
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+		table.bind(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+		vkCmdPushConstants(commandBuffer, table.getPipelineLayout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), &constants);
+		vkCmdDispatch(commandBuffer, (buffers.objectCount + workgroupSize - 1) / workgroupSize, 1, 1);
+	}
+	memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				  VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+				  VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+				  VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+void GpuCulling::draw(VkCommandBuffer commandBuffer, const Buffers& buffers)
+{
+	vkCmdDrawIndexedIndirectCount(commandBuffer, buffers.drawBuffer, buffers.drawOffset, buffers.countBuffer,
+								  buffers.countOffset, buffers.objectCount, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+GpuCulling::Frustum GpuCulling::extractFrustum(const float viewProjection[16])
+{
+	// Gribb and Hartmann: a clip space point is inside if -w <= x <= w, -w <= y <= w and 0 <= z <= w,
+	// and each of those compares two rows of the matrix applied to the point
+	Frustum frustum;
+	for (int column = 0; column < 4; ++column)
+	{
+		const float* rows		  = viewProjection + column * 4;	// The column's element of each row
+		frustum.planes[0][column] = rows[3] + rows[0];				// Left
+		frustum.planes[1][column] = rows[3] - rows[0];				// Right
+		frustum.planes[2][column] = rows[3] + rows[1];				// Bottom
+		frustum.planes[3][column] = rows[3] - rows[1];				// Top
+		frustum.planes[4][column] = rows[2];						// Near
+		frustum.planes[5][column] = rows[3] - rows[2];				// Far
+	}
+	for (float* plane : frustum.planes)
+	{
+		const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length > 0.0f)
+		{
+			for (int i = 0; i < 4; ++i)
+				plane[i] /= length;
+		}
+	}
+	return frustum;
+}
+
+Result GpuCulling::createPipeline(VkShaderModule module)
+{
+	VkComputePipelineCreateInfo pipelineInfo {};
+	pipelineInfo.sType		  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = module;
+	pipelineInfo.stage.pName  = "main";
+	pipelineInfo.layout		  = m_renderer->getBindlessTable().getPipelineLayout();
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult   result	= vkCreateComputePipelines(m_renderer->getDevice().getDevice(), m_renderer->getPipelineCache(), 1,
+												   &pipelineInfo, nullptr, &pipeline);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkCreateComputePipelines");
+	m_pipeline = pipeline;
+	return Result(Result::Code::SUCCESS);
+}
+}	 // namespace zaphod::render
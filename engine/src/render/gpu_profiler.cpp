@@ -0,0 +1,150 @@
+#include "render/gpu_profiler.h"
+
+#include "render/device.h"
+
+#include <algorithm>
+
+namespace zaphod::render
+{
+GpuProfiler::~GpuProfiler()
+{
+	destroy();
+}
+
+Result GpuProfiler::initialize(const Device& device, uint32_t framesInFlight)
+{
+	if (m_device)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The GPU profiler already exists");
+
+	VkPhysicalDevice physicalDevice = device.getPhysicalDevice();
+	uint32_t		 count			= 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueFamilies.data());
+	const uint32_t validBits = queueFamilies[device.getQueueFamilies().graphics].timestampValidBits;
+	if (validBits == 0)
+		return Result(Result::Code::UNSUPPORTED, "The graphics queue does not support timestamps");
+
+	m_period	 = device.getProperties().limits.timestampPeriod;
+	m_validMask	 = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+	m_offset	 = INT64_MIN;
+	m_frameCount = framesInFlight;
+	m_frames	 = std::make_unique<FrameQueries[]>(framesInFlight);
+	m_results.resize(queriesPerFrame);
+	m_device = &device;
+
+	VkQueryPoolCreateInfo poolInfo {};
+	poolInfo.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType	= VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = queriesPerFrame;
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		VkResult result = vkCreateQueryPool(device.getDevice(), &poolInfo, nullptr, &m_frames[i].pool);
+		if (result != VK_SUCCESS)
+		{
+			destroy();
+			return makeResult(result, "vkCreateQueryPool");
+		}
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+void GpuProfiler::destroy()
+{
+	if (!m_device)
+		return;
+
+	for (uint32_t i = 0; i < m_frameCount; ++i)
+	{
+		if (m_frames[i].pool != VK_NULL_HANDLE)
+			vkDestroyQueryPool(m_device->getDevice(), m_frames[i].pool, nullptr);
+	}
+	m_frames.reset();
+	m_results.clear();
+	m_frameCount   = 0;
+	m_currentFrame = nullptr;
+	m_device	   = nullptr;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	if (!m_device)
+		return;
+
+	FrameQueries& frame = m_frames[frameIndex];
+	if (frame.isSubmitted)
+		collect(frame);
+	frame.zoneCount.store(0, std::memory_order_relaxed);
+	frame.isSubmitted = false;
+	m_currentFrame	  = &frame;
+
+	vkCmdResetQueryPool(commandBuffer, frame.pool, 0, queriesPerFrame);
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.pool, 0);
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer commandBuffer)
+{
+	if (!m_currentFrame)
+		return;
+
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_currentFrame->pool, 1);
+	m_currentFrame->submitTime	= profiling::Profiler::get().now();
+	m_currentFrame->isSubmitted = true;
+	m_currentFrame				= nullptr;
+}
+
+uint32_t GpuProfiler::beginZone(VkCommandBuffer commandBuffer, const char* name)
+{
+	if (!m_currentFrame)
+		return invalidZone;
+
+	const uint32_t zone = m_currentFrame->zoneCount.fetch_add(1, std::memory_order_relaxed);
+	if (zone >= maxZonesPerFrame)
+		return invalidZone;
+	m_currentFrame->names[zone] = name;
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_currentFrame->pool, 2 + 2 * zone);
+	return zone;
+}
+
+void GpuProfiler::endZone(VkCommandBuffer commandBuffer, uint32_t zone)
+{
+	if (zone == invalidZone || !m_currentFrame)
+		return;
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_currentFrame->pool, 3 + 2 * zone);
+}
+
+void GpuProfiler::collect(FrameQueries& frame)
+{
+	// The frame has finished, so its results are available without waiting
+	const uint32_t zoneCount  = std::min(frame.zoneCount.load(std::memory_order_relaxed), maxZonesPerFrame);
+	const uint32_t queryCount = 2 + 2 * zoneCount;
+	VkResult	   result	  = vkGetQueryPoolResults(m_device->getDevice(), frame.pool, 0, queryCount,
+													  queryCount * sizeof(uint64_t), m_results.data(), sizeof(uint64_t),
+													  VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS)
+		return;
+
+	auto toNanoseconds = [this](uint64_t ticks) { return static_cast<int64_t>((ticks & m_validMask) * m_period); };
+	const int64_t frameBegin = toNanoseconds(m_results[0]);
+	const int64_t frameEnd	 = toNanoseconds(m_results[1]);
+	if (frameEnd < frameBegin)
+		return;	   // The counter wrapped around during the frame
+
+	// The GPU cannot have started the frame before it was submitted
+	m_offset = std::max(m_offset, frame.submitTime - frameBegin);
+
+	profiling::Profiler& profiler = profiling::Profiler::get();
+	profiler.recordGpuFrame((frameEnd - frameBegin) / 1e6);
+	if (!profiler.isCapturing())
+		return;
+
+	profiler.recordGpuZone({ "GPU frame", frameBegin + m_offset, frameEnd - frameBegin });
+	for (uint32_t zone = 0; zone < zoneCount; ++zone)
+	{
+		const int64_t begin = toNanoseconds(m_results[2 + 2 * zone]);
+		const int64_t end	= toNanoseconds(m_results[3 + 2 * zone]);
+		if (end >= begin)
+			profiler.recordGpuZone({ frame.names[zone], begin + m_offset, end - begin });
+	}
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,415 @@
+#include "render/memory_allocator.h"
+
+#include "render/device.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace zaphod::render
+{
+struct MemoryBlock
+{
+	VkDeviceMemory memory	   = VK_NULL_HANDLE;
+	VkDeviceSize   size		   = 0;
+	void*		   mapped	   = nullptr;
+	uint32_t	   memoryType  = 0;
+	bool		   isDedicated = false;
+	TlsfAllocator  ranges;	  // Unused by dedicated blocks
+};
+
+namespace
+{
+constexpr uint32_t invalidMemoryType = UINT32_MAX;
+
+// Blocks are never smaller, below this a dedicated allocation wastes less than a block does
+constexpr VkDeviceSize minimumBlockSize = VkDeviceSize(1) << 20;
+
+struct MemoryFlags
+{
+	VkMemoryPropertyFlags required;
+	VkMemoryPropertyFlags preferred;
+	VkMemoryPropertyFlags avoided;
+};
+
+MemoryFlags getMemoryFlags(MemoryUsage usage)
+{
+	constexpr VkMemoryPropertyFlags hostCoherent = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	switch (usage)
+	{
+	case MemoryUsage::GPU_ONLY: return { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+	// Staging data is read once by the GPU, it should not take up the small device local host visible heap
+	case MemoryUsage::UPLOAD:
+		return { hostCoherent, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT };
+	case MemoryUsage::DYNAMIC: return { hostCoherent, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT };
+	case MemoryUsage::READBACK: return { hostCoherent, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 0 };
+	}
+	return { 0, 0, 0 };
+}
+}	 // namespace
+
+MemoryAllocator::MemoryAllocator() = default;
+
+MemoryAllocator::~MemoryAllocator()
+{
+	destroy();
+}
+
+void MemoryAllocator::initialize(const Device& device, const Config& config)
+{
+	m_device = &device;
+	m_config = config;
+}
+
+void MemoryAllocator::destroy()
+{
+	if (!m_device)
+		return;
+
+	std::lock_guard lock(m_mutex);
+	for (auto& pools : m_blocks)
+	{
+		for (auto& blocks : pools)
+		{
+			for (const std::unique_ptr<MemoryBlock>& block : blocks)
+				freeBlock(*block);
+			blocks.clear();
+		}
+	}
+	for (const std::unique_ptr<MemoryBlock>& block : m_dedicatedBlocks)
+		freeBlock(*block);
+	m_dedicatedBlocks.clear();
+	m_device = nullptr;
+}
+
+Result MemoryAllocator::allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, bool isLinear,
+								 Allocation& allocation)
+{
+	allocation = {};
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The memory allocator has no device");
+	if (requirements.size == 0)
+		return Result(Result::Code::INVALID_ARGUMENT, "Cannot allocate 0 bytes");
+
+	const uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, usage);
+	if (memoryType == invalidMemoryType)
+		return Result(Result::Code::UNSUPPORTED, "No memory type is suitable for the resource");
+
+	const VkDeviceSize blockSize = getBlockSize(memoryType);
+	std::lock_guard	   lock(m_mutex);
+	if (requirements.size > blockSize / 2)
+	{
+		std::unique_ptr<MemoryBlock> block;
+		Result						 result = allocateMemory(memoryType, requirements.size, block);
+		if (result.isFailure())
+			return result;
+		block->isDedicated = true;
+		allocation.memory  = block->memory;
+		allocation.size	   = requirements.size;
+		allocation.mapped  = block->mapped;
+		allocation.block   = block.get();
+		m_dedicatedBlocks.push_back(std::move(block));
+		return Result(Result::Code::SUCCESS);
+	}
+
+	auto&		 blocks = m_blocks[memoryType][isLinear ? 1 : 0];
+	MemoryBlock* target = nullptr;
+	for (const std::unique_ptr<MemoryBlock>& block : blocks)
+	{
+		allocation.range = block->ranges.allocate(requirements.size, requirements.alignment);
+		if (allocation.range.isValid())
+		{
+			target = block.get();
+			break;
+		}
+	}
+
+	if (!target)
+	{
+		// Close to the budget a smaller block may still fit
+		std::unique_ptr<MemoryBlock> block;
+		Result						 result;
+		for (VkDeviceSize size = blockSize;; size /= 2)
+		{
+			result = allocateMemory(memoryType, size, block);
+			if (result.code != Result::Code::OUT_OF_MEMORY || size / 2 < std::max(requirements.size * 2, minimumBlockSize))
+				break;
+		}
+		if (result.isFailure())
+			return result;
+		block->ranges.reset(block->size);
+		allocation.range = block->ranges.allocate(requirements.size, requirements.alignment);
+		target			 = block.get();
+		blocks.push_back(std::move(block));
+	}
+
+	allocation.memory = target->memory;
+	allocation.offset = allocation.range.offset;
+	allocation.size	  = requirements.size;
+	allocation.mapped = target->mapped ? static_cast<std::byte*>(target->mapped) + allocation.offset : nullptr;
+	allocation.block  = target;
+	return Result(Result::Code::SUCCESS);
+}
+
+void MemoryAllocator::free(Allocation& allocation)
+{
+	MemoryBlock*					block = allocation.block;
+	const TlsfAllocator::Allocation range = allocation.range;
+	allocation							  = {};
+	if (!block)
+		return;
+
+	std::lock_guard lock(m_mutex);
+	if (block->isDedicated)
+	{
+		freeBlock(*block);
+		std::erase_if(m_dedicatedBlocks,
+					  [block](const std::unique_ptr<MemoryBlock>& dedicated) { return dedicated.get() == block; });
+		return;
+	}
+
+	block->ranges.free(range);
+	if (!block->ranges.isEmpty())
+		return;
+
+	// Keep one empty block per pool, so a resource freed and recreated every frame does not reallocate it
+	for (auto& blocks : m_blocks[block->memoryType])
+	{
+		auto it = std::find_if(blocks.begin(), blocks.end(),
+							   [block](const std::unique_ptr<MemoryBlock>& candidate) { return candidate.get() == block; });
+		if (it == blocks.end())
+			continue;
+		const bool hasOtherEmptyBlock = std::any_of(blocks.begin(), blocks.end(),
+													[block](const std::unique_ptr<MemoryBlock>& candidate)
+													{ return candidate.get() != block && candidate->ranges.isEmpty(); });
+		if (hasOtherEmptyBlock)
+		{
+			freeBlock(*block);
+			blocks.erase(it);
+		}
+		return;
+	}
+}
+
+Result MemoryAllocator::createBuffer(const VkBufferCreateInfo& bufferInfo, MemoryUsage usage, Buffer& buffer)
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The memory allocator has no device");
+
+	VkDevice device = m_device->getDevice();
+	VkResult result = vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.buffer);
+	if (result != VK_SUCCESS)
+	{
+		buffer.buffer = VK_NULL_HANDLE;
+		return makeResult(result, "vkCreateBuffer");
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(device, buffer.buffer, &requirements);
+	Result allocated = allocate(requirements, usage, true, buffer.allocation);
+	if (allocated.isSuccess())
+		allocated = makeResult(vkBindBufferMemory(device, buffer.buffer, buffer.allocation.memory, buffer.allocation.offset),
+							   "vkBindBufferMemory");
+	if (allocated.isFailure())
+		destroyBuffer(buffer);
+	return allocated;
+}
+
+void MemoryAllocator::destroyBuffer(Buffer& buffer)
+{
+	if (buffer.buffer != VK_NULL_HANDLE)
+		vkDestroyBuffer(m_device->getDevice(), buffer.buffer, nullptr);
+	buffer.buffer = VK_NULL_HANDLE;
+	free(buffer.allocation);
+}
+
+Result MemoryAllocator::createImage(const VkImageCreateInfo& imageInfo, MemoryUsage usage, Image& image)
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The memory allocator has no device");
+
+	VkDevice device = m_device->getDevice();
+	VkResult result = vkCreateImage(device, &imageInfo, nullptr, &image.image);
+	if (result != VK_SUCCESS)
+	{
+		image.image = VK_NULL_HANDLE;
+		return makeResult(result, "vkCreateImage");
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(device, image.image, &requirements);
+	Result allocated = allocate(requirements, usage, imageInfo.tiling == VK_IMAGE_TILING_LINEAR, image.allocation);
+	if (allocated.isSuccess())
+		allocated = makeResult(vkBindImageMemory(device, image.image, image.allocation.memory, image.allocation.offset),
+							   "vkBindImageMemory");
+	if (allocated.isFailure())
+		destroyImage(image);
+	return allocated;
+}
+
+void MemoryAllocator::destroyImage(Image& image)
+{
+	if (image.image != VK_NULL_HANDLE)
+		vkDestroyImage(m_device->getDevice(), image.image, nullptr);
+	image.image = VK_NULL_HANDLE;
+	free(image.allocation);
+}
+
+MemoryAllocator::Statistics MemoryAllocator::getStatistics() const
+{
+	Statistics statistics;
+	if (!m_device)
+		return statistics;
+
+	const VkPhysicalDeviceMemoryProperties& properties = m_device->getMemoryProperties();
+	statistics.heaps.resize(properties.memoryHeapCount);
+	std::vector<VkDeviceSize> freeBytes(properties.memoryHeapCount, 0);
+	{
+		std::lock_guard lock(m_mutex);
+		auto			add = [&](const MemoryBlock& block)
+		{
+			const uint32_t	heapIndex = properties.memoryTypes[block.memoryType].heapIndex;
+			HeapStatistics& heap	  = statistics.heaps[heapIndex];
+			heap.blockBytes += block.size;
+			++heap.blockCount;
+			++statistics.deviceMemoryCount;
+			if (block.isDedicated)
+			{
+				heap.allocatedBytes += block.size;
+				++heap.allocationCount;
+				return;
+			}
+			heap.allocatedBytes += block.size - block.ranges.getFreeSize();
+			heap.allocationCount += block.ranges.getAllocationCount();
+			heap.largestFreeRange = std::max(heap.largestFreeRange, block.ranges.getLargestFreeRange());
+			freeBytes[heapIndex] += block.ranges.getFreeSize();
+		};
+		for (const auto& pools : m_blocks)
+		{
+			for (const auto& blocks : pools)
+			{
+				for (const std::unique_ptr<MemoryBlock>& block : blocks)
+					add(*block);
+			}
+		}
+		for (const std::unique_ptr<MemoryBlock>& block : m_dedicatedBlocks)
+			add(*block);
+	}
+
+	VkDeviceSize budgets[VK_MAX_MEMORY_HEAPS], usages[VK_MAX_MEMORY_HEAPS];
+	queryBudgets(budgets, usages);
+	for (uint32_t i = 0; i < properties.memoryHeapCount; ++i)
+	{
+		HeapStatistics& heap = statistics.heaps[i];
+		if (freeBytes[i] > 0)
+			heap.fragmentation = 1.0f - static_cast<float>(heap.largestFreeRange) / static_cast<float>(freeBytes[i]);
+		heap.budget = budgets[i];
+		heap.usage	= m_device->hasMemoryBudget() ? usages[i] : heap.blockBytes;
+	}
+	return statistics;
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeBits, MemoryUsage usage) const
+{
+	const VkPhysicalDeviceMemoryProperties& properties = m_device->getMemoryProperties();
+	const MemoryFlags						flags	   = getMemoryFlags(usage);
+
+	uint32_t bestType  = invalidMemoryType;
+	int		 bestScore = 0;
+	for (uint32_t i = 0; i < properties.memoryTypeCount; ++i)
+	{
+		const VkMemoryPropertyFlags typeFlags = properties.memoryTypes[i].propertyFlags;
+		if (!(typeBits & (1u << i)) || (typeFlags & flags.required) != flags.required)
+			continue;
+		const int score = std::popcount(typeFlags & flags.preferred) - std::popcount(typeFlags & flags.avoided);
+		if (bestType == invalidMemoryType || score > bestScore)
+		{
+			bestType  = i;
+			bestScore = score;
+		}
+	}
+	return bestType;
+}
+
+VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryType) const
+{
+	const VkPhysicalDeviceMemoryProperties& properties = m_device->getMemoryProperties();
+	const VkDeviceSize heapSize = properties.memoryHeaps[properties.memoryTypes[memoryType].heapIndex].size;
+	// Small heaps, like the 256 MiB host visible window into device memory, get blocks of an eighth
+	if (heapSize < (VkDeviceSize(1) << 30))
+		return std::max(std::min(m_config.blockSize, heapSize / 8), minimumBlockSize);
+	return m_config.blockSize;
+}
+
+void MemoryAllocator::queryBudgets(VkDeviceSize* budgets, VkDeviceSize* usages) const
+{
+	const VkPhysicalDeviceMemoryProperties& properties = m_device->getMemoryProperties();
+	if (!m_device->hasMemoryBudget())
+	{
+		for (uint32_t i = 0; i < properties.memoryHeapCount; ++i)
+		{
+			budgets[i] = properties.memoryHeaps[i].size;
+			usages[i]  = 0;
+		}
+		return;
+	}
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {};
+	budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 properties2 {};
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	properties2.pNext = &budgetProperties;
+	vkGetPhysicalDeviceMemoryProperties2(m_device->getPhysicalDevice(), &properties2);
+	std::copy_n(budgetProperties.heapBudget, properties.memoryHeapCount, budgets);
+	std::copy_n(budgetProperties.heapUsage, properties.memoryHeapCount, usages);
+}
+
+Result MemoryAllocator::allocateMemory(uint32_t memoryType, VkDeviceSize size, std::unique_ptr<MemoryBlock>& block) const
+{
+	const VkPhysicalDeviceMemoryProperties& properties = m_device->getMemoryProperties();
+	const uint32_t							heapIndex  = properties.memoryTypes[memoryType].heapIndex;
+	if (m_device->hasMemoryBudget())
+	{
+		// Going over the budget makes the driver page memory out, or fail later on
+		VkDeviceSize budgets[VK_MAX_MEMORY_HEAPS], usages[VK_MAX_MEMORY_HEAPS];
+		queryBudgets(budgets, usages);
+		if (usages[heapIndex] + size > budgets[heapIndex])
+			return Result(Result::Code::OUT_OF_MEMORY, "Allocating device memory would exceed the heap's budget");
+	}
+
+	VkMemoryAllocateInfo allocateInfo {};
+	allocateInfo.sType			 = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize	 = size;
+	allocateInfo.memoryTypeIndex = memoryType;
+
+	VkDevice	   device = m_device->getDevice();
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkResult	   result = vkAllocateMemory(device, &allocateInfo, nullptr, &memory);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkAllocateMemory");
+
+	void* mapped = nullptr;
+	if (properties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+		if (result != VK_SUCCESS)
+		{
+			vkFreeMemory(device, memory, nullptr);
+			return makeResult(result, "vkMapMemory");
+		}
+	}
+
+	block			  = std::make_unique<MemoryBlock>();
+	block->memory	  = memory;
+	block->size		  = size;
+	block->mapped	  = mapped;
+	block->memoryType = memoryType;
+	return Result(Result::Code::SUCCESS);
+}
+
+void MemoryAllocator::freeBlock(MemoryBlock& block) const
+{
+	// Freeing memory unmaps it
+	vkFreeMemory(m_device->getDevice(), block.memory, nullptr);
+	block.memory = VK_NULL_HANDLE;
+}
+}	 // namespace zaphod::render
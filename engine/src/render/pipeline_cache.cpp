@@ -0,0 +1,174 @@
+#include "render/pipeline_cache.h"
+
+#include "render/device.h"
+#include "util/hash.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+namespace zaphod::render
+{
+namespace
+{
+constexpr char	   fileMagic[4] = { 'Z', 'P', 'S', 'O' };
+constexpr uint32_t fileVersion	= 1;
+
+// Written in front of the driver's data, identifies what produced it
+struct FileHeader
+{
+	char	 magic[4];
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t	 deviceUUID[VK_UUID_SIZE];
+	uint8_t	 driverUUID[VK_UUID_SIZE];
+	uint8_t	 pipelineCacheUUID[VK_UUID_SIZE];
+	uint32_t reserved;	  // Keeps the header free of padding, it is compared with memcmp
+	uint64_t dataSize;
+	uint64_t dataHash;
+};
+static_assert(sizeof(FileHeader) == 88);
+
+FileHeader makeHeader(const Device& device, size_t dataSize, uint64_t dataHash)
+{
+	const VkPhysicalDeviceProperties&	properties	 = device.getProperties();
+	const VkPhysicalDeviceIDProperties& idProperties = device.getIDProperties();
+
+	FileHeader header {};
+	std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+	header.version		 = fileVersion;
+	header.vendorID		 = properties.vendorID;
+	header.deviceID		 = properties.deviceID;
+	header.driverVersion = properties.driverVersion;
+	std::memcpy(header.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+	std::memcpy(header.driverUUID, idProperties.driverUUID, VK_UUID_SIZE);
+	std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header.dataSize = dataSize;
+	header.dataHash = dataHash;
+	return header;
+}
+
+// Checks the file against the device, then the driver's own header at the start of the data
+bool isValid(const Device& device, const std::vector<char>& file)
+{
+	if (file.size() < sizeof(FileHeader) + sizeof(VkPipelineCacheHeaderVersionOne))
+		return false;
+
+	FileHeader header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	const char*	 data	  = file.data() + sizeof(header);
+	const size_t dataSize = file.size() - sizeof(header);
+	FileHeader	 expected = makeHeader(device, dataSize, hashBytes(data, dataSize));
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+		return false;
+
+	const VkPhysicalDeviceProperties& properties = device.getProperties();
+	VkPipelineCacheHeaderVersionOne	  cacheHeader;
+	std::memcpy(&cacheHeader, data, sizeof(cacheHeader));
+	return cacheHeader.headerSize >= sizeof(cacheHeader) && cacheHeader.headerSize <= dataSize
+		&& cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && cacheHeader.vendorID == properties.vendorID
+		&& cacheHeader.deviceID == properties.deviceID
+		&& std::memcmp(cacheHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+}	 // namespace
+
+PipelineCache::~PipelineCache()
+{
+	destroy();
+}
+
+Result PipelineCache::initialize(const Device& device, const std::filesystem::path& path)
+{
+	if (m_cache != VK_NULL_HANDLE)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The pipeline cache already exists");
+
+	std::vector<char> file;
+	if (!path.empty())
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (stream)
+			file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	const bool useFile = isValid(device, file);
+
+	VkPipelineCacheCreateInfo cacheInfo {};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	if (useFile)
+	{
+		cacheInfo.initialDataSize = file.size() - sizeof(FileHeader);
+		cacheInfo.pInitialData	  = file.data() + sizeof(FileHeader);
+	}
+
+	VkResult result = vkCreatePipelineCache(device.getDevice(), &cacheInfo, nullptr, &m_cache);
+	if (result != VK_SUCCESS)
+	{
+		m_cache = VK_NULL_HANDLE;
+		return makeResult(result, "vkCreatePipelineCache");
+	}
+
+	m_device	 = &device;
+	m_path		 = path;
+	m_loadedSize = cacheInfo.initialDataSize;
+	m_loadedHash = useFile ? hashBytes(cacheInfo.pInitialData, cacheInfo.initialDataSize) : 0;
+	return Result(Result::Code::SUCCESS);
+}
+
+Result PipelineCache::save()
+{
+	if (m_cache == VK_NULL_HANDLE)
+		return Result(Result::Code::NOT_INITIALIZED, "There is no pipeline cache to save");
+	if (m_path.empty())
+		return Result(Result::Code::SUCCESS);
+
+	VkDevice device = m_device->getDevice();
+	size_t	 size	= 0;
+	VkResult result = vkGetPipelineCacheData(device, m_cache, &size, nullptr);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkGetPipelineCacheData");
+	std::vector<char> data(size);
+	result = vkGetPipelineCacheData(device, m_cache, &size, data.data());
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkGetPipelineCacheData");
+	data.resize(size);
+
+	const uint64_t hash = hashBytes(data.data(), data.size());
+	if (data.size() == m_loadedSize && hash == m_loadedHash)
+		return Result(Result::Code::SUCCESS);
+
+	// Write next to the file and rename over it, so a crash mid-write never leaves a torn cache
+	const FileHeader	  header	= makeHeader(*m_device, data.size(), hash);
+	std::filesystem::path temporary = std::filesystem::path(m_path).concat(".tmp");
+	{
+		std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!stream)
+			return Result(Result::Code::IO_ERROR, "Failed to write " + temporary.string());
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, m_path, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return Result(Result::Code::IO_ERROR, "Failed to replace " + m_path.string());
+	}
+	m_loadedSize = data.size();
+	m_loadedHash = hash;
+	return Result(Result::Code::SUCCESS);
+}
+
+void PipelineCache::destroy()
+{
+	if (m_cache != VK_NULL_HANDLE)
+		vkDestroyPipelineCache(m_device->getDevice(), m_cache, nullptr);
+	m_cache		 = VK_NULL_HANDLE;
+	m_device	 = nullptr;
+	m_loadedSize = 0;
+	m_loadedHash = 0;
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,793 @@
+#include "render/renderer.h"
+
+#include "core/profiler.h"
+#include "gui/window.h"
+
+#include <algorithm>
+
+namespace zaphod::render
+{
+namespace
+{
+void transitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+					 VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage,
+					 VkAccessFlags2 dstAccess)
+{
+	VkImageMemoryBarrier2 barrier {};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask					= srcStage;
+	barrier.srcAccessMask					= srcAccess;
+	barrier.dstStageMask					= dstStage;
+	barrier.dstAccessMask					= dstAccess;
+	barrier.oldLayout						= oldLayout;
+	barrier.newLayout						= newLayout;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= image;
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= 0;
+	barrier.subresourceRange.levelCount		= 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+
+	VkDependencyInfo dependency {};
+	dependency.sType				   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.imageMemoryBarrierCount = 1;
+	dependency.pImageMemoryBarriers	   = &barrier;
+	vkCmdPipelineBarrier2(commandBuffer, &dependency);
+}
+
+VkExtent2D getFramebufferExtent(const Window& window)
+{
+	int width = 0, height = 0;
+	window.getFramebufferSize(width, height);
+	return { static_cast<uint32_t>(std::max(width, 0)), static_cast<uint32_t>(std::max(height, 0)) };
+}
+}	 // namespace
+
+Renderer::~Renderer()
+{
+	shutdown();
+}
+
+void Renderer::setConfig(const Config& config)
+{
+	if (!isInitialized())
+		m_config = config;
+}
+
+void Renderer::setJobSystem(JobSystem* jobSystem)
+{
+	if (!isInitialized())
+		m_jobSystem = jobSystem;
+}
+
+Result Renderer::initialize(Window& window)
+{
+	if (isInitialized())
+		return Result(Result::Code::ALREADY_INITIALIZED, "The renderer is already initialized");
+
+	if (m_config.recordingThreads == 0 && m_jobSystem)
+		m_config.recordingThreads = m_jobSystem->getWorkerCount();
+	m_config.framesInFlight	  = std::clamp<uint32_t>(m_config.framesInFlight, 1, maxFramesInFlight);
+	m_config.recordingThreads = std::max<uint32_t>(m_config.recordingThreads, 1);
+
+	Result result = m_device.createInstance(m_config.device);
+	if (result.isFailure())
+		return result;
+
+	VkSurfaceKHR surface = window.createSurface(m_device.getInstance());
+	if (surface == VK_NULL_HANDLE)
+	{
+		m_device.destroy();
+		return Result(Result::Code::FAILURE, "Failed to create a Vulkan surface for the window");
+	}
+
+	result = m_device.createDevice(surface);
+	if (result.isSuccess())
+		result = createTarget(window, surface);
+	else
+		vkDestroySurfaceKHR(m_device.getInstance(), surface, nullptr);
+	if (result.isSuccess())
+		result = m_pipelineCache.initialize(m_device, m_config.pipelineCachePath);
+	if (result.isSuccess())
+	{
+		m_memoryAllocator.initialize(m_device, m_config.memory);
+		constexpr VkBufferUsageFlags frameDataUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+													| VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+													| VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		result = m_frameData.initialize(m_memoryAllocator, m_config.frameDataSize, frameDataUsage);
+	}
+	if (result.isSuccess())
+		result = m_uploadQueue.initialize(m_device, m_memoryAllocator, m_config.upload);
+	if (result.isSuccess())
+		result = m_bindlessTable.initialize(m_device, m_config.bindless);
+	if (result.isSuccess())
+		result = createFrames();
+	if (result.isFailure())
+	{
+		destroyFrames();
+		m_gpuProfiler.destroy();
+		m_bindlessTable.destroy();
+		m_uploadQueue.destroy();
+		m_frameData.destroy();
+		m_memoryAllocator.destroy();
+		m_pipelineCache.destroy();
+		for (const std::unique_ptr<WindowTarget>& target : m_targets)
+			destroyTarget(*target);
+		m_targets.clear();
+		m_device.destroy();
+		return result;
+	}
+	m_shaderLibrary.initialize(m_device);
+	// Frames are timed where the device has timestamps, they are rendered the same without
+	m_gpuProfiler.initialize(m_device, m_config.framesInFlight);
+
+#ifdef ZAPHOD_SHADER_HOT_RELOAD
+	if (m_config.hotReloadShaders)
+	{
+		ShaderReloader::Config reloaderConfig;
+		reloaderConfig.directories = m_config.shaderDirectories;
+		reloaderConfig.directories.emplace_back(ZAPHOD_SHADER_SOURCE_DIR);
+		reloaderConfig.compiler = ZAPHOD_GLSLC;
+		// A development aid, rendering works the same without it
+		m_shaderReloader.start(m_shaderLibrary, reloaderConfig);
+	}
+#endif
+
+	m_isInitialized = true;
+	return Result(Result::Code::SUCCESS);
+}
+
+void Renderer::shutdown()
+{
+	if (!isInitialized())
+		return;
+
+	m_shaderReloader.stop();
+	if (m_jobSystem)
+		m_jobSystem->wait(m_recordingJobs);
+	releaseRecordCallables();
+	m_device.waitIdle();
+	runPendingDestructions(UINT64_MAX);
+	destroyFrames();
+	m_gpuProfiler.destroy();
+	m_bindlessTable.destroy();
+	m_uploadQueue.destroy();
+	m_frameData.destroy();
+	m_memoryAllocator.destroy();
+	m_pipelineCache.save();	   // A failed save only costs the next startup its warm cache
+	m_pipelineCache.destroy();
+	m_shaderLibrary.destroy();
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+		destroyTarget(*target);
+	m_targets.clear();
+	m_device.destroy();
+	m_isInitialized = false;
+	m_frameNumber	= 0;
+	m_isFrameActive = false;
+}
+
+Result Renderer::addWindow(Window& window)
+{
+	if (!isInitialized())
+		return Result(Result::Code::NOT_INITIALIZED, "The renderer is not initialized");
+	if (getSwapchain(window))
+		return Result(Result::Code::INVALID_ARGUMENT, "The window is rendered to already");
+
+	VkSurfaceKHR surface = window.createSurface(m_device.getInstance());
+	if (surface == VK_NULL_HANDLE)
+		return Result(Result::Code::FAILURE, "Failed to create a Vulkan surface for the window");
+
+	// The device was chosen for the first window, the present family may not reach every surface
+	VkBool32 isSupported = VK_FALSE;
+	vkGetPhysicalDeviceSurfaceSupportKHR(m_device.getPhysicalDevice(), m_device.getQueueFamilies().present, surface,
+										 &isSupported);
+	if (!isSupported)
+	{
+		vkDestroySurfaceKHR(m_device.getInstance(), surface, nullptr);
+		return Result(Result::Code::UNSUPPORTED, "The device cannot present to the window");
+	}
+	return createTarget(window, surface);
+}
+
+Result Renderer::removeWindow(Window& window)
+{
+	if (m_isFrameActive)
+		return Result(Result::Code::FAILURE, "Windows cannot be removed while a frame is recorded");
+
+	auto target = std::find_if(m_targets.begin(), m_targets.end(),
+							   [&window](const std::unique_ptr<WindowTarget>& entry) { return entry->window == &window; });
+	if (target == m_targets.end())
+		return Result(Result::Code::INVALID_ARGUMENT, "The window is not rendered to");
+
+	// Nothing tells when the presentation engine is done with the images, short of the device idling.
+	// Swapchains the window's resizes retired go first, a surface outlives every swapchain of it.
+	m_device.waitIdle();
+	runPendingDestructions(m_frameNumber);
+	destroyTarget(**target);
+	m_targets.erase(target);
+	return Result(Result::Code::SUCCESS);
+}
+
+FrameContext* Renderer::beginFrame()
+{
+	if (!isInitialized() || m_isFrameActive)
+		return nullptr;
+	ZAPHOD_PROFILE_ZONE("Renderer::beginFrame");
+
+	// Pipelines rebuilt for reloaded shaders are in place before anything is recorded with them
+	m_shaderReloader.update();
+	// Uploads started since the last frame go out as one batch, also while nothing is rendered
+	m_uploadQueue.flush();
+
+	// Minimized windows have nothing to present to and sit the frame out. However many resize events
+	// arrived since the last frame, a resized window's swapchain is recreated once, to its latest size.
+	bool hasTarget = false;
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+	{
+		const VkExtent2D extent = getFramebufferExtent(*target->window);
+		if (extent.width != target->extent.width || extent.height != target->extent.height)
+			target->isOutdated = true;
+		target->isRendered = extent.width > 0 && extent.height > 0 && (!target->isOutdated || recreateSwapchain(*target, extent));
+		hasTarget |= target->isRendered;
+	}
+	if (!hasTarget)
+		return nullptr;
+
+	const uint64_t frameNumber = m_frameNumber + 1;
+	const uint32_t frameIndex  = static_cast<uint32_t>(frameNumber % m_frames.size());
+	Frame&		   frame	   = m_frames[frameIndex];
+	VkDevice	   device	   = m_device.getDevice();
+
+	// Wait until the GPU is done with the last frame that used this slot
+	{
+		ZAPHOD_PROFILE_ZONE("Wait for frame slot");
+		VkSemaphoreWaitInfo waitInfo {};
+		waitInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores	= &m_frameTimeline;
+		waitInfo.pValues		= &frame.timelineValue;
+		vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+	}
+
+	uint64_t completedFrame = 0;
+	vkGetSemaphoreCounterValue(device, m_frameTimeline, &completedFrame);
+	runPendingDestructions(completedFrame);
+	m_frameData.retire(completedFrame);
+
+	uint32_t firstTarget = UINT32_MAX;
+	{
+		ZAPHOD_PROFILE_ZONE("Acquire images");
+		for (uint32_t i = 0; i < m_targets.size(); ++i)
+		{
+			WindowTarget& target = *m_targets[i];
+			if (!target.isRendered)
+				continue;
+
+			VkResult result = target.swapchain.acquireNextImage(target.imageAcquired[frameIndex], target.imageIndex);
+			if (result == VK_SUBOPTIMAL_KHR)
+				target.isOutdated = true;	 // Still presentable, recreate after this frame
+			else if (result != VK_SUCCESS)
+			{
+				target.isOutdated = result == VK_ERROR_OUT_OF_DATE_KHR;
+				target.isRendered = false;
+				continue;
+			}
+			firstTarget = std::min(firstTarget, i);
+		}
+	}
+	if (firstTarget == UINT32_MAX)
+		return nullptr;
+
+	for (CommandPool& pool : frame.commandPools)
+	{
+		vkResetCommandPool(device, pool.pool, 0);
+		pool.usedBuffers = 0;
+	}
+
+	VkCommandBufferBeginInfo beginInfo {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+	m_gpuProfiler.beginFrame(frame.commandBuffer, frameIndex);
+
+	// Rendering begins in endFrame, compute work recorded until then runs before it
+	m_context.computeCommandBuffer = frame.commandBuffer;
+	m_context.frameIndex		   = frameIndex;
+	m_context.frameNumber		   = frameNumber;
+
+	m_isFrameActive	  = true;
+	m_uploadWaitValue = 0;
+	m_secondaryBuffers.clear();
+	m_segments.clear();
+	selectTarget(firstTarget);
+	beginMainThreadBuffer();
+	return &m_context;
+}
+
+const FrameContext* Renderer::selectWindow(const Window& window)
+{
+	if (!m_isFrameActive)
+		return nullptr;
+
+	for (uint32_t i = 0; i < m_targets.size(); ++i)
+	{
+		if (m_targets[i]->window != &window)
+			continue;
+		if (!m_targets[i]->isRendered)
+			return nullptr;
+		if (i != m_currentTarget)
+		{
+			endMainThreadBuffer();
+			selectTarget(i);
+			beginMainThreadBuffer();
+		}
+		return &m_context;
+	}
+	return nullptr;
+}
+
+void Renderer::endFrame()
+{
+	if (!m_isFrameActive)
+		return;
+	ZAPHOD_PROFILE_ZONE("Renderer::endFrame");
+
+	endMainThreadBuffer();
+	if (m_jobSystem)
+	{
+		ZAPHOD_PROFILE_ZONE("Wait for recording");
+		m_jobSystem->wait(m_recordingJobs);
+	}
+	releaseRecordCallables();
+	m_isFrameActive = false;
+
+	Frame&			frame		  = m_frames[m_context.frameIndex];
+	VkCommandBuffer commandBuffer = frame.commandBuffer;
+	for (uint32_t i = 0; i < m_targets.size(); ++i)
+	{
+		if (m_targets[i]->isRendered)
+			renderTarget(commandBuffer, i);
+	}
+	m_gpuProfiler.endFrame(commandBuffer);
+	vkEndCommandBuffer(commandBuffer);
+
+	// The frame waits for the image of every window, and signals each ready to be presented
+	m_submitWaits.clear();
+	m_submitSignals.clear();
+	VkSemaphoreSubmitInfo timelineSignal {};
+	timelineSignal.sType	 = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	timelineSignal.semaphore = m_frameTimeline;
+	timelineSignal.value	 = m_context.frameNumber;
+	timelineSignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	m_submitSignals.push_back(timelineSignal);
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+	{
+		if (!target->isRendered)
+			continue;
+
+		VkSemaphoreSubmitInfo semaphore {};
+		semaphore.sType		= VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		semaphore.semaphore = target->imageAcquired[m_context.frameIndex];
+		semaphore.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		m_submitWaits.push_back(semaphore);
+		semaphore.semaphore = target->swapchain.getReadySemaphore(target->imageIndex);
+		semaphore.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		m_submitSignals.push_back(semaphore);
+	}
+
+	VkCommandBufferSubmitInfo commandBufferInfos[2] {};
+	uint32_t				  commandBufferCount = 0;
+
+	// Uploads queued during the frame that it already uses have to be submitted before it
+	if (m_uploadWaitValue > m_uploadQueue.getSubmittedValue())
+		m_uploadQueue.flush();
+	// Batches that have finished are acquired too, waiting for them costs nothing
+	const uint64_t uploadValue = std::max(m_uploadWaitValue, m_uploadQueue.getCompletedValue());
+	const bool	   hasAcquires = m_uploadQueue.hasPendingAcquires(uploadValue);
+	if (hasAcquires)
+	{
+		VkCommandBufferBeginInfo beginInfo {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(frame.acquireCommandBuffer, &beginInfo);
+		m_uploadQueue.recordAcquireBarriers(frame.acquireCommandBuffer, uploadValue);
+		vkEndCommandBuffer(frame.acquireCommandBuffer);
+
+		commandBufferInfos[commandBufferCount].sType		 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+		commandBufferInfos[commandBufferCount].commandBuffer = frame.acquireCommandBuffer;
+		++commandBufferCount;
+	}
+	if (hasAcquires || !m_uploadQueue.isComplete(m_uploadWaitValue))
+	{
+		VkSemaphoreSubmitInfo uploadWait {};
+		uploadWait.sType	 = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		uploadWait.semaphore = m_uploadQueue.getTimeline();
+		uploadWait.value	 = uploadValue;
+		uploadWait.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		m_submitWaits.push_back(uploadWait);
+	}
+	commandBufferInfos[commandBufferCount].sType		 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	commandBufferInfos[commandBufferCount].commandBuffer = commandBuffer;
+	++commandBufferCount;
+
+	VkSubmitInfo2 submitInfo {};
+	submitInfo.sType					= VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submitInfo.waitSemaphoreInfoCount	= static_cast<uint32_t>(m_submitWaits.size());
+	submitInfo.pWaitSemaphoreInfos		= m_submitWaits.data();
+	submitInfo.commandBufferInfoCount	= commandBufferCount;
+	submitInfo.pCommandBufferInfos		= commandBufferInfos;
+	submitInfo.signalSemaphoreInfoCount = static_cast<uint32_t>(m_submitSignals.size());
+	submitInfo.pSignalSemaphoreInfos	= m_submitSignals.data();
+	vkQueueSubmit2(m_device.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+
+	frame.timelineValue = m_context.frameNumber;
+	m_frameNumber		= m_context.frameNumber;
+	m_frameData.close(m_frameNumber);
+
+	// Every window in one call, which the presentation engine may also batch
+	ZAPHOD_PROFILE_ZONE("Present");
+	m_presentSwapchains.clear();
+	m_presentImages.clear();
+	m_presentWaits.clear();
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+	{
+		if (!target->isRendered)
+			continue;
+		m_presentSwapchains.push_back(target->swapchain.getSwapchain());
+		m_presentImages.push_back(target->imageIndex);
+		m_presentWaits.push_back(target->swapchain.getReadySemaphore(target->imageIndex));
+	}
+	m_presentResults.assign(m_presentSwapchains.size(), VK_SUCCESS);
+
+	VkPresentInfoKHR presentInfo {};
+	presentInfo.sType			   = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = static_cast<uint32_t>(m_presentWaits.size());
+	presentInfo.pWaitSemaphores	   = m_presentWaits.data();
+	presentInfo.swapchainCount	   = static_cast<uint32_t>(m_presentSwapchains.size());
+	presentInfo.pSwapchains		   = m_presentSwapchains.data();
+	presentInfo.pImageIndices	   = m_presentImages.data();
+	presentInfo.pResults		   = m_presentResults.data();
+	vkQueuePresentKHR(m_device.getPresentQueue(), &presentInfo);
+
+	uint32_t presented = 0;
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+	{
+		if (!target->isRendered)
+			continue;
+		const VkResult result = m_presentResults[presented++];
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+			target->isOutdated = true;
+	}
+}
+
+const Swapchain* Renderer::getSwapchain(const Window& window) const
+{
+	for (const std::unique_ptr<WindowTarget>& target : m_targets)
+	{
+		if (target->window == &window)
+			return &target->swapchain;
+	}
+	return nullptr;
+}
+
+VkCommandPool Renderer::getCommandPool(uint32_t thread) const
+{
+	return m_frames[m_context.frameIndex].commandPools[thread].pool;
+}
+
+void Renderer::waitIdle() const
+{
+	if (m_frameTimeline == VK_NULL_HANDLE)
+		return;
+
+	VkSemaphoreWaitInfo waitInfo {};
+	waitInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores	= &m_frameTimeline;
+	waitInfo.pValues		= &m_frameNumber;
+	vkWaitSemaphores(m_device.getDevice(), &waitInfo, UINT64_MAX);
+}
+
+void Renderer::destroyLater(std::function<void()> destroy)
+{
+	if (!isInitialized())
+	{
+		destroy();
+		return;
+	}
+	// Every frame up to the one being recorded may use the objects
+	const uint64_t frameNumber = m_isFrameActive ? m_context.frameNumber : m_frameNumber;
+	m_pendingDestructions.push_back({ frameNumber, std::move(destroy) });
+}
+
+RingBuffer::Allocation Renderer::allocateFrameData(VkDeviceSize size, VkDeviceSize alignment)
+{
+	return m_frameData.allocate(size, alignment);
+}
+
+void Renderer::useUpload(UploadQueue::Ticket ticket)
+{
+	if (m_isFrameActive)
+		m_uploadWaitValue = std::max(m_uploadWaitValue, ticket);
+}
+
+Result Renderer::createFrames()
+{
+	VkDevice device = m_device.getDevice();
+
+	VkSemaphoreTypeCreateInfo timelineInfo {};
+	timelineInfo.sType		   = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue  = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &timelineInfo;
+	VkResult result		= vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_frameTimeline);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkCreateSemaphore");
+
+	VkCommandPoolCreateInfo poolInfo {};
+	poolInfo.sType			  = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags			  = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_device.getQueueFamilies().graphics;
+
+	m_frames.resize(m_config.framesInFlight);
+	for (Frame& frame : m_frames)
+	{
+		frame.commandPools.resize(m_config.recordingThreads + 1);
+		for (CommandPool& pool : frame.commandPools)
+		{
+			result = vkCreateCommandPool(device, &poolInfo, nullptr, &pool.pool);
+			if (result != VK_SUCCESS)
+				return makeResult(result, "vkCreateCommandPool");
+		}
+
+		// The primary buffers come from the first thread's pool, which is the main thread's
+		VkCommandBufferAllocateInfo allocateInfo {};
+		allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool		= frame.commandPools[0].pool;
+		allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+		result = vkAllocateCommandBuffers(device, &allocateInfo, &frame.commandBuffer);
+		if (result == VK_SUCCESS)
+			result = vkAllocateCommandBuffers(device, &allocateInfo, &frame.acquireCommandBuffer);
+		if (result != VK_SUCCESS)
+			return makeResult(result, "vkAllocateCommandBuffers");
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+void Renderer::destroyFrames()
+{
+	VkDevice device = m_device.getDevice();
+	if (device == VK_NULL_HANDLE)
+		return;
+
+	for (Frame& frame : m_frames)
+	{
+		// Destroying a pool frees its command buffers
+		for (CommandPool& pool : frame.commandPools)
+		{
+			if (pool.pool != VK_NULL_HANDLE)
+				vkDestroyCommandPool(device, pool.pool, nullptr);
+		}
+	}
+	m_frames.clear();
+	if (m_frameTimeline != VK_NULL_HANDLE)
+		vkDestroySemaphore(device, m_frameTimeline, nullptr);
+	m_frameTimeline = VK_NULL_HANDLE;
+}
+
+Result Renderer::createTarget(Window& window, VkSurfaceKHR surface)
+{
+	auto target	   = std::make_unique<WindowTarget>();
+	target->window = &window;
+	target->extent = getFramebufferExtent(window);
+	Result result  = target->swapchain.initialize(m_device, surface, target->extent, m_config.presentMode);
+
+	VkSemaphoreCreateInfo semaphoreInfo {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	for (uint32_t i = 0; i < m_config.framesInFlight && result.isSuccess(); ++i)
+	{
+		VkResult semaphoreResult = vkCreateSemaphore(m_device.getDevice(), &semaphoreInfo, nullptr, &target->imageAcquired[i]);
+		if (semaphoreResult != VK_SUCCESS)
+			result = makeResult(semaphoreResult, "vkCreateSemaphore");
+	}
+	if (result.isFailure())
+	{
+		destroyTarget(*target);
+		return result;
+	}
+	m_targets.push_back(std::move(target));
+	return result;
+}
+
+void Renderer::destroyTarget(WindowTarget& target)
+{
+	for (VkSemaphore semaphore : target.imageAcquired)
+	{
+		if (semaphore != VK_NULL_HANDLE)
+			vkDestroySemaphore(m_device.getDevice(), semaphore, nullptr);
+	}
+	target.swapchain.destroy();
+}
+
+bool Renderer::recreateSwapchain(WindowTarget& target, VkExtent2D extent)
+{
+	// The frames in flight keep their images of the old swapchain, which goes once they have finished
+	ZAPHOD_PROFILE_ZONE("Recreate swapchain");
+	Swapchain::Retired retired;
+	Result			   result = target.swapchain.recreate(extent, retired);
+	if (retired.swapchain != VK_NULL_HANDLE)
+		destroyLater([device = m_device.getDevice(), retired] { retired.destroy(device); });
+	if (result.isFailure())
+		return false;
+	target.extent	  = extent;
+	target.isOutdated = false;
+	return true;
+}
+
+void Renderer::selectTarget(uint32_t target)
+{
+	// The buffers recorded from here on render to the target
+	const WindowTarget&	window = *m_targets[target];
+	m_currentTarget			   = target;
+	m_segments.push_back({ target, static_cast<uint32_t>(m_secondaryBuffers.size()) });
+
+	m_context.window	 = window.window;
+	m_context.imageIndex = window.imageIndex;
+	m_context.image		 = window.swapchain.getImage(window.imageIndex);
+	m_context.imageView	 = window.swapchain.getImageView(window.imageIndex);
+	m_context.format	 = window.swapchain.getFormat();
+	m_context.extent	 = window.swapchain.getExtent();
+}
+
+void Renderer::renderTarget(VkCommandBuffer commandBuffer, uint32_t target)
+{
+	const WindowTarget&	window = *m_targets[target];
+	const VkImage		image  = window.swapchain.getImage(window.imageIndex);
+	const VkExtent2D	extent = window.swapchain.getExtent();
+
+	// The previous contents are cleared anyway, so the old layout can be discarded
+	transitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+					VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE,
+					VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+
+	VkRenderingAttachmentInfo colorAttachment {};
+	colorAttachment.sType			 = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	colorAttachment.imageView		 = window.swapchain.getImageView(window.imageIndex);
+	colorAttachment.imageLayout		 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.loadOp			 = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp			 = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.clearValue.color = m_config.clearColor;
+
+	VkRenderingInfo renderingInfo {};
+	renderingInfo.sType				   = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	renderingInfo.flags				   = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+	renderingInfo.renderArea.offset	   = { 0, 0 };
+	renderingInfo.renderArea.extent	   = extent;
+	renderingInfo.layerCount		   = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments	   = &colorAttachment;
+	vkCmdBeginRendering(commandBuffer, &renderingInfo);
+
+	// The window's segments in recording order, a window that recorded nothing is only cleared
+	for (size_t i = 0; i < m_segments.size(); ++i)
+	{
+		if (m_segments[i].target != target)
+			continue;
+		const uint32_t first = m_segments[i].firstBuffer;
+		const uint32_t end	 = i + 1 < m_segments.size() ? m_segments[i + 1].firstBuffer
+														 : static_cast<uint32_t>(m_secondaryBuffers.size());
+		if (end > first)
+			vkCmdExecuteCommands(commandBuffer, end - first, &m_secondaryBuffers[first]);
+	}
+
+	vkCmdEndRendering(commandBuffer);
+	transitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+					VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+					VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
+}
+
+void Renderer::runPendingDestructions(uint64_t completedFrame)
+{
+	while (!m_pendingDestructions.empty() && m_pendingDestructions.front().frameNumber <= completedFrame)
+	{
+		// Popped first, a function may queue another destruction
+		std::function<void()> destroy = std::move(m_pendingDestructions.front().destroy);
+		m_pendingDestructions.pop_front();
+		destroy();
+	}
+}
+
+void Renderer::releaseRecordCallables()
+{
+	for (const RecordCallable& callable : m_recordCallables)
+		callable.destroy(callable.callable);
+	m_recordCallables.clear();
+	m_recordCallableArena.reset();
+}
+
+uint32_t Renderer::reserveSecondaryBuffers(uint32_t count)
+{
+	// Growing the list would move the slots running jobs write to, let them finish first
+	const size_t first = m_secondaryBuffers.size();
+	if (first + count > m_secondaryBuffers.capacity())
+	{
+		if (m_jobSystem)
+			m_jobSystem->wait(m_recordingJobs);
+		m_secondaryBuffers.reserve(std::max(first + count, m_secondaryBuffers.capacity() * 2));
+	}
+	m_secondaryBuffers.resize(first + count, VK_NULL_HANDLE);
+	return static_cast<uint32_t>(first);
+}
+
+void Renderer::recordTask(uint32_t slot, uint32_t task, VkFormat format, RecordFunction function, const void* callable)
+{
+	Frame&		   frame	= m_frames[m_context.frameIndex];
+	const uint32_t worker	= m_jobSystem ? m_jobSystem->getCurrentWorkerIndex() : 0;
+	const uint32_t shared	= m_config.recordingThreads;
+	const bool	   ownsPool	= worker < shared;
+	CommandPool&   pool		= frame.commandPools[ownsPool ? worker : shared];
+
+	// A pool and its buffers may only be used by one thread at a time
+	std::unique_lock<std::mutex> lock(m_sharedPoolMutex, std::defer_lock);
+	if (!ownsPool)
+		lock.lock();
+
+	VkCommandBuffer commandBuffer = beginSecondaryBuffer(pool, format);
+	function(callable, commandBuffer, task);
+	vkEndCommandBuffer(commandBuffer);
+	m_secondaryBuffers[slot] = commandBuffer;
+}
+
+VkCommandBuffer Renderer::beginSecondaryBuffer(CommandPool& pool, VkFormat format)
+{
+	if (pool.usedBuffers == pool.secondaryBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocateInfo {};
+		allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool		= pool.pool;
+		allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocateInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		vkAllocateCommandBuffers(m_device.getDevice(), &allocateInfo, &commandBuffer);
+		pool.secondaryBuffers.push_back(commandBuffer);
+	}
+	VkCommandBuffer commandBuffer = pool.secondaryBuffers[pool.usedBuffers++];
+
+	// Continues the primary's dynamic rendering, so it has to match its attachments
+	VkCommandBufferInheritanceRenderingInfo renderingInfo {};
+	renderingInfo.sType					  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+	renderingInfo.colorAttachmentCount	  = 1;
+	renderingInfo.pColorAttachmentFormats = &format;
+	renderingInfo.rasterizationSamples	  = VK_SAMPLE_COUNT_1_BIT;
+
+	VkCommandBufferInheritanceInfo inheritanceInfo {};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.pNext = &renderingInfo;
+
+	VkCommandBufferBeginInfo beginInfo {};
+	beginInfo.sType			   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags			   = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	return commandBuffer;
+}
+
+void Renderer::beginMainThreadBuffer()
+{
+	m_mainThreadSlot		= reserveSecondaryBuffers(1);
+	m_context.commandBuffer = beginSecondaryBuffer(m_frames[m_context.frameIndex].commandPools[0], m_context.format);
+}
+
+void Renderer::endMainThreadBuffer()
+{
+	vkEndCommandBuffer(m_context.commandBuffer);
+	m_secondaryBuffers[m_mainThreadSlot] = m_context.commandBuffer;
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,97 @@
+#include "render/ring_buffer.h"
+
+namespace zaphod::render
+{
+RingBuffer::~RingBuffer()
+{
+	destroy();
+}
+
+Result RingBuffer::initialize(MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags bufferUsage,
+							  MemoryUsage memoryUsage)
+{
+	if (m_allocator)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The ring buffer already exists");
+	if (memoryUsage == MemoryUsage::GPU_ONLY)
+		return Result(Result::Code::INVALID_ARGUMENT, "A ring buffer must be host visible");
+
+	VkBufferCreateInfo bufferInfo {};
+	bufferInfo.sType	   = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size		   = size;
+	bufferInfo.usage	   = bufferUsage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	Result result		   = allocator.createBuffer(bufferInfo, memoryUsage, m_buffer);
+	if (result.isFailure())
+		return result;
+
+	m_allocator = &allocator;
+	m_size		= size;
+	m_head = m_tail = m_closedHead = 0;
+	return Result(Result::Code::SUCCESS);
+}
+
+void RingBuffer::destroy()
+{
+	if (!m_allocator)
+		return;
+	m_allocator->destroyBuffer(m_buffer);
+	m_allocator = nullptr;
+	m_size		= 0;
+	m_regions.clear();
+}
+
+RingBuffer::Allocation RingBuffer::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	if (size == 0 || size > m_size)
+		return {};
+
+	std::lock_guard lock(m_mutex);
+	uint64_t		offset = (m_head % m_size + alignment - 1) & ~(alignment - 1);
+	uint64_t		start  = m_head - m_head % m_size + offset;
+	// Ranges never wrap, skip the end of the buffer if the range does not fit in it
+	if (offset + size > m_size)
+	{
+		offset = 0;
+		start  = m_head - m_head % m_size + m_size;
+	}
+	if (start + size - m_tail > m_size)
+		return {};
+
+	m_head = start + size;
+	return { m_buffer.buffer, offset, size, static_cast<std::byte*>(m_buffer.allocation.mapped) + offset, start };
+}
+
+void RingBuffer::close(uint64_t value)
+{
+	std::lock_guard lock(m_mutex);
+	if (m_head == m_closedHead)
+		return;
+	m_regions.push_back({ value, m_head });
+	m_closedHead = m_head;
+}
+
+void RingBuffer::close(uint64_t value, uint64_t end)
+{
+	std::lock_guard lock(m_mutex);
+	if (end <= m_closedHead)
+		return;
+	m_regions.push_back({ value, end });
+	m_closedHead = end;
+}
+
+void RingBuffer::retire(uint64_t completedValue)
+{
+	std::lock_guard lock(m_mutex);
+	while (!m_regions.empty() && m_regions.front().value <= completedValue)
+	{
+		m_tail = m_regions.front().end;
+		m_regions.pop_front();
+	}
+}
+
+VkDeviceSize RingBuffer::getUsedSize() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_head - m_tail;
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,88 @@
+#include "render/shader_library.h"
+
+#include "render/device.h"
+#include "util/hash.h"
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace zaphod::render
+{
+ShaderLibrary::~ShaderLibrary()
+{
+	destroy();
+}
+
+void ShaderLibrary::initialize(const Device& device)
+{
+	m_device = &device;
+}
+
+void ShaderLibrary::destroy()
+{
+	clear();
+	m_device = nullptr;
+}
+
+void ShaderLibrary::clear()
+{
+	std::unique_lock lock(m_mutex);
+	for (const auto& [hash, module] : m_modules)
+		vkDestroyShaderModule(m_device->getDevice(), module, nullptr);
+	m_modules.clear();
+}
+
+VkShaderModule ShaderLibrary::getModule(const void* code, size_t size)
+{
+	if (!m_device || !code || size == 0 || size % sizeof(uint32_t) != 0)
+		return VK_NULL_HANDLE;
+
+	const uint64_t hash = hashCode(code, size);
+	if (VkShaderModule module = findModule(hash); module != VK_NULL_HANDLE)
+		return module;
+
+	// pCode must point to aligned words, byte arrays generated from .spv files may not be
+	std::vector<uint32_t> alignedCode;
+	const uint32_t*		  words = static_cast<const uint32_t*>(code);
+	if (reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0)
+	{
+		alignedCode.resize(size / sizeof(uint32_t));
+		std::memcpy(alignedCode.data(), code, size);
+		words = alignedCode.data();
+	}
+
+	VkShaderModuleCreateInfo moduleInfo {};
+	moduleInfo.sType	= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = size;
+	moduleInfo.pCode	= words;
+
+	std::unique_lock lock(m_mutex);
+	// Another thread may have created it since the lookup
+	auto [it, inserted] = m_modules.try_emplace(hash, VK_NULL_HANDLE);
+	if (inserted && vkCreateShaderModule(m_device->getDevice(), &moduleInfo, nullptr, &it->second) != VK_SUCCESS)
+	{
+		m_modules.erase(it);
+		return VK_NULL_HANDLE;
+	}
+	return it->second;
+}
+
+VkShaderModule ShaderLibrary::findModule(uint64_t hash) const
+{
+	std::shared_lock lock(m_mutex);
+	auto			 it = m_modules.find(hash);
+	return it != m_modules.end() ? it->second : VK_NULL_HANDLE;
+}
+
+uint64_t ShaderLibrary::hashCode(const void* code, size_t size)
+{
+	return hashBytes(code, size);
+}
+
+size_t ShaderLibrary::getModuleCount() const
+{
+	std::shared_lock lock(m_mutex);
+	return m_modules.size();
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,67 @@
+#include "render/shader_pack.h"
+
+#include "util/hash.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace zaphod::render
+{
+Result ShaderPack::load(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return Result(Result::Code::IO_ERROR, "Failed to open " + path.string());
+	const size_t size = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+
+	// Read into words so every shader's code is aligned for VkShaderModuleCreateInfo::pCode
+	std::vector<uint32_t> data((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+	if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size)))
+		return Result(Result::Code::IO_ERROR, "Failed to read " + path.string());
+
+	const auto*	bytes	= reinterpret_cast<const char*>(data.data());
+	auto		invalid	= [&path](const char* reason)
+	{ return Result(Result::Code::INVALID_ARGUMENT, path.string() + " is not a valid shader pack: " + reason); };
+
+	shader_pack::Header header;
+	if (size < sizeof(header))
+		return invalid("truncated header");
+	std::memcpy(&header, bytes, sizeof(header));
+	if (std::memcmp(header.magic, shader_pack::magic, sizeof(header.magic)) != 0)
+		return invalid("wrong magic");
+	if (header.version != shader_pack::version)
+		return invalid("unsupported version");
+	if (header.entryCount > (size - sizeof(header)) / sizeof(shader_pack::Entry))
+		return invalid("truncated entry table");
+
+	ShaderMap shaders;
+	for (uint32_t i = 0; i < header.entryCount; ++i)
+	{
+		shader_pack::Entry entry;
+		std::memcpy(&entry, bytes + sizeof(header) + i * sizeof(entry), sizeof(entry));
+		if (size_t(entry.nameOffset) + entry.nameLength > size || size_t(entry.codeOffset) + entry.codeSize > size)
+			return invalid("entry out of bounds");
+		if (entry.codeOffset % sizeof(uint32_t) != 0 || entry.codeSize % sizeof(uint32_t) != 0)
+			return invalid("unaligned code");
+
+		const char* code = bytes + entry.codeOffset;
+		if (hashBytes(code, entry.codeSize) != entry.codeHash)
+			return invalid("corrupted code");
+		shaders.emplace(std::string(bytes + entry.nameOffset, entry.nameLength),
+						std::span<const uint32_t>(data.data() + entry.codeOffset / sizeof(uint32_t),
+												  entry.codeSize / sizeof(uint32_t)));
+	}
+
+	// Moving the vector keeps its buffer, so the spans stay valid
+	m_data	  = std::move(data);
+	m_shaders = std::move(shaders);
+	return Result(Result::Code::SUCCESS);
+}
+
+std::span<const uint32_t> ShaderPack::find(std::string_view name) const
+{
+	auto it = m_shaders.find(name);
+	return it != m_shaders.end() ? it->second : std::span<const uint32_t>();
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,332 @@
+#include "render/shader_reloader.h"
+
+#include "core/logger.h"
+#include "render/shader_library.h"
+#include "util/hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace zaphod::render
+{
+namespace
+{
+constexpr std::array<std::string_view, 6> stageExtensions = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+
+bool isStage(const std::filesystem::path& path)
+{
+	const std::string extension = path.extension().string();
+	return std::find(stageExtensions.begin(), stageExtensions.end(), extension) != stageExtensions.end();
+}
+
+// The same file always gets the same key, however it was reached
+std::string makeKey(const std::filesystem::path& path)
+{
+	std::error_code error;
+	std::filesystem::path absolute = std::filesystem::absolute(path, error);
+	return (error ? path : absolute).lexically_normal().string();
+}
+
+// Output files are named after the file and its key, so that stages with the same file name in
+// different directories do not overwrite each other's SPIR-V and depfiles
+std::string makeOutputName(const std::string& key)
+{
+	char hash[17];
+	std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(hashString(key)));
+	return std::filesystem::path(key).filename().string() + '-' + hash;
+}
+
+std::string quote(const std::filesystem::path& path)
+{
+	return '"' + path.string() + '"';
+}
+
+bool readFile(const std::filesystem::path& path, std::string& contents)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// Splits a Makefile rule "target: prerequisite..." into its prerequisites, which escape spaces with
+// a backslash and may continue over several lines
+std::vector<std::string> parseDepfile(const std::string& depfile)
+{
+	std::vector<std::string> files;
+	size_t					 separator = depfile.find(": ");	// Not the one after a Windows drive letter
+	if (separator == std::string::npos)
+		return files;
+
+	std::string file;
+	for (size_t i = separator + 2; i < depfile.size(); ++i)
+	{
+		const char c = depfile[i];
+		if (c == '\\' && i + 1 < depfile.size() && (depfile[i + 1] == ' ' || depfile[i + 1] == '\n' || depfile[i + 1] == '\r'))
+		{
+			if (depfile[i + 1] == ' ')
+				file += ' ';
+			++i;
+		}
+		else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+		{
+			if (!file.empty())
+				files.push_back(std::move(file));
+			file.clear();
+		}
+		else
+		{
+			file += c;
+		}
+	}
+	if (!file.empty())
+		files.push_back(std::move(file));
+	return files;
+}
+}	 // namespace
+
+ShaderReloader::ShaderReloader() = default;
+
+ShaderReloader::~ShaderReloader()
+{
+	stop();
+}
+
+Result ShaderReloader::start(ShaderLibrary& library, const Config& config)
+{
+	if (isRunning())
+		return Result(Result::Code::ALREADY_INITIALIZED, "The shader reloader is already running");
+
+	if (!m_logger)
+	{
+		m_logger = logging::SimpleLoggerFactory("Shaders").create();
+		m_logger->setLogLevelFlags(
+			{ logging::Logger::LogLevel::INFO, logging::Logger::LogLevel::WARN, logging::Logger::LogLevel::ERROR });
+	}
+
+	m_config = config;
+	std::erase_if(m_config.directories,
+				  [this](const std::filesystem::path& directory)
+				  {
+					  if (std::filesystem::is_directory(directory))
+						  return false;
+					  m_logger->log<logging::Logger::LogLevel::WARN>("Not watching {}, it is not a directory",
+																	 directory.string());
+					  return true;
+				  });
+	if (m_config.directories.empty())
+		return Result(Result::Code::INVALID_ARGUMENT, "None of the shader directories exist");
+
+	// Unique to this reloader, two running applications must not compile over each other's files
+	const auto now	  = std::chrono::steady_clock::now().time_since_epoch().count();
+	m_outputDirectory = std::filesystem::temp_directory_path()
+					  / ("zaphod-shaders-" + std::to_string(now) + "-" + std::to_string(reinterpret_cast<uintptr_t>(this)));
+	std::error_code error;
+	std::filesystem::create_directories(m_outputDirectory, error);
+	if (error)
+		return Result(Result::Code::IO_ERROR, "Failed to create " + m_outputDirectory.string());
+
+	m_library	 = &library;
+	m_isStopping = false;
+	m_thread	 = std::thread([this] { run(); });
+	return Result(Result::Code::SUCCESS);
+}
+
+void ShaderReloader::stop()
+{
+	if (!isRunning())
+		return;
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_stopCondition.notify_one();
+	m_thread.join();
+
+	m_compilations.clear();
+	m_writeTimes.clear();
+	m_dependents.clear();
+	std::error_code error;
+	std::filesystem::remove_all(m_outputDirectory, error);
+	m_library = nullptr;
+}
+
+uint32_t ShaderReloader::subscribe(const std::filesystem::path& source, ReloadCallback callback)
+{
+	const uint32_t id = m_nextSubscriptionID++;
+	m_subscriptions.push_back({ id, makeKey(source), std::move(callback) });
+	return id;
+}
+
+void ShaderReloader::unsubscribe(uint32_t id)
+{
+	std::erase_if(m_subscriptions, [id](const Subscription& subscription) { return subscription.id == id; });
+}
+
+void ShaderReloader::update()
+{
+	std::vector<Compilation> compilations;
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_compilations.empty())
+			return;
+		compilations.swap(m_compilations);
+	}
+
+	using LogLevel = logging::Logger::LogLevel;
+	for (const Compilation& compilation : compilations)
+	{
+		if (compilation.code.empty())
+		{
+			m_logger->log<LogLevel::ERROR>("Failed to compile {}, keeping the previous version:\n{}", compilation.name,
+										   compilation.output);
+			continue;
+		}
+
+		VkShaderModule module = m_library->getModule(compilation.code.data(), compilation.code.size() * sizeof(uint32_t));
+		if (module == VK_NULL_HANDLE)
+		{
+			m_logger->log<LogLevel::ERROR>("Failed to create a shader module for {}", compilation.name);
+			continue;
+		}
+
+		m_logger->log<LogLevel::INFO>("Reloaded {}", compilation.name);
+		++m_reloadCount;
+		// A callback may subscribe or unsubscribe, which would invalidate iterators
+		for (size_t i = 0; i < m_subscriptions.size(); ++i)
+		{
+			if (m_subscriptions[i].source == compilation.source)
+			{
+				ReloadCallback callback = m_subscriptions[i].callback;
+				callback(module);
+			}
+		}
+	}
+}
+
+void ShaderReloader::run()
+{
+	scan(true);
+	std::unique_lock lock(m_mutex);
+	while (!m_stopCondition.wait_for(lock, m_config.pollInterval, [this] { return m_isStopping; }))
+	{
+		lock.unlock();
+		scan(false);
+		lock.lock();
+	}
+}
+
+void ShaderReloader::scan(bool isFirstScan)
+{
+	std::unordered_set<std::string> changedStages;
+	for (const std::filesystem::path& directory : m_config.directories)
+	{
+		std::error_code error;
+		for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+			 !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			if (!it->is_regular_file(error))
+				continue;
+			const std::filesystem::file_time_type writeTime = it->last_write_time(error);
+			if (error)
+				continue;
+
+			const std::string key	  = makeKey(it->path());
+			auto [written, isNewFile] = m_writeTimes.try_emplace(key, writeTime);
+			if (isFirstScan)
+			{
+				// Includes are only known from depfiles, find them for every stage before anything changes
+				if (isStage(it->path()))
+				{
+					const std::filesystem::path depfile = m_outputDirectory / (makeOutputName(key) + ".d");
+					std::string					output;
+					if (runCompiler("-M -MF " + quote(depfile) + " " + quote(it->path()), output))
+						readDependencies(key, depfile);
+				}
+				continue;
+			}
+			if (!isNewFile && written->second == writeTime)
+				continue;
+			written->second = writeTime;
+
+			if (isStage(it->path()))
+				changedStages.insert(key);
+			if (auto dependents = m_dependents.find(key); dependents != m_dependents.end())
+				changedStages.insert(dependents->second.begin(), dependents->second.end());
+		}
+	}
+
+	if (!isFirstScan)
+	{
+		for (const std::string& source : changedStages)
+			compile(source);
+	}
+}
+
+bool ShaderReloader::runCompiler(const std::string& arguments, std::string& output) const
+{
+	const std::filesystem::path log = m_outputDirectory / "compiler.log";
+	std::string command = quote(m_config.compiler) + " --target-env=vulkan1.3 " + arguments + " > " + quote(log) + " 2>&1";
+#ifdef _WIN32
+	command = '"' + command + '"';	  // cmd /c strips the outer quotes, keep the ones around the compiler
+#endif
+	const int status = std::system(command.c_str());
+	readFile(log, output);
+	return status == 0;
+}
+
+void ShaderReloader::compile(const std::string& source)
+{
+	const std::filesystem::path sourcePath(source);
+	const std::string			name	= sourcePath.filename().string();
+	const std::string			output	= makeOutputName(source);
+	const std::filesystem::path spirv	= m_outputDirectory / (output + ".spv");
+	const std::filesystem::path depfile = m_outputDirectory / (output + ".d");
+
+	Compilation compilation;
+	compilation.source = source;
+	compilation.name   = name;
+	if (runCompiler("-MD -MF " + quote(depfile) + " " + quote(sourcePath) + " -o " + quote(spirv), compilation.output))
+	{
+		readDependencies(source, depfile);
+
+		std::string code;
+		if (readFile(spirv, code) && !code.empty() && code.size() % sizeof(uint32_t) == 0)
+		{
+			compilation.code.resize(code.size() / sizeof(uint32_t));
+			std::memcpy(compilation.code.data(), code.data(), code.size());
+		}
+		else
+		{
+			compilation.output = "Failed to read " + spirv.string();
+		}
+	}
+
+	std::lock_guard lock(m_mutex);
+	m_compilations.push_back(std::move(compilation));
+}
+
+void ShaderReloader::readDependencies(const std::string& source, const std::filesystem::path& depfile)
+{
+	std::string contents;
+	if (!readFile(depfile, contents))
+		return;
+
+	for (auto& [file, dependents] : m_dependents)
+		dependents.erase(source);
+	for (const std::string& file : parseDepfile(contents))
+	{
+		std::string key = makeKey(file);
+		if (key != source)
+			m_dependents[std::move(key)].insert(source);
+	}
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,249 @@
+#include "render/swapchain.h"
+
+#include "render/device.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace zaphod::render
+{
+namespace
+{
+VkSurfaceFormatKHR chooseSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats)
+{
+	for (const VkSurfaceFormatKHR& format : formats)
+	{
+		if ((format.format == VK_FORMAT_B8G8R8A8_SRGB || format.format == VK_FORMAT_R8G8B8A8_SRGB)
+			&& format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+			return format;
+	}
+	return formats.front();
+}
+}	 // namespace
+
+Swapchain::~Swapchain()
+{
+	destroy();
+}
+
+Result Swapchain::initialize(const Device& device, VkSurfaceKHR surface, VkExtent2D extent, PresentMode presentMode)
+{
+	if (m_swapchain != VK_NULL_HANDLE)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The swapchain already exists");
+	if (surface == VK_NULL_HANDLE)
+		return Result(Result::Code::INVALID_ARGUMENT, "The swapchain needs a surface");
+
+	m_device	  = &device;
+	m_surface	  = surface;
+	m_presentMode = presentMode;
+	Retired retired;	// Stays empty, there is no swapchain yet
+	return create(extent, retired);
+}
+
+Result Swapchain::recreate(VkExtent2D extent, Retired& retired)
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The swapchain has not been initialized");
+	return create(extent, retired);
+}
+
+void Swapchain::destroy()
+{
+	if (!m_device)
+		return;
+
+	destroyImages();
+	if (m_swapchain != VK_NULL_HANDLE)
+		vkDestroySwapchainKHR(m_device->getDevice(), m_swapchain, nullptr);
+	if (m_surface != VK_NULL_HANDLE)
+		vkDestroySurfaceKHR(m_device->getInstance(), m_surface, nullptr);
+	m_swapchain = VK_NULL_HANDLE;
+	m_surface	= VK_NULL_HANDLE;
+	m_device	= nullptr;
+}
+
+VkResult Swapchain::acquireNextImage(VkSemaphore signal, uint32_t& imageIndex)
+{
+	return vkAcquireNextImageKHR(m_device->getDevice(), m_swapchain, UINT64_MAX, signal, VK_NULL_HANDLE, &imageIndex);
+}
+
+VkResult Swapchain::present(VkQueue queue, uint32_t imageIndex)
+{
+	VkPresentInfoKHR presentInfo {};
+	presentInfo.sType			   = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores	   = &m_readySemaphores[imageIndex];
+	presentInfo.swapchainCount	   = 1;
+	presentInfo.pSwapchains		   = &m_swapchain;
+	presentInfo.pImageIndices	   = &imageIndex;
+	return vkQueuePresentKHR(queue, &presentInfo);
+}
+
+Result Swapchain::create(VkExtent2D extent, Retired& retired)
+{
+	VkPhysicalDevice physicalDevice = m_device->getPhysicalDevice();
+	VkDevice		 device			= m_device->getDevice();
+
+	VkSurfaceCapabilitiesKHR capabilities;
+	VkResult				 result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, m_surface, &capabilities);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+
+	uint32_t formatCount = 0;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, nullptr);
+	if (formatCount == 0)
+		return Result(Result::Code::UNSUPPORTED, "The surface reports no formats");
+	std::vector<VkSurfaceFormatKHR> formats(formatCount);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, formats.data());
+	VkSurfaceFormatKHR surfaceFormat = chooseSurfaceFormat(formats);
+
+	// A current extent of 0xFFFFFFFF means the surface takes its size from the swapchain
+	if (capabilities.currentExtent.width != UINT32_MAX)
+		extent = capabilities.currentExtent;
+	extent.width  = std::clamp(extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+	extent.height = std::clamp(extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+
+	// One image more than the minimum, so acquiring never waits on the presentation engine
+	uint32_t imageCount = capabilities.minImageCount + 1;
+	if (capabilities.maxImageCount > 0)
+		imageCount = std::min(imageCount, capabilities.maxImageCount);
+
+	const Device::QueueFamilies& families		 = m_device->getQueueFamilies();
+	const uint32_t				 queueFamilies[] = { families.graphics, families.present };
+
+	VkSwapchainCreateInfoKHR swapchainInfo {};
+	swapchainInfo.sType			   = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapchainInfo.surface		   = m_surface;
+	swapchainInfo.minImageCount	   = imageCount;
+	swapchainInfo.imageFormat	   = surfaceFormat.format;
+	swapchainInfo.imageColorSpace  = surfaceFormat.colorSpace;
+	swapchainInfo.imageExtent	   = extent;
+	swapchainInfo.imageArrayLayers = 1;
+	swapchainInfo.imageUsage	   = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	swapchainInfo.preTransform	   = capabilities.currentTransform;
+	swapchainInfo.compositeAlpha   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	swapchainInfo.presentMode	   = choosePresentMode();
+	swapchainInfo.clipped		   = VK_TRUE;
+	swapchainInfo.oldSwapchain	   = m_swapchain;
+	if (families.graphics != families.present)
+	{
+		swapchainInfo.imageSharingMode		= VK_SHARING_MODE_CONCURRENT;
+		swapchainInfo.queueFamilyIndexCount = 2;
+		swapchainInfo.pQueueFamilyIndices	= queueFamilies;
+	}
+	else
+	{
+		swapchainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
+
+	// Frames in flight may still render to and present the old images, the caller destroys them later
+	retired.swapchain		= m_swapchain;
+	retired.imageViews		= std::move(m_imageViews);
+	retired.readySemaphores = std::move(m_readySemaphores);
+	m_swapchain				= VK_NULL_HANDLE;
+	m_images.clear();
+	m_imageViews.clear();
+	m_readySemaphores.clear();
+
+	result = vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &m_swapchain);
+	if (result != VK_SUCCESS)
+		return makeResult(result, "vkCreateSwapchainKHR");
+	m_format	 = surfaceFormat.format;
+	m_colorSpace = surfaceFormat.colorSpace;
+	m_extent	 = extent;
+
+	vkGetSwapchainImagesKHR(device, m_swapchain, &imageCount, nullptr);
+	m_images.resize(imageCount);
+	vkGetSwapchainImagesKHR(device, m_swapchain, &imageCount, m_images.data());
+
+	m_imageViews.resize(imageCount, VK_NULL_HANDLE);
+	m_readySemaphores.resize(imageCount, VK_NULL_HANDLE);
+	for (uint32_t i = 0; i < imageCount; ++i)
+	{
+		VkImageViewCreateInfo viewInfo {};
+		viewInfo.sType							 = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image							 = m_images[i];
+		viewInfo.viewType						 = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format							 = m_format;
+		viewInfo.subresourceRange.aspectMask	 = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel	 = 0;
+		viewInfo.subresourceRange.levelCount	 = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount	 = 1;
+
+		result = vkCreateImageView(device, &viewInfo, nullptr, &m_imageViews[i]);
+		if (result != VK_SUCCESS)
+			return makeResult(result, "vkCreateImageView");
+
+		VkSemaphoreCreateInfo semaphoreInfo {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		result				= vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_readySemaphores[i]);
+		if (result != VK_SUCCESS)
+			return makeResult(result, "vkCreateSemaphore");
+	}
+	return Result(Result::Code::SUCCESS);
+}
+
+void Swapchain::Retired::destroy(VkDevice device) const
+{
+	for (VkImageView view : imageViews)
+	{
+		if (view != VK_NULL_HANDLE)
+			vkDestroyImageView(device, view, nullptr);
+	}
+	for (VkSemaphore semaphore : readySemaphores)
+	{
+		if (semaphore != VK_NULL_HANDLE)
+			vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	if (swapchain != VK_NULL_HANDLE)
+		vkDestroySwapchainKHR(device, swapchain, nullptr);
+}
+
+void Swapchain::destroyImages()
+{
+	VkDevice device = m_device->getDevice();
+	for (VkImageView view : m_imageViews)
+	{
+		if (view != VK_NULL_HANDLE)
+			vkDestroyImageView(device, view, nullptr);
+	}
+	for (VkSemaphore semaphore : m_readySemaphores)
+	{
+		if (semaphore != VK_NULL_HANDLE)
+			vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	m_imageViews.clear();
+	m_readySemaphores.clear();
+	m_images.clear();
+}
+
+VkPresentModeKHR Swapchain::choosePresentMode() const
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(m_device->getPhysicalDevice(), m_surface, &count, nullptr);
+	std::vector<VkPresentModeKHR> modes(count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(m_device->getPhysicalDevice(), m_surface, &count, modes.data());
+	auto isSupported = [&modes](VkPresentModeKHR mode) { return std::find(modes.begin(), modes.end(), mode) != modes.end(); };
+
+	VkPresentModeKHR preferences[2] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR };
+	switch (m_presentMode)
+	{
+	case PresentMode::VSYNC: break;
+	case PresentMode::MAILBOX:
+		preferences[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+		preferences[1] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		break;
+	case PresentMode::IMMEDIATE:
+		preferences[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		preferences[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	}
+	for (VkPresentModeKHR mode : preferences)
+	{
+		if (isSupported(mode))
+			return mode;
+	}
+	return VK_PRESENT_MODE_FIFO_KHR;	// Required to be supported everywhere
+}
+}	 // namespace zaphod::render
@@ -0,0 +1,416 @@
+#include "render/upload_queue.h"
+
+#include "render/device.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zaphod::render
+{
+namespace
+{
+VkImageSubresourceRange getSubresourceRange(const VkImageSubresourceLayers& layers)
+{
+	VkImageSubresourceRange range {};
+	range.aspectMask	 = layers.aspectMask;
+	range.baseMipLevel	 = layers.mipLevel;
+	range.levelCount	 = 1;
+	range.baseArrayLayer = layers.baseArrayLayer;
+	range.layerCount	 = layers.layerCount;
+	return range;
+}
+}	 // namespace
+
+UploadQueue::~UploadQueue()
+{
+	destroy();
+}
+
+Result UploadQueue::initialize(const Device& device, MemoryAllocator& allocator, const Config& config)
+{
+	if (m_device)
+		return Result(Result::Code::ALREADY_INITIALIZED, "The upload queue already exists");
+
+	Result result = m_staging.initialize(allocator, config.stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::UPLOAD);
+	if (result.isFailure())
+		return result;
+
+	VkSemaphoreTypeCreateInfo timelineInfo {};
+	timelineInfo.sType		   = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue  = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &timelineInfo;
+	VkResult vkResult	= vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &m_timeline);
+	if (vkResult != VK_SUCCESS)
+	{
+		m_staging.destroy();
+		return makeResult(vkResult, "vkCreateSemaphore");
+	}
+
+	// Image copies need offsets aligned to the texel block size, 16 covers every format
+	m_stagingAlignment = std::max<VkDeviceSize>(16, device.getProperties().limits.optimalBufferCopyOffsetAlignment);
+	m_transferFamily   = device.getQueueFamilies().transfer;
+	m_graphicsFamily   = device.getQueueFamilies().graphics;
+	m_nextValue		   = 1;
+	m_device		   = &device;
+	return Result(Result::Code::SUCCESS);
+}
+
+void UploadQueue::destroy()
+{
+	if (!m_device)
+		return;
+
+	VkDevice	   device		  = m_device->getDevice();
+	const uint64_t submittedValue = getSubmittedValue();
+
+	VkSemaphoreWaitInfo waitInfo {};
+	waitInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores	= &m_timeline;
+	waitInfo.pValues		= &submittedValue;
+	vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+
+	// Destroying a pool frees its command buffer
+	for (const Batch& batch : m_submittedBatches)
+		vkDestroyCommandPool(device, batch.pool, nullptr);
+	for (const Batch& batch : m_freeBatches)
+		vkDestroyCommandPool(device, batch.pool, nullptr);
+	m_submittedBatches.clear();
+	m_freeBatches.clear();
+	m_acquires.clear();
+	m_bufferCopies.clear();
+	m_imageCopies.clear();
+	m_writingUploads.clear();
+
+	vkDestroySemaphore(device, m_timeline, nullptr);
+	m_timeline = VK_NULL_HANDLE;
+	m_staging.destroy();
+	m_device = nullptr;
+}
+
+Result UploadQueue::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size, Ticket& ticket)
+{
+	auto copy = [data, size](void* staging)
+	{
+		std::memcpy(staging, data, size);
+		return true;
+	};
+	return uploadBuffer(buffer, offset, size, copy, ticket);
+}
+
+Result UploadQueue::uploadImage(VkImage image, const VkBufferImageCopy& region, VkImageLayout finalLayout, const void* data,
+								VkDeviceSize size, Ticket& ticket)
+{
+	auto copy = [data, size](void* staging)
+	{
+		std::memcpy(staging, data, size);
+		return true;
+	};
+
+	VkBufferImageCopy dataRegion = region;
+	dataRegion.bufferOffset		 = 0;
+	return uploadImage(image, std::span(&dataRegion, 1), finalLayout, size, copy, ticket);
+}
+
+Result UploadQueue::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const Writer& writer, Ticket& ticket)
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The upload queue does not exist");
+
+	RingBuffer::Allocation staging;
+	Result				   result = reserve(size, staging);
+	if (result.isFailure())
+		return result;
+
+	// Written without holding a lock, flush leaves the range to a later batch until the copy is queued
+	const bool		isWritten = writer(staging.data);
+	std::lock_guard lock(m_copyMutex);
+	endWrite(staging);
+	if (!isWritten)
+		return Result(Result::Code::FAILURE, "Writing the data of the upload failed");
+	m_bufferCopies.push_back({ buffer, { staging.offset, offset, size } });
+	ticket = m_nextValue;
+	return result;
+}
+
+Result UploadQueue::uploadImage(VkImage image, std::span<const VkBufferImageCopy> regions, VkImageLayout finalLayout,
+								VkDeviceSize size, const Writer& writer, Ticket& ticket)
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The upload queue does not exist");
+
+	RingBuffer::Allocation staging;
+	Result				   result = reserve(size, staging);
+	if (result.isFailure())
+		return result;
+
+	const bool		isWritten = writer(staging.data);
+	std::lock_guard lock(m_copyMutex);
+	endWrite(staging);
+	if (!isWritten)
+		return Result(Result::Code::FAILURE, "Writing the data of the upload failed");
+	for (const VkBufferImageCopy& region : regions)
+	{
+		ImageCopy copy { image, region, finalLayout };
+		copy.region.bufferOffset += staging.offset;
+		m_imageCopies.push_back(copy);
+	}
+	ticket = m_nextValue;
+	return result;
+}
+
+Result UploadQueue::flush()
+{
+	if (!m_device)
+		return Result(Result::Code::NOT_INITIALIZED, "The upload queue does not exist");
+
+	// Uploads only take the lock to reserve staging memory and to queue their copies, so this never waits for a writer
+	std::lock_guard lock(m_copyMutex);
+	const uint64_t	completed = getCompletedValue();
+	m_staging.retire(completed);
+	while (!m_submittedBatches.empty() && m_submittedBatches.front().value <= completed)
+	{
+		m_freeBatches.push_back(m_submittedBatches.front());
+		m_submittedBatches.pop_front();
+	}
+	if (m_bufferCopies.empty() && m_imageCopies.empty())
+		return Result(Result::Code::SUCCESS);
+
+	Batch  batch;
+	Result result = beginBatch(batch);
+	if (result.isFailure())
+		return result;
+
+	const bool isTransferred = m_transferFamily != m_graphicsFamily;
+	Acquire	   acquire { m_nextValue, {}, {} };
+
+	// Images start out undefined, the copy overwrites them anyway
+	std::vector<VkImageMemoryBarrier2> imageBarriers(m_imageCopies.size());
+	for (size_t i = 0; i < m_imageCopies.size(); ++i)
+	{
+		VkImageMemoryBarrier2& barrier = imageBarriers[i];
+		barrier.sType				   = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask		   = VK_PIPELINE_STAGE_2_NONE;
+		barrier.srcAccessMask		   = VK_ACCESS_2_NONE;
+		barrier.dstStageMask		   = VK_PIPELINE_STAGE_2_COPY_BIT;
+		barrier.dstAccessMask		   = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		barrier.oldLayout			   = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout			   = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcQueueFamilyIndex	   = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex	   = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image				   = m_imageCopies[i].image;
+		barrier.subresourceRange	   = getSubresourceRange(m_imageCopies[i].region.imageSubresource);
+	}
+	VkDependencyInfo dependency {};
+	dependency.sType				   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+	dependency.pImageMemoryBarriers	   = imageBarriers.data();
+	if (!imageBarriers.empty())
+		vkCmdPipelineBarrier2(batch.commandBuffer, &dependency);
+
+	VkBuffer stagingBuffer = m_staging.getBuffer();
+	for (const BufferCopy& copy : m_bufferCopies)
+		vkCmdCopyBuffer(batch.commandBuffer, stagingBuffer, copy.buffer, 1, &copy.region);
+	for (const ImageCopy& copy : m_imageCopies)
+	{
+		vkCmdCopyBufferToImage(batch.commandBuffer, stagingBuffer, copy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+							   &copy.region);
+	}
+
+	// Move images to their final layout, and with separate families release everything to the graphics family.
+	// The semaphore the graphics queue waits on makes the copies visible, so there is nothing to wait for here.
+	for (size_t i = 0; i < m_imageCopies.size(); ++i)
+	{
+		VkImageMemoryBarrier2& barrier = imageBarriers[i];
+		barrier.srcStageMask		   = VK_PIPELINE_STAGE_2_COPY_BIT;
+		barrier.srcAccessMask		   = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		barrier.dstStageMask		   = VK_PIPELINE_STAGE_2_NONE;
+		barrier.dstAccessMask		   = VK_ACCESS_2_NONE;
+		barrier.oldLayout			   = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout			   = m_imageCopies[i].finalLayout;
+		if (isTransferred)
+		{
+			barrier.srcQueueFamilyIndex = m_transferFamily;
+			barrier.dstQueueFamilyIndex = m_graphicsFamily;
+		}
+	}
+	std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+	if (isTransferred)
+	{
+		bufferBarriers.resize(m_bufferCopies.size());
+		for (size_t i = 0; i < m_bufferCopies.size(); ++i)
+		{
+			VkBufferMemoryBarrier2& barrier = bufferBarriers[i];
+			barrier.sType					= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+			barrier.srcStageMask			= VK_PIPELINE_STAGE_2_COPY_BIT;
+			barrier.srcAccessMask			= VK_ACCESS_2_TRANSFER_WRITE_BIT;
+			barrier.dstStageMask			= VK_PIPELINE_STAGE_2_NONE;
+			barrier.dstAccessMask			= VK_ACCESS_2_NONE;
+			barrier.srcQueueFamilyIndex		= m_transferFamily;
+			barrier.dstQueueFamilyIndex		= m_graphicsFamily;
+			barrier.buffer					= m_bufferCopies[i].buffer;
+			barrier.offset					= m_bufferCopies[i].region.dstOffset;
+			barrier.size					= m_bufferCopies[i].region.size;
+		}
+	}
+	dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+	dependency.pBufferMemoryBarriers	= bufferBarriers.data();
+	if (!imageBarriers.empty() || !bufferBarriers.empty())
+		vkCmdPipelineBarrier2(batch.commandBuffer, &dependency);
+	vkEndCommandBuffer(batch.commandBuffer);
+
+	VkSemaphoreSubmitInfo signalSemaphore {};
+	signalSemaphore.sType	  = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	signalSemaphore.semaphore = m_timeline;
+	signalSemaphore.value	  = m_nextValue;
+	signalSemaphore.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkCommandBufferSubmitInfo commandBufferInfo {};
+	commandBufferInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	commandBufferInfo.commandBuffer = batch.commandBuffer;
+
+	VkSubmitInfo2 submitInfo {};
+	submitInfo.sType					= VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submitInfo.commandBufferInfoCount	= 1;
+	submitInfo.pCommandBufferInfos		= &commandBufferInfo;
+	submitInfo.signalSemaphoreInfoCount = 1;
+	submitInfo.pSignalSemaphoreInfos	= &signalSemaphore;
+	VkResult vkResult = vkQueueSubmit2(m_device->getTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+	if (vkResult != VK_SUCCESS)
+	{
+		// Nothing was submitted, the copies stay queued for the next flush
+		m_freeBatches.push_back(batch);
+		return makeResult(vkResult, "vkQueueSubmit2");
+	}
+
+	// The graphics family acquires with the same barriers, waiting for the uses after them instead
+	if (isTransferred)
+	{
+		for (VkImageMemoryBarrier2& barrier : imageBarriers)
+		{
+			barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			barrier.srcAccessMask = VK_ACCESS_2_NONE;
+			barrier.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+		}
+		for (VkBufferMemoryBarrier2& barrier : bufferBarriers)
+		{
+			barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			barrier.srcAccessMask = VK_ACCESS_2_NONE;
+			barrier.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+		}
+		acquire.imageBarriers  = std::move(imageBarriers);
+		acquire.bufferBarriers = std::move(bufferBarriers);
+		m_acquires.push_back(std::move(acquire));
+	}
+
+	batch.value = m_nextValue;
+	m_submittedBatches.push_back(batch);
+	// The ranges of uploads still being written go to the batch that ends up copying them
+	if (m_writingUploads.empty())
+		m_staging.close(m_nextValue);
+	else
+		m_staging.close(m_nextValue, *std::min_element(m_writingUploads.begin(), m_writingUploads.end()));
+	m_bufferCopies.clear();
+	m_imageCopies.clear();
+	++m_nextValue;
+	return Result(Result::Code::SUCCESS);
+}
+
+bool UploadQueue::recordAcquireBarriers(VkCommandBuffer commandBuffer, Ticket ticket)
+{
+	if (!hasPendingAcquires(ticket))
+		return false;
+
+	std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+	std::vector<VkImageMemoryBarrier2>	imageBarriers;
+	while (hasPendingAcquires(ticket))
+	{
+		const Acquire& acquire = m_acquires.front();
+		bufferBarriers.insert(bufferBarriers.end(), acquire.bufferBarriers.begin(), acquire.bufferBarriers.end());
+		imageBarriers.insert(imageBarriers.end(), acquire.imageBarriers.begin(), acquire.imageBarriers.end());
+		m_acquires.pop_front();
+	}
+
+	VkDependencyInfo dependency {};
+	dependency.sType					= VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+	dependency.pBufferMemoryBarriers	= bufferBarriers.data();
+	dependency.imageMemoryBarrierCount	= static_cast<uint32_t>(imageBarriers.size());
+	dependency.pImageMemoryBarriers		= imageBarriers.data();
+	vkCmdPipelineBarrier2(commandBuffer, &dependency);
+	return true;
+}
+
+UploadQueue::Ticket UploadQueue::getCompletedValue() const
+{
+	if (!m_device)
+		return 0;
+	uint64_t value = 0;
+	vkGetSemaphoreCounterValue(m_device->getDevice(), m_timeline, &value);
+	return value;
+}
+
+Result UploadQueue::reserve(VkDeviceSize size, RingBuffer::Allocation& staging)
+{
+	if (size == 0 || size > m_staging.getSize())
+		return Result(Result::Code::INVALID_ARGUMENT, "The upload is empty or larger than the staging ring");
+
+	// Under the lock flush closes the ring with, so the range is either left open or known to be written
+	std::lock_guard lock(m_copyMutex);
+	staging = m_staging.allocate(size, m_stagingAlignment);
+	if (!staging.isValid())
+		return Result(Result::Code::OUT_OF_MEMORY, "The staging ring is full");
+	m_writingUploads.push_back(staging.position);
+	return Result(Result::Code::SUCCESS);
+}
+
+void UploadQueue::endWrite(const RingBuffer::Allocation& staging)
+{
+	m_writingUploads.erase(std::find(m_writingUploads.begin(), m_writingUploads.end(), staging.position));
+}
+
+Result UploadQueue::beginBatch(Batch& batch)
+{
+	VkDevice device = m_device->getDevice();
+	if (!m_freeBatches.empty())
+	{
+		batch = m_freeBatches.back();
+		m_freeBatches.pop_back();
+		vkResetCommandPool(device, batch.pool, 0);
+	}
+	else
+	{
+		VkCommandPoolCreateInfo poolInfo {};
+		poolInfo.sType			  = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags			  = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = m_transferFamily;
+		VkResult result			  = vkCreateCommandPool(device, &poolInfo, nullptr, &batch.pool);
+		if (result != VK_SUCCESS)
+			return makeResult(result, "vkCreateCommandPool");
+
+		VkCommandBufferAllocateInfo allocateInfo {};
+		allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool		= batch.pool;
+		allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+		result = vkAllocateCommandBuffers(device, &allocateInfo, &batch.commandBuffer);
+		if (result != VK_SUCCESS)
+		{
+			vkDestroyCommandPool(device, batch.pool, nullptr);
+			return makeResult(result, "vkAllocateCommandBuffers");
+		}
+	}
+
+	VkCommandBufferBeginInfo beginInfo {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+	return Result(Result::Code::SUCCESS);
+}
+}	 // namespace zaphod::render
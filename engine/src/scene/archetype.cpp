@@ -0,0 +1,113 @@
+#include "scene/archetype.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace zaphod::scene
+{
+namespace
+{
+constexpr size_t alignUp(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+}	 // namespace
+
+Archetype::Archetype(const ComponentMask& mask, FixedPool& chunkPool): m_mask(mask), m_chunkPool(chunkPool)
+{
+	m_columnOf.fill(noColumn);
+	mask.forEachFlag(
+		[this](ComponentId component)
+		{
+			m_columnOf[static_cast<uint32_t>(component)] = static_cast<uint16_t>(m_columns.size());
+			m_columns.push_back({ component, ComponentRegistry::getInfo(component).size, 0 });
+		});
+
+	// Fit as many entities as the chunk holds once every column is aligned
+	size_t rowSize = sizeof(Entity);
+	for (const Column& column : m_columns)
+		rowSize += column.size;
+	m_chunkCapacity = static_cast<uint32_t>(std::max<size_t>(chunkSize / rowSize, 1));
+	while (m_chunkCapacity > 1 && layOut(m_chunkCapacity) > chunkSize)
+		--m_chunkCapacity;
+	m_chunkBytes = std::max(chunkSize, layOut(m_chunkCapacity));
+}
+
+Archetype::~Archetype()
+{
+	for (Chunk& chunk : m_chunks)
+		freeChunk(chunk);
+}
+
+Archetype::Location Archetype::allocate(Entity entity)
+{
+	if (m_chunks.empty() || m_chunks.back().count == m_chunkCapacity)
+		addChunk();
+
+	Chunk&		   chunk = m_chunks.back();
+	const Location location { static_cast<uint32_t>(m_chunks.size() - 1), chunk.count++ };
+	getEntities(location.chunk)[location.row] = entity;
+	++m_entityCount;
+	return location;
+}
+
+Entity Archetype::remove(const Location& location)
+{
+	const Location last { static_cast<uint32_t>(m_chunks.size() - 1), m_chunks.back().count - 1 };
+	Entity		   moved;
+	if (location.chunk != last.chunk || location.row != last.row)
+	{
+		moved									  = getEntities(last.chunk)[last.row];
+		getEntities(location.chunk)[location.row] = moved;
+		for (uint16_t column = 0; column < getColumnCount(); ++column)
+			std::memcpy(getComponent(location, column), getComponent(last, column), m_columns[column].size);
+	}
+
+	--m_entityCount;
+	if (--m_chunks.back().count == 0)
+	{
+		freeChunk(m_chunks.back());
+		m_chunks.pop_back();
+	}
+	return moved;
+}
+
+Archetype::Edge& Archetype::getEdge(ComponentId component)
+{
+	for (Edge& edge : m_edges)
+	{
+		if (edge.component == component)
+			return edge;
+	}
+	return m_edges.emplace_back(Edge { component });
+}
+
+size_t Archetype::layOut(uint32_t capacity)
+{
+	size_t offset = sizeof(Entity) * capacity;
+	for (Column& column : m_columns)
+	{
+		const uint32_t alignment = ComponentRegistry::getInfo(column.component).alignment;
+		offset					 = alignUp(offset, std::max<size_t>(columnAlignment, alignment));
+		column.offset			 = static_cast<uint32_t>(offset);
+		offset += size_t(column.size) * capacity;
+	}
+	return offset;
+}
+
+void Archetype::addChunk()
+{
+	void* data = m_chunkBytes == chunkSize ? m_chunkPool.allocate()
+										   : ::operator new(m_chunkBytes, std::align_val_t(columnAlignment));
+	m_chunks.push_back({ static_cast<std::byte*>(data), 0 });
+}
+
+void Archetype::freeChunk(Chunk& chunk)
+{
+	if (m_chunkBytes == chunkSize)
+		m_chunkPool.free(chunk.data);
+	else
+		::operator delete(chunk.data, std::align_val_t(columnAlignment));
+}
+}	 // namespace zaphod::scene
@@ -0,0 +1,34 @@
+#include "scene/component.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace zaphod::scene
+{
+namespace
+{
+std::array<ComponentInfo, maxComponentTypes> s_components;
+std::atomic<uint32_t>						 s_componentCount { 0 };
+}	 // namespace
+
+ComponentId ComponentRegistry::registerComponent(const ComponentInfo& info)
+{
+	// Readers get the id through getComponentId's static, whose initialization orders this write before them
+	const uint32_t index = s_componentCount.fetch_add(1, std::memory_order_relaxed);
+	if (index >= maxComponentTypes)
+		return invalidComponent;
+	s_components[index] = info;
+	return ComponentId(index);
+}
+
+const ComponentInfo& ComponentRegistry::getInfo(ComponentId id)
+{
+	return s_components[static_cast<uint32_t>(id)];
+}
+
+uint32_t ComponentRegistry::getCount()
+{
+	return std::min(s_componentCount.load(std::memory_order_relaxed), maxComponentTypes);
+}
+}	 // namespace zaphod::scene
@@ -0,0 +1,235 @@
+#include "scene/world.h"
+
+#include <cstring>
+
+namespace zaphod::scene
+{
+const std::vector<Archetype*>& Query::getArchetypes()
+{
+	const auto& archetypes = m_world.getArchetypes();
+	for (; m_checkedArchetypes < archetypes.size(); ++m_checkedArchetypes)
+	{
+		Archetype&			 archetype = *archetypes[m_checkedArchetypes];
+		const ComponentMask& mask	   = archetype.getMask();
+		if (mask.checkAllFlags(m_required) && !mask.checkFlags(m_excluded))
+			m_archetypes.push_back(&archetype);
+	}
+	return m_archetypes;
+}
+
+size_t Query::getEntityCount()
+{
+	size_t count = 0;
+	for (const Archetype* archetype : getArchetypes())
+		count += archetype->getEntityCount();
+	return count;
+}
+
+void Query::gatherChunks()
+{
+	m_chunks.clear();
+	for (const Archetype* archetype : getArchetypes())
+	{
+		for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk)
+			m_chunks.push_back({ archetype, chunk });
+	}
+}
+
+World::World(): m_chunkPool(Archetype::chunkSize, Archetype::columnAlignment, 16)
+{
+	getArchetype({});	 // The archetype of entities without components
+}
+
+World::~World()
+{
+	m_archetypesByMask.clear();
+	m_archetypes.clear();	 // Before the pool their chunks came from
+}
+
+void World::destroy(Entity entity)
+{
+	if (!isAlive(entity))
+		return;
+
+	Record&	   record = m_records[entity.index];
+	const auto moved  = record.archetype->remove(record.location);
+	if (moved.isValid())
+		m_records[moved.index].location = record.location;
+
+	record.archetype = nullptr;
+	++record.generation;
+	m_freeIndices.push_back(entity.index);
+	--m_entityCount;
+}
+
+void World::apply(CommandBuffer& commands)
+{
+	using Type = CommandBuffer::Type;
+
+	const std::byte* data = commands.m_data.data();
+	const std::byte* end  = data + commands.m_data.size();
+	while (data < end)
+	{
+		CommandBuffer::Header header;
+		std::memcpy(&header, data, sizeof(header));
+		data += sizeof(header);
+
+		switch (header.type)
+		{
+		case Type::CREATE:
+			m_createScratch.clear();
+			for (uint32_t i = 0; i < header.count; ++i)
+			{
+				CommandBuffer::ComponentHeader component;
+				std::memcpy(&component, data, sizeof(component));
+				data += sizeof(component);
+				m_createScratch.push_back({ component.component, data });
+				data += component.size;
+			}
+			createRaw(m_createScratch.data(), m_createScratch.size());
+			break;
+		case Type::DESTROY: destroy(header.entity); break;
+		case Type::ADD:
+			addRaw(header.entity, header.component, data);
+			data += header.count;
+			break;
+		case Type::REMOVE: removeRaw(header.entity, header.component); break;
+		}
+	}
+	commands.clear();
+}
+
+Entity World::createRaw(const ComponentData* components, size_t count)
+{
+	ComponentMask mask;
+	for (size_t i = 0; i < count; ++i)
+		mask.setFlag(components[i].component);
+
+	Entity entity;
+	if (!m_freeIndices.empty())
+	{
+		entity.index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+	}
+	else
+	{
+		entity.index = static_cast<uint32_t>(m_records.size());
+		m_records.emplace_back();
+	}
+	entity.generation = m_records[entity.index].generation;
+
+	Archetype& archetype = *getArchetype(mask);
+	place(entity, archetype);
+	const Archetype::Location& location = m_records[entity.index].location;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint16_t column = archetype.getColumn(components[i].component);
+		if (column != Archetype::noColumn)
+			std::memcpy(archetype.getComponent(location, column), components[i].data, archetype.getColumnSize(column));
+	}
+	++m_entityCount;
+	return entity;
+}
+
+void* World::addRaw(Entity entity, ComponentId component, const void* data)
+{
+	if (!isAlive(entity) || static_cast<uint32_t>(component) >= maxComponentTypes)
+		return nullptr;
+
+	Record& record = m_records[entity.index];
+	if (record.archetype->getColumn(component) == Archetype::noColumn)
+		moveEntity(entity, *getAddTarget(*record.archetype, component));
+
+	Archetype&	   archetype = *record.archetype;
+	const uint16_t column	 = archetype.getColumn(component);
+	void*		   target	 = archetype.getComponent(record.location, column);
+	std::memcpy(target, data, archetype.getColumnSize(column));
+	return target;
+}
+
+void World::removeRaw(Entity entity, ComponentId component)
+{
+	if (!isAlive(entity))
+		return;
+
+	Record& record = m_records[entity.index];
+	if (record.archetype->getColumn(component) != Archetype::noColumn)
+		moveEntity(entity, *getRemoveTarget(*record.archetype, component));
+}
+
+void* World::getRaw(Entity entity, ComponentId component) const
+{
+	if (!isAlive(entity))
+		return nullptr;
+
+	const Record&  record = m_records[entity.index];
+	const uint16_t column = record.archetype->getColumn(component);
+	return column == Archetype::noColumn ? nullptr : record.archetype->getComponent(record.location, column);
+}
+
+Archetype* World::getArchetype(const ComponentMask& mask)
+{
+	auto found = m_archetypesByMask.find(mask);
+	if (found != m_archetypesByMask.end())
+		return found->second;
+
+	Archetype* archetype = m_archetypes.emplace_back(std::make_unique<Archetype>(mask, m_chunkPool)).get();
+	m_archetypesByMask.emplace(mask, archetype);
+	return archetype;
+}
+
+Archetype* World::getAddTarget(Archetype& archetype, ComponentId component)
+{
+	Archetype::Edge& edge = archetype.getEdge(component);
+	if (!edge.add)
+	{
+		ComponentMask mask = archetype.getMask();
+		mask.setFlag(component);
+		edge.add							= getArchetype(mask);
+		edge.add->getEdge(component).remove = &archetype;
+	}
+	return edge.add;
+}
+
+Archetype* World::getRemoveTarget(Archetype& archetype, ComponentId component)
+{
+	Archetype::Edge& edge = archetype.getEdge(component);
+	if (!edge.remove)
+	{
+		ComponentMask mask = archetype.getMask();
+		mask.unsetFlag(component);
+		edge.remove							= getArchetype(mask);
+		edge.remove->getEdge(component).add = &archetype;
+	}
+	return edge.remove;
+}
+
+void World::moveEntity(Entity entity, Archetype& target)
+{
+	Record&					  record = m_records[entity.index];
+	Archetype&				  source = *record.archetype;
+	const Archetype::Location from	 = record.location;
+	const Archetype::Location to	 = target.allocate(entity);
+
+	// Copy the components both archetypes have, a component being added is written by the caller
+	for (uint16_t column = 0; column < source.getColumnCount(); ++column)
+	{
+		const uint16_t targetColumn = target.getColumn(source.getColumnComponent(column));
+		if (targetColumn != Archetype::noColumn)
+			std::memcpy(target.getComponent(to, targetColumn), source.getComponent(from, column), source.getColumnSize(column));
+	}
+
+	const Entity moved = source.remove(from);
+	if (moved.isValid())
+		m_records[moved.index].location = from;
+	record.archetype = &target;
+	record.location	 = to;
+}
+
+void World::place(Entity entity, Archetype& archetype)
+{
+	Record& record	 = m_records[entity.index];
+	record.archetype = &archetype;
+	record.location	 = archetype.allocate(entity);
+}
+}	 // namespace zaphod::scene
@@ -0,0 +1,29 @@
+// The bindings of BindlessTable and the GPU side of the structures GpuCulling shares with C++.
+// Storage buffers all alias binding 1, every shader declares the layouts it reads them with.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+
+// GpuCulling::Object, one per drawn mesh instance
+struct ObjectData {
+    mat4 transform;
+    vec4 bounding_sphere;   // Center in object space, radius
+    uint index_count;
+    uint first_index;
+    int vertex_offset;
+    uint material_index;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand {
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;    // The object index, the vertex shader reads it as gl_InstanceIndex
+};
+
+layout (set = 0, binding = 1, std430) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+} object_buffers[];
@@ -0,0 +1,28 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "bindless.glsl"
+
+// simple_shader.vert for GPU driven drawing: drawn with vkCmdDrawIndexedIndirectCount from the
+// commands cull.comp writes, so gl_InstanceIndex is the object and vertices are pulled from a
+// bindless buffer instead of vertex input attributes
+layout (push_constant) uniform DrawConstants {
+    mat4 view_projection;
+    uint object_buffer;     // Bindless indices
+    uint vertex_buffer;
+} constants;
+
+layout (set = 0, binding = 1, std430) readonly buffer VertexBuffer {
+    vec4 positions[];
+} vertex_buffers[];
+
+// Output to fragment shader
+layout (location = 0) flat out uint out_material_index;
+
+void main() {
+    ObjectData object = object_buffers[constants.object_buffer].objects[gl_InstanceIndex];
+    // gl_VertexIndex already includes the draw's vertex offset
+    vec4 position = vertex_buffers[constants.vertex_buffer].positions[gl_VertexIndex];
+    gl_Position = constants.view_projection * object.transform * position;
+    out_material_index = object.material_index;
+}
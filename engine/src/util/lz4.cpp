@@ -0,0 +1,170 @@
+#include "util/lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace zaphod
+{
+namespace
+{
+constexpr size_t minMatch	  = 4;
+constexpr size_t lastLiterals = 5;	   // A block always ends in at least this many literals
+constexpr size_t matchLimit	  = 12;	   // And no match starts closer than this to its end
+constexpr size_t maxOffset	  = 65535;
+constexpr int	 hashBits	  = 12;
+
+uint32_t read32(const unsigned char* bytes)
+{
+	uint32_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+uint32_t hashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - hashBits);
+}
+
+// Lengths that do not fit the 4 bits of the token continue in bytes, 255 meaning another follows
+unsigned char* writeLength(unsigned char* out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = static_cast<unsigned char>(length);
+	return out;
+}
+
+bool readLength(const unsigned char*& in, const unsigned char* end, size_t& length)
+{
+	unsigned char byte;
+	do
+	{
+		if (in == end)
+			return false;
+		byte = *in++;
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+}	 // namespace
+
+size_t lz4Compress(const void* source, size_t size, void* destination, size_t capacity)
+{
+	if (size == 0)
+		return 0;
+
+	const auto*			 in		= static_cast<const unsigned char*>(source);
+	auto* const			 begin	= static_cast<unsigned char*>(destination);
+	unsigned char*		 out	= begin;
+	unsigned char* const outEnd = begin + capacity;
+
+	// A sequence is literals followed by a match, the last one has no match
+	auto emit = [&](const unsigned char* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		const size_t worstCase = 1 + literalCount / 255 + 1 + literalCount + 2 + matchLength / 255 + 1;
+		if (worstCase > static_cast<size_t>(outEnd - out))
+			return false;
+
+		unsigned char* token = out++;
+		*token				 = static_cast<unsigned char>(std::min<size_t>(literalCount, 15) << 4);
+		if (literalCount >= 15)
+			out = writeLength(out, literalCount - 15);
+		std::memcpy(out, literals, literalCount);
+		out += literalCount;
+		if (matchLength == 0)
+			return true;
+
+		*out++					 = static_cast<unsigned char>(offset);
+		*out++					 = static_cast<unsigned char>(offset >> 8);
+		const size_t extraLength = matchLength - minMatch;
+		*token |= static_cast<unsigned char>(std::min<size_t>(extraLength, 15));
+		if (extraLength >= 15)
+			out = writeLength(out, extraLength - 15);
+		return true;
+	};
+
+	// The last position each hashed sequence was seen at, plus one so zero means never
+	size_t table[size_t(1) << hashBits] = {};
+	size_t anchor						= 0;
+	if (size > matchLimit)
+	{
+		const size_t matchEnd = size - lastLiterals;
+		for (size_t i = 0; i + matchLimit <= size;)
+		{
+			const uint32_t sequence	 = read32(in + i);
+			size_t&		   slot		 = table[hashSequence(sequence)];
+			const size_t   candidate = slot;
+			slot					 = i + 1;
+			if (candidate == 0 || i - (candidate - 1) > maxOffset || read32(in + candidate - 1) != sequence)
+			{
+				// Step further the longer nothing matched, so incompressible data goes quickly
+				i += 1 + ((i - anchor) >> 6);
+				continue;
+			}
+
+			const size_t match	= candidate - 1;
+			size_t		 length = minMatch;
+			while (i + length < matchEnd && in[match + length] == in[i + length])
+				++length;
+			if (!emit(in + anchor, i - anchor, i - match, length))
+				return 0;
+			i += length;
+			anchor = i;
+		}
+	}
+	if (!emit(in + anchor, size - anchor, 0, 0))
+		return 0;
+	return static_cast<size_t>(out - begin);
+}
+
+bool lz4Decompress(const void* source, size_t size, void* destination, size_t decompressedSize)
+{
+	const auto*				   in	  = static_cast<const unsigned char*>(source);
+	const unsigned char* const inEnd  = in + size;
+	auto* const				   begin  = static_cast<unsigned char*>(destination);
+	unsigned char*			   out	  = begin;
+	unsigned char* const	   outEnd = begin + decompressedSize;
+	while (in < inEnd)
+	{
+		const unsigned char token		 = *in++;
+		size_t				literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(in, inEnd, literalCount))
+			return false;
+		if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > static_cast<size_t>(outEnd - out))
+			return false;
+		std::memcpy(out, in, literalCount);
+		in += literalCount;
+		out += literalCount;
+		if (in == inEnd)
+			break;
+
+		if (inEnd - in < 2)
+			return false;
+		const size_t offset = in[0] | size_t(in[1]) << 8;
+		in += 2;
+		if (offset == 0 || offset > static_cast<size_t>(out - begin))
+			return false;
+		size_t length = token & 15;
+		if (length == 15 && !readLength(in, inEnd, length))
+			return false;
+		length += minMatch;
+		if (length > static_cast<size_t>(outEnd - out))
+			return false;
+
+		// A match closer than its length overlaps itself, repeating its first offset bytes
+		const unsigned char* match = out - offset;
+		if (offset >= length)
+		{
+			std::memcpy(out, match, length);
+			out += length;
+		}
+		else
+		{
+			for (size_t i = 0; i < length; ++i)
+				*out++ = *match++;
+		}
+	}
+	return out == outEnd;
+}
+}	 // namespace zaphod
@@ -0,0 +1,409 @@
+// Cooks source assets into one package file, read at runtime with AssetPackage.
+//
+// Usage: zaphod-asset-cooker [--lz4] [--split] <output.zap> <type>:<name>=<input>...
+//
+// type is one of
+//   raw      the file as it is
+//   mesh     a Wavefront OBJ, triangulated, with duplicate vertices merged and uint32_t indices
+//   texture  a binary PPM (P6), as RGBA8 sRGB with a full mip chain
+// --lz4 compresses every blob that gets at least a page smaller, --split writes meshes with their
+// positions apart from their other attributes instead of interleaved.
+//
+// The package is left untouched if its content would not change, like the outputs of the
+// zaphod-spirv-tool, so a rebuild cooking the same assets does not touch what depends on it.
+
+#include "asset/asset_package.h"
+#include "util/hash.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+namespace format = zaphod::asset::asset_package;
+
+struct Options
+{
+	bool			   compress	= false;
+	format::MeshLayout layout	= format::MeshLayout::INTERLEAVED;
+};
+
+using Asset = format::CookedAsset;
+
+bool readFile(const std::filesystem::path& path, std::string& contents)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// Writes only if the content hash differs from what is there, keeping the old timestamp otherwise
+bool writeIfChanged(const std::filesystem::path& path, const std::string& contents)
+{
+	std::string existing;
+	if (readFile(path, existing) && existing.size() == contents.size()
+		&& zaphod::hashBytes(existing.data(), existing.size()) == zaphod::hashBytes(contents.data(), contents.size()))
+		return true;
+
+	std::error_code error;
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+	if (!file)
+	{
+		std::cerr << "Failed to write " << path.string() << '\n';
+		return false;
+	}
+	return true;
+}
+
+template<typename T>
+void append(std::string& data, const T* values, size_t count)
+{
+	data.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+// OBJ indices count from 1, or back from the last element when negative
+bool resolveIndex(std::string_view text, size_t count, int64_t& index)
+{
+	if (text.empty())
+	{
+		index = -1;
+		return true;
+	}
+	int64_t value	  = 0;
+	auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (error != std::errc() || end != text.data() + text.size() || value == 0)
+		return false;
+	index = value > 0 ? value - 1 : static_cast<int64_t>(count) + value;
+	return index >= 0 && index < static_cast<int64_t>(count);
+}
+
+bool cookMesh(const std::filesystem::path& path, const Options& options, Asset& asset)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		std::cerr << "Failed to read " << path.string() << '\n';
+		return false;
+	}
+
+	struct Vertex
+	{
+		float position[3];
+		float normal[3];
+		float uv[2];
+	};
+	static_assert(sizeof(Vertex) == 32);
+
+	// Each distinct position, uv and normal triple of a face corner becomes one vertex
+	struct Corner
+	{
+		int64_t position, uv, normal;
+		bool	operator==(const Corner&) const = default;
+	};
+	struct CornerHash
+	{
+		size_t operator()(const Corner& corner) const { return zaphod::hashBytes(&corner, sizeof(corner)); }
+	};
+
+	std::vector<float>								 positions, normals, uvs;
+	std::vector<Vertex>								 vertices;
+	std::vector<uint32_t>							 indices;
+	std::unordered_map<Corner, uint32_t, CornerHash> vertexIndices;
+	std::string										 line;
+	for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		std::istringstream stream(line);
+		std::string		   keyword;
+		stream >> keyword;
+		if (keyword == "v" || keyword == "vn")
+		{
+			std::vector<float>&	values = keyword == "v" ? positions : normals;
+			float				x	   = 0.0f, y = 0.0f, z = 0.0f;
+			stream >> x >> y >> z;
+			values.insert(values.end(), { x, y, z });
+		}
+		else if (keyword == "vt")
+		{
+			// OBJ puts v = 0 at the bottom of the image, Vulkan at the top
+			float u = 0.0f, v = 0.0f;
+			stream >> u >> v;
+			uvs.insert(uvs.end(), { u, 1.0f - v });
+		}
+		else if (keyword == "f")
+		{
+			std::vector<uint32_t> face;
+			for (std::string token; stream >> token;)
+			{
+				// position, position/uv, position//normal or position/uv/normal
+				std::string_view parts[3];
+				std::string_view rest = token;
+				for (std::string_view& part : parts)
+				{
+					const size_t slash = rest.find('/');
+					part = rest.substr(0, slash);
+					rest = slash == std::string_view::npos ? std::string_view() : rest.substr(slash + 1);
+				}
+
+				Corner corner;
+				if (parts[0].empty() || !resolveIndex(parts[0], positions.size() / 3, corner.position)
+					|| !resolveIndex(parts[1], uvs.size() / 2, corner.uv)
+					|| !resolveIndex(parts[2], normals.size() / 3, corner.normal))
+				{
+					std::cerr << path.string() << ':' << lineNumber << ": invalid face corner " << token << '\n';
+					return false;
+				}
+
+				auto [it, isNew] = vertexIndices.try_emplace(corner, static_cast<uint32_t>(vertices.size()));
+				if (isNew)
+				{
+					// Zeroed, for the attributes the corner does not have
+					Vertex& vertex = vertices.emplace_back();
+					std::memcpy(vertex.position, &positions[corner.position * 3], sizeof(vertex.position));
+					if (corner.normal >= 0)
+						std::memcpy(vertex.normal, &normals[corner.normal * 3], sizeof(vertex.normal));
+					if (corner.uv >= 0)
+						std::memcpy(vertex.uv, &uvs[corner.uv * 2], sizeof(vertex.uv));
+				}
+				face.push_back(it->second);
+			}
+			if (face.size() < 3)
+			{
+				std::cerr << path.string() << ':' << lineNumber << ": face with fewer than 3 corners\n";
+				return false;
+			}
+
+			// Polygons become fans, which assumes they are convex
+			for (size_t i = 2; i < face.size(); ++i)
+				indices.insert(indices.end(), { face[0], face[i - 1], face[i] });
+		}
+	}
+	if (indices.empty())
+	{
+		std::cerr << path.string() << " has no faces\n";
+		return false;
+	}
+
+	format::MeshInfo info {};
+	info.layout		 = options.layout;
+	info.vertexCount = static_cast<uint32_t>(vertices.size());
+	info.indexCount	 = static_cast<uint32_t>(indices.size());
+	if (options.layout == format::MeshLayout::INTERLEAVED)
+		append(asset.data, vertices.data(), vertices.size());
+	else
+	{
+		for (const Vertex& vertex : vertices)
+			append(asset.data, vertex.position, 3);
+		info.attributeOffset = static_cast<uint32_t>(asset.data.size());
+		for (const Vertex& vertex : vertices)
+		{
+			append(asset.data, vertex.normal, 3);
+			append(asset.data, vertex.uv, 2);
+		}
+	}
+	info.indexOffset = static_cast<uint32_t>(asset.data.size());
+	append(asset.data, indices.data(), indices.size());
+
+	asset.entry.type = format::AssetType::MESH;
+	format::setInfo(asset.entry, info);
+	return true;
+}
+
+// Skips whitespace and # comments between the fields of a PPM header
+bool readPpmField(std::string_view& text, uint32_t& value)
+{
+	while (!text.empty() && (std::isspace(static_cast<unsigned char>(text.front())) || text.front() == '#'))
+	{
+		if (text.front() == '#')
+			text.remove_prefix(std::min(text.find('\n'), text.size()));
+		else
+			text.remove_prefix(1);
+	}
+	auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	text.remove_prefix(static_cast<size_t>(end - text.data()));
+	return error == std::errc();
+}
+
+float toLinear(uint8_t value)
+{
+	const float c = value / 255.0f;
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t toSrgb(float value)
+{
+	const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+bool cookTexture(const std::filesystem::path& path, Asset& asset)
+{
+	std::string contents;
+	if (!readFile(path, contents))
+	{
+		std::cerr << "Failed to read " << path.string() << '\n';
+		return false;
+	}
+
+	std::string_view text  = contents;
+	uint32_t		 width = 0, height = 0, maxValue = 0;
+	if (!text.starts_with("P6"))
+	{
+		std::cerr << path.string() << " is not a binary PPM\n";
+		return false;
+	}
+	text.remove_prefix(2);
+	if (!readPpmField(text, width) || !readPpmField(text, height) || !readPpmField(text, maxValue) || width == 0
+		|| height == 0 || maxValue != 255 || text.empty() || text.size() - 1 < size_t(width) * height * 3)
+	{
+		std::cerr << path.string() << " is not an 8-bit PPM of the size its header gives\n";
+		return false;
+	}
+	text.remove_prefix(1);	  // The single whitespace before the texels
+
+	format::TextureInfo info {};
+	info.format	   = VK_FORMAT_R8G8B8A8_SRGB;
+	info.width	   = width;
+	info.height	   = height;
+	info.mipCount  = static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+	info.texelSize = 4;
+	asset.data.assign(format::getMipOffset(info, info.mipCount), '\0');
+
+	auto* level = reinterpret_cast<uint8_t*>(asset.data.data());
+	for (size_t i = 0; i < size_t(width) * height; ++i)
+	{
+		std::memcpy(level + i * 4, text.data() + i * 3, 3);
+		level[i * 4 + 3] = 255;
+	}
+
+	// Every level averages 2x2 texels of the one before in linear space, the last row or column
+	// of an odd size is repeated
+	float linear[256];
+	for (int value = 0; value < 256; ++value)
+		linear[value] = toLinear(static_cast<uint8_t>(value));
+	for (uint32_t mip = 1; mip < info.mipCount; ++mip)
+	{
+		const uint32_t sourceWidth	= format::getMipExtent(width, mip - 1);
+		const uint32_t sourceHeight	= format::getMipExtent(height, mip - 1);
+		const uint8_t* source		= level;
+		level						= reinterpret_cast<uint8_t*>(asset.data.data() + format::getMipOffset(info, mip));
+		const uint32_t levelWidth	= format::getMipExtent(width, mip);
+		for (uint32_t y = 0; y < format::getMipExtent(height, mip); ++y)
+		{
+			const uint8_t* row0 = source + size_t(std::min(y * 2, sourceHeight - 1)) * sourceWidth * 4;
+			const uint8_t* row1 = source + size_t(std::min(y * 2 + 1, sourceHeight - 1)) * sourceWidth * 4;
+			for (uint32_t x = 0; x < levelWidth; ++x)
+			{
+				const uint32_t x0		 = std::min(x * 2, sourceWidth - 1) * 4;
+				const uint32_t x1		 = std::min(x * 2 + 1, sourceWidth - 1) * 4;
+				const uint8_t* texels[4] = { row0 + x0, row0 + x1, row1 + x0, row1 + x1 };
+				uint8_t*	   texel	 = level + (size_t(y) * levelWidth + x) * 4;
+				for (int channel = 0; channel < 3; ++channel)
+				{
+					float sum = 0.0f;
+					for (const uint8_t* sample : texels)
+						sum += linear[sample[channel]];
+					texel[channel] = toSrgb(sum * 0.25f);
+				}
+				texel[3] = static_cast<uint8_t>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+			}
+		}
+	}
+
+	asset.entry.type = format::AssetType::TEXTURE;
+	format::setInfo(asset.entry, info);
+	return true;
+}
+
+int cook(const std::filesystem::path& outputPath, const Options& options, const std::vector<std::string_view>& inputs)
+{
+	std::vector<Asset> assets;
+	for (std::string_view input : inputs)
+	{
+		const size_t colon	= input.find(':');
+		const size_t equals = input.find('=');
+		if (colon == std::string_view::npos || equals == std::string_view::npos || equals < colon || equals == colon + 1)
+		{
+			std::cerr << "Expected <type>:<name>=<input>, got " << input << '\n';
+			return 1;
+		}
+
+		Asset& asset = assets.emplace_back();
+		asset.name	 = input.substr(colon + 1, equals - colon - 1);
+
+		const std::string_view		type	 = input.substr(0, colon);
+		const std::filesystem::path	path	 = std::string(input.substr(equals + 1));
+		bool						isCooked = false;
+		if (type == "raw")
+		{
+			isCooked = readFile(path, asset.data);
+			if (!isCooked)
+				std::cerr << "Failed to read " << path.string() << '\n';
+		}
+		else if (type == "mesh")
+			isCooked = cookMesh(path, options, asset);
+		else if (type == "texture")
+			isCooked = cookTexture(path, asset);
+		else
+			std::cerr << "Unknown asset type " << type << '\n';
+		if (!isCooked)
+			return 1;
+	}
+
+	std::string			 file;
+	const zaphod::Result result = format::buildPackage(assets, options.compress, file);
+	if (result.isFailure())
+	{
+		std::cerr << result.message << '\n';
+		return 1;
+	}
+	return writeIfChanged(outputPath, file) ? 0 : 1;
+}
+
+int usage()
+{
+	std::cerr << "Usage: zaphod-asset-cooker [--lz4] [--split] <output.zap> <type>:<name>=<input>...\n"
+				 "       type is raw, mesh (.obj) or texture (.ppm)\n";
+	return 1;
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	Options	options;
+	int		argument = 1;
+	for (; argument < argc && std::string_view(argv[argument]).starts_with("--"); ++argument)
+	{
+		const std::string_view option = argv[argument];
+		if (option == "--lz4")
+			options.compress = true;
+		else if (option == "--split")
+			options.layout = format::MeshLayout::SPLIT;
+		else
+			return usage();
+	}
+	if (argument >= argc)
+		return usage();
+	return cook(argv[argument], options, std::vector<std::string_view>(argv + argument + 1, argv + argc));
+}
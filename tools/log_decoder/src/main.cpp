@@ -0,0 +1,111 @@
+// Turns binary log files written by the BINARY log destination back into text.
+//
+// Usage: zaphod-log-decoder [--simple | --error] <input> [output]
+//
+// By default every record is rendered with the format it was logged with. --simple and --error
+// render every record with SimpleLogger::defaultFormatString or ErrorLogger::defaultFormatString
+// instead, using the static tokens recorded with the original format.
+
+#include "core/binary_log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace zaphod::logging;
+
+namespace
+{
+// Builds a format from one of the default layouts, keeping the recorded values of SOURCE, FUNCTION, ...
+Logger::Format makeLayout(std::string_view formatString, const Logger::Format::ParameterMap& recordedTokens)
+{
+	Logger::Format::ParameterMap staticTokens { { "SOURCE", "" }, { "FUNCTION", "" } };
+	for (const auto& [token, value] : recordedTokens)
+		if (token != "LEVEL" && token != "TIME")
+			staticTokens[token] = value;
+	return Logger::Format(std::string(formatString), staticTokens);
+}
+
+int usage()
+{
+	std::cerr << "Usage: zaphod-log-decoder [--simple | --error] <input> [output]\n";
+	return 1;
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	std::string_view layout;
+	std::string		 inputPath, outputPath;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view argument = argv[i];
+		if (argument == "--simple")
+			layout = SimpleLogger::defaultFormatString;
+		else if (argument == "--error")
+			layout = ErrorLogger::defaultFormatString;
+		else if (argument.starts_with("--"))
+			return usage();
+		else if (inputPath.empty())
+			inputPath = argument;
+		else if (outputPath.empty())
+			outputPath = argument;
+		else
+			return usage();
+	}
+	if (inputPath.empty())
+		return usage();
+
+	BinaryLogReader reader;
+	zaphod::Result	result = reader.open(inputPath);
+	if (!result.isSuccess())
+	{
+		std::cerr << result.message << '\n';
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (!outputPath.empty())
+	{
+		outputFile.open(outputPath, std::ios::binary);
+		if (!outputFile)
+		{
+			std::cerr << "Failed to open " << outputPath << '\n';
+			return 1;
+		}
+	}
+	std::ostream& output = outputPath.empty() ? std::cout : outputFile;
+
+	BinaryLogReader::Entry entry;
+	TimestampCache		   timestampCache;
+	std::string			   line;
+	size_t				   skipped = 0;
+	while (reader.next(entry))
+	{
+		const Logger::Format* format = reader.getFormat(entry.formatIndex);
+		std::optional<Logger::Format> override;
+		if (!layout.empty())
+			format = &override.emplace(makeLayout(layout, reader.getStaticTokens(entry.formatIndex)));
+		if (!format || !format->isValid())
+		{
+			++skipped;
+			continue;
+		}
+
+		line.clear();
+		format->render(line,
+					   entry.message,
+					   entry.level,
+					   timestampCache.format(entry.time, TimePrecision::MILLISECONDS),
+					   entry.dynamicParameters);
+		line.push_back('\n');
+		output.write(line.data(), static_cast<std::streamsize>(line.size()));
+	}
+
+	if (skipped > 0)
+		std::cerr << skipped << " records referenced an unknown or invalid format and were skipped\n";
+	return 0;
+}
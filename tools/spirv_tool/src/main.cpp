@@ -0,0 +1,175 @@
+// Turns SPIR-V compiled by glslc into what the engine consumes, as a build step.
+//
+// Usage: zaphod-spirv-tool embed <input.spv> <output.h> <symbol>
+//        zaphod-spirv-tool pack <output.zpk> <name=input.spv>...
+//
+// embed writes a header defining `alignas(4) inline constexpr uint32_t <symbol>[]` and
+// `<symbol>_size` (in bytes), ready for VkShaderModuleCreateInfo::pCode.
+// pack bundles every input into one shader pack file, read at runtime with ShaderPack.
+//
+// Outputs whose content would not change are left untouched, so recompiling a shader to the same
+// SPIR-V (after editing a comment, say) does not rebuild anything that depends on them.
+
+#include "render/shader_pack.h"
+#include "util/hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+bool readFile(const std::filesystem::path& path, std::string& contents)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// Writes only if the content hash differs from what is there, keeping the old timestamp otherwise
+bool writeIfChanged(const std::filesystem::path& path, const std::string& contents)
+{
+	std::string existing;
+	if (readFile(path, existing) && existing.size() == contents.size()
+		&& zaphod::hashBytes(existing.data(), existing.size()) == zaphod::hashBytes(contents.data(), contents.size()))
+		return true;
+
+	std::error_code error;
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+	if (!file)
+	{
+		std::cerr << "Failed to write " << path.string() << '\n';
+		return false;
+	}
+	return true;
+}
+
+bool readSpirv(const std::filesystem::path& path, std::string& code)
+{
+	if (!readFile(path, code))
+	{
+		std::cerr << "Failed to read " << path.string() << '\n';
+		return false;
+	}
+	if (code.empty() || code.size() % sizeof(uint32_t) != 0)
+	{
+		std::cerr << path.string() << " is not SPIR-V, its size is not a multiple of 4\n";
+		return false;
+	}
+	return true;
+}
+
+int embed(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, std::string_view symbol)
+{
+	std::string code;
+	if (!readSpirv(inputPath, code))
+		return 1;
+
+	std::string header;
+	header += "#pragma once\n\n";
+	header += "// Generated from " + inputPath.filename().string() + " by zaphod-spirv-tool, do not edit\n\n";
+	header += "#include <cstddef>\n#include <cstdint>\n\n";
+	header += "alignas(4) inline constexpr uint32_t " + std::string(symbol) + "[] = {";
+
+	constexpr size_t wordsPerLine = 8;
+	const size_t	 wordCount	  = code.size() / sizeof(uint32_t);
+	char			 word[16];
+	for (size_t i = 0; i < wordCount; ++i)
+	{
+		uint32_t value;
+		std::memcpy(&value, code.data() + i * sizeof(uint32_t), sizeof(value));
+		std::snprintf(word, sizeof(word), "0x%08x,", value);
+		header += i % wordsPerLine == 0 ? "\n\t" : " ";
+		header += word;
+	}
+	header += "\n};\n";
+	header += "inline constexpr size_t " + std::string(symbol) + "_size = sizeof(" + std::string(symbol) + ");\n";
+	return writeIfChanged(outputPath, header) ? 0 : 1;
+}
+
+int pack(const std::filesystem::path& outputPath, const std::vector<std::string_view>& inputs)
+{
+	namespace format = zaphod::render::shader_pack;
+
+	std::vector<std::string> names, codes;
+	for (std::string_view input : inputs)
+	{
+		const size_t separator = input.find('=');
+		if (separator == std::string_view::npos)
+		{
+			std::cerr << "Expected <name>=<input.spv>, got " << input << '\n';
+			return 1;
+		}
+		names.emplace_back(input.substr(0, separator));
+		if (!readSpirv(std::string(input.substr(separator + 1)), codes.emplace_back()))
+			return 1;
+	}
+
+	format::Header header {};
+	std::memcpy(header.magic, format::magic, sizeof(header.magic));
+	header.version	  = format::version;
+	header.entryCount = static_cast<uint32_t>(names.size());
+
+	// Header, entry table and names, then the code of every shader on a 4-byte boundary
+	std::vector<format::Entry> entries(names.size());
+	size_t					   offset = sizeof(header) + entries.size() * sizeof(format::Entry);
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		entries[i].nameOffset = static_cast<uint32_t>(offset);
+		entries[i].nameLength = static_cast<uint32_t>(names[i].size());
+		offset += names[i].size();
+	}
+	offset = (offset + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+	for (size_t i = 0; i < codes.size(); ++i)
+	{
+		entries[i].codeOffset = static_cast<uint32_t>(offset);
+		entries[i].codeSize	  = static_cast<uint32_t>(codes[i].size());
+		entries[i].codeHash	  = zaphod::hashBytes(codes[i].data(), codes[i].size());
+		offset += codes[i].size();
+	}
+
+	std::string file;
+	file.reserve(offset);
+	file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(format::Entry));
+	for (const std::string& name : names)
+		file += name;
+	file.resize((file.size() + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1), '\0');
+	for (const std::string& code : codes)
+		file += code;
+	return writeIfChanged(outputPath, file) ? 0 : 1;
+}
+
+int usage()
+{
+	std::cerr << "Usage: zaphod-spirv-tool embed <input.spv> <output.h> <symbol>\n"
+				 "       zaphod-spirv-tool pack <output.zpk> <name=input.spv>...\n";
+	return 1;
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return usage();
+
+	std::string_view command = argv[1];
+	if (command == "embed" && argc == 5)
+		return embed(argv[2], argv[3], argv[4]);
+	if (command == "pack" && argc >= 3)
+		return pack(argv[2], std::vector<std::string_view>(argv + 3, argv + argc));
+	return usage();
+}